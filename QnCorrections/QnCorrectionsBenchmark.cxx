@@ -0,0 +1,1339 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsBenchmark.cxx
+/// \brief Micro and macro benchmarks of the framework hot paths
+///
+/// Stand alone program, built when the CMake option
+/// QNCORRECTIONS_BUILD_BENCHMARKS is on, which times the framework
+/// building blocks, Qn vector building, histogram bin location and
+/// filling, cuts and profile division, as well as the whole event
+/// processing with the framework in calibration, mixed and apply states.
+///
+/// The benchmarks are parametrised by multiplicity, number of harmonics
+/// and event classes dimensionality. Each one runs in doubling batches
+/// of iterations until the minimum time is reached. The command line
+/// and the JSON output follow the Google benchmark library ones, so the
+/// results can be tracked across releases with the same tools
+///
+///     QnCorrectionsBenchmark [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>]
+///                            [--benchmark_format=console|json] [--benchmark_out=<file>]
+///                            [--benchmark_prep_events=<n>] [--benchmark_list_tests]
+///
+/// The parameters of each benchmark are reported, in the JSON output,
+/// as counters of the benchmark entry. Benchmarks which also check a
+/// framework property report its failure as an error of the benchmark
+/// entry and the program then exits with a non zero status.
+
+#include <TMath.h>
+#include <TList.h>
+#include <TFile.h>
+#include <THn.h>
+#include <TRandom3.h>
+#include <TStopwatch.h>
+#include <TSystem.h>
+#include <TDatime.h>
+#include <TPRegexp.h>
+
+#include "QnCorrectionsLog.h"
+#include "QnCorrectionsEventClassVariable.h"
+#include "QnCorrectionsEventClassVariablesSet.h"
+#include "QnCorrectionsCutAbove.h"
+#include "QnCorrectionsCutBelow.h"
+#include "QnCorrectionsCutWithin.h"
+#include "QnCorrectionsCutsSet.h"
+#include "QnCorrectionsHistogram.h"
+#include "QnCorrectionsHistogramChannelized.h"
+#include "QnCorrectionsProfile.h"
+#include "QnCorrectionsProfileComponents.h"
+#include "QnCorrectionsProfileCorrelationComponents.h"
+#include "QnCorrectionsProfileCorrelationComponentsHarmonics.h"
+#include "QnCorrectionsProfile3DCorrelations.h"
+#include "QnCorrectionsProfileChannelized.h"
+#include "QnCorrectionsQnVector.h"
+#include "QnCorrectionsQnVectorBuild.h"
+#include "QnCorrectionsDetector.h"
+#include "QnCorrectionsDetectorConfigurationTracks.h"
+#include "QnCorrectionsDetectorConfigurationChannels.h"
+#include "QnCorrectionsInputGainEqualization.h"
+#include "QnCorrectionsQnVectorRecentering.h"
+#include "QnCorrectionsQnVectorAlignment.h"
+#include "QnCorrectionsQnVectorTwistAndRescale.h"
+#include "QnCorrectionsManager.h"
+#include "QnCorrectionsCalibrationSnapshot.h"
+#include "QnCorrectionsEventGenerator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/// The benchmark execution state
+///
+/// Drives the timed loop of a benchmark. KeepRunning is called before
+/// each iteration; the time is only checked at the end of each batch of
+/// iterations, the batches doubling their size, so that the loop
+/// overhead is negligible.
+class QnCorrectionsBenchmarkState {
+public:
+  QnCorrectionsBenchmarkState(const Int_t *args, Double_t minTime);
+
+  /// Gets a benchmark parameter
+  /// \param i the parameter index
+  /// \return the parameter value
+  Int_t GetArg(Int_t i) const { return fArgs[i]; }
+  /// Gets the number of completed iterations
+  /// \return the number of iterations
+  Long64_t GetIterations() const { return fIterations; }
+  /// Gets the measured real time
+  /// \return the real time in seconds
+  Double_t GetRealTime() const { return fRealTime; }
+  /// Gets the measured cpu time
+  /// \return the cpu time in seconds
+  Double_t GetCpuTime() const { return fCpuTime; }
+  /// Gets the number of items processed by the whole run
+  /// \return the number of items
+  Long64_t GetItemsProcessed() const { return fItemsProcessed; }
+  /// Gets the run label
+  /// \return the label
+  const char *GetLabel() const { return fLabel.Data(); }
+  /// Checks whether the run was stopped because of an error
+  /// \return kTRUE if an error occurred
+  Bool_t ErrorOccurred() const { return fErrorOccurred; }
+  /// Gets the error which stopped the run
+  /// \return the error message
+  const char *GetErrorMessage() const { return fErrorMessage.Data(); }
+  /// Sets the number of items processed by the whole run
+  /// \param nItems the number of items
+  void SetItemsProcessed(Long64_t nItems) { fItemsProcessed = nItems; }
+  /// Sets a descriptive label for the run
+  /// \param label the label
+  void SetLabel(const char *label) { fLabel = label; }
+  /// Stops the timing for a non measured part of an iteration
+  void PauseTiming() { fStopwatch.Stop(); }
+  /// Resumes the timing after a non measured part of an iteration
+  void ResumeTiming() { fStopwatch.Continue(); }
+  void SkipWithError(const char *message);
+
+  Bool_t KeepRunning();
+
+  static const Long64_t nMaxIterations;  ///< the maximum number of iterations of a run
+
+private:
+  Bool_t NextBatch();
+
+  const Int_t *fArgs;          ///< the benchmark parameters
+  Double_t fMinTime;           ///< the minimum measuring time in seconds
+  Bool_t fStarted;             ///< the timing started
+  Long64_t fIterations;        ///< the number of started iterations
+  Long64_t fBatchEnd;          ///< the number of iterations at which the current batch finishes
+  Long64_t fItemsProcessed;    ///< the number of items processed
+  Double_t fRealTime;          ///< the measured real time in seconds
+  Double_t fCpuTime;           ///< the measured cpu time in seconds
+  TString fLabel;              ///< the run label
+  Bool_t fErrorOccurred;       ///< the run was stopped because of an error
+  TString fErrorMessage;       ///< the error which stopped the run
+  TStopwatch fStopwatch;       ///< the run timer
+};
+
+const Long64_t QnCorrectionsBenchmarkState::nMaxIterations = 1000000000;
+
+/// Normal constructor
+/// \param args the benchmark parameters
+/// \param minTime the minimum measuring time in seconds
+QnCorrectionsBenchmarkState::QnCorrectionsBenchmarkState(const Int_t *args, Double_t minTime) :
+    fLabel(), fErrorMessage(), fStopwatch() {
+  fArgs = args;
+  fMinTime = minTime;
+  fStarted = kFALSE;
+  fIterations = 0;
+  fBatchEnd = 0;
+  fItemsProcessed = 0;
+  fRealTime = 0.0;
+  fCpuTime = 0.0;
+  fErrorOccurred = kFALSE;
+}
+
+/// Stops the run because of an error
+///
+/// The next KeepRunning call finishes the run, which is reported as failed.
+/// \param message the error message
+void QnCorrectionsBenchmarkState::SkipWithError(const char *message) {
+  fErrorOccurred = kTRUE;
+  fErrorMessage = message;
+  fBatchEnd = fIterations;
+}
+
+/// Checks whether a new iteration should be run
+///
+/// The first call starts the timing.
+/// \return kTRUE if a new iteration has to be run
+inline Bool_t QnCorrectionsBenchmarkState::KeepRunning() {
+  if (fIterations < fBatchEnd) {
+    fIterations++;
+    return kTRUE;
+  }
+  return NextBatch();
+}
+
+/// Starts the timing or, at the end of a batch, decides about a new one
+///
+/// The next batch is sized from the time taken so far for reaching the
+/// minimum time, but never more than ten times the iterations done.
+/// \return kTRUE if a new iteration has to be run
+Bool_t QnCorrectionsBenchmarkState::NextBatch() {
+  if (!fStarted) {
+    fStarted = kTRUE;
+    fIterations = 1;
+    fBatchEnd = 1;
+    fStopwatch.Start(kTRUE);
+    return kTRUE;
+  }
+  /* RealTime stops the stopwatch */
+  Double_t elapsed = fStopwatch.RealTime();
+  if (fErrorOccurred || !(elapsed < fMinTime) || !(fIterations < nMaxIterations)) {
+    fRealTime = elapsed;
+    fCpuTime = fStopwatch.CpuTime();
+    return kFALSE;
+  }
+  Double_t factor = (elapsed > 0.0) ? 1.4 * fMinTime / elapsed : 10.0;
+  if (factor > 10.0) factor = 10.0;
+  if (factor < 2.0) factor = 2.0;
+  fBatchEnd = TMath::Min(Long64_t(fIterations * factor), nMaxIterations);
+  fIterations++;
+  fStopwatch.Continue();
+  return kTRUE;
+}
+
+/// The benchmark function type
+typedef void (*QnCorrectionsBenchmarkFunction_t)(QnCorrectionsBenchmarkState &state);
+
+/// The maximum number of parameters of a benchmark
+#define QNCORRECTIONSBENCHMARKMAXARGS 4
+
+/// A registered benchmark with concrete parameter values
+struct QnCorrectionsBenchmarkCase {
+  TString fName;                                      ///< the benchmark name, with its parameters
+  QnCorrectionsBenchmarkFunction_t fFunction;         ///< the benchmark function
+  Int_t fNoOfArgs;                                    ///< the number of parameters
+  const char *fArgName[QNCORRECTIONSBENCHMARKMAXARGS]; ///< the parameters names
+  Int_t fArgs[QNCORRECTIONSBENCHMARKMAXARGS];         ///< the parameters values
+};
+
+/// The values one parameter of a benchmark family takes
+struct QnCorrectionsBenchmarkRange {
+  const char *fName;        ///< the parameter name
+  Int_t fNoOfValues;        ///< the number of values
+  const Int_t *fValues;     ///< the values
+};
+
+/// The outcome of a benchmark run
+struct QnCorrectionsBenchmarkResult {
+  Long64_t fIterations;     ///< the number of iterations run
+  Double_t fRealTime;       ///< the real time per iteration in ns
+  Double_t fCpuTime;        ///< the cpu time per iteration in ns
+  Double_t fItemsPerSecond; ///< the items processed per second, zero if not reported
+  TString fLabel;           ///< the run label
+  Bool_t fErrorOccurred;    ///< the run was stopped because of an error
+  TString fErrorMessage;    ///< the error which stopped the run
+};
+
+/// Keeps the benchmark results out of the compiler dead code elimination
+volatile Long64_t gQnCorrectionsBenchmarkSink = 0;
+
+/// Runs a benchmark
+/// \param benchmark the benchmark to run
+/// \param minTime the minimum measuring time in seconds
+/// \param result the run outcome
+void QnCorrectionsRunBenchmark(const QnCorrectionsBenchmarkCase &benchmark, Double_t minTime, QnCorrectionsBenchmarkResult &result) {
+  QnCorrectionsBenchmarkState state(benchmark.fArgs, minTime);
+  benchmark.fFunction(state);
+
+  Long64_t nIterations = state.GetIterations();
+  result.fIterations = nIterations;
+  result.fRealTime = (nIterations > 0) ? state.GetRealTime() * 1e9 / nIterations : 0.0;
+  result.fCpuTime = (nIterations > 0) ? state.GetCpuTime() * 1e9 / nIterations : 0.0;
+  result.fItemsPerSecond = (state.GetRealTime() > 0.0) ? state.GetItemsProcessed() / state.GetRealTime() : 0.0;
+  result.fLabel = state.GetLabel();
+  result.fErrorOccurred = state.ErrorOccurred();
+  result.fErrorMessage = state.GetErrorMessage();
+}
+
+/// Registers a benchmark family, one benchmark per parameters combination
+///
+/// The first parameter is the outermost one.
+/// \param cases the registered benchmarks
+/// \param family the family name
+/// \param function the benchmark function
+/// \param nRanges the number of parameters
+/// \param ranges the values of each parameter
+void QnCorrectionsRegisterBenchmark(std::vector<QnCorrectionsBenchmarkCase> &cases, const char *family,
+    QnCorrectionsBenchmarkFunction_t function, Int_t nRanges, const QnCorrectionsBenchmarkRange *ranges) {
+  Int_t nCombinations = 1;
+  for (Int_t ixRange = 0; ixRange < nRanges; ixRange++) {
+    nCombinations *= ranges[ixRange].fNoOfValues;
+  }
+  for (Int_t ixCombination = 0; ixCombination < nCombinations; ixCombination++) {
+    QnCorrectionsBenchmarkCase benchmark;
+    benchmark.fFunction = function;
+    benchmark.fNoOfArgs = nRanges;
+    Int_t rest = ixCombination;
+    for (Int_t ixRange = nRanges - 1; ixRange >= 0; ixRange--) {
+      benchmark.fArgName[ixRange] = ranges[ixRange].fName;
+      benchmark.fArgs[ixRange] = ranges[ixRange].fValues[rest % ranges[ixRange].fNoOfValues];
+      rest /= ranges[ixRange].fNoOfValues;
+    }
+    benchmark.fName = family;
+    for (Int_t ixRange = 0; ixRange < nRanges; ixRange++) {
+      benchmark.fName += Form("/%s:%d", benchmark.fArgName[ixRange], benchmark.fArgs[ixRange]);
+    }
+    cases.push_back(benchmark);
+  }
+}
+
+/* the micro benchmarks setup */
+
+/// The number of variables, and event class variables at most, of the micro benchmarks
+const Int_t nMicroNoOfVariables = 4;
+/// The number of variables containers the micro benchmarks cycle through
+const Int_t nMicroNoOfContainers = 1024;
+/// The number of channels of the channelized histograms
+const Int_t nMicroNoOfChannels = 64;
+/// The random seed for the benchmarks input
+const UInt_t nBenchmarkSeed = 1234;
+
+/// Builds the event classes variables set of the micro benchmarks
+///
+/// Each dimension spans ten bins within [0,100). The variables are
+/// owned by the set.
+/// \param nDimensions the number of event classes dimensions
+/// \return the event classes variables set
+QnCorrectionsEventClassVariablesSet *BuildMicroEventClasses(Int_t nDimensions) {
+  QnCorrectionsEventClassVariablesSet *ecvs = new QnCorrectionsEventClassVariablesSet(nDimensions);
+  for (Int_t ixDimension = 0; ixDimension < nDimensions; ixDimension++) {
+    ecvs->Add(new QnCorrectionsEventClassVariable(ixDimension, Form("Variable%d", ixDimension), 10, 0.0, 100.0));
+  }
+  ecvs->SetOwner(kTRUE);
+  return ecvs;
+}
+
+/// Builds the variables containers the micro benchmarks cycle through
+///
+/// The values are uniformly distributed within [0,100).
+/// \param containers the containers storage, container major
+void BuildMicroContainers(std::vector<Float_t> &containers) {
+  TRandom3 random(nBenchmarkSeed);
+  containers.resize(nMicroNoOfContainers * nMicroNoOfVariables);
+  for (UInt_t ix = 0; ix < containers.size(); ix++) {
+    containers[ix] = random.Uniform(0.0, 100.0);
+  }
+}
+
+/// Builds a consecutive harmonics map starting at the given harmonic
+/// \param nHarmonics the number of harmonics
+/// \param first the first harmonic
+/// \param harmonicsMap the map storage
+void BuildHarmonicsMap(Int_t nHarmonics, Int_t first, Int_t *harmonicsMap) {
+  for (Int_t h = 0; h < nHarmonics; h++) {
+    harmonicsMap[h] = first + h;
+  }
+}
+
+/// Builds a Qn vector with good quality out of random angles
+/// \param name the Qn vector name
+/// \param nHarmonics the number of harmonics
+/// \param harmonicsMap the harmonics map
+/// \param random the random numbers generator
+/// \return the Qn vector
+QnCorrectionsQnVectorBuild *BuildMicroQnVector(const char *name, Int_t nHarmonics, Int_t *harmonicsMap, TRandom &random) {
+  QnCorrectionsQnVectorBuild *qn = new QnCorrectionsQnVectorBuild(name, nHarmonics, harmonicsMap);
+  for (Int_t ix = 0; ix < 100; ix++) {
+    qn->Add(random.Uniform(0.0, TMath::TwoPi()));
+  }
+  qn->CheckQuality();
+  return qn;
+}
+
+/// Profile giving access to the histograms division
+class QnCorrectionsBenchmarkProfile : public QnCorrectionsProfile {
+public:
+  /// Normal constructor
+  /// \param name base for the name of the histograms
+  /// \param title base for the title of the histograms
+  /// \param ecvs the event classes variables set
+  QnCorrectionsBenchmarkProfile(const char *name, const char *title, QnCorrectionsEventClassVariablesSet &ecvs) :
+    QnCorrectionsProfile(name, title, ecvs) {}
+  /// Divides the values histogram by the entries one
+  /// \param values the values histogram
+  /// \param entries the entries histogram
+  /// \return the new histogram with the division result
+  THnF *Divide(THnF *values, THnI *entries) { return DivideTHnF(values, entries); }
+};
+
+/* the micro benchmarks */
+
+/// Qn vector building from individual data vectors
+///
+/// Parameters: harmonics, multiplicity. Items: data vectors.
+void BM_QnVectorBuildAdd(QnCorrectionsBenchmarkState &state) {
+  Int_t nHarmonics = state.GetArg(0);
+  Int_t nMultiplicity = state.GetArg(1);
+  Int_t harmonicsMap[MAXHARMONICNUMBERSUPPORTED];
+  BuildHarmonicsMap(nHarmonics, 1, harmonicsMap);
+
+  TRandom3 random(nBenchmarkSeed);
+  std::vector<Double_t> phi(nMultiplicity);
+  for (Int_t ix = 0; ix < nMultiplicity; ix++) phi[ix] = random.Uniform(0.0, TMath::TwoPi());
+
+  QnCorrectionsQnVectorBuild qn("QnVectorBuildAdd", nHarmonics, harmonicsMap);
+  while (state.KeepRunning()) {
+    qn.Reset();
+    for (Int_t ix = 0; ix < nMultiplicity; ix++) {
+      qn.Add(phi[ix]);
+    }
+  }
+  gQnCorrectionsBenchmarkSink += qn.GetN();
+  state.SetItemsProcessed(state.GetIterations() * nMultiplicity);
+}
+
+/// Qn vector harmonics recurrence accuracy and direct evaluation reference
+///
+/// The harmonics of each contribution obtained by the recurrence used when
+/// building Qn vectors are compared against their direct TMath::Cos /
+/// TMath::Sin evaluation and the maximum absolute deviation per harmonic is
+/// reported in the label. The timed part is the Qn vector build with the
+/// direct evaluation per harmonic, the reference for BM_QnVectorBuildAdd.
+///
+/// Parameters: harmonics, multiplicity. Items: data vectors.
+void BM_QnVectorBuildAccuracy(QnCorrectionsBenchmarkState &state) {
+  Int_t nHarmonics = state.GetArg(0);
+  Int_t nMultiplicity = state.GetArg(1);
+
+  TRandom3 random(nBenchmarkSeed);
+  std::vector<Double_t> phi(nMultiplicity);
+  for (Int_t ix = 0; ix < nMultiplicity; ix++) phi[ix] = random.Uniform(0.0, TMath::TwoPi());
+
+  Double_t cosTable[HARMONICSTABLESIZE];
+  Double_t sinTable[HARMONICSTABLESIZE];
+  Double_t maxDeviation[MAXHARMONICNUMBERSUPPORTED + 1];
+  for (Int_t h = 1; h < nHarmonics + 1; h++) maxDeviation[h] = 0.0;
+  for (Int_t ix = 0; ix < nMultiplicity; ix++) {
+    QnCorrectionsQnVectorBuild::FillHarmonicsTable(phi[ix], nHarmonics, cosTable, sinTable);
+    for (Int_t h = 1; h < nHarmonics + 1; h++) {
+      maxDeviation[h] = TMath::Max(maxDeviation[h], TMath::Abs(cosTable[h] - TMath::Cos(h * phi[ix])));
+      maxDeviation[h] = TMath::Max(maxDeviation[h], TMath::Abs(sinTable[h] - TMath::Sin(h * phi[ix])));
+    }
+  }
+  TString label = "max deviation";
+  for (Int_t h = 1; h < nHarmonics + 1; h++) label += Form(" h%d:%.2g", h, maxDeviation[h]);
+  state.SetLabel(label);
+
+  std::vector<Double_t> qnX(nHarmonics + 1);
+  std::vector<Double_t> qnY(nHarmonics + 1);
+  while (state.KeepRunning()) {
+    for (Int_t h = 1; h < nHarmonics + 1; h++) { qnX[h] = 0.0; qnY[h] = 0.0; }
+    for (Int_t ix = 0; ix < nMultiplicity; ix++) {
+      for (Int_t h = 1; h < nHarmonics + 1; h++) {
+        qnX[h] += TMath::Cos(h * phi[ix]);
+        qnY[h] += TMath::Sin(h * phi[ix]);
+      }
+    }
+  }
+  gQnCorrectionsBenchmarkSink += Long64_t(qnX[nHarmonics] + qnY[nHarmonics]);
+  state.SetItemsProcessed(state.GetIterations() * nMultiplicity);
+}
+
+/// Histogram bin location from the event class variables
+///
+/// Parameters: dimensions. Items: bins located.
+void BM_HistogramBaseGetBin(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsProfile *profile = new QnCorrectionsProfile("GetBin", "GetBin", *ecvs);
+  profile->CreateProfileHistograms(&list);
+  QnCorrectionsHistogramBase *histogram = profile;
+
+  Long64_t sum = 0;
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      sum += histogram->GetBin(&containers[ix * nMicroNoOfVariables]);
+    }
+  }
+  gQnCorrectionsBenchmarkSink += sum;
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete profile;
+  delete ecvs;
+}
+
+/// Basic profile filling
+///
+/// Parameters: dimensions. Items: fills.
+void BM_ProfileFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsProfile *profile = new QnCorrectionsProfile("ProfileFill", "ProfileFill", *ecvs);
+  profile->CreateProfileHistograms(&list);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      profile->Fill(&containers[ix * nMicroNoOfVariables], containers[ix * nMicroNoOfVariables]);
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete profile;
+  delete ecvs;
+}
+
+/// Components profile filling, both components of all harmonics per fill
+///
+/// Parameters: harmonics, dimensions. Items: fills.
+void BM_ProfileComponentsFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nHarmonics = state.GetArg(0);
+  Int_t nDimensions = state.GetArg(1);
+  Int_t harmonicsMap[MAXHARMONICNUMBERSUPPORTED];
+  BuildHarmonicsMap(nHarmonics, 1, harmonicsMap);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsProfileComponents *profile = new QnCorrectionsProfileComponents("ComponentsFill", "ComponentsFill", *ecvs);
+  profile->CreateComponentsProfileHistograms(&list, nHarmonics, harmonicsMap);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      const Float_t *container = &containers[ix * nMicroNoOfVariables];
+      for (Int_t h = 0; h < nHarmonics; h++) {
+        profile->FillX(harmonicsMap[h], container, container[0]);
+        profile->FillY(harmonicsMap[h], container, container[1 % nMicroNoOfVariables]);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete profile;
+  delete ecvs;
+}
+
+/// Correlation components profile filling, the four components per fill
+///
+/// Parameters: dimensions. Items: fills.
+void BM_ProfileCorrelationComponentsFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsProfileCorrelationComponents *profile =
+      new QnCorrectionsProfileCorrelationComponents("CorrelationFill", "CorrelationFill", *ecvs);
+  profile->CreateCorrelationComponentsProfileHistograms(&list);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      const Float_t *container = &containers[ix * nMicroNoOfVariables];
+      profile->FillXX(container, container[0]);
+      profile->FillXY(container, container[1]);
+      profile->FillYX(container, container[2]);
+      profile->FillYY(container, container[3]);
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete profile;
+  delete ecvs;
+}
+
+/// Correlation components profile filling, the four components of all harmonics per fill
+///
+/// Parameters: harmonics, dimensions. Items: fills.
+void BM_ProfileCorrelationComponentsHarmonicsFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nHarmonics = state.GetArg(0);
+  Int_t nDimensions = state.GetArg(1);
+  Int_t harmonicsMap[MAXHARMONICNUMBERSUPPORTED];
+  BuildHarmonicsMap(nHarmonics, 1, harmonicsMap);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsProfileCorrelationComponentsHarmonics *profile =
+      new QnCorrectionsProfileCorrelationComponentsHarmonics("CorrelationHarmonicsFill", "CorrelationHarmonicsFill", *ecvs);
+  profile->CreateCorrelationComponentsProfileHistograms(&list, nHarmonics, harmonicsMap);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      const Float_t *container = &containers[ix * nMicroNoOfVariables];
+      for (Int_t h = 0; h < nHarmonics; h++) {
+        profile->FillXX(harmonicsMap[h], container, container[0]);
+        profile->FillXY(harmonicsMap[h], container, container[1]);
+        profile->FillYX(harmonicsMap[h], container, container[2]);
+        profile->FillYY(harmonicsMap[h], container, container[3]);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete profile;
+  delete ecvs;
+}
+
+/// Three detector configurations correlations profile filling
+///
+/// Parameters: harmonics, dimensions. Items: fills.
+void BM_Profile3DCorrelationsFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nHarmonics = state.GetArg(0);
+  Int_t nDimensions = state.GetArg(1);
+  Int_t harmonicsMap[MAXHARMONICNUMBERSUPPORTED];
+  BuildHarmonicsMap(nHarmonics, 1, harmonicsMap);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  TRandom3 random(nBenchmarkSeed);
+  QnCorrectionsQnVectorBuild *qnA = BuildMicroQnVector("A", nHarmonics, harmonicsMap, random);
+  QnCorrectionsQnVectorBuild *qnB = BuildMicroQnVector("B", nHarmonics, harmonicsMap, random);
+  QnCorrectionsQnVectorBuild *qnC = BuildMicroQnVector("C", nHarmonics, harmonicsMap, random);
+
+  QnCorrectionsProfile3DCorrelations *profile =
+      new QnCorrectionsProfile3DCorrelations("3DCorrelationsFill", "3DCorrelationsFill", "A", "B", "C", *ecvs);
+  profile->CreateCorrelationComponentsProfileHistograms(&list, nHarmonics, 1, harmonicsMap);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      profile->Fill(qnA, qnB, qnC, &containers[ix * nMicroNoOfVariables]);
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete profile;
+  delete qnA;
+  delete qnB;
+  delete qnC;
+  delete ecvs;
+}
+
+/// Channelized profile filling, all channels per fill
+///
+/// Parameters: dimensions. Items: channel fills.
+void BM_ProfileChannelizedFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsProfileChannelized *profile =
+      new QnCorrectionsProfileChannelized("ChannelizedFill", "ChannelizedFill", *ecvs, nMicroNoOfChannels);
+  profile->CreateProfileHistograms(&list, NULL, NULL);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      const Float_t *container = &containers[ix * nMicroNoOfVariables];
+      for (Int_t ixChannel = 0; ixChannel < nMicroNoOfChannels; ixChannel++) {
+        profile->Fill(container, ixChannel, container[0]);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers * nMicroNoOfChannels);
+  delete profile;
+  delete ecvs;
+}
+
+/// Histogram filling
+///
+/// Parameters: dimensions. Items: fills.
+void BM_HistogramFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsHistogram *histogram = new QnCorrectionsHistogram("HistogramFill", "HistogramFill", *ecvs);
+  histogram->CreateHistogram(&list);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      histogram->Fill(&containers[ix * nMicroNoOfVariables], 1.0);
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+  delete histogram;
+  delete ecvs;
+}
+
+/// Channelized histogram filling, all channels per fill
+///
+/// Parameters: dimensions. Items: channel fills.
+void BM_HistogramChannelizedFill(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsHistogramChannelized *histogram =
+      new QnCorrectionsHistogramChannelized("HistogramChannelizedFill", "HistogramChannelizedFill", *ecvs, nMicroNoOfChannels);
+  histogram->CreateChannelizedHistogram(&list, NULL);
+
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      const Float_t *container = &containers[ix * nMicroNoOfVariables];
+      for (Int_t ixChannel = 0; ixChannel < nMicroNoOfChannels; ixChannel++) {
+        histogram->Fill(container, ixChannel, container[0]);
+      }
+    }
+  }
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers * nMicroNoOfChannels);
+  delete histogram;
+  delete ecvs;
+}
+
+/// Cuts set selection, all cuts passed
+///
+/// Parameters: cuts. Items: selections.
+void BM_CutsSetIsSelected(QnCorrectionsBenchmarkState &state) {
+  Int_t nCuts = state.GetArg(0);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+
+  QnCorrectionsCutsSet cuts;
+  for (Int_t ixCut = 0; ixCut < nCuts; ixCut++) {
+    cuts.Add(new QnCorrectionsCutWithin(ixCut % nMicroNoOfVariables, -1.0, 101.0));
+  }
+  cuts.SetOwner(kTRUE);
+
+  Long64_t nSelected = 0;
+  while (state.KeepRunning()) {
+    for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+      if (cuts.IsSelected(&containers[ix * nMicroNoOfVariables])) nSelected++;
+    }
+  }
+  gQnCorrectionsBenchmarkSink += nSelected;
+  state.SetItemsProcessed(state.GetIterations() * nMicroNoOfContainers);
+}
+
+/// Profile values by entries division
+///
+/// Parameters: dimensions. Items: histogram bins.
+void BM_DivideTHnF(QnCorrectionsBenchmarkState &state) {
+  Int_t nDimensions = state.GetArg(0);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildMicroEventClasses(nDimensions);
+  std::vector<Float_t> containers;
+  BuildMicroContainers(containers);
+  TList list; list.SetOwner(kTRUE);
+
+  QnCorrectionsBenchmarkProfile *profile = new QnCorrectionsBenchmarkProfile("DivideTHnF", "DivideTHnF", *ecvs);
+  profile->CreateProfileHistograms(&list);
+  for (Int_t ix = 0; ix < nMicroNoOfContainers; ix++) {
+    profile->Fill(&containers[ix * nMicroNoOfVariables], containers[ix * nMicroNoOfVariables]);
+  }
+  profile->FlushAccumulator();
+  /* the values histogram goes first and the entries one last */
+  THnF *values = (THnF *) list.First();
+  THnI *entries = (THnI *) list.Last();
+
+  while (state.KeepRunning()) {
+    delete profile->Divide(values, entries);
+  }
+  state.SetItemsProcessed(state.GetIterations() * values->GetNbins());
+  delete profile;
+  delete ecvs;
+}
+
+/* the event processing benchmarks setup */
+
+/// The detectors of the event processing benchmarks
+enum BenchmarkDetectors {
+  kBenchmarkTracks = 0,     ///< the tracking detector
+  kBenchmarkChannels,       ///< the channelized detector
+  kBenchmarkNoOfDetectors
+};
+
+/// The variables of the event processing benchmarks
+enum BenchmarkVariables {
+  kBenchmarkCentrality = 0,  ///< the event centrality
+  kBenchmarkVertexZ,         ///< the event vertex z
+  kBenchmarkOccupancy,       ///< a third event classes variable
+  kBenchmarkCharge,          ///< the track charge
+  kBenchmarkNoOfVariables
+};
+
+/// The channelized detector number of channels
+const Int_t nBenchmarkNoOfChannels = 64;
+/// The channelized detector number of sectors
+const Int_t nBenchmarkNoOfSectors = 8;
+/// The channelized detector lowest channel of its second sub-detector
+const Int_t nBenchmarkLowestCChannel = 32;
+/// The number of different events the timed loop cycles through
+const Int_t nBenchmarkNoOfPoolEvents = 64;
+/// The multiplicity of the events of the calibration passes before the timed one
+const Int_t nBenchmarkPrepMultiplicity = 500;
+/// The number of events of each calibration pass before the timed one
+Int_t nBenchmarkPrepEvents = 2000;
+
+/// The framework state the event processing is benchmarked on
+enum BenchmarkFrameworkState {
+  kBenchmarkCalibration = 0, ///< no calibration available, all steps collecting data
+  kBenchmarkMixed,           ///< the calibration of one pass available, some steps applied
+  kBenchmarkApply            ///< all steps applied
+};
+
+/// Configures the events generator of the event processing benchmarks
+///
+/// The events follow the Example.C toy model: flow modulated tracks with
+/// an acceptance hole and a channelized detector with sector signals
+/// with gain non-uniformity. The number of produced particles is fixed.
+/// \param generator the events generator
+/// \param nMultiplicity the produced particles per event
+void ConfigureBenchmarkGenerator(QnCorrectionsEventGenerator &generator, Int_t nMultiplicity) {
+  Float_t gains[nBenchmarkNoOfChannels];
+  for (Int_t ixChannel = 0; ixChannel < nBenchmarkNoOfChannels; ixChannel++) {
+    gains[ixChannel] = (200. + ixChannel) / 200.;
+  }
+
+  generator.SetFastRandom(kTRUE);
+  generator.SetCentralityVariable(kBenchmarkCentrality, 0.0, 100.0);
+  generator.AddEventVariable(kBenchmarkVertexZ, -10.0, 10.0);
+  generator.AddEventVariable(kBenchmarkOccupancy, 0.0, 100.0);
+  generator.SetMultiplicity(QnCorrectionsEventGenerator::kFixedMultiplicity, nMultiplicity);
+  generator.SetFlow(2, 0.25);
+  generator.AddAcceptanceHole(0.0, 0.5, 0.5);
+  generator.SetTracksDetector(kBenchmarkTracks, kBenchmarkCharge, 0.4);
+  generator.SetChannelsDetector(kBenchmarkChannels, nBenchmarkNoOfChannels, nBenchmarkNoOfSectors, -0.3);
+  generator.SetChannelGains(gains);
+}
+
+/// Builds the event classes variables set of the event processing benchmarks
+///
+/// Centrality, vertex z and a third variable, in this order, as many as
+/// dimensions. The variables are owned by the set.
+/// \param nDimensions the number of event classes dimensions
+/// \return the event classes variables set
+QnCorrectionsEventClassVariablesSet *BuildBenchmarkEventClasses(Int_t nDimensions) {
+  QnCorrectionsEventClassVariablesSet *ecvs = new QnCorrectionsEventClassVariablesSet(nDimensions);
+  if (nDimensions > 0)
+    ecvs->Add(new QnCorrectionsEventClassVariable(kBenchmarkCentrality, "Centrality", 10, 0.0, 100.0));
+  if (nDimensions > 1)
+    ecvs->Add(new QnCorrectionsEventClassVariable(kBenchmarkVertexZ, "VertexZ", 10, -10.0, 10.0));
+  if (nDimensions > 2)
+    ecvs->Add(new QnCorrectionsEventClassVariable(kBenchmarkOccupancy, "Occupancy", 5, 0.0, 100.0));
+  ecvs->SetOwner(kTRUE);
+  return ecvs;
+}
+
+/// Builds the framework manager of the event processing benchmarks
+///
+/// The configuration follows the Example.C one: a tracking detector
+/// with its positive and negative tracks configurations, with
+/// recentering and twist, and a channelized detector with its two
+/// sub-detectors configurations with gain equalization, recentering,
+/// alignment and twist and rescale. Output histograms are filled, QA
+/// histograms are not.
+/// \param nHarmonics the number of harmonics, starting at the second one
+/// \param ecvs the event classes variables set
+/// \return the configured manager, still to be initialized
+QnCorrectionsManager *ConfigureBenchmarkManager(Int_t nHarmonics, QnCorrectionsEventClassVariablesSet *ecvs) {
+  Int_t harmonicsMap[MAXHARMONICNUMBERSUPPORTED];
+  BuildHarmonicsMap(nHarmonics, 2, harmonicsMap);
+
+  QnCorrectionsManager *manager = new QnCorrectionsManager();
+
+  QnCorrectionsDetector *tracks = new QnCorrectionsDetector("Tracks", kBenchmarkTracks);
+  const char *tracksConfigurationName[2] = {"Det1pos", "Det1neg"};
+  for (Int_t ixConf = 0; ixConf < 2; ixConf++) {
+    QnCorrectionsCutsSet *cuts = new QnCorrectionsCutsSet();
+    if (ixConf == 0)
+      cuts->Add(new QnCorrectionsCutAbove(kBenchmarkCharge, 0.0));
+    else
+      cuts->Add(new QnCorrectionsCutBelow(kBenchmarkCharge, 0.0));
+    cuts->SetOwner(kTRUE);
+
+    QnCorrectionsDetectorConfigurationTracks *configuration =
+        new QnCorrectionsDetectorConfigurationTracks(tracksConfigurationName[ixConf], ecvs, nHarmonics, harmonicsMap);
+    configuration->SetCuts(cuts);
+    configuration->SetQVectorNormalizationMethod(QnCorrectionsQnVector::QVNORM_QoverM);
+    configuration->AddCorrectionOnQnVector(new QnCorrectionsQnVectorRecentering());
+    QnCorrectionsQnVectorTwistAndRescale *twScale = new QnCorrectionsQnVectorTwistAndRescale();
+    twScale->SetApplyTwist(kTRUE);
+    twScale->SetApplyRescale(kFALSE);
+    twScale->SetTwistAndRescaleMethod(QnCorrectionsQnVectorTwistAndRescale::TWRESCALE_doubleHarmonic);
+    configuration->AddCorrectionOnQnVector(twScale);
+    tracks->AddDetectorConfiguration(configuration);
+  }
+  manager->AddDetector(tracks);
+
+  QnCorrectionsDetector *channels = new QnCorrectionsDetector("Channels", kBenchmarkChannels);
+  const char *channelsConfigurationName[2] = {"Det2A", "Det2C"};
+  Bool_t bUsedChannel[nBenchmarkNoOfChannels];
+  Int_t nChannelGroup[nBenchmarkNoOfChannels];
+  for (Int_t ixConf = 0; ixConf < 2; ixConf++) {
+    for (Int_t ixChannel = 0; ixChannel < nBenchmarkNoOfChannels; ixChannel++) {
+      bUsedChannel[ixChannel] = ((ixChannel < nBenchmarkLowestCChannel) ? (ixConf == 0) : (ixConf == 1));
+      nChannelGroup[ixChannel] = Int_t(ixChannel / 8);
+    }
+    QnCorrectionsDetectorConfigurationChannels *configuration =
+        new QnCorrectionsDetectorConfigurationChannels(channelsConfigurationName[ixConf], ecvs, nBenchmarkNoOfChannels, nHarmonics, harmonicsMap);
+    configuration->SetChannelsScheme(bUsedChannel, nChannelGroup);
+    configuration->SetQVectorNormalizationMethod(QnCorrectionsQnVector::QVNORM_QoverM);
+    QnCorrectionsInputGainEqualization *equalization = new QnCorrectionsInputGainEqualization();
+    equalization->SetEqualizationMethod(QnCorrectionsInputGainEqualization::GEQUAL_averageEqualization);
+    equalization->SetShift(1.0);
+    equalization->SetScale(0.1);
+    equalization->SetUseChannelGroupsWeights(kTRUE);
+    configuration->AddCorrectionOnInputData(equalization);
+    configuration->AddCorrectionOnQnVector(new QnCorrectionsQnVectorRecentering());
+    QnCorrectionsQnVectorAlignment *alignment = new QnCorrectionsQnVectorAlignment();
+    alignment->SetReferenceConfigurationForAlignment("Det1pos");
+    alignment->SetHarmonicNumberForAlignment(2);
+    configuration->AddCorrectionOnQnVector(alignment);
+    QnCorrectionsQnVectorTwistAndRescale *twScale = new QnCorrectionsQnVectorTwistAndRescale();
+    twScale->SetApplyTwist(kTRUE);
+    twScale->SetApplyRescale(kTRUE);
+    twScale->SetTwistAndRescaleMethod(QnCorrectionsQnVectorTwistAndRescale::TWRESCALE_correlations);
+    twScale->SetReferenceConfigurationsForTwistAndRescale("Det1pos", channelsConfigurationName[1 - ixConf]);
+    configuration->AddCorrectionOnQnVector(twScale);
+    channels->AddDetectorConfiguration(configuration);
+  }
+  manager->AddDetector(channels);
+
+  manager->SetShouldFillOutputHistograms(kTRUE);
+  manager->SetShouldFillQAHistograms(kFALSE);
+  manager->SetShouldFillNveQAHistograms(kFALSE);
+  return manager;
+}
+
+/// Builds and initializes the framework manager of the event processing benchmarks
+/// \param nHarmonics the number of harmonics, starting at the second one
+/// \param ecvs the event classes variables set
+/// \param calibrationList the calibration histograms list, the manager takes its ownership. NULL for none
+/// \return the manager ready for processing events
+QnCorrectionsManager *BuildBenchmarkManager(Int_t nHarmonics, QnCorrectionsEventClassVariablesSet *ecvs, TList *calibrationList) {
+  QnCorrectionsManager *manager = ConfigureBenchmarkManager(nHarmonics, ecvs);
+  if (calibrationList != NULL)
+    manager->SetCalibrationHistogramsList(calibrationList);
+  manager->InitializeQnCorrectionsFramework();
+  manager->SetCurrentProcessListName("Benchmark");
+  return manager;
+}
+
+/// Deletes a framework manager together with its histograms lists
+/// \param manager the framework manager
+/// \param keepOutput kTRUE if the output histograms list should be kept
+/// \return the output histograms list, if keepOutput, NULL otherwise
+TList *DeleteBenchmarkManager(QnCorrectionsManager *manager, Bool_t keepOutput) {
+  TList *outputList = manager->GetOutputHistogramsList();
+  if (manager->GetQAHistogramsList() != NULL) delete manager->GetQAHistogramsList();
+  if (manager->GetNveQAHistogramsList() != NULL) delete manager->GetNveQAHistogramsList();
+  delete manager;
+  if (keepOutput) return outputList;
+  if (outputList != NULL) {
+    outputList->SetOwner(kTRUE);
+    delete outputList;
+  }
+  return NULL;
+}
+
+/// Whole event processing with the framework in the given state
+///
+/// The calibration passes needed to reach the state are run on their
+/// own events before the timing starts. Output histograms are filled,
+/// QA histograms are not.
+/// Parameters: multiplicity, harmonics, dimensions. Items: events.
+/// \param state the benchmark state
+/// \param frameworkState the framework state
+void BenchmarkProcessEvent(QnCorrectionsBenchmarkState &state, BenchmarkFrameworkState frameworkState) {
+  Int_t nMultiplicity = state.GetArg(0);
+  Int_t nHarmonics = state.GetArg(1);
+  Int_t nDimensions = state.GetArg(2);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildBenchmarkEventClasses(nDimensions);
+
+  QnCorrectionsManager *manager = BuildBenchmarkManager(nHarmonics, ecvs, NULL);
+  Int_t nNoOfSteps = manager->GetNoOfCorrectionSteps();
+  Int_t nNoOfPasses = 0;
+  switch (frameworkState) {
+  case kBenchmarkCalibration:
+    nNoOfPasses = 0;
+    break;
+  case kBenchmarkMixed:
+    nNoOfPasses = 1;
+    break;
+  case kBenchmarkApply:
+    nNoOfPasses = nNoOfSteps;
+    break;
+  }
+
+  if (nNoOfPasses > 0) {
+    QnCorrectionsEventGenerator prepGenerator(nBenchmarkSeed + 1);
+    ConfigureBenchmarkGenerator(prepGenerator, nBenchmarkPrepMultiplicity);
+    prepGenerator.GenerateEvents(nBenchmarkPrepEvents);
+    for (Int_t ixPass = 0; ixPass < nNoOfPasses && manager->GetNoOfAppliedCorrectionSteps() < nNoOfSteps; ixPass++) {
+      for (Int_t ixEvent = 0; ixEvent < prepGenerator.GetNoOfEvents(); ixEvent++) {
+        manager->ClearEvent();
+        prepGenerator.FeedEvent(manager, ixEvent);
+        manager->ProcessEvent();
+      }
+      manager->FinalizeQnCorrectionsFramework();
+      TList *calibrationList = DeleteBenchmarkManager(manager, kTRUE);
+      manager = BuildBenchmarkManager(nHarmonics, ecvs, calibrationList);
+    }
+  }
+  state.SetLabel(Form("%d of %d steps applied", manager->GetNoOfAppliedCorrectionSteps(), nNoOfSteps));
+
+  /* the timed events are generated beforehand */
+  QnCorrectionsEventGenerator generator(nBenchmarkSeed);
+  ConfigureBenchmarkGenerator(generator, nMultiplicity);
+  generator.GenerateEvents(nBenchmarkNoOfPoolEvents);
+  Int_t ixEvent = 0;
+  while (state.KeepRunning()) {
+    manager->ClearEvent();
+    generator.FeedEvent(manager, ixEvent);
+    manager->ProcessEvent();
+    ixEvent = (ixEvent + 1) % generator.GetNoOfEvents();
+  }
+  state.SetItemsProcessed(state.GetIterations());
+
+  DeleteBenchmarkManager(manager, kFALSE);
+  delete ecvs;
+}
+
+/// Event processing with the framework in calibration state
+void BM_ProcessEventCalibration(QnCorrectionsBenchmarkState &state) {
+  BenchmarkProcessEvent(state, kBenchmarkCalibration);
+}
+
+/// Event processing with the framework in mixed state
+void BM_ProcessEventMixed(QnCorrectionsBenchmarkState &state) {
+  BenchmarkProcessEvent(state, kBenchmarkMixed);
+}
+
+/// Event processing with the framework in apply state
+void BM_ProcessEventApply(QnCorrectionsBenchmarkState &state) {
+  BenchmarkProcessEvent(state, kBenchmarkApply);
+}
+
+/// Process switch with the next process calibration list prefetched
+///
+/// The calibration list of one calibration pass is stored in a lazy
+/// loading calibration file under several process names. With a single
+/// cached calibration list, each switch needs the next process list
+/// read and its correction inputs prepared, which is done by the prefetch
+/// before the timed switch. The correction parameters tables built while
+/// switching are counted: the benchmark fails if any is built there or
+/// if the prefetch did not prepare any.
+/// Parameters: harmonics, dimensions. Items: process switches.
+void BM_ProcessListSwitch(QnCorrectionsBenchmarkState &state) {
+  const Int_t nNoOfProcesses = 3;
+  Int_t nHarmonics = state.GetArg(0);
+  Int_t nDimensions = state.GetArg(1);
+  QnCorrectionsEventClassVariablesSet *ecvs = BuildBenchmarkEventClasses(nDimensions);
+
+  /* one calibration pass gives the inputs of the first correction steps */
+  QnCorrectionsManager *manager = BuildBenchmarkManager(nHarmonics, ecvs, NULL);
+  QnCorrectionsEventGenerator prepGenerator(nBenchmarkSeed + 1);
+  ConfigureBenchmarkGenerator(prepGenerator, nBenchmarkPrepMultiplicity);
+  prepGenerator.GenerateEvents(nBenchmarkPrepEvents);
+  for (Int_t ixEvent = 0; ixEvent < prepGenerator.GetNoOfEvents(); ixEvent++) {
+    manager->ClearEvent();
+    prepGenerator.FeedEvent(manager, ixEvent);
+    manager->ProcessEvent();
+  }
+  manager->FinalizeQnCorrectionsFramework();
+
+  /* stored once per process name, one key per process */
+  TString fileName = Form("%s/QnCorrectionsBenchmarkSwitch_%d.root", gSystem->TempDirectory(), gSystem->GetPid());
+  TFile *calibrationFile = new TFile(fileName, "RECREATE");
+  TList *processList = (TList *) manager->GetOutputHistogramsList()->FindObject("Benchmark");
+  for (Int_t ixProcess = 0; ixProcess < nNoOfProcesses; ixProcess++) {
+    processList->SetName(Form("Benchmark%d", ixProcess));
+    manager->WriteOutputHistogramsDirectory(calibrationFile);
+  }
+  calibrationFile->Close();
+  delete calibrationFile;
+  DeleteBenchmarkManager(manager, kFALSE);
+
+  calibrationFile = new TFile(fileName, "READ");
+  manager = ConfigureBenchmarkManager(nHarmonics, ecvs);
+  manager->SetMaxNoOfCachedCalibrationLists(1);
+  manager->SetCalibrationHistogramsList(calibrationFile, kTRUE);
+  manager->InitializeQnCorrectionsFramework();
+  manager->SetCurrentProcessListName("Benchmark0");
+
+  Long64_t nBuiltOnPrefetch = 0;
+  Long64_t nBuiltOnSwitch = 0;
+  Int_t ixProcess = 0;
+  while (state.KeepRunning()) {
+    state.PauseTiming();
+    ixProcess = (ixProcess + 1) % nNoOfProcesses;
+    Long64_t nBuilt = QnCorrectionsCalibrationSnapshot::GetNoOfBuiltSnapshots();
+    manager->PrefetchProcessList(Form("Benchmark%d", ixProcess));
+    manager->WaitForCalibrationPrefetch();
+    nBuiltOnPrefetch += QnCorrectionsCalibrationSnapshot::GetNoOfBuiltSnapshots() - nBuilt;
+    nBuilt = QnCorrectionsCalibrationSnapshot::GetNoOfBuiltSnapshots();
+    state.ResumeTiming();
+
+    manager->SetCurrentProcessListName(Form("Benchmark%d", ixProcess));
+
+    state.PauseTiming();
+    nBuiltOnSwitch += QnCorrectionsCalibrationSnapshot::GetNoOfBuiltSnapshots() - nBuilt;
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.GetIterations());
+  state.SetLabel(Form("%lld tables built on prefetch, %lld on switch", nBuiltOnPrefetch, nBuiltOnSwitch));
+  if (nBuiltOnSwitch != 0)
+    state.SkipWithError(Form("%lld correction parameters tables built on the process switch", nBuiltOnSwitch));
+  else if (nBuiltOnPrefetch == 0)
+    state.SkipWithError("no correction parameters table prepared by the prefetch");
+
+  DeleteBenchmarkManager(manager, kFALSE);
+  calibrationFile->Close();
+  delete calibrationFile;
+  gSystem->Unlink(fileName);
+  delete ecvs;
+}
+
+/// Registers the whole set of benchmarks
+/// \param cases the registered benchmarks
+void RegisterBenchmarks(std::vector<QnCorrectionsBenchmarkCase> &cases) {
+  const Int_t harmonics[] = {1, 2, 4, 8};
+  const Int_t multiplicities[] = {100, 1000, 10000};
+  const Int_t dimensions[] = {1, 2, 3, 4};
+  const Int_t noOfCuts[] = {1, 4, 16};
+  const Int_t eventHarmonics[] = {1, 2, 4};
+  const Int_t accuracyHarmonics[] = {MAXHARMONICNUMBERSUPPORTED};
+  const Int_t accuracyMultiplicities[] = {20000};
+
+  QnCorrectionsBenchmarkRange harmonicsMultiplicity[] = {{"harmonics", 4, harmonics}, {"multiplicity", 3, multiplicities}};
+  QnCorrectionsBenchmarkRange allDimensions[] = {{"dimensions", 4, dimensions}};
+  QnCorrectionsBenchmarkRange someDimensions[] = {{"dimensions", 3, dimensions}};
+  QnCorrectionsBenchmarkRange harmonicsDimensions[] = {{"harmonics", 4, harmonics}, {"dimensions", 3, dimensions}};
+  QnCorrectionsBenchmarkRange cuts[] = {{"cuts", 3, noOfCuts}};
+  QnCorrectionsBenchmarkRange accuracy[] = {{"harmonics", 1, accuracyHarmonics}, {"multiplicity", 1, accuracyMultiplicities}};
+  QnCorrectionsBenchmarkRange event[] = {{"multiplicity", 3, multiplicities}, {"harmonics", 3, eventHarmonics}, {"dimensions", 3, dimensions}};
+  QnCorrectionsBenchmarkRange processSwitch[] = {{"harmonics", 3, eventHarmonics}, {"dimensions", 3, dimensions}};
+
+  QnCorrectionsRegisterBenchmark(cases, "BM_QnVectorBuildAdd", BM_QnVectorBuildAdd, 2, harmonicsMultiplicity);
+  QnCorrectionsRegisterBenchmark(cases, "BM_QnVectorBuildAccuracy", BM_QnVectorBuildAccuracy, 2, accuracy);
+  QnCorrectionsRegisterBenchmark(cases, "BM_HistogramBaseGetBin", BM_HistogramBaseGetBin, 1, allDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProfileFill", BM_ProfileFill, 1, allDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProfileComponentsFill", BM_ProfileComponentsFill, 2, harmonicsDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProfileCorrelationComponentsFill", BM_ProfileCorrelationComponentsFill, 1, someDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProfileCorrelationComponentsHarmonicsFill", BM_ProfileCorrelationComponentsHarmonicsFill, 2, harmonicsDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_Profile3DCorrelationsFill", BM_Profile3DCorrelationsFill, 2, harmonicsDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProfileChannelizedFill", BM_ProfileChannelizedFill, 1, someDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_HistogramFill", BM_HistogramFill, 1, allDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_HistogramChannelizedFill", BM_HistogramChannelizedFill, 1, someDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_CutsSetIsSelected", BM_CutsSetIsSelected, 1, cuts);
+  QnCorrectionsRegisterBenchmark(cases, "BM_DivideTHnF", BM_DivideTHnF, 1, allDimensions);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProcessEventCalibration", BM_ProcessEventCalibration, 3, event);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProcessEventMixed", BM_ProcessEventMixed, 3, event);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProcessEventApply", BM_ProcessEventApply, 3, event);
+  QnCorrectionsRegisterBenchmark(cases, "BM_ProcessListSwitch", BM_ProcessListSwitch, 2, processSwitch);
+}
+
+/* the output */
+
+/// Writes the JSON output header with the run context
+/// \param out the output stream
+void WriteJSONHeader(FILE *out) {
+  TDatime now;
+  SysInfo_t sysInfo;
+  Int_t nCpus = 0;
+  Int_t nCpuSpeed = 0;
+  if (gSystem->GetSysInfo(&sysInfo) == 0) {
+    nCpus = sysInfo.fCpus;
+    nCpuSpeed = sysInfo.fCpuSpeed;
+  }
+  fprintf(out, "{\n");
+  fprintf(out, "  \"context\": {\n");
+  fprintf(out, "    \"date\": \"%s\",\n", now.AsSQLString());
+  fprintf(out, "    \"host_name\": \"%s\",\n", gSystem->HostName());
+  fprintf(out, "    \"executable\": \"QnCorrectionsBenchmark\",\n");
+  fprintf(out, "    \"num_cpus\": %d,\n", nCpus);
+  fprintf(out, "    \"mhz_per_cpu\": %d,\n", nCpuSpeed);
+#ifdef NDEBUG
+  fprintf(out, "    \"library_build_type\": \"release\"\n");
+#else
+  fprintf(out, "    \"library_build_type\": \"debug\"\n");
+#endif
+  fprintf(out, "  },\n");
+  fprintf(out, "  \"benchmarks\": [");
+}
+
+/// Writes a benchmark entry of the JSON output
+/// \param out the output stream
+/// \param benchmark the benchmark
+/// \param result the benchmark outcome
+/// \param first kTRUE if it is the first entry
+void WriteJSONEntry(FILE *out, const QnCorrectionsBenchmarkCase &benchmark, const QnCorrectionsBenchmarkResult &result, Bool_t first) {
+  fprintf(out, "%s\n    {\n", first ? "" : ",");
+  fprintf(out, "      \"name\": \"%s\",\n", benchmark.fName.Data());
+  fprintf(out, "      \"run_name\": \"%s\",\n", benchmark.fName.Data());
+  fprintf(out, "      \"run_type\": \"iteration\",\n");
+  fprintf(out, "      \"iterations\": %lld,\n", result.fIterations);
+  fprintf(out, "      \"real_time\": %.6e,\n", result.fRealTime);
+  fprintf(out, "      \"cpu_time\": %.6e,\n", result.fCpuTime);
+  fprintf(out, "      \"time_unit\": \"ns\",\n");
+  for (Int_t ixArg = 0; ixArg < benchmark.fNoOfArgs; ixArg++) {
+    fprintf(out, "      \"%s\": %d,\n", benchmark.fArgName[ixArg], benchmark.fArgs[ixArg]);
+  }
+  if (!result.fLabel.IsNull())
+    fprintf(out, "      \"label\": \"%s\",\n", result.fLabel.Data());
+  if (result.fErrorOccurred) {
+    fprintf(out, "      \"error_occurred\": true,\n");
+    fprintf(out, "      \"error_message\": \"%s\",\n", result.fErrorMessage.Data());
+  }
+  fprintf(out, "      \"items_per_second\": %.6e\n", result.fItemsPerSecond);
+  fprintf(out, "    }");
+  fflush(out);
+}
+
+/// Writes the JSON output trailer
+/// \param out the output stream
+void WriteJSONTrailer(FILE *out) {
+  fprintf(out, "\n  ]\n}\n");
+}
+
+/// Writes a benchmark line of the console output
+/// \param benchmark the benchmark
+/// \param result the benchmark outcome
+void WriteConsoleEntry(const QnCorrectionsBenchmarkCase &benchmark, const QnCorrectionsBenchmarkResult &result) {
+  printf("%-72s %13.0f ns %13.0f ns %12lld", benchmark.fName.Data(), result.fRealTime, result.fCpuTime, result.fIterations);
+  if (result.fItemsPerSecond > 0.0)
+    printf(" items_per_second=%.4g/s", result.fItemsPerSecond);
+  if (!result.fLabel.IsNull())
+    printf(" %s", result.fLabel.Data());
+  if (result.fErrorOccurred)
+    printf(" ERROR OCCURRED: '%s'", result.fErrorMessage.Data());
+  printf("\n");
+  fflush(stdout);
+}
+
+/// Gets the value of a command line flag
+/// \param argument the command line argument
+/// \param flag the flag name, without the leading dashes
+/// \param value the flag value, if the argument is the flag
+/// \return kTRUE if the argument is the flag
+Bool_t GetFlagValue(const char *argument, const char *flag, TString &value) {
+  TString prefix = Form("--%s=", flag);
+  if (strncmp(argument, prefix.Data(), prefix.Length()) != 0) return kFALSE;
+  value = argument + prefix.Length();
+  return kTRUE;
+}
+
+/// The benchmarks program
+///
+/// \param argc the number of command line arguments
+/// \param argv the command line arguments
+/// \return zero on success, one if any benchmark failed
+int main(int argc, char **argv) {
+  TString filter = ".";
+  TString format = "console";
+  TString outFileName = "";
+  Double_t minTime = 0.5;
+  Bool_t listOnly = kFALSE;
+
+  for (Int_t ixArg = 1; ixArg < argc; ixArg++) {
+    TString value;
+    if (GetFlagValue(argv[ixArg], "benchmark_filter", value))
+      filter = value;
+    else if (GetFlagValue(argv[ixArg], "benchmark_format", value))
+      format = value;
+    else if (GetFlagValue(argv[ixArg], "benchmark_out", value))
+      outFileName = value;
+    else if (GetFlagValue(argv[ixArg], "benchmark_min_time", value))
+      minTime = value.Atof();
+    else if (GetFlagValue(argv[ixArg], "benchmark_prep_events", value))
+      nBenchmarkPrepEvents = value.Atoi();
+    else if (strcmp(argv[ixArg], "--benchmark_list_tests") == 0)
+      listOnly = kTRUE;
+    else {
+      fprintf(stderr, "Unknown argument %s\n", argv[ixArg]);
+      return 1;
+    }
+  }
+  if (!(format == "console") && !(format == "json")) {
+    fprintf(stderr, "Unknown output format %s\n", format.Data());
+    return 1;
+  }
+
+  /* only errors from the framework */
+  QnCorrectionsSetTracingLevel(kError);
+
+  std::vector<QnCorrectionsBenchmarkCase> cases;
+  RegisterBenchmarks(cases);
+  TPRegexp filterRegexp(filter);
+
+  FILE *jsonOut = NULL;
+  if (!outFileName.IsNull()) {
+    jsonOut = fopen(outFileName.Data(), "w");
+    if (jsonOut == NULL) {
+      fprintf(stderr, "The output file %s could not be created\n", outFileName.Data());
+      return 1;
+    }
+  }
+  else if (format == "json" && !listOnly) {
+    jsonOut = stdout;
+  }
+  Bool_t consoleOut = (jsonOut != stdout);
+
+  if (jsonOut != NULL) WriteJSONHeader(jsonOut);
+  if (consoleOut && !listOnly) {
+    printf("%-72s %16s %16s %12s\n", "Benchmark", "Time", "CPU", "Iterations");
+  }
+
+  Bool_t first = kTRUE;
+  Bool_t failed = kFALSE;
+  for (UInt_t ixCase = 0; ixCase < cases.size(); ixCase++) {
+    if (!filterRegexp.MatchB(cases[ixCase].fName)) continue;
+    if (listOnly) {
+      printf("%s\n", cases[ixCase].fName.Data());
+      continue;
+    }
+    QnCorrectionsBenchmarkResult result;
+    QnCorrectionsRunBenchmark(cases[ixCase], minTime, result);
+    if (consoleOut) WriteConsoleEntry(cases[ixCase], result);
+    if (jsonOut != NULL) WriteJSONEntry(jsonOut, cases[ixCase], result, first);
+    first = kFALSE;
+    failed = failed || result.fErrorOccurred;
+  }
+
+  if (jsonOut != NULL) {
+    WriteJSONTrailer(jsonOut);
+    if (jsonOut != stdout) fclose(jsonOut);
+  }
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,259 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsCalibrationDriver.cxx
+/// \brief Implementation of the single job multi-pass calibration driver
+
+#include <TList.h>
+#include <TSystem.h>
+
+#include "QnCorrectionsManager.h"
+#include "QnCorrectionsEventContext.h"
+#include "QnCorrectionsCalibrationDriver.h"
+#include "QnCorrectionsLog.h"
+
+#include <fstream>
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsCalibrationDriver);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsCalibrationDriver::QnCorrectionsCalibrationDriver() : TObject(),
+    fCacheFileName(), fProcessName() {
+  fBuilder = NULL;
+  fBuilderArgument = NULL;
+  fNoOfRecordedVariables = 0;
+  fRecordedVariables = NULL;
+  fMaxNoOfPasses = 0;
+  fPass = 0;
+  fNoOfRecordedEvents = 0;
+  fManager = NULL;
+  fCacheWriter = NULL;
+}
+
+/// Normal constructor
+/// \param builder the function building each pass manager, configured but not initialized
+/// \param arg the argument to pass to the builder function
+/// \param cacheFileName the name of the events input cache file
+QnCorrectionsCalibrationDriver::QnCorrectionsCalibrationDriver(ManagerBuilder_t builder, void *arg, const char *cacheFileName) : TObject(),
+    fCacheFileName(cacheFileName), fProcessName() {
+  fBuilder = builder;
+  fBuilderArgument = arg;
+  fNoOfRecordedVariables = 0;
+  fRecordedVariables = NULL;
+  fMaxNoOfPasses = 0;
+  fPass = 0;
+  fNoOfRecordedEvents = 0;
+  fManager = NULL;
+  fCacheWriter = NULL;
+}
+
+/// Default destructor
+/// Deletes the current manager and the cache file
+QnCorrectionsCalibrationDriver::~QnCorrectionsCalibrationDriver() {
+  if (fCacheWriter != NULL) delete fCacheWriter;
+  if (fManager != NULL) delete fManager;
+  if (fRecordedVariables != NULL) delete [] fRecordedVariables;
+  if (fPass > 0) gSystem->Unlink(fCacheFileName);
+}
+
+/// Sets the variables bank positions to record for each event
+/// \param nVariables the number of variables
+/// \param variableId array with the external Ids of the variables
+void QnCorrectionsCalibrationDriver::SetRecordedVariables(Int_t nVariables, const Int_t *variableId) {
+  if (fPass > 0) {
+    QnCorrectionsFatal("The recorded variables cannot be changed once the passes started");
+    return;
+  }
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    if (variableId[ixVariable] < 0 || !(variableId[ixVariable] < QnCorrectionsManager::GetMaxNoOfDataVariables())) {
+      QnCorrectionsFatal(Form("Recorded variable id %d out of the variables bank range [0, %d)",
+          variableId[ixVariable], QnCorrectionsManager::GetMaxNoOfDataVariables()));
+      return;
+    }
+  }
+  if (fRecordedVariables != NULL) delete [] fRecordedVariables;
+  fRecordedVariables = new Int_t[nVariables];
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    fRecordedVariables[ixVariable] = variableId[ixVariable];
+  }
+  fNoOfRecordedVariables = nVariables;
+}
+
+/// Builds and initializes the manager for a new pass
+/// \param calibrationList the calibration histograms list, the manager takes its ownership. NULL for none
+/// \return the manager ready for processing events
+QnCorrectionsManager *QnCorrectionsCalibrationDriver::BuildPassManager(TList *calibrationList) {
+  QnCorrectionsManager *manager = fBuilder(fBuilderArgument);
+  if (manager == NULL) {
+    QnCorrectionsFatal("The manager builder did not provide a manager");
+    return NULL;
+  }
+  /* the support histograms are the calibration of the next pass */
+  manager->SetShouldFillOutputHistograms(kTRUE);
+  if (calibrationList != NULL)
+    manager->SetCalibrationHistogramsList(calibrationList);
+  manager->InitializeQnCorrectionsFramework();
+  manager->SetCurrentProcessListName(fProcessName);
+  return manager;
+}
+
+/// Starts the first pass
+///
+/// The manager for the first pass is built and the cache file is
+/// created. The events are then handed through GetEventContext,
+/// ProcessEvent and ClearEvent.
+/// \param processName the name of the process being calibrated
+/// \return the manager of the first pass
+QnCorrectionsManager *QnCorrectionsCalibrationDriver::StartFirstPass(const char *processName) {
+  if (fBuilder == NULL) {
+    QnCorrectionsFatal("No manager builder function was provided");
+    return NULL;
+  }
+  if (fPass > 0) {
+    QnCorrectionsFatal("The first pass was already started");
+    return NULL;
+  }
+  fProcessName = processName;
+  fCacheWriter = new std::ofstream(fCacheFileName.Data(), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!fCacheWriter->is_open()) {
+    QnCorrectionsFatal(Form("The events input cache file %s could not be created", fCacheFileName.Data()));
+    return NULL;
+  }
+  if (!QnCorrectionsEventContext::WriteStreamHeader(*fCacheWriter, fNoOfRecordedVariables, fRecordedVariables)) {
+    QnCorrectionsFatal(Form("Failed to write the header of the events input cache file %s", fCacheFileName.Data()));
+    return NULL;
+  }
+  fNoOfRecordedEvents = 0;
+  fPass = 1;
+  fManager = BuildPassManager(NULL);
+  return fManager;
+}
+
+/// Gets an event context for a new first pass event
+/// \return the event context
+QnCorrectionsEventContext *QnCorrectionsCalibrationDriver::GetEventContext() {
+  return fManager->GetEventContext();
+}
+
+/// Records and processes a first pass event
+/// \param context the event context
+void QnCorrectionsCalibrationDriver::ProcessEvent(QnCorrectionsEventContext *context) {
+  if (!context->WriteEvent(*fCacheWriter, fNoOfRecordedVariables, fRecordedVariables)) {
+    QnCorrectionsFatal(Form("Failed to record the event in the cache file %s", fCacheFileName.Data()));
+    return;
+  }
+  fNoOfRecordedEvents++;
+  fManager->ProcessEvent(context);
+}
+
+/// Returns a first pass event context to the pool
+/// \param context the event context
+void QnCorrectionsCalibrationDriver::ClearEvent(QnCorrectionsEventContext *context) {
+  fManager->ClearEvent(context);
+}
+
+/// Replays the cached events input on the current manager
+///
+/// The cache header is checked first. The whole cache must then be
+/// consumed by the recorded events, otherwise it is corrupted.
+/// \return the number of replayed events
+Long64_t QnCorrectionsCalibrationDriver::ReplayCache() {
+  std::ifstream cacheReader(fCacheFileName.Data(), std::ios::in | std::ios::binary | std::ios::ate);
+  if (!cacheReader.is_open()) {
+    QnCorrectionsFatal(Form("The events input cache file %s could not be opened", fCacheFileName.Data()));
+    return 0;
+  }
+  Long64_t cacheSize = cacheReader.tellg();
+  cacheReader.seekg(0);
+  if (!QnCorrectionsEventContext::ReadStreamHeader(cacheReader, fNoOfRecordedVariables, fRecordedVariables)) {
+    QnCorrectionsFatal(Form("The events input cache file %s has not the expected header", fCacheFileName.Data()));
+    return 0;
+  }
+  Long64_t nAvailable = cacheSize - (Long64_t) cacheReader.tellg();
+  Long64_t nEvents = 0;
+  QnCorrectionsEventContext *context = fManager->GetEventContext();
+  while (nAvailable > 0) {
+    if (!context->ReadEvent(cacheReader, fNoOfRecordedVariables, fRecordedVariables, nAvailable)) {
+      QnCorrectionsFatal(Form("The events input cache file %s is corrupted at event %lld", fCacheFileName.Data(), nEvents));
+      break;
+    }
+    fManager->ProcessEvent(context);
+    nEvents++;
+  }
+  fManager->ClearEvent(context);
+  if (nEvents != fNoOfRecordedEvents)
+    QnCorrectionsFatal(Form("%lld events replayed from the cache file %s while %lld were recorded", nEvents,
+        fCacheFileName.Data(), fNoOfRecordedEvents));
+  return nEvents;
+}
+
+/// Runs the passes after the first one
+///
+/// Each pass finalizes the previous pass manager, takes its support
+/// histograms as calibration histograms of a new manager and replays
+/// the cached events on it.
+/// \return the number of passes run, the first one included
+Int_t QnCorrectionsCalibrationDriver::RunRemainingPasses() {
+  if (fPass == 0) {
+    QnCorrectionsFatal("The first pass was not started");
+    return 0;
+  }
+  if (fCacheWriter != NULL) {
+    fCacheWriter->close();
+    delete fCacheWriter;
+    fCacheWriter = NULL;
+  }
+
+  Int_t nNoOfSteps = fManager->GetNoOfCorrectionSteps();
+  Int_t nApplied = fManager->GetNoOfAppliedCorrectionSteps();
+  while (nApplied < nNoOfSteps && (fMaxNoOfPasses == 0 || fPass < fMaxNoOfPasses)) {
+    fManager->FinalizeQnCorrectionsFramework();
+    TList *calibrationList = fManager->GetOutputHistogramsList();
+    /* the QA histograms of the intermediate passes are not kept */
+    if (fManager->GetQAHistogramsList() != NULL) delete fManager->GetQAHistogramsList();
+    if (fManager->GetNveQAHistogramsList() != NULL) delete fManager->GetNveQAHistogramsList();
+    delete fManager;
+
+    fPass++;
+    fManager = BuildPassManager(calibrationList);
+    Int_t nPreviousApplied = nApplied;
+    nApplied = fManager->GetNoOfAppliedCorrectionSteps();
+    Long64_t nEvents = ReplayCache();
+    QnCorrectionsInfo(Form("Pass %d: %d of %d correction steps applied, %lld events replayed", fPass, nApplied, nNoOfSteps, nEvents));
+    if (!(nPreviousApplied < nApplied)) {
+      QnCorrectionsWarning(Form("Pass %d did not apply more correction steps than the previous one. Stopping", fPass));
+      break;
+    }
+  }
+  return fPass;
+}
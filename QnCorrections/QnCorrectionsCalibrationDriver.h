@@ -0,0 +1,126 @@
+#ifndef QNCORRECTIONS_CALIBRATIONDRIVER_H
+#define QNCORRECTIONS_CALIBRATIONDRIVER_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsCalibrationDriver.h
+/// \brief Runs the whole set of calibration passes within a single job
+
+#include <TObject.h>
+#include <TString.h>
+#include <iosfwd>
+
+class QnCorrectionsManager;
+class QnCorrectionsEventContext;
+
+/// \class QnCorrectionsCalibrationDriver
+/// \brief Drives the consecutive calibration passes replaying a cache of the events input
+///
+/// Each correction step needs its own calibration pass, built on the
+/// support histograms of the previous one. Instead of reading the raw
+/// data once per pass, the driver records the input of each event of
+/// the first pass, the variables bank and the data vectors as handed in
+/// its QnCorrectionsEventContext, into a local binary cache file, see
+/// QnCorrectionsEventContext::WriteEvent. Once
+/// the first pass is over, the subsequent passes are run in the same job
+/// replaying the cache, each one with the support histograms produced by
+/// the previous pass attached as calibration histograms.
+///
+/// The framework manager of each pass is built by the user supplied
+/// builder function which should return it completely configured but
+/// not initialized. The driver owns the managers. The passes go on until
+/// all the correction steps are applied, the maximum number of passes is
+/// reached or one pass does not apply more steps than the previous one.
+///
+/// The cache does not use the QnCorrectionsEventRecorder format on
+/// purpose: that format quantizes the azimuthal angles and needs the per
+/// data vector variables declared up front, while the passes after the
+/// first one must see exactly the first pass input, the context blocks
+/// with their own variables included, for their calibration to match the
+/// one obtained over several jobs. The cache starts with a header that
+/// is checked before replaying it, and each replayed event is checked
+/// against the bytes left in the file and the framework ranges; a
+/// corrupted cache stops the calibration.
+///
+/// Only the variables bank positions declared with SetRecordedVariables
+/// are recorded; the event class variables and the variables used by the
+/// cuts must be among them. Per data vector variables must be passed in
+/// the variables block of the context AddDataVectors.
+///
+/// After RunRemainingPasses the manager of the last pass is left
+/// ready for being finalized and for its output being stored as usual.
+/// The cache file is removed when the driver is destroyed.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsCalibrationDriver : public TObject {
+public:
+  /// The manager builder function type
+  /// \param arg the argument registered together with the builder
+  /// \return the configured but not initialized manager
+  typedef QnCorrectionsManager *(*ManagerBuilder_t)(void *arg);
+
+  QnCorrectionsCalibrationDriver();
+  QnCorrectionsCalibrationDriver(ManagerBuilder_t builder, void *arg, const char *cacheFileName);
+  virtual ~QnCorrectionsCalibrationDriver();
+
+  void SetRecordedVariables(Int_t nVariables, const Int_t *variableId);
+  /// Sets the maximum number of passes to run
+  /// \param nPasses the maximum number of passes, zero for as many as correction steps
+  void SetMaxNoOfPasses(Int_t nPasses) { fMaxNoOfPasses = (nPasses < 0) ? 0 : nPasses; }
+  /// Gets the current pass number, starting from one
+  /// \return the current pass number
+  Int_t GetPass() const { return fPass; }
+  /// Gets the framework manager of the current pass
+  /// \return the current manager
+  QnCorrectionsManager *GetManager() const { return fManager; }
+  /// Gets the number of events recorded in the cache
+  /// \return the number of recorded events
+  Long64_t GetNoOfRecordedEvents() const { return fNoOfRecordedEvents; }
+
+  QnCorrectionsManager *StartFirstPass(const char *processName);
+  QnCorrectionsEventContext *GetEventContext();
+  void ProcessEvent(QnCorrectionsEventContext *context);
+  void ClearEvent(QnCorrectionsEventContext *context);
+  Int_t RunRemainingPasses();
+
+private:
+  QnCorrectionsManager *BuildPassManager(TList *calibrationList);
+  Long64_t ReplayCache();
+
+  ManagerBuilder_t fBuilder;          //!<! the manager builder function
+  void *fBuilderArgument;             //!<! the argument to pass to the builder function
+  TString fCacheFileName;             ///< the name of the events input cache file
+  TString fProcessName;               ///< the name of the process being calibrated
+  Int_t fNoOfRecordedVariables;       ///< the number of recorded variables bank positions
+  Int_t *fRecordedVariables;          //[fNoOfRecordedVariables] the recorded variables bank positions
+  Int_t fMaxNoOfPasses;               ///< the maximum number of passes, zero for as many as correction steps
+  Int_t fPass;                        ///< the current pass number
+  Long64_t fNoOfRecordedEvents;       ///< the number of events recorded in the cache
+  QnCorrectionsManager *fManager;     //!<! the manager of the current pass, owned
+  std::ofstream *fCacheWriter;        //!<! the cache file while recording
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsCalibrationDriver(const QnCorrectionsCalibrationDriver &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsCalibrationDriver& operator= (const QnCorrectionsCalibrationDriver &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsCalibrationDriver, 1);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_CALIBRATIONDRIVER_H */
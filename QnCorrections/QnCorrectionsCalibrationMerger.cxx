@@ -0,0 +1,457 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsCalibrationMerger.cxx
+/// \brief Implementation of the process by process parallel merger of the framework output histograms files
+
+#include <TFile.h>
+#include <TKey.h>
+#include <TH1.h>
+#include <TObjString.h>
+#include <TThread.h>
+#include <TMutex.h>
+#include <TCondition.h>
+
+#include "QnCorrectionsManager.h"
+#include "QnCorrectionsCalibrationMerger.h"
+#include "QnCorrectionsLog.h"
+
+#include <fstream>
+#include <string>
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsCalibrationMerger);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsCalibrationMerger::QnCorrectionsCalibrationMerger() : TObject(),
+    fInputFiles(), fProcessesFiles(), fSingleKeyFiles(), fProcessName(), fSlotList(), fSlotSpan(), fSlotBusy() {
+  fInputFiles.SetOwner(kTRUE);
+  fProcessesFiles.SetOwner(kTRUE);
+  /* the files names are owned by the input files array */
+  fSingleKeyFiles.SetOwner(kFALSE);
+  fNoOfWorkers = 0;
+  fProcessFiles = NULL;
+  fNextFile = 0;
+  fNoOfStepsRunning = 0;
+  fMutex = NULL;
+  fProgressCondition = NULL;
+}
+
+/// Default destructor
+QnCorrectionsCalibrationMerger::~QnCorrectionsCalibrationMerger() {
+}
+
+/// Incorporates an input file
+/// \param fileName the input file name, any name TFile::Open accepts
+void QnCorrectionsCalibrationMerger::AddInputFile(const char *fileName) {
+  fInputFiles.Add(new TObjString(fileName));
+}
+
+/// Incorporates the input files listed in a text file
+///
+/// One file name per line, empty lines and lines starting with # are ignored.
+/// \param listFileName the name of the text file with the list of input files
+/// \return the number of input files incorporated
+Int_t QnCorrectionsCalibrationMerger::AddInputFilesList(const char *listFileName) {
+  std::ifstream listFile(listFileName);
+  if (!listFile.is_open()) {
+    QnCorrectionsError(Form("Input files list %s could not be opened", listFileName));
+    return 0;
+  }
+  Int_t nFiles = 0;
+  std::string line;
+  while (std::getline(listFile, line)) {
+    TString fileName = TString(line.c_str()).Strip(TString::kBoth);
+    if (fileName.IsNull() || fileName.BeginsWith("#")) continue;
+    AddInputFile(fileName.Data());
+    nFiles++;
+  }
+  return nFiles;
+}
+
+/// Incorporates an input file as holding a process list
+/// \param processName the process name
+/// \param fileName the input file name
+void QnCorrectionsCalibrationMerger::IncludeProcessFile(const char *processName, TObject *fileName) {
+  TObjArray *files = (TObjArray *) fProcessesFiles.FindObject(processName);
+  if (files == NULL) {
+    files = new TObjArray();
+    files->SetName(processName);
+    /* the files names are owned by the input files array */
+    files->SetOwner(kFALSE);
+    fProcessesFiles.Add(files);
+  }
+  if (files->Last() != fileName)
+    files->Add(fileName);
+}
+
+/// Scans the input files for the process lists they hold
+///
+/// Only the keys are looked at. Files in the directory layout are
+/// incorporated per process while files with a single key are just
+/// kept apart, they will be read once and whole. Files which cannot
+/// be opened or do not have calibration histograms are reported and
+/// ignored.
+void QnCorrectionsCalibrationMerger::ScanInputFiles() {
+  const char *keyName = QnCorrectionsManager::GetCalibrationHistogramsContainerName();
+
+  fProcessesFiles.Delete();
+  fSingleKeyFiles.Clear();
+  for (Int_t ixFile = 0; ixFile < fInputFiles.GetEntriesFast(); ixFile++) {
+    TObjString *fileName = (TObjString *) fInputFiles.At(ixFile);
+    TFile *inputFile = TFile::Open(fileName->GetName(), "READ");
+    if (inputFile == NULL || inputFile->IsZombie()) {
+      QnCorrectionsWarning(Form("Input file %s could not be opened. Ignored", fileName->GetName()));
+      if (inputFile != NULL) delete inputFile;
+      continue;
+    }
+    TDirectory *calibrationDirectory = inputFile->GetDirectory(keyName);
+    if (calibrationDirectory != NULL) {
+      /* one key per process */
+      TIter nextKey(calibrationDirectory->GetListOfKeys());
+      TKey *processKey;
+      while ((processKey = (TKey *) nextKey()) != NULL) {
+        IncludeProcessFile(processKey->GetName(), fileName);
+      }
+    }
+    else if (inputFile->GetKey(keyName) != NULL) {
+      /* single key: it will be read whole, once for all its processes */
+      fSingleKeyFiles.Add(fileName);
+    }
+    else {
+      QnCorrectionsWarning(Form("Input file %s does not hold calibration histograms. Ignored", fileName->GetName()));
+    }
+    inputFile->Close();
+    delete inputFile;
+  }
+}
+
+/// Reads the whole calibration list of a single key input file
+/// \param inputFile the input file
+/// \return the calibration list, with its process lists, NULL if not available
+TList *QnCorrectionsCalibrationMerger::ReadCalibrationList(TFile *inputFile) {
+  TKey *calibrationKey = inputFile->GetKey(QnCorrectionsManager::GetCalibrationHistogramsContainerName());
+  if (calibrationKey == NULL) return NULL;
+
+  TList *calibrationList = (TList *) calibrationKey->ReadObj();
+  if (calibrationList != NULL) {
+    calibrationList->SetOwner(kTRUE);
+    TIter nextList(calibrationList);
+    TObject *processList;
+    while ((processList = nextList()) != NULL) {
+      ((TList *) processList)->SetOwner(kTRUE);
+    }
+  }
+  return calibrationList;
+}
+
+/// Merges two whole calibration lists process by process
+///
+/// Each process list of the source is merged into the target one with
+/// the same name or, if the target does not have it, moved to the target.
+/// The source is left empty.
+/// \param target the calibration list which gets the merged content
+/// \param source the calibration list to merge
+void QnCorrectionsCalibrationMerger::MergeCalibrationLists(TList *target, TList *source) {
+  TObject *sourceProcessList;
+  while ((sourceProcessList = source->First()) != NULL) {
+    source->Remove(sourceProcessList);
+    TList *targetProcessList = (TList *) target->FindObject(sourceProcessList->GetName());
+    if (targetProcessList != NULL) {
+      TList sources;
+      sources.Add(sourceProcessList);
+      targetProcessList->Merge(&sources);
+      delete sourceProcessList;
+    }
+    else {
+      target->Add(sourceProcessList);
+    }
+  }
+}
+
+/// Runs the next step of the current process reduction
+///
+/// Merging a pair of subtrees takes precedence over reading the
+/// process list of the next input file. The subtree starting at input
+/// i, multiple of twice its span s, is merged with the one starting at
+/// input i+s once both cover s inputs. Subtrees without partner go up
+/// as they are, see GetSubtreeSpan. An input whose process list
+/// could not be read is an empty subtree. If there is nothing to do but
+/// other steps are still running, waits for them as they could leave
+/// a new pair of subtrees to merge. With no process name the whole
+/// calibration lists are read and merged.
+/// \return kFALSE when the process reduction is complete
+Bool_t QnCorrectionsCalibrationMerger::RunNextStep() {
+  Int_t nFiles = fProcessFiles->GetEntriesFast();
+  fMutex->Lock();
+  while (kTRUE) {
+    for (Int_t ixSlot = 0; ixSlot < fNextFile; ixSlot++) {
+      if (fSlotBusy[ixSlot] || fSlotSpan[ixSlot] == 0) continue;
+      Int_t span = fSlotSpan[ixSlot];
+      if (!(span < nFiles) || (ixSlot % (2 * span)) != 0) continue;
+      Int_t ixPartner = ixSlot + span;
+      if (!(ixPartner < fNextFile) || fSlotBusy[ixPartner] || fSlotSpan[ixPartner] != span) continue;
+
+      TList *target = fSlotList[ixSlot];
+      TList *source = fSlotList[ixPartner];
+      fSlotBusy[ixSlot] = kTRUE;
+      fSlotBusy[ixPartner] = kTRUE;
+      fNoOfStepsRunning++;
+      fMutex->UnLock();
+
+      if (target == NULL) {
+        target = source;
+      }
+      else if (source != NULL) {
+        if (fProcessName.IsNull()) {
+          MergeCalibrationLists(target, source);
+        }
+        else {
+          TList sources;
+          sources.Add(source);
+          target->Merge(&sources);
+        }
+        delete source;
+      }
+
+      fMutex->Lock();
+      fSlotList[ixSlot] = target;
+      fSlotSpan[ixSlot] = GetSubtreeSpan(ixSlot, 2 * span);
+      fSlotBusy[ixSlot] = kFALSE;
+      fSlotList[ixPartner] = NULL;
+      fSlotSpan[ixPartner] = 0;
+      fSlotBusy[ixPartner] = kFALSE;
+      fNoOfStepsRunning--;
+      fProgressCondition->Broadcast();
+      fMutex->UnLock();
+      return kTRUE;
+    }
+    if (fNextFile < nFiles) {
+      Int_t ixSlot = fNextFile;
+      const char *fileName = fProcessFiles->At(ixSlot)->GetName();
+      fNextFile++;
+      fSlotBusy[ixSlot] = kTRUE;
+      fNoOfStepsRunning++;
+      fMutex->UnLock();
+
+      TList *processList = NULL;
+      TFile *inputFile = TFile::Open(fileName, "READ");
+      if (inputFile != NULL && !inputFile->IsZombie()) {
+        if (fProcessName.IsNull())
+          processList = ReadCalibrationList(inputFile);
+        else
+          processList = QnCorrectionsManager::ReadCalibrationProcessList(inputFile, (const char *) fProcessName);
+        inputFile->Close();
+      }
+      if (inputFile != NULL) delete inputFile;
+      if (processList == NULL) {
+        if (fProcessName.IsNull())
+          QnCorrectionsWarning(Form("Calibration list could not be read from %s. Ignored", fileName));
+        else
+          QnCorrectionsWarning(Form("Process list %s could not be read from %s. Ignored", fProcessName.Data(), fileName));
+      }
+
+      fMutex->Lock();
+      fSlotList[ixSlot] = processList;
+      fSlotSpan[ixSlot] = GetSubtreeSpan(ixSlot, 1);
+      fSlotBusy[ixSlot] = kFALSE;
+      fNoOfStepsRunning--;
+      fProgressCondition->Broadcast();
+      fMutex->UnLock();
+      return kTRUE;
+    }
+    if (fNoOfStepsRunning == 0) {
+      fMutex->UnLock();
+      return kFALSE;
+    }
+    fProgressCondition->Wait();
+  }
+}
+
+/// Gets the span of a subtree once taken up the levels where it has no partner
+///
+/// The subtree starting at input i with span s has no partner if i is
+/// a multiple of 2s but there is no input i+s. In that case it covers
+/// the inputs up to the last one and also stands for the subtree with
+/// span 2s.
+/// \param ixSlot the input the subtree starts at
+/// \param span the inputs covered by the subtree
+/// \return the span of the subtree at the level where it has to be merged or at the top
+Int_t QnCorrectionsCalibrationMerger::GetSubtreeSpan(Int_t ixSlot, Int_t span) const {
+  Int_t nFiles = fProcessFiles->GetEntriesFast();
+  while (span < nFiles && (ixSlot % (2 * span)) == 0 && !(ixSlot + span < nFiles)) {
+    span *= 2;
+  }
+  return span;
+}
+
+/// The worker threads function
+/// \param merger the merger which launched the worker
+/// \return always NULL
+void *QnCorrectionsCalibrationMerger::WorkerLoop(void *merger) {
+  QnCorrectionsCalibrationMerger *theMerger = (QnCorrectionsCalibrationMerger *) merger;
+  while (theMerger->RunNextStep());
+  return NULL;
+}
+
+/// Merges one process lists out of the input files holding it
+///
+/// The worker threads are launched for the process and run the
+/// reduction together with the calling thread. If the array of files
+/// has no name, the whole calibration lists of the files are merged.
+/// \param files the names of the input files holding the process list, the array named as the process
+/// \return the merged process list, NULL if none could be read
+TList *QnCorrectionsCalibrationMerger::MergeProcess(const TObjArray *files) {
+  fProcessName = files->GetName();
+  fProcessFiles = files;
+  fNextFile = 0;
+  fNoOfStepsRunning = 0;
+  fSlotList.assign(files->GetEntriesFast(), (TList *) NULL);
+  fSlotSpan.assign(files->GetEntriesFast(), 0);
+  fSlotBusy.assign(files->GetEntriesFast(), kFALSE);
+
+  Int_t nWorkers = (fNoOfWorkers < files->GetEntriesFast() - 1) ? fNoOfWorkers : files->GetEntriesFast() - 1;
+  TThread **workers = NULL;
+  if (nWorkers > 0) {
+    workers = new TThread *[nWorkers];
+    for (Int_t ixWorker = 0; ixWorker < nWorkers; ixWorker++) {
+      workers[ixWorker] = new TThread(Form("QnCorrectionsMerger%d", ixWorker),
+          (TThread::VoidRtnFunc_t) &WorkerLoop, (void *) this);
+      workers[ixWorker]->Run();
+    }
+  }
+  while (RunNextStep());
+  for (Int_t ixWorker = 0; ixWorker < nWorkers; ixWorker++) {
+    workers[ixWorker]->Join();
+    delete workers[ixWorker];
+  }
+  if (workers != NULL) delete [] workers;
+
+  /* the whole tree ends up in the first input subtree */
+  TList *processList = (fSlotList.size() > 0) ? fSlotList[0] : NULL;
+  fSlotList.clear();
+  fSlotSpan.clear();
+  fSlotBusy.clear();
+  fProcessFiles = NULL;
+  return processList;
+}
+
+/// Merges the input files into the output calibration file
+///
+/// The output file is recreated and each merged process list, the all
+/// processes one included, stored within the calibration histograms
+/// directory under its own key. The single key input files are merged
+/// first, whole, and their process lists merged last with the ones of
+/// the directory layout input files.
+/// \param outputFileName the output file name
+/// \return kTRUE if everything went OK
+Bool_t QnCorrectionsCalibrationMerger::Merge(const char *outputFileName) {
+  TFile *outputFile = TFile::Open(outputFileName, "RECREATE");
+  if (outputFile == NULL || outputFile->IsZombie()) {
+    QnCorrectionsError(Form("Output file %s could not be created", outputFileName));
+    if (outputFile != NULL) delete outputFile;
+    return kFALSE;
+  }
+  TDirectory *outputDirectory = outputFile->mkdir(QnCorrectionsManager::GetCalibrationHistogramsContainerName());
+
+  /* the read histograms must not be attached to their, soon closed, files */
+  Bool_t addDirectoryStatus = TH1::AddDirectoryStatus();
+  TH1::AddDirectory(kFALSE);
+  if (fNoOfWorkers > 0) TThread::Initialize();
+  fMutex = new TMutex();
+  fProgressCondition = new TCondition(fMutex);
+
+  ScanInputFiles();
+  Bool_t retValue = kTRUE;
+
+  /* the single key files, each one read once for all its processes */
+  TList *singleKeyList = NULL;
+  if (fSingleKeyFiles.GetEntriesFast() > 0) {
+    singleKeyList = MergeProcess(&fSingleKeyFiles);
+    if (singleKeyList == NULL) {
+      QnCorrectionsError("The single key input files could not be merged");
+      retValue = kFALSE;
+    }
+    else
+      QnCorrectionsInfo(Form("Merged calibration lists out of %d single key files", fSingleKeyFiles.GetEntriesFast()));
+  }
+
+  TIter nextProcess(&fProcessesFiles);
+  TObjArray *files;
+  while ((files = (TObjArray *) nextProcess()) != NULL) {
+    TList *processList = MergeProcess(files);
+    TList *singleKeyProcessList = NULL;
+    if (singleKeyList != NULL) {
+      singleKeyProcessList = (TList *) singleKeyList->FindObject(files->GetName());
+      if (singleKeyProcessList != NULL)
+        singleKeyList->Remove(singleKeyProcessList);
+    }
+    if (processList == NULL) {
+      processList = singleKeyProcessList;
+    }
+    else if (singleKeyProcessList != NULL) {
+      TList sources;
+      sources.Add(singleKeyProcessList);
+      processList->Merge(&sources);
+      delete singleKeyProcessList;
+    }
+    if (processList == NULL) {
+      QnCorrectionsError(Form("Process list %s could not be merged", files->GetName()));
+      retValue = kFALSE;
+      continue;
+    }
+    outputDirectory->WriteTObject(processList, processList->GetName());
+    delete processList;
+    QnCorrectionsInfo(Form("Merged process list %s out of %d directory layout files", files->GetName(), files->GetEntriesFast()));
+  }
+
+  /* the processes only present in the single key files */
+  if (singleKeyList != NULL) {
+    TIter nextList(singleKeyList);
+    TObject *processList;
+    while ((processList = nextList()) != NULL) {
+      outputDirectory->WriteTObject(processList, processList->GetName());
+      QnCorrectionsInfo(Form("Merged process list %s", processList->GetName()));
+    }
+    delete singleKeyList;
+  }
+
+  delete fProgressCondition;
+  delete fMutex;
+  fProgressCondition = NULL;
+  fMutex = NULL;
+  TH1::AddDirectory(addDirectoryStatus);
+
+  outputFile->Close();
+  delete outputFile;
+  return retValue;
+}
@@ -0,0 +1,121 @@
+#ifndef QNCORRECTIONS_CALIBRATIONMERGER_H
+#define QNCORRECTIONS_CALIBRATIONMERGER_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsCalibrationMerger.h
+/// \brief Process by process parallel merging of the framework output histograms files
+
+#include <TObject.h>
+#include <TObjArray.h>
+#include <TList.h>
+#include <TString.h>
+#include <vector>
+
+class TFile;
+class TMutex;
+class TCondition;
+
+/// \class QnCorrectionsCalibrationMerger
+/// \brief Merges the support histograms of many output files into a calibration file
+///
+/// The framework output files hold, under the calibration histograms
+/// key, one list per concurrent process plus the all processes list.
+/// Either as a single key, as stored by the framework manager output
+/// list, or within a directory with one key per process, as stored by
+/// QnCorrectionsManager::WriteOutputHistogramsDirectory.
+///
+/// The input files are first scanned for the process lists they hold.
+/// Afterwards each process is merged on its own: its lists are read,
+/// one file at a time, and merged in pairs by a pool of threads in a
+/// tree reduction. Reading is only done when no pair is waiting to be
+/// merged so that, whatever the number of input files, just a few
+/// process lists per thread are kept in memory.
+///
+/// The reduction tree is fixed by the input files order: at each level,
+/// with stride s, the subtree starting at input i, multiple of 2s, is
+/// merged with the one starting at input i+s. Which thread runs each
+/// merge depends on the threads timing but the pairs and their order do
+/// not, so the merged content is the same, bit by bit, whatever the
+/// number of threads. Only the needed
+/// process list is read out of files in the directory layout.
+///
+/// Files with a single key can only be read whole so, they are not
+/// read per process. They go first through their own tree reduction,
+/// with the same rules, where each file is read once and the whole
+/// calibration lists are merged process by process. The result is kept
+/// while the processes of the directory layout files are merged, each
+/// process list being merged, last, with its single key counterpart.
+/// The memory then taken is the one of a few whole calibration lists
+/// per thread.
+///
+/// Once merged each process list is written to the output file, in the
+/// directory layout, and released. The output file is ready to be used
+/// as calibration file for the next pass.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsCalibrationMerger : public TObject {
+public:
+  QnCorrectionsCalibrationMerger();
+  virtual ~QnCorrectionsCalibrationMerger();
+
+  void AddInputFile(const char *fileName);
+  Int_t AddInputFilesList(const char *listFileName);
+  /// Sets the number of worker threads helping the one calling Merge
+  /// \param nWorkers the number of worker threads
+  void SetNoOfWorkers(Int_t nWorkers) { fNoOfWorkers = (nWorkers < 0) ? 0 : nWorkers; }
+  /// Gets the number of input files
+  /// \return the number of input files
+  Int_t GetNoOfInputFiles() const { return fInputFiles.GetEntriesFast(); }
+
+  Bool_t Merge(const char *outputFileName);
+
+private:
+  void ScanInputFiles();
+  void IncludeProcessFile(const char *processName, TObject *fileName);
+  static TList *ReadCalibrationList(TFile *inputFile);
+  static void MergeCalibrationLists(TList *target, TList *source);
+  TList *MergeProcess(const TObjArray *files);
+  Bool_t RunNextStep();
+  Int_t GetSubtreeSpan(Int_t ixSlot, Int_t span) const;
+  static void *WorkerLoop(void *merger);
+
+  TObjArray fInputFiles;              ///< the input files names
+  TList fProcessesFiles;              //!<! per process, the array of directory layout input files names holding it
+  TObjArray fSingleKeyFiles;          //!<! the single key input files names, with no name as it holds every process
+  Int_t fNoOfWorkers;                 ///< the number of worker threads
+  TString fProcessName;               //!<! the name of the process being merged, empty for whole calibration lists
+  const TObjArray *fProcessFiles;     //!<! the input files names of the process being merged, not owned
+  Int_t fNextFile;                    //!<! the next input file to read for the process being merged
+  std::vector<TList *> fSlotList;     //!<! per input file, the merged list of the subtree starting at it
+  std::vector<Int_t> fSlotSpan;       //!<! per input file, the number of inputs its subtree covers, zero if not available
+  std::vector<Bool_t> fSlotBusy;      //!<! per input file, its subtree is being read or merged
+  Int_t fNoOfStepsRunning;            //!<! the number of reading and merging steps being run
+  TMutex *fMutex;                     //!<! protects the reduction state
+  TCondition *fProgressCondition;     //!<! signals the completion of a step
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsCalibrationMerger(const QnCorrectionsCalibrationMerger &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsCalibrationMerger& operator= (const QnCorrectionsCalibrationMerger &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsCalibrationMerger, 3);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_CALIBRATIONMERGER_H */
@@ -0,0 +1,216 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsCalibrationSnapshot.cxx
+/// \brief Implementation of the shared correction parameters tables class
+
+#include <TList.h>
+#include <TThread.h>
+
+#include "QnCorrectionsCalibrationSnapshot.h"
+#include "QnCorrectionsLog.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsCalibrationSnapshot);
+/// \endcond
+
+TList *QnCorrectionsCalibrationSnapshot::fSnapshotsRegistry = NULL;
+Long64_t QnCorrectionsCalibrationSnapshot::fNoOfBuiltSnapshots = 0;
+
+/// Default constructor
+QnCorrectionsCalibrationSnapshot::QnCorrectionsCalibrationSnapshot() : TNamed() {
+  fSource = NULL;
+  fNoOfBins = 0;
+  fNoOfSlots = 0;
+  fNoOfParameters = 0;
+  fBinValidated = NULL;
+  fStatus = NULL;
+  fParameters = NULL;
+  fNoOfReferences = 0;
+}
+
+/// Normal constructor
+///
+/// Allocates the table storage. The bins are initialized as not validated,
+/// with zero status and zero parameters.
+/// \param source the calibration list the snapshot is extracted from
+/// \param name the name of the correction step owning the snapshot
+/// \param nNoOfBins the number of bins
+/// \param nNoOfSlots the number of slots per bin
+/// \param nNoOfParameters the number of parameters per slot
+/// \param bWithStatus kTRUE if a per slot status is needed
+QnCorrectionsCalibrationSnapshot::QnCorrectionsCalibrationSnapshot(const TList *source, const char *name,
+    Long64_t nNoOfBins, Int_t nNoOfSlots, Int_t nNoOfParameters, Bool_t bWithStatus) :
+    TNamed(name, name) {
+  fSource = source;
+  fNoOfBins = nNoOfBins;
+  fNoOfSlots = nNoOfSlots;
+  fNoOfParameters = nNoOfParameters;
+  fBinValidated = new Bool_t[fNoOfBins];
+  fStatus = NULL;
+  if (bWithStatus)
+    fStatus = new Char_t[fNoOfBins * fNoOfSlots];
+  fParameters = new Float_t[fNoOfBins * fNoOfSlots * fNoOfParameters];
+  for (Long64_t bin = 0; bin < fNoOfBins; bin++) {
+    fBinValidated[bin] = kFALSE;
+  }
+  if (fStatus != NULL) {
+    for (Long64_t ix = 0; ix < fNoOfBins * fNoOfSlots; ix++) {
+      fStatus[ix] = 0;
+    }
+  }
+  for (Long64_t ix = 0; ix < fNoOfBins * fNoOfSlots * fNoOfParameters; ix++) {
+    fParameters[ix] = 0.0;
+  }
+  fNoOfReferences = 0;
+}
+
+/// Default destructor
+/// Releases the memory taken
+QnCorrectionsCalibrationSnapshot::~QnCorrectionsCalibrationSnapshot() {
+  if (fBinValidated != NULL) delete [] fBinValidated;
+  if (fStatus != NULL) delete [] fStatus;
+  if (fParameters != NULL) delete [] fParameters;
+}
+
+/// Acquires a published snapshot
+///
+/// If a snapshot extracted from the passed calibration list by
+/// the passed correction step is published a new reference to it
+/// is taken
+/// \param source the calibration list the snapshot was extracted from
+/// \param name the name of the correction step
+/// \return the snapshot, NULL if not published
+const QnCorrectionsCalibrationSnapshot *QnCorrectionsCalibrationSnapshot::Acquire(const TList *source, const char *name) {
+  QnCorrectionsCalibrationSnapshot *found = NULL;
+
+  TThread::Lock();
+  if (fSnapshotsRegistry != NULL) {
+    TIter next(fSnapshotsRegistry);
+    QnCorrectionsCalibrationSnapshot *snapshot;
+    while ((snapshot = (QnCorrectionsCalibrationSnapshot *) next()) != NULL) {
+      if ((snapshot->fSource == source) && (strcmp(snapshot->GetName(), name) == 0)) {
+        found = snapshot;
+        found->fNoOfReferences++;
+        break;
+      }
+    }
+  }
+  TThread::UnLock();
+  return found;
+}
+
+/// Publishes a just built snapshot
+///
+/// The snapshot should not be modified anymore. If in the meantime
+/// an equivalent snapshot was published the passed one is destroyed
+/// and a reference to the already published one is returned.
+/// \param snapshot the snapshot to publish
+/// \return the published snapshot with a reference taken
+const QnCorrectionsCalibrationSnapshot *QnCorrectionsCalibrationSnapshot::Publish(QnCorrectionsCalibrationSnapshot *snapshot) {
+  TThread::Lock();
+  fNoOfBuiltSnapshots++;
+  TThread::UnLock();
+
+  const QnCorrectionsCalibrationSnapshot *published = Acquire(snapshot->fSource, snapshot->GetName());
+  if (published != NULL) {
+    delete snapshot;
+    return published;
+  }
+
+  TThread::Lock();
+  if (fSnapshotsRegistry == NULL)
+    fSnapshotsRegistry = new TList();
+  snapshot->fNoOfReferences = 1;
+  fSnapshotsRegistry->Add(snapshot);
+  TThread::UnLock();
+  return snapshot;
+}
+
+/// Releases a reference to a snapshot
+///
+/// The snapshot is destroyed once its last reference is released
+/// \param snapshot the snapshot to release
+void QnCorrectionsCalibrationSnapshot::Release(const QnCorrectionsCalibrationSnapshot *snapshot) {
+  if (snapshot == NULL) return;
+
+  QnCorrectionsCalibrationSnapshot *released = const_cast<QnCorrectionsCalibrationSnapshot *>(snapshot);
+  Bool_t destroy = kFALSE;
+
+  TThread::Lock();
+  released->fNoOfReferences--;
+  if (released->fNoOfReferences <= 0) {
+    if (fSnapshotsRegistry != NULL)
+      fSnapshotsRegistry->Remove(released);
+    destroy = kTRUE;
+  }
+  TThread::UnLock();
+
+  if (destroy)
+    delete released;
+}
+
+/// Withdraws from the registry the snapshots extracted from a calibration list
+///
+/// The snapshots extracted from the passed list or from any of the
+/// lists it contains cannot be acquired anymore. Should be called before
+/// deleting the list. The references already taken remain valid.
+/// \param list the calibration list going to be deleted
+void QnCorrectionsCalibrationSnapshot::Withdraw(const TList *list) {
+  if (list == NULL) return;
+
+  TThread::Lock();
+  if (fSnapshotsRegistry != NULL) {
+    for (Int_t ix = fSnapshotsRegistry->GetEntries() - 1; ix >= 0; ix--) {
+      QnCorrectionsCalibrationSnapshot *snapshot = (QnCorrectionsCalibrationSnapshot *) fSnapshotsRegistry->At(ix);
+      if ((snapshot->fSource == list) ||
+          (list->FindObject((const TObject *) snapshot->fSource) != NULL)) {
+        fSnapshotsRegistry->Remove(snapshot);
+      }
+    }
+  }
+  TThread::UnLock();
+}
+
+/// Gets the number of snapshots built so far
+///
+/// Every snapshot offered for publishing is accounted, even if
+/// an equivalent one was already published. It allows checking
+/// where the correction parameters tables are built.
+/// \return the number of built snapshots
+Long64_t QnCorrectionsCalibrationSnapshot::GetNoOfBuiltSnapshots() {
+  Long64_t nBuilt;
+
+  TThread::Lock();
+  nBuilt = fNoOfBuiltSnapshots;
+  TThread::UnLock();
+  return nBuilt;
+}
@@ -0,0 +1,129 @@
+#ifndef QNCORRECTIONS_CALIBRATIONSNAPSHOT_H
+#define QNCORRECTIONS_CALIBRATIONSNAPSHOT_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsCalibrationSnapshot.h
+/// \brief Immutable correction parameters tables shared among framework instances
+
+#include <TNamed.h>
+
+class TList;
+
+/// \class QnCorrectionsCalibrationSnapshot
+/// \brief Immutable, reference counted, correction parameters table
+///
+/// The correction steps transform their calibration input histograms
+/// into per bin parameters tables when the inputs are attached. Once
+/// built and published a table is not modified anymore so, it can be
+/// read concurrently by any number of framework managers, the replicas
+/// of a manager or managers running in different threads, without
+/// copies.
+///
+/// The table is organized per histogram bin. Each bin has a validation
+/// flag and a number of slots, usually one per harmonic, each one with
+/// a fixed number of parameters and an optional status.
+///
+/// Published snapshots are kept in a process wide registry identified
+/// by a key built out of the calibration list they were extracted from
+/// and the name of the correction step. A correction step asks
+/// first for an already published snapshot, Acquire, and only builds
+/// and publishes its own one if none is available. Each holder releases
+/// its reference once it does not need the snapshot anymore and the
+/// snapshot is destroyed when the last reference is released. The
+/// registry and the references are protected by the global ROOT
+/// thread lock.
+///
+/// When a calibration list is going to be deleted the snapshots extracted
+/// from it are withdrawn from the registry so that a new list allocated at
+/// the same address does not find them. Already acquired references
+/// remain valid.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsCalibrationSnapshot : public TNamed {
+public:
+  QnCorrectionsCalibrationSnapshot();
+  QnCorrectionsCalibrationSnapshot(const TList *source, const char *name,
+      Long64_t nNoOfBins, Int_t nNoOfSlots, Int_t nNoOfParameters, Bool_t bWithStatus = kFALSE);
+  virtual ~QnCorrectionsCalibrationSnapshot();
+
+  static const QnCorrectionsCalibrationSnapshot *Acquire(const TList *source, const char *name);
+  static const QnCorrectionsCalibrationSnapshot *Publish(QnCorrectionsCalibrationSnapshot *snapshot);
+  static void Release(const QnCorrectionsCalibrationSnapshot *snapshot);
+  static void Withdraw(const TList *list);
+  static Long64_t GetNoOfBuiltSnapshots();
+
+  /// Gets the number of bins in the table
+  /// \return the number of bins
+  Long64_t GetNoOfBins() const { return fNoOfBins; }
+  /// Gets the number of slots per bin
+  /// \return the number of slots
+  Int_t GetNoOfSlots() const { return fNoOfSlots; }
+  /// Gets the number of parameters per slot
+  /// \return the number of parameters
+  Int_t GetNoOfParameters() const { return fNoOfParameters; }
+  /// Gets the validation flag for the passed bin
+  /// \param bin the interested bin
+  /// \return kTRUE if the bin input information was validated
+  Bool_t IsBinValidated(Long64_t bin) const { return fBinValidated[bin]; }
+  /// Gets the slots status for the passed bin
+  /// \param bin the interested bin
+  /// \return the bin slots status, NULL if the table has no status
+  const Char_t *GetStatus(Long64_t bin) const { return (fStatus != NULL) ? fStatus + bin * fNoOfSlots : NULL; }
+  /// Gets the parameters for the passed bin
+  ///
+  /// The parameters of slot s are located at s times the number of parameters
+  /// \param bin the interested bin
+  /// \return the bin parameters
+  const Float_t *GetParameters(Long64_t bin) const { return fParameters + bin * fNoOfSlots * fNoOfParameters; }
+
+  /// Sets the validation flag for the passed bin. Only while building
+  /// \param bin the interested bin
+  /// \param validated the validation flag
+  void SetBinValidated(Long64_t bin, Bool_t validated) { fBinValidated[bin] = validated; }
+  /// Gets the modifiable slots status for the passed bin. Only while building
+  /// \param bin the interested bin
+  /// \return the bin slots status, NULL if the table has no status
+  Char_t *GetStatusToBuild(Long64_t bin) { return (fStatus != NULL) ? fStatus + bin * fNoOfSlots : NULL; }
+  /// Gets the modifiable parameters for the passed bin. Only while building
+  /// \param bin the interested bin
+  /// \return the bin parameters
+  Float_t *GetParametersToBuild(Long64_t bin) { return fParameters + bin * fNoOfSlots * fNoOfParameters; }
+
+private:
+  static TList *fSnapshotsRegistry;  ///< the published snapshots
+  static Long64_t fNoOfBuiltSnapshots; ///< the number of snapshots built and offered for publishing
+  const TList *fSource;              //!<! the calibration list the snapshot was extracted from
+  Long64_t fNoOfBins;                ///< the number of bins
+  Int_t fNoOfSlots;                  ///< the number of slots per bin
+  Int_t fNoOfParameters;             ///< the number of parameters per slot
+  Bool_t *fBinValidated;             //!<! array, per bin the input information validation flag
+  Char_t *fStatus;                   //!<! array, per bin and slot the status, if used
+  Float_t *fParameters;              //!<! array, per bin and slot the parameters
+  Int_t fNoOfReferences;             //!<! the number of holders of the snapshot
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsCalibrationSnapshot(const QnCorrectionsCalibrationSnapshot &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsCalibrationSnapshot& operator= (const QnCorrectionsCalibrationSnapshot &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsCalibrationSnapshot, 1);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_CALIBRATIONSNAPSHOT_H */
@@ -0,0 +1,343 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsConfigurationsScheduler.cxx
+/// \brief Implementation of the detector configurations event processing scheduler
+
+#include <TList.h>
+#include <TThread.h>
+#include <TMutex.h>
+#include <TCondition.h>
+
+#include "QnCorrectionsDetector.h"
+#include "QnCorrectionsDetectorConfigurationBase.h"
+#include "QnCorrectionsConfigurationsScheduler.h"
+#include "QnCorrectionsLog.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsConfigurationsScheduler);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsConfigurationsScheduler::QnCorrectionsConfigurationsScheduler() : TObject(),
+    fConfigurations() {
+  fConfigurations.SetOwner(kFALSE);
+  fNoOfConfigurations = 0;
+  fReferencesStart = NULL;
+  fReferences = NULL;
+  fTasks = NULL;
+  fCorrectionsDone = NULL;
+  fVariableContainer = NULL;
+  fNextTask = 0;
+  fNoOfPendingTasks = 0;
+  fEventNumber = 0;
+  fStopWorkers = kFALSE;
+  fNoOfWorkers = 0;
+  fWorkers = NULL;
+  fMutex = NULL;
+  fEventCondition = NULL;
+  fProgressCondition = NULL;
+}
+
+/// Default destructor
+/// Stops the worker threads and releases the memory taken
+QnCorrectionsConfigurationsScheduler::~QnCorrectionsConfigurationsScheduler() {
+  StopWorkers();
+  if (fReferencesStart != NULL) delete [] fReferencesStart;
+  if (fReferences != NULL) delete [] fReferences;
+  if (fTasks != NULL) delete [] fTasks;
+  if (fCorrectionsDone != NULL) delete [] fCorrectionsDone;
+}
+
+/// Builds the dependency graph and the tasks schedule
+///
+/// The detector configurations of the passed detectors are collected
+/// and the configurations each of them references are located. Should be
+/// called once the detector configurations have their support data
+/// structures created, i.e. the references are resolved.
+/// \param detectors the list of detectors
+void QnCorrectionsConfigurationsScheduler::BuildSchedule(const TList *detectors) {
+  if (fReferencesStart != NULL) delete [] fReferencesStart;
+  if (fReferences != NULL) delete [] fReferences;
+  if (fTasks != NULL) delete [] fTasks;
+  if (fCorrectionsDone != NULL) delete [] fCorrectionsDone;
+  fConfigurations.Clear();
+
+  TList *configurations = new TList();
+  configurations->SetOwner(kFALSE);
+  for (Int_t ixDetector = 0; ixDetector < detectors->GetEntries(); ixDetector++) {
+    ((QnCorrectionsDetector *) detectors->At(ixDetector))->FillDetectorConfigurationList(configurations);
+  }
+  fNoOfConfigurations = configurations->GetEntries();
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    fConfigurations.Add(configurations->At(ixConfiguration));
+  }
+  delete configurations;
+
+  /* the dependency graph: the configurations each configuration references */
+  TList *references = new TList();
+  references->SetOwner(kFALSE);
+  Int_t *noOfReferences = new Int_t[fNoOfConfigurations];
+  Int_t *buffer = new Int_t[fNoOfConfigurations * fNoOfConfigurations];
+  Int_t nTotalReferences = 0;
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    references->Clear();
+    ((QnCorrectionsDetectorConfigurationBase *) fConfigurations.At(ixConfiguration))->FillReferencedConfigurations(references);
+    noOfReferences[ixConfiguration] = 0;
+    for (Int_t ixReference = 0; ixReference < references->GetEntries(); ixReference++) {
+      Int_t referenced = fConfigurations.IndexOf(references->At(ixReference));
+      if (referenced < 0 || referenced == ixConfiguration) continue;
+      Bool_t already = kFALSE;
+      for (Int_t i = 0; i < noOfReferences[ixConfiguration]; i++) {
+        if (buffer[ixConfiguration * fNoOfConfigurations + i] == referenced) already = kTRUE;
+      }
+      if (already) continue;
+      buffer[ixConfiguration * fNoOfConfigurations + noOfReferences[ixConfiguration]] = referenced;
+      noOfReferences[ixConfiguration]++;
+      nTotalReferences++;
+    }
+  }
+  delete references;
+
+  fReferencesStart = new Int_t[fNoOfConfigurations + 1];
+  fReferences = new Int_t[(nTotalReferences > 0) ? nTotalReferences : 1];
+  fReferencesStart[0] = 0;
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    for (Int_t i = 0; i < noOfReferences[ixConfiguration]; i++) {
+      fReferences[fReferencesStart[ixConfiguration] + i] = buffer[ixConfiguration * fNoOfConfigurations + i];
+    }
+    fReferencesStart[ixConfiguration + 1] = fReferencesStart[ixConfiguration] + noOfReferences[ixConfiguration];
+  }
+  delete [] noOfReferences;
+  delete [] buffer;
+
+  /* the corrections tasks go first, the ones of referenced configurations ahead */
+  fTasks = new Int_t[2 * fNoOfConfigurations];
+  fCorrectionsDone = new Bool_t[fNoOfConfigurations];
+  Bool_t *referenced = new Bool_t[fNoOfConfigurations];
+  Int_t *position = new Int_t[fNoOfConfigurations];
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    referenced[ixConfiguration] = kFALSE;
+    fCorrectionsDone[ixConfiguration] = kFALSE;
+  }
+  for (Int_t ix = 0; ix < nTotalReferences; ix++) {
+    referenced[fReferences[ix]] = kTRUE;
+  }
+  Int_t nTasks = 0;
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    if (referenced[ixConfiguration]) {
+      position[ixConfiguration] = nTasks;
+      fTasks[nTasks++] = ixConfiguration;
+    }
+  }
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    if (!referenced[ixConfiguration]) {
+      position[ixConfiguration] = nTasks;
+      fTasks[nTasks++] = ixConfiguration;
+    }
+  }
+
+  /* the data collection tasks ordered by the last of the corrections they wait for */
+  Int_t *ready = new Int_t[fNoOfConfigurations];
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    ready[ixConfiguration] = position[ixConfiguration];
+    for (Int_t ix = fReferencesStart[ixConfiguration]; ix < fReferencesStart[ixConfiguration + 1]; ix++) {
+      if (ready[ixConfiguration] < position[fReferences[ix]])
+        ready[ixConfiguration] = position[fReferences[ix]];
+    }
+  }
+  for (Int_t pos = 0; pos < fNoOfConfigurations; pos++) {
+    for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+      if (ready[ixConfiguration] == pos)
+        fTasks[nTasks++] = fNoOfConfigurations + ixConfiguration;
+    }
+  }
+  delete [] referenced;
+  delete [] position;
+  delete [] ready;
+
+  fNextTask = 2 * fNoOfConfigurations;
+  fNoOfPendingTasks = 0;
+
+  QnCorrectionsInfo(Form("Scheduled %d detector configurations with %d references among them",
+      fNoOfConfigurations, nTotalReferences));
+}
+
+/// Starts the pool of worker threads
+///
+/// ROOT must support threads. TThread::Initialize is invoked.
+/// \param nWorkers the number of worker threads besides the one calling ProcessEvent
+void QnCorrectionsConfigurationsScheduler::StartWorkers(Int_t nWorkers) {
+  StopWorkers();
+  if (nWorkers < 1) return;
+
+  TThread::Initialize();
+  fMutex = new TMutex();
+  fEventCondition = new TCondition(fMutex);
+  fProgressCondition = new TCondition(fMutex);
+  fStopWorkers = kFALSE;
+  fWorkers = new TThread *[nWorkers];
+  for (Int_t ixWorker = 0; ixWorker < nWorkers; ixWorker++) {
+    fWorkers[ixWorker] = new TThread(Form("QnCorrectionsWorker%d", ixWorker),
+        (TThread::VoidRtnFunc_t) &WorkerLoop, (void *) this);
+    fWorkers[ixWorker]->Run();
+  }
+  fNoOfWorkers = nWorkers;
+}
+
+/// Stops and releases the pool of worker threads
+void QnCorrectionsConfigurationsScheduler::StopWorkers() {
+  if (fNoOfWorkers == 0) return;
+
+  fMutex->Lock();
+  fStopWorkers = kTRUE;
+  fEventCondition->Broadcast();
+  fMutex->UnLock();
+  for (Int_t ixWorker = 0; ixWorker < fNoOfWorkers; ixWorker++) {
+    fWorkers[ixWorker]->Join();
+    delete fWorkers[ixWorker];
+  }
+  delete [] fWorkers;
+  delete fEventCondition;
+  delete fProgressCondition;
+  delete fMutex;
+  fWorkers = NULL;
+  fEventCondition = NULL;
+  fProgressCondition = NULL;
+  fMutex = NULL;
+  fNoOfWorkers = 0;
+}
+
+/// Processes the current event on the scheduled detector configurations
+///
+/// The calling thread takes part in running the tasks and returns
+/// once all of them are finished.
+/// \param variableContainer the current variables content addressed by var Id
+void QnCorrectionsConfigurationsScheduler::ProcessEvent(const Float_t *variableContainer) {
+  fVariableContainer = variableContainer;
+
+  if (fNoOfWorkers == 0) {
+    /* the tasks order already fulfills the dependencies */
+    for (Int_t ixTask = 0; ixTask < 2 * fNoOfConfigurations; ixTask++) {
+      RunTask(fTasks[ixTask]);
+    }
+    return;
+  }
+
+  fMutex->Lock();
+  for (Int_t ixConfiguration = 0; ixConfiguration < fNoOfConfigurations; ixConfiguration++) {
+    fCorrectionsDone[ixConfiguration] = kFALSE;
+  }
+  fNextTask = 0;
+  fNoOfPendingTasks = 2 * fNoOfConfigurations;
+  fEventNumber++;
+  fEventCondition->Broadcast();
+  fMutex->UnLock();
+
+  while (RunNextTask());
+
+  fMutex->Lock();
+  while (fNoOfPendingTasks > 0) {
+    fProgressCondition->Wait();
+  }
+  fMutex->UnLock();
+}
+
+/// Runs a task
+/// \param task the task, the configuration index for its corrections, plus the number of configurations for its data collection
+void QnCorrectionsConfigurationsScheduler::RunTask(Int_t task) {
+  if (task < fNoOfConfigurations)
+    ((QnCorrectionsDetectorConfigurationBase *) fConfigurations.At(task))->ProcessCorrections(fVariableContainer);
+  else
+    ((QnCorrectionsDetectorConfigurationBase *) fConfigurations.At(task - fNoOfConfigurations))->ProcessDataCollection(fVariableContainer);
+}
+
+/// Claims and runs the next task of the current event
+///
+/// A data collection task waits for the corrections of its configuration
+/// and of its reference configurations to be done.
+/// \return kFALSE if there were no tasks left
+Bool_t QnCorrectionsConfigurationsScheduler::RunNextTask() {
+  fMutex->Lock();
+  if (!(fNextTask < 2 * fNoOfConfigurations)) {
+    fMutex->UnLock();
+    return kFALSE;
+  }
+  Int_t task = fTasks[fNextTask];
+  fNextTask++;
+  if (!(task < fNoOfConfigurations)) {
+    Int_t ixConfiguration = task - fNoOfConfigurations;
+    Bool_t ready = kFALSE;
+    while (!ready) {
+      ready = fCorrectionsDone[ixConfiguration];
+      for (Int_t ix = fReferencesStart[ixConfiguration]; ready && (ix < fReferencesStart[ixConfiguration + 1]); ix++) {
+        ready = fCorrectionsDone[fReferences[ix]];
+      }
+      if (!ready)
+        fProgressCondition->Wait();
+    }
+  }
+  fMutex->UnLock();
+
+  RunTask(task);
+
+  fMutex->Lock();
+  if (task < fNoOfConfigurations)
+    fCorrectionsDone[task] = kTRUE;
+  fNoOfPendingTasks--;
+  fProgressCondition->Broadcast();
+  fMutex->UnLock();
+  return kTRUE;
+}
+
+/// The worker threads body
+///
+/// Waits for new events and runs their tasks until asked to stop
+/// \param scheduler the scheduler the worker belongs to
+/// \return NULL
+void *QnCorrectionsConfigurationsScheduler::WorkerLoop(void *scheduler) {
+  QnCorrectionsConfigurationsScheduler *theScheduler = (QnCorrectionsConfigurationsScheduler *) scheduler;
+
+  theScheduler->fMutex->Lock();
+  Int_t nLastEvent = theScheduler->fEventNumber;
+  while (kTRUE) {
+    while (!theScheduler->fStopWorkers && (theScheduler->fEventNumber == nLastEvent)) {
+      theScheduler->fEventCondition->Wait();
+    }
+    if (theScheduler->fStopWorkers) break;
+    nLastEvent = theScheduler->fEventNumber;
+    theScheduler->fMutex->UnLock();
+    while (theScheduler->RunNextTask());
+    theScheduler->fMutex->Lock();
+  }
+  theScheduler->fMutex->UnLock();
+  return NULL;
+}
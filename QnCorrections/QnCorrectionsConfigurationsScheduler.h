@@ -0,0 +1,104 @@
+#ifndef QNCORRECTIONS_CONFIGURATIONSSCHEDULER_H
+#define QNCORRECTIONS_CONFIGURATIONSSCHEDULER_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsConfigurationsScheduler.h
+/// \brief Dependency aware parallel processing of the detector configurations within an event
+
+#include <TObject.h>
+#include <TObjArray.h>
+
+class TList;
+class TThread;
+class TMutex;
+class TCondition;
+
+/// \class QnCorrectionsConfigurationsScheduler
+/// \brief Schedules the event processing of the detector configurations on a pool of threads
+///
+/// The event processing of each detector configuration is split in
+/// two tasks: the corrections and the data collection. Corrections
+/// only involve the own configuration while the data collection of
+/// some correction steps, alignment and twist and rescale by
+/// correlations, reads the current Qn vectors of other, reference,
+/// configurations. The dependency graph is built out of these
+/// references when the scheduler is built.
+///
+/// The corrections tasks are scheduled first, the ones of the
+/// referenced configurations ahead, followed by the data collection
+/// tasks ordered by the availability of their references. A data
+/// collection task only starts once the corrections of its own
+/// configuration and of all its reference configurations are done.
+/// As corrections tasks never wait, the scheduling cannot dead lock
+/// even with circular references.
+///
+/// The tasks are run by the thread calling ProcessEvent together with
+/// a pool of worker threads that live as long as the scheduler. Without
+/// worker threads the tasks are run serially.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsConfigurationsScheduler : public TObject {
+public:
+  QnCorrectionsConfigurationsScheduler();
+  virtual ~QnCorrectionsConfigurationsScheduler();
+
+  void BuildSchedule(const TList *detectors);
+  void StartWorkers(Int_t nWorkers);
+  void StopWorkers();
+  void ProcessEvent(const Float_t *variableContainer);
+
+  /// Gets the number of scheduled detector configurations
+  /// \return the number of detector configurations
+  Int_t GetNoOfConfigurations() const { return fNoOfConfigurations; }
+  /// Gets the number of worker threads
+  /// \return the number of worker threads
+  Int_t GetNoOfWorkers() const { return fNoOfWorkers; }
+
+private:
+  void RunTask(Int_t task);
+  Bool_t RunNextTask();
+  static void *WorkerLoop(void *scheduler);
+
+  TObjArray fConfigurations;          //!<! the scheduled detector configurations, not owned
+  Int_t fNoOfConfigurations;          //!<! the number of scheduled detector configurations
+  Int_t *fReferencesStart;            //!<! array, per configuration the position of its first reference in fReferences
+  Int_t *fReferences;                 //!<! array, the referenced configurations indexes
+  Int_t *fTasks;                      //!<! array, the tasks in scheduling order, configuration index for corrections, plus number of configurations for data collection
+  Bool_t *fCorrectionsDone;           //!<! array, per configuration the current event corrections done flag
+  const Float_t *fVariableContainer;  //!<! the current event variables content
+  Int_t fNextTask;                    //!<! the next task to be run
+  Int_t fNoOfPendingTasks;            //!<! the number of not yet finished tasks
+  Int_t fEventNumber;                 //!<! the number of events given to the workers
+  Bool_t fStopWorkers;                //!<! the workers should finish
+  Int_t fNoOfWorkers;                 //!<! the number of worker threads
+  TThread **fWorkers;                 //!<! array, the worker threads
+  TMutex *fMutex;                     //!<! protects the scheduling state
+  TCondition *fEventCondition;        //!<! signals the workers a new event is available
+  TCondition *fProgressCondition;     //!<! signals the tasks completion
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsConfigurationsScheduler(const QnCorrectionsConfigurationsScheduler &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsConfigurationsScheduler& operator= (const QnCorrectionsConfigurationsScheduler &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsConfigurationsScheduler, 1);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_CONFIGURATIONSSCHEDULER_H */
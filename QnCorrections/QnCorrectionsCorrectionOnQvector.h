@@ -79,6 +79,10 @@ public:
   /// Clean the correction to accept a new event
   /// Pure virtual function
   virtual void ClearCorrectionStep() = 0;
+  /// Transfers the accumulated content of the filled histograms to them
+  ///
+  /// Pure virtual function
+  virtual void FlushHistograms() = 0;
   /// Reports if the correction step is being applied
   /// Pure virutal function
   /// \return TRUE if the correction step is being applied
@@ -33,6 +33,8 @@
 /// \brief Correction steps base class implementation
 
 #include "QnCorrectionsCorrectionStepBase.h"
+#include "QnCorrectionsDetectorConfigurationBase.h"
+#include "QnCorrectionsCalibrationSnapshot.h"
 
 /// \cond CLASSIMP
 ClassImp(QnCorrectionsCorrectionStepBase);
@@ -44,6 +46,9 @@ QnCorrectionsCorrectionStepBase::QnCorrectionsCorrectionStepBase() : TNamed() {
   fState = QCORRSTEP_calibration;
   fDetectorConfiguration = NULL;
   fKey = "";
+  fCorrectionsCounters = NULL;
+  fDataCollectionCounters = NULL;
+  fPreparedInput = NULL;
 }
 
 /// Normal constructor
@@ -55,11 +60,15 @@ QnCorrectionsCorrectionStepBase::QnCorrectionsCorrectionStepBase(const char *nam
   fState = QCORRSTEP_calibration;
   fDetectorConfiguration = NULL;
   fKey = key;
+  fCorrectionsCounters = NULL;
+  fDataCollectionCounters = NULL;
+  fPreparedInput = NULL;
 }
 
 /// Default destructor
 QnCorrectionsCorrectionStepBase::~QnCorrectionsCorrectionStepBase() {
 
+  ReleasePreparedInput();
 }
 
 /// Checks if should be applied before the one passed as parameter
@@ -71,4 +80,40 @@ Bool_t QnCorrectionsCorrectionStepBase::Before(const QnCorrectionsCorrectionStep
   return kFALSE;
 }
 
+/// Attaches the correction step to an instrumentation table
+///
+/// An entry per event processing phase is added to the table and its
+/// counters are the ones updated from then on.
+/// \param instrumentation the instrumentation table, NULL for detaching the step
+void QnCorrectionsCorrectionStepBase::AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation) {
 
+  if (instrumentation != NULL) {
+    fCorrectionsCounters = instrumentation->AddEntry(fDetectorConfiguration->GetName(), GetName(), QnCorrectionsInstrumentation::kCorrections);
+    fDataCollectionCounters = instrumentation->AddEntry(fDetectorConfiguration->GetName(), GetName(), QnCorrectionsInstrumentation::kDataCollection);
+  }
+  else {
+    fCorrectionsCounters = NULL;
+    fDataCollectionCounters = NULL;
+  }
+}
+
+/// Holds the input prepared in advance
+///
+/// The reference is kept until the input is released once
+/// attached. If an input was already held it is released.
+/// \param snapshot the prepared input with a reference already taken
+void QnCorrectionsCorrectionStepBase::HoldPreparedInput(const QnCorrectionsCalibrationSnapshot *snapshot) {
+
+  ReleasePreparedInput();
+  fPreparedInput = snapshot;
+}
+
+/// Releases the input prepared in advance
+///
+/// Should be called once the inputs have been attached. By then
+/// the correction step has taken its own reference, if any.
+void QnCorrectionsCorrectionStepBase::ReleasePreparedInput() {
+
+  QnCorrectionsCalibrationSnapshot::Release(fPreparedInput);
+  fPreparedInput = NULL;
+}
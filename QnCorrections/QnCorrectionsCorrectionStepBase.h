@@ -17,6 +17,9 @@
 
 #include <TNamed.h>
 #include <TList.h>
+#include "QnCorrectionsInstrumentation.h"
+
+class QnCorrectionsCalibrationSnapshot;
 
 class QnCorrectionsDetectorConfigurationBase;
 class QnCorrectionsDetectorConfigurationChannels;
@@ -29,6 +32,12 @@ class QnCorrectionsQnVector;
 /// in an open way while the key is used to codify its position
 /// in an ordered list of consecutive corrections.
 ///
+/// The detector configurations invoke the event processing of the
+/// correction step through InstrumentedProcessCorrections and
+/// InstrumentedProcessDataCollection which, if the instrumentation is
+/// compiled in and the step is attached to an instrumentation table,
+/// account the call before passing it to the correction step.
+///
 /// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
 /// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
 /// \author Víctor González <victor.gonzalez@cern.ch>, UCM
@@ -71,6 +80,20 @@ public:
   /// \param list list where the inputs should be found
   /// \return kTRUE if everything went OK
   virtual Bool_t AttachInput(TList *list) = 0;
+  /// Prepares in advance the input information of a calibration list
+  ///
+  /// Intended to be called from a thread other than the one processing
+  /// events, while the correction step is still attached to a previous
+  /// calibration list. The correction step builds, out of the passed list,
+  /// what AttachInput will need and publishes it so that AttachInput for
+  /// the same list only has to pick it up. Only the configuration
+  /// of the correction step is read, its ongoing state is not touched.
+  ///
+  /// By default nothing is prepared.
+  /// \param list list where the inputs should be found
+  /// \return kTRUE if something was prepared
+  virtual Bool_t PrepareInput(TList *list) { return kFALSE; }
+  void ReleasePreparedInput();
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -111,6 +134,15 @@ public:
   /// Pure virtual function
   /// \return kTRUE if everything went OK
   virtual Bool_t ProcessDataCollection(const Float_t *variableContainer) = 0;
+  Bool_t InstrumentedProcessCorrections(const Float_t *variableContainer, Int_t nDataVectors);
+  Bool_t InstrumentedProcessDataCollection(const Float_t *variableContainer, Int_t nDataVectors);
+  void AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation);
+  /// Include the detector configurations whose Qn vectors the step reads into the passed list
+  ///
+  /// Most correction steps only involve its own detector configuration
+  /// so, by default, nothing is included.
+  /// \param list list where the referenced detector configurations should be added
+  virtual void FillReferencedConfigurations(TList *list) const { }
   /// Include the new corrected Qn vector into the passed list
   ///
   /// Pure virtual function
@@ -119,6 +151,10 @@ public:
   /// Clean the correction to accept a new event
   /// Pure virtual function
   virtual void ClearCorrectionStep() = 0;
+  /// Transfers the accumulated content of the filled histograms to them
+  ///
+  /// Pure virtual function
+  virtual void FlushHistograms() = 0;
   /// Reports if the correction step is being applied
   /// Pure virutal function
   /// \return TRUE if the correction step is being applied
@@ -138,10 +174,14 @@ protected:
   /// \param detectorConfiguration the detector configuration owner
   void SetConfigurationOwner(QnCorrectionsDetectorConfigurationBase *detectorConfiguration)
   { fDetectorConfiguration = detectorConfiguration; }
+  void HoldPreparedInput(const QnCorrectionsCalibrationSnapshot *snapshot);
 
   QnCorrectionStepStatus fState;                                  ///< the state in which the correction step is
   QnCorrectionsDetectorConfigurationBase *fDetectorConfiguration; ///< pointer to the detector configuration owner
   TString fKey;                                                   ///< the correction key that codifies order information
+  ULong64_t *fCorrectionsCounters;                                //!<! the instrumentation counters of the corrections phase, NULL if not instrumented
+  ULong64_t *fDataCollectionCounters;                             //!<! the instrumentation counters of the data collection phase, NULL if not instrumented
+  const QnCorrectionsCalibrationSnapshot *fPreparedInput;         //!<! the input prepared in advance, held until attached
 
 private:
   /// Copy constructor
@@ -152,8 +192,26 @@ private:
   QnCorrectionsCorrectionStepBase& operator= (const QnCorrectionsCorrectionStepBase &);
 
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsCorrectionStepBase, 1);
+  ClassDef(QnCorrectionsCorrectionStepBase, 3);
 /// \endcond
 };
 
+/// Processes the correction step accounting it for the instrumentation
+/// \param variableContainer pointer to the variable content bank
+/// \param nDataVectors the number of data vectors of the detector configuration
+/// \return what the correction step ProcessCorrections returns
+inline Bool_t QnCorrectionsCorrectionStepBase::InstrumentedProcessCorrections(const Float_t *variableContainer, Int_t nDataVectors) {
+  QnCorrectionsInstrument(fCorrectionsCounters, nDataVectors);
+  return ProcessCorrections(variableContainer);
+}
+
+/// Processes the correction step data collection accounting it for the instrumentation
+/// \param variableContainer pointer to the variable content bank
+/// \param nDataVectors the number of data vectors of the detector configuration
+/// \return what the correction step ProcessDataCollection returns
+inline Bool_t QnCorrectionsCorrectionStepBase::InstrumentedProcessDataCollection(const Float_t *variableContainer, Int_t nDataVectors) {
+  QnCorrectionsInstrument(fDataCollectionCounters, nDataVectors);
+  return ProcessDataCollection(variableContainer);
+}
+
 #endif // QNCORRECTIONS_CORRECTIONSTEPBASE_H
@@ -37,6 +37,7 @@ class QnCorrectionsCutAbove: public QnCorrectionsCutsBase {
   virtual ~QnCorrectionsCutAbove();
 
   virtual Bool_t IsSelected(const Float_t *variableContainer);
+  virtual Int_t GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const;
  private:
   Float_t         fThreshold;   ///< The value that must be surpassed
 
@@ -56,4 +57,18 @@ inline Bool_t QnCorrectionsCutAbove::IsSelected(const Float_t *variableContainer
     return kFALSE;
 }
 
+/// Gets the operation code and parameters of the cut for a compiled cuts table
+/// \param min storage for the lower parameter of the cut
+/// \param max storage for the upper parameter of the cut
+/// \param mask storage for the mask parameter of the cut
+/// \param expected storage for the expected masked value of the cut
+/// \return the cut operation code
+inline Int_t QnCorrectionsCutAbove::GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const {
+  min = fThreshold;
+  max = 0.0;
+  mask = 0x00000000;
+  expected = 0x00000000;
+  return kCUTABOVE;
+}
+
 #endif // QNCORRECTIONS_CUT_ABOVE_H
@@ -37,6 +37,7 @@ class QnCorrectionsCutBelow: public QnCorrectionsCutsBase {
   virtual ~QnCorrectionsCutBelow();
 
   virtual Bool_t IsSelected(const Float_t *variableContainer);
+  virtual Int_t GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const;
  private:
   Float_t         fThreshold;   ///< The upper, not reached, value
 
@@ -56,4 +57,18 @@ inline Bool_t QnCorrectionsCutBelow::IsSelected(const Float_t *variableContainer
     return kFALSE;
 }
 
+/// Gets the operation code and parameters of the cut for a compiled cuts table
+/// \param min storage for the lower parameter of the cut
+/// \param max storage for the upper parameter of the cut
+/// \param mask storage for the mask parameter of the cut
+/// \param expected storage for the expected masked value of the cut
+/// \return the cut operation code
+inline Int_t QnCorrectionsCutBelow::GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const {
+  min = 0.0;
+  max = fThreshold;
+  mask = 0x00000000;
+  expected = 0x00000000;
+  return kCUTBELOW;
+}
+
 #endif // QNCORRECTIONS_CUT_BELOW_H
@@ -38,6 +38,7 @@ class QnCorrectionsCutOutside: public QnCorrectionsCutsBase {
   virtual ~QnCorrectionsCutOutside();
 
   virtual Bool_t IsSelected(const Float_t *variableContainer);
+  virtual Int_t GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const;
  private:
   Float_t         fMinThreshold;   ///< The lower limit
   Float_t         fMaxThreshold;   ///< The upper limit
@@ -58,4 +59,18 @@ inline Bool_t QnCorrectionsCutOutside::IsSelected(const Float_t *variableContain
     return kTRUE;
 }
 
+/// Gets the operation code and parameters of the cut for a compiled cuts table
+/// \param min storage for the lower parameter of the cut
+/// \param max storage for the upper parameter of the cut
+/// \param mask storage for the mask parameter of the cut
+/// \param expected storage for the expected masked value of the cut
+/// \return the cut operation code
+inline Int_t QnCorrectionsCutOutside::GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const {
+  min = fMinThreshold;
+  max = fMaxThreshold;
+  mask = 0x00000000;
+  expected = 0x00000000;
+  return kCUTOUTSIDE;
+}
+
 #endif // QNCORRECTIONS_CUT_OUTSIDE_H
@@ -39,6 +39,7 @@ class QnCorrectionsCutSetBit: public QnCorrectionsCutsBase {
   virtual ~QnCorrectionsCutSetBit();
 
   virtual Bool_t IsSelected(const Float_t *variableContainer);
+  virtual Int_t GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const;
  private:
   UInt_t          fBitMask;   ///< The mask to apply to the variable value
   UInt_t          fExpectedResult; ///< The expected masked result to pass the cut
@@ -59,4 +60,18 @@ inline Bool_t QnCorrectionsCutSetBit::IsSelected(const Float_t *variableContaine
     return kTRUE;
 }
 
+/// Gets the operation code and parameters of the cut for a compiled cuts table
+/// \param min storage for the lower parameter of the cut
+/// \param max storage for the upper parameter of the cut
+/// \param mask storage for the mask parameter of the cut
+/// \param expected storage for the expected masked value of the cut
+/// \return the cut operation code
+inline Int_t QnCorrectionsCutSetBit::GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const {
+  min = 0.0;
+  max = 0.0;
+  mask = fBitMask;
+  expected = fExpectedResult;
+  return kCUTSETBIT;
+}
+
 #endif // QNCORRECTIONS_CUT_SETBIT_H
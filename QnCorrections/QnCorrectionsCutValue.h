@@ -38,6 +38,7 @@ class QnCorrectionsCutValue: public QnCorrectionsCutsBase {
   virtual ~QnCorrectionsCutValue();
 
   virtual Bool_t IsSelected(const Float_t *variableContainer);
+  virtual Int_t GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const;
  private:
   Float_t         fValue;   ///< The desired value
 
@@ -57,4 +58,18 @@ inline Bool_t QnCorrectionsCutValue::IsSelected(const Float_t *variableContainer
     return kTRUE;
 }
 
+/// Gets the operation code and parameters of the cut for a compiled cuts table
+/// \param min storage for the lower parameter of the cut
+/// \param max storage for the upper parameter of the cut
+/// \param mask storage for the mask parameter of the cut
+/// \param expected storage for the expected masked value of the cut
+/// \return the cut operation code
+inline Int_t QnCorrectionsCutValue::GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const {
+  min = fValue;
+  max = fValue;
+  mask = 0x00000000;
+  expected = 0x00000000;
+  return kCUTVALUE;
+}
+
 #endif // QNCORRECTIONS_CUT_VALUE_H
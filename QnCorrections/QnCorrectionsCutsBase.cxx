@@ -63,4 +63,20 @@ QnCorrectionsCutsBase::QnCorrectionsCutsBase(Int_t varId) :
 QnCorrectionsCutsBase::~QnCorrectionsCutsBase() {
 }
 
+/// Gets the operation code and parameters of the cut for a compiled cuts table
+///
+/// Default behavior. The cut is not expressible as an operation code so,
+/// it will be evaluated through IsSelected.
+/// \param min storage for the lower parameter of the cut
+/// \param max storage for the upper parameter of the cut
+/// \param mask storage for the mask parameter of the cut
+/// \param expected storage for the expected masked value of the cut
+/// \return the cut operation code
+Int_t QnCorrectionsCutsBase::GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const {
+  min = 0.0;
+  max = 0.0;
+  mask = 0x00000000;
+  expected = 0x00000000;
+  return kCUTNOTCOMPILABLE;
+}
 
@@ -25,6 +25,10 @@
 /// Provides the interface for the set of different cuts
 /// classes.
 ///
+/// Cuts that can be expressed as one of the framework cut operation
+/// codes report it, together with its parameters, via GetCompiledCut so
+/// that sets of cuts can be evaluated from a compact table.
+///
 /// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
 /// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
 /// \author Víctor González <victor.gonzalez@cern.ch>, UCM
@@ -32,6 +36,23 @@
 class QnCorrectionsCutsBase: public TObject {
 
  public:
+  /// \typedef QnCorrectionsCutOpCode
+  /// \brief The operation codes of the cuts evaluable from a compiled cuts table
+  ///
+  /// Actually it is not a class because the C++ level of implementation.
+  /// But full protection will be reached when were possible declaring it
+  /// as a class.
+  typedef enum {
+    kCUTABOVE = 0,               ///< passes if the value is above the min parameter
+    kCUTBELOW,                   ///< passes if the value is below the max parameter
+    kCUTWITHIN,                  ///< passes if the value is within the min and max parameters
+    kCUTOUTSIDE,                 ///< passes if the value is not within the min and max parameters
+    kCUTVALUE,                   ///< passes if the value is equal to the min parameter
+    kCUTSETBIT,                  ///< passes if the value masked with the mask parameter equals the expected parameter
+    kNOOFCUTOPCODES,             ///< the number of operation codes
+    kCUTNOTCOMPILABLE = kNOOFCUTOPCODES ///< the cut cannot be expressed as an operation code
+  } QnCorrectionsCutOpCode;
+
   QnCorrectionsCutsBase();
   QnCorrectionsCutsBase(const QnCorrectionsCutsBase &cut);
   QnCorrectionsCutsBase(Int_t varId);
@@ -48,6 +69,7 @@ class QnCorrectionsCutsBase: public TObject {
   /// \param variableContainer the current variables content addressed by var Id
   /// \return kTRUE if the actual value passes the cut else kFALSE
   virtual Bool_t IsSelected(const Float_t *variableContainer) = 0;
+  virtual Int_t GetCompiledCut(Float_t &min, Float_t &max, UInt_t &mask, UInt_t &expected) const;
  protected:
   Int_t         fVarId;   ///< The external Id for the variable in the data bank
 
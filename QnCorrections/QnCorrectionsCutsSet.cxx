@@ -31,6 +31,8 @@
 /// \file QnCorrectionsCutsSet.cxx
 /// \brief Implementation of the set of cuts class support for the Q vector correction framework
 
+#include <TMath.h>
+
 #include "QnCorrectionsCutsSet.h"
 #include "QnCorrectionsLog.h"
 
@@ -39,5 +41,228 @@
 ClassImp(QnCorrectionsCutsSet);
 /// \endcond
 
+const Int_t QnCorrectionsCutsSet::nSelectionMaskWordBits = 64;
+
+/// Default destructor
+/// Releases the compiled cuts table
+QnCorrectionsCutsSet::~QnCorrectionsCutsSet() {
+  ReleaseCompiledCuts();
+}
+
+/// Adds a cut at the end of the set
+/// Releases the compiled cuts table
+/// \param obj the cut
+void QnCorrectionsCutsSet::Add(TObject *obj) {
+  ReleaseCompiledCuts();
+  TObjArray::Add(obj);
+}
+
+/// Adds a cut at the beginning of the set
+/// Releases the compiled cuts table
+/// \param obj the cut
+void QnCorrectionsCutsSet::AddFirst(TObject *obj) {
+  ReleaseCompiledCuts();
+  TObjArray::AddFirst(obj);
+}
+
+/// Adds a cut at the end of the set
+/// Releases the compiled cuts table
+/// \param obj the cut
+void QnCorrectionsCutsSet::AddLast(TObject *obj) {
+  ReleaseCompiledCuts();
+  TObjArray::AddLast(obj);
+}
+
+/// Adds a cut at the passed position, replacing the one there if any
+/// Releases the compiled cuts table
+/// \param obj the cut
+/// \param idx the position in the set
+void QnCorrectionsCutsSet::AddAt(TObject *obj, Int_t idx) {
+  ReleaseCompiledCuts();
+  TObjArray::AddAt(obj, idx);
+}
+
+/// Adds a cut at the passed position expanding the set if needed
+/// Releases the compiled cuts table
+/// \param obj the cut
+/// \param idx the position in the set
+void QnCorrectionsCutsSet::AddAtAndExpand(TObject *obj, Int_t idx) {
+  ReleaseCompiledCuts();
+  TObjArray::AddAtAndExpand(obj, idx);
+}
+
+/// Removes the cut at the passed position
+/// Releases the compiled cuts table
+/// \param idx the position in the set
+/// \return the removed cut
+TObject *QnCorrectionsCutsSet::RemoveAt(Int_t idx) {
+  ReleaseCompiledCuts();
+  return TObjArray::RemoveAt(idx);
+}
+
+/// Removes the passed cut from the set
+/// Releases the compiled cuts table
+/// \param obj the cut
+/// \return the removed cut
+TObject *QnCorrectionsCutsSet::Remove(TObject *obj) {
+  ReleaseCompiledCuts();
+  return TObjArray::Remove(obj);
+}
+
+/// Removes all the cuts from the set
+/// Releases the compiled cuts table
+/// \param option the clear option
+void QnCorrectionsCutsSet::Clear(Option_t *option) {
+  ReleaseCompiledCuts();
+  TObjArray::Clear(option);
+}
+
+/// Removes all the cuts from the set deleting them if owned
+/// Releases the compiled cuts table
+/// \param option the delete option
+void QnCorrectionsCutsSet::Delete(Option_t *option) {
+  ReleaseCompiledCuts();
+  TObjArray::Delete(option);
+}
+
+/// Releases the memory taken by the compiled cuts table
+void QnCorrectionsCutsSet::ReleaseCompiledCuts() {
+  if (fCompiledVarId != NULL) delete [] fCompiledVarId;
+  if (fCompiledOpCode != NULL) delete [] fCompiledOpCode;
+  if (fCompiledMin != NULL) delete [] fCompiledMin;
+  if (fCompiledMax != NULL) delete [] fCompiledMax;
+  if (fCompiledMask != NULL) delete [] fCompiledMask;
+  if (fCompiledExpected != NULL) delete [] fCompiledExpected;
+  fCompiledVarId = NULL;
+  fCompiledOpCode = NULL;
+  fCompiledMin = NULL;
+  fCompiledMax = NULL;
+  fCompiledMask = NULL;
+  fCompiledExpected = NULL;
+  fNoOfCompiledCuts = -1;
+  fAllCutsCompiled = kFALSE;
+}
+
+/// Flattens the set of cuts into the compiled cuts table
+///
+/// Each cut is asked for its operation code and parameters. If any
+/// of them is not expressible as an operation code the table is
+/// flagged as incomplete and the set will be evaluated through the
+/// individual cuts.
+///
+/// The set is compiled when the owning detector configuration creates
+/// its support data structures and, if it was modified afterwards,
+/// on first use.
+void QnCorrectionsCutsSet::Compile() {
+  ReleaseCompiledCuts();
+
+  Int_t nCuts = GetEntriesFast();
+  fCompiledVarId = new Int_t[nCuts];
+  fCompiledOpCode = new Int_t[nCuts];
+  fCompiledMin = new Float_t[nCuts];
+  fCompiledMax = new Float_t[nCuts];
+  fCompiledMask = new UInt_t[nCuts];
+  fCompiledExpected = new UInt_t[nCuts];
+
+  fAllCutsCompiled = kTRUE;
+  for (Int_t icut = 0; icut < nCuts; icut++) {
+    fCompiledVarId[icut] = At(icut)->GetVariableId();
+    fCompiledOpCode[icut] = At(icut)->GetCompiledCut(fCompiledMin[icut], fCompiledMax[icut], fCompiledMask[icut], fCompiledExpected[icut]);
+    if (!(fCompiledOpCode[icut] < QnCorrectionsCutsBase::kNOOFCUTOPCODES)) {
+      fAllCutsCompiled = kFALSE;
+    }
+  }
+  fNoOfCompiledCuts = nCuts;
+}
+
+/// Produces the selection bit mask for a block of data vectors
+///
+/// Bit b of word w of the selection mask is set if the data vector
+/// w*nSelectionMaskWordBits+b passes the whole set of cuts. The
+/// variables of each data vector are taken from the variables block
+/// and the ones not present in it are taken from the variable container.
+///
+/// The compiled table is evaluated cut by cut over the whole block. If
+/// the set has cuts not expressible as operation codes each data vector
+/// block of variables is stored in the variable container and the set
+/// evaluated through IsSelected.
+///
+/// In both cases, on return the variable container holds the variables
+/// block of the last data vector.
+/// \param variableContainer pointer to the variable content bank
+/// \param n the number of data vectors
+/// \param nVariables the number of variables per data vector in the variables block
+/// \param variableId array with the external Ids of the variables in the variables block
+/// \param variableValues the variables block, nVariables consecutive values per data vector
+/// \param selectionMask storage for the selection mask, at least (n+nSelectionMaskWordBits-1)/nSelectionMaskWordBits words
+void QnCorrectionsCutsSet::FillSelectionMask(Float_t *variableContainer, Int_t n, Int_t nVariables, const Int_t *variableId,
+    const Float_t *variableValues, ULong64_t *selectionMask) {
+  if (n < 1) return;
+
+  if (fNoOfCompiledCuts != GetEntriesFast())
+    Compile();
+
+  Int_t nWords = (n + nSelectionMaskWordBits - 1) / nSelectionMaskWordBits;
+
+  if (fAllCutsCompiled) {
+    /* initially all data vectors are selected */
+    for (Int_t ixWord = 0; ixWord < nWords; ixWord++) {
+      selectionMask[ixWord] = ~ULong64_t(0);
+    }
+    if ((n % nSelectionMaskWordBits) != 0) {
+      selectionMask[nWords - 1] = (ULong64_t(1) << (n % nSelectionMaskWordBits)) - 1;
+    }
+
+    for (Int_t icut = 0; icut < fNoOfCompiledCuts; icut++) {
+      /* the last column for the cut variable prevails as it would when storing in the variable container */
+      Int_t column = -1;
+      for (Int_t ixVar = 0; ixVar < nVariables; ixVar++) {
+        if (variableId[ixVar] == fCompiledVarId[icut])
+          column = ixVar;
+      }
+      if (column < 0) {
+        /* the variable is common to the whole block */
+        if (CompiledCutResult(icut, variableContainer[fCompiledVarId[icut]]) == 0) {
+          for (Int_t ixWord = 0; ixWord < nWords; ixWord++) {
+            selectionMask[ixWord] = 0;
+          }
+        }
+        continue;
+      }
+      for (Int_t ixWord = 0; ixWord < nWords; ixWord++) {
+        Int_t nInWord = TMath::Min(nSelectionMaskWordBits, n - ixWord * nSelectionMaskWordBits);
+        const Float_t *values = variableValues + ixWord * nSelectionMaskWordBits * nVariables + column;
+        ULong64_t word = 0;
+        for (Int_t ixBit = 0; ixBit < nInWord; ixBit++) {
+          word |= ULong64_t(CompiledCutResult(icut, values[ixBit * nVariables])) << ixBit;
+        }
+        selectionMask[ixWord] &= word;
+      }
+    }
+    /* leave the variable container as the sequential path would do */
+    if (nVariables > 0) {
+      const Float_t *lastVariables = variableValues + (n - 1) * nVariables;
+      for (Int_t ixVar = 0; ixVar < nVariables; ixVar++) {
+        variableContainer[variableId[ixVar]] = lastVariables[ixVar];
+      }
+    }
+  }
+  else {
+    for (Int_t ixWord = 0; ixWord < nWords; ixWord++) {
+      selectionMask[ixWord] = 0;
+    }
+    const Float_t *dataVectorVariables = variableValues;
+    for (Int_t ixData = 0; ixData < n; ixData++) {
+      for (Int_t ixVar = 0; ixVar < nVariables; ixVar++) {
+        variableContainer[variableId[ixVar]] = dataVectorVariables[ixVar];
+      }
+      dataVectorVariables += nVariables;
+      if (IsSelected(variableContainer)) {
+        selectionMask[ixData / nSelectionMaskWordBits] |= ULong64_t(1) << (ixData % nSelectionMaskWordBits);
+      }
+    }
+  }
+}
+
 
 
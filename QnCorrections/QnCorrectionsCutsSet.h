@@ -30,6 +30,20 @@
 /// Provides IsSelected that goes through the whole set of cuts
 /// to check whether the current variables values pass the them.
 ///
+/// When all the cuts in the set are expressible as cut operation
+/// codes the set is compiled into a compact table of variable Ids,
+/// operation codes and parameters which is evaluated without branching
+/// on the cut type. FillSelectionMask evaluates the table for a block
+/// of data vectors producing a bit mask with the selected ones. If any
+/// of the cuts is not expressible as an operation code the set falls
+/// back to the individual cuts IsSelected.
+///
+/// The compiled table is released whenever the set is modified through
+/// its add, remove and clear methods, and it is rebuilt unconditionally
+/// when the owning detector configuration creates its support data
+/// structures. Modifications made through the subscript [] operator
+/// are only taken into account at that point.
+///
 /// The cuts objects are not own by the array so,
 /// they are not destroyed when the the set is destroyed. This allows
 /// to create several sets with the same cuts.
@@ -47,37 +61,107 @@ class QnCorrectionsCutsSet : public TObjArray {
 public:
   /// Normal constructor
   /// \param n number of cuts in the set
-  QnCorrectionsCutsSet(Int_t n = TCollection::kInitCapacity) : TObjArray(n) {}
+  QnCorrectionsCutsSet(Int_t n = TCollection::kInitCapacity) : TObjArray(n),
+    fNoOfCompiledCuts(-1), fAllCutsCompiled(kFALSE), fCompiledVarId(NULL), fCompiledOpCode(NULL),
+    fCompiledMin(NULL), fCompiledMax(NULL), fCompiledMask(NULL), fCompiledExpected(NULL) {}
   /// Copy constructor
+  ///
+  /// The compiled cuts table is not copied. It will be built on first use.
   /// \param ccs the object instance to be copied
-  QnCorrectionsCutsSet(const QnCorrectionsCutsSet &ccs) : TObjArray(ccs) {}
-  /// Default destructor
-  virtual ~QnCorrectionsCutsSet() {}
+  QnCorrectionsCutsSet(const QnCorrectionsCutsSet &ccs) : TObjArray(ccs),
+    fNoOfCompiledCuts(-1), fAllCutsCompiled(kFALSE), fCompiledVarId(NULL), fCompiledOpCode(NULL),
+    fCompiledMin(NULL), fCompiledMax(NULL), fCompiledMask(NULL), fCompiledExpected(NULL) {}
+  virtual ~QnCorrectionsCutsSet();
 
   /// Access the event class variable at the passed position
   /// \param i position in the array (starting at zero)
   /// \return the event class variable object a position i
   virtual QnCorrectionsCutsBase *At(Int_t i) const { return (QnCorrectionsCutsBase *) TObjArray::At(i); }
 
+  virtual void Add(TObject *obj);
+  virtual void AddFirst(TObject *obj);
+  virtual void AddLast(TObject *obj);
+  virtual void AddAt(TObject *obj, Int_t idx);
+  virtual void AddAtAndExpand(TObject *obj, Int_t idx);
+  virtual TObject *RemoveAt(Int_t idx);
+  virtual TObject *Remove(TObject *obj);
+  virtual void Clear(Option_t *option = "");
+  virtual void Delete(Option_t *option = "");
+
+  void Compile();
   Bool_t IsSelected(const Float_t *variableContainer);
+  void FillSelectionMask(Float_t *variableContainer, Int_t n, Int_t nVariables, const Int_t *variableId,
+      const Float_t *variableValues, ULong64_t *selectionMask);
+
+  static const Int_t nSelectionMaskWordBits;     ///< the number of data vectors covered by each selection mask word
+private:
+  Int_t CompiledCutResult(Int_t icut, Float_t value) const;
+  void ReleaseCompiledCuts();
+
+  Int_t fNoOfCompiledCuts;       //!<! the number of cuts in the compiled table, -1 if not compiled
+  Bool_t fAllCutsCompiled;       //!<! all the cuts in the set are expressible as operation codes
+  Int_t *fCompiledVarId;         //!<! the variable Id of each compiled cut
+  Int_t *fCompiledOpCode;        //!<! the operation code of each compiled cut
+  Float_t *fCompiledMin;         //!<! the lower parameter of each compiled cut
+  Float_t *fCompiledMax;         //!<! the upper parameter of each compiled cut
+  UInt_t *fCompiledMask;         //!<! the mask parameter of each compiled cut
+  UInt_t *fCompiledExpected;     //!<! the expected masked value of each compiled cut
 
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsCutsSet, 1);
+  ClassDef(QnCorrectionsCutsSet, 2);
 /// \endcond
 };
 
+/// Evaluates a compiled cut for the passed variable value
+///
+/// All the operation results are computed and the one corresponding
+/// to the cut operation code is selected so no branch on the cut
+/// type is taken.
+/// \param icut the compiled cut index
+/// \param value the value of the variable the cut acts on
+/// \return 1 if the value passes the cut, 0 otherwise
+inline Int_t QnCorrectionsCutsSet::CompiledCutResult(Int_t icut, Float_t value) const {
+  Int_t results[QnCorrectionsCutsBase::kNOOFCUTOPCODES];
+  Int_t above = (fCompiledMin[icut] < value);
+  Int_t below = (value < fCompiledMax[icut]);
+
+  results[QnCorrectionsCutsBase::kCUTABOVE] = above;
+  results[QnCorrectionsCutsBase::kCUTBELOW] = below;
+  results[QnCorrectionsCutsBase::kCUTWITHIN] = above & below;
+  results[QnCorrectionsCutsBase::kCUTOUTSIDE] = (above & below) ^ 1;
+  results[QnCorrectionsCutsBase::kCUTVALUE] = (value == fCompiledMin[icut]);
+  results[QnCorrectionsCutsBase::kCUTSETBIT] = ((UInt_t(Long64_t(value)) & fCompiledMask[icut]) == fCompiledExpected[icut]);
+  return results[fCompiledOpCode[icut]];
+}
+
 /// Checks that the current content of the variableContainer passes
-/// the whole set of cuts by going through all the array components
+/// the whole set of cuts
+///
+/// The set is compiled if it was not yet or cuts were added since
+/// the last compilation. If all the cuts are compiled the compiled
+/// table is evaluated, otherwise the array components are gone through.
 ///
 /// \param variableContainer the current variables content addressed by var Id
 /// \return kTRUE if the actual values pass the set of cuts else kFALSE
 inline Bool_t QnCorrectionsCutsSet::IsSelected(const Float_t *variableContainer) {
-  for (Int_t icut = 0; icut < GetEntriesFast(); icut++) {
-    if (!At(icut)->IsSelected(variableContainer)) {
-      return kFALSE;
+  if (fNoOfCompiledCuts != GetEntriesFast())
+    Compile();
+
+  if (fAllCutsCompiled) {
+    Int_t pass = 1;
+    for (Int_t icut = 0; icut < fNoOfCompiledCuts; icut++) {
+      pass &= CompiledCutResult(icut, variableContainer[fCompiledVarId[icut]]);
+    }
+    return (pass != 0);
+  }
+  else {
+    for (Int_t icut = 0; icut < GetEntriesFast(); icut++) {
+      if (!At(icut)->IsSelected(variableContainer)) {
+        return kFALSE;
+      }
     }
+    return kTRUE;
   }
-  return kTRUE;
 }
 
 #endif // QNCORRECTIONS_CUTSSET_H
@@ -0,0 +1,145 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsDataVectorBank.cxx
+/// \brief Implementation of the data vectors bank class
+
+#include <string.h>
+#include "QnCorrectionsDataVectorBank.h"
+#include "QnCorrectionsDataVectorChannelized.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsDataVectorBank);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsDataVectorBank::QnCorrectionsDataVectorBank() : TObject() {
+  fChannelized = kFALSE;
+  fNoOfEntries = 0;
+  fSize = 0;
+  fPhi = NULL;
+  fWeight = NULL;
+  fEqualizedWeight = NULL;
+  fId = NULL;
+  fDataVectorsArray = NULL;
+}
+
+/// Normal constructor
+/// \param size the initial capacity of the bank
+/// \param channelized kTRUE if the bank will store data vectors from a channelized detector configuration
+QnCorrectionsDataVectorBank::QnCorrectionsDataVectorBank(Int_t size, Bool_t channelized) : TObject() {
+  fChannelized = channelized;
+  fNoOfEntries = 0;
+  fSize = 0;
+  fPhi = NULL;
+  fWeight = NULL;
+  fEqualizedWeight = NULL;
+  fId = NULL;
+  fDataVectorsArray = NULL;
+  Expand((size > 0) ? size : 1);
+}
+
+/// Default destructor
+/// Releases the memory taken
+QnCorrectionsDataVectorBank::~QnCorrectionsDataVectorBank() {
+  if (fPhi != NULL) delete [] fPhi;
+  if (fWeight != NULL) delete [] fWeight;
+  if (fEqualizedWeight != NULL) delete [] fEqualizedWeight;
+  if (fId != NULL) delete [] fId;
+  if (fDataVectorsArray != NULL) delete fDataVectorsArray;
+}
+
+/// Expands the bank capacity
+///
+/// The current content of the bank is kept.
+/// \param size the new capacity of the bank
+void QnCorrectionsDataVectorBank::Expand(Int_t size) {
+  if (!(fSize < size)) return;
+
+  Float_t *phi = new Float_t[size];
+  Float_t *weight = new Float_t[size];
+  Float_t *equalizedWeight = new Float_t[size];
+  Int_t *id = new Int_t[size];
+
+  if (fNoOfEntries > 0) {
+    memcpy(phi, fPhi, fNoOfEntries * sizeof(Float_t));
+    memcpy(weight, fWeight, fNoOfEntries * sizeof(Float_t));
+    memcpy(equalizedWeight, fEqualizedWeight, fNoOfEntries * sizeof(Float_t));
+    memcpy(id, fId, fNoOfEntries * sizeof(Int_t));
+  }
+  if (fPhi != NULL) delete [] fPhi;
+  if (fWeight != NULL) delete [] fWeight;
+  if (fEqualizedWeight != NULL) delete [] fEqualizedWeight;
+  if (fId != NULL) delete [] fId;
+
+  fPhi = phi;
+  fWeight = weight;
+  fEqualizedWeight = equalizedWeight;
+  fId = id;
+  fSize = size;
+}
+
+/// Gets the bank content as an array of data vector objects
+///
+/// Provided for backward compatibility with code that expects
+/// the data vectors as objects within an array of clones.
+/// The array is built on each call and it is a snapshot of the
+/// current bank content. Changes to its data vectors are not
+/// transferred back to the bank.
+/// \return the array of data vectors
+TClonesArray *QnCorrectionsDataVectorBank::GetDataVectorsArray() {
+  if (fDataVectorsArray == NULL) {
+    if (fChannelized)
+      fDataVectorsArray = new TClonesArray("QnCorrectionsDataVectorChannelized", fSize);
+    else
+      fDataVectorsArray = new TClonesArray("QnCorrectionsDataVector", fSize);
+  }
+  fDataVectorsArray->Clear("C");
+  for (Int_t ixData = 0; ixData < fNoOfEntries; ixData++) {
+    if (fChannelized) {
+      QnCorrectionsDataVectorChannelized *dataVector =
+          new (fDataVectorsArray->ConstructedAt(ixData)) QnCorrectionsDataVectorChannelized(fId[ixData], fPhi[ixData], fWeight[ixData]);
+      dataVector->SetEqualizedWeight(fEqualizedWeight[ixData]);
+    }
+    else {
+      new (fDataVectorsArray->ConstructedAt(ixData)) QnCorrectionsDataVector(fId[ixData], fPhi[ixData], fWeight[ixData]);
+    }
+  }
+  return fDataVectorsArray;
+}
+
+/// Clears the bank content to accept a new event
+///
+/// The bank capacity is kept.
+/// \param option not used
+void QnCorrectionsDataVectorBank::Clear(Option_t *) {
+  fNoOfEntries = 0;
+}
@@ -0,0 +1,135 @@
+#ifndef QNCORRECTIONS_DATAVECTORBANK_H
+#define QNCORRECTIONS_DATAVECTORBANK_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsDataVectorBank.h
+/// \brief Class that models the bank of data vectors of a detector configuration within the Q vector correction framework
+///
+
+#include <TObject.h>
+#include <TClonesArray.h>
+
+/// \class QnCorrectionsDataVectorBank
+/// \brief Structure of arrays bank of data vectors
+///
+/// Stores the current event data vectors of a detector configuration
+/// as contiguous arrays of azimuthal angles, weights, equalized
+/// weights and ids, so that Qn vector building and input data
+/// corrections just stream over them.
+///
+/// The equalized weight of a data vector is initialized with its weight
+/// at insertion time. For data vectors coming from non channelized
+/// detector configurations the equalized weight is just never modified.
+///
+/// The bank grows, doubling its capacity, when more data vectors than
+/// the current capacity are stored. The capacity is kept from event to event.
+///
+/// For backward compatibility the bank content could be obtained as an
+/// array of data vector objects. This array is built on request and it is
+/// just a snapshot: changes on its data vectors do not go back to the bank.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Feb 01, 2016
+class QnCorrectionsDataVectorBank : public TObject {
+public:
+  QnCorrectionsDataVectorBank();
+  QnCorrectionsDataVectorBank(Int_t size, Bool_t channelized);
+  virtual ~QnCorrectionsDataVectorBank();
+
+  void AddDataVector(Int_t id, Float_t phi, Float_t weight);
+
+  /// Gets the number of data vectors stored in the bank
+  /// \return the number of data vectors
+  Int_t GetEntriesFast() const { return fNoOfEntries; }
+  /// Gets the azimuthal angle of a data vector
+  /// \param ixData the data vector position in the bank
+  /// \return phi
+  Float_t Phi(Int_t ixData) const { return fPhi[ixData]; }
+  /// Gets the weight of a data vector
+  /// \param ixData the data vector position in the bank
+  /// \return the raw weight
+  Float_t Weight(Int_t ixData) const { return fWeight[ixData]; }
+  /// Gets the equalized weight of a data vector
+  /// \param ixData the data vector position in the bank
+  /// \return the equalized weight
+  Float_t EqualizedWeight(Int_t ixData) const { return fEqualizedWeight[ixData]; }
+  /// Gets the id, usually the channel id, associated with a data vector
+  /// \param ixData the data vector position in the bank
+  /// \return the data vector id
+  Int_t GetId(Int_t ixData) const { return fId[ixData]; }
+  /// Sets the equalized weight of a data vector
+  /// \param ixData the data vector position in the bank
+  /// \param weight equalized weight after channel equalization
+  void SetEqualizedWeight(Int_t ixData, Float_t weight) { fEqualizedWeight[ixData] = weight; }
+
+  /// Gets the azimuthal angles array
+  /// \return the array with GetEntriesFast() azimuthal angles
+  const Float_t *GetPhiArray() const { return fPhi; }
+  /// Gets the weights array
+  /// \return the array with GetEntriesFast() weights
+  const Float_t *GetWeightArray() const { return fWeight; }
+  /// Gets the equalized weights array
+  /// \return the array with GetEntriesFast() equalized weights
+  Float_t *GetEqualizedWeightArray() { return fEqualizedWeight; }
+  /// Gets the ids array
+  /// \return the array with GetEntriesFast() data vector ids
+  const Int_t *GetIdArray() const { return fId; }
+
+  TClonesArray *GetDataVectorsArray();
+
+  virtual void Clear(Option_t *option="");
+
+private:
+  void Expand(Int_t size);
+
+  Bool_t fChannelized;            ///< kTRUE if the bank stores data vectors from a channelized configuration
+  Int_t fNoOfEntries;             ///< the number of data vectors currently stored
+  Int_t fSize;                    ///< the current capacity of the bank
+  Float_t *fPhi;                  //!<! the azimuthal angles of the data vectors
+  Float_t *fWeight;               //!<! the raw weights of the data vectors
+  Float_t *fEqualizedWeight;      //!<! the equalized weights of the data vectors
+  Int_t *fId;                     //!<! the ids associated to the data vectors
+  TClonesArray *fDataVectorsArray; //!<! data vector objects snapshot of the bank content
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsDataVectorBank(const QnCorrectionsDataVectorBank &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsDataVectorBank& operator= (const QnCorrectionsDataVectorBank &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsDataVectorBank, 1);
+/// \endcond
+};
+
+/// Stores a new data vector in the bank
+///
+/// The equalized weight is initialized with the data vector weight.
+/// \param id the id associated to the data vector
+/// \param phi the azimuthal angle
+/// \param weight the data vector weight
+inline void QnCorrectionsDataVectorBank::AddDataVector(Int_t id, Float_t phi, Float_t weight) {
+  if (!(fNoOfEntries < fSize)) {
+    Expand(2 * fSize);
+  }
+  fPhi[fNoOfEntries] = phi;
+  fWeight[fNoOfEntries] = weight;
+  fEqualizedWeight[fNoOfEntries] = weight;
+  fId[fNoOfEntries] = id;
+  fNoOfEntries++;
+}
+
+#endif /* QNCORRECTIONS_DATAVECTORBANK_H */
@@ -39,6 +39,8 @@
 ClassImp(QnCorrectionsDetector);
 /// \endcond
 
+const Int_t QnCorrectionsDetector::nMaxNoOfConfigurations = 64;
+
 
 /// Default constructor
 QnCorrectionsDetector::QnCorrectionsDetector() : TNamed(),
@@ -46,6 +48,7 @@ QnCorrectionsDetector::QnCorrectionsDetector() : TNamed(),
     fDataVectorAcceptedConfigurations() {
 
   fDetectorId = -1;
+  fDataVectorAcceptedConfigurationsMask = 0;
   fDataVectorAcceptedConfigurations.SetOwner(kFALSE);
   fCorrectionsManager = NULL;
 }
@@ -59,6 +62,7 @@ QnCorrectionsDetector::QnCorrectionsDetector(const char *name, Int_t id) :
     fDataVectorAcceptedConfigurations() {
 
   fDetectorId = id;
+  fDataVectorAcceptedConfigurationsMask = 0;
   fDataVectorAcceptedConfigurations.SetOwner(kFALSE);
   fCorrectionsManager = NULL;
 }
@@ -132,6 +136,16 @@ Bool_t QnCorrectionsDetector::AttachCorrectionInputs(TList *list) {
   return retValue;
 }
 
+/// Asks for preparing in advance the input information of the correction steps
+///
+/// The request is transmitted to the attached detector configurations
+/// \param list list where the input information should be found
+void QnCorrectionsDetector::PrepareCorrectionInputs(TList *list) {
+  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast(); ixConfiguration++) {
+    fConfigurations.At(ixConfiguration)->PrepareCorrectionInputs(list);
+  }
+}
+
 /// Perform after calibration histograms attach actions
 /// It is used to inform the different correction step that
 /// all conditions for running the network are in place so
@@ -177,6 +191,15 @@ void QnCorrectionsDetector::AddDetectorConfiguration(QnCorrectionsDetectorConfig
         GetId()));
     return;
   }
+
+  if (fConfigurations.GetEntriesFast() == nMaxNoOfConfigurations) {
+    QnCorrectionsInfo(Form("Detector Id %d goes beyond %d detector configurations with %s. " \
+        "The acceptance mask only covers the first %d ones, the accepting configurations are kept in a set as well.",
+        GetId(),
+        nMaxNoOfConfigurations,
+        detectorConfiguration->GetName(),
+        nMaxNoOfConfigurations));
+  }
   detectorConfiguration->SetDetectorOwner(this);
   detectorConfiguration->AttachCorrectionsManager(fCorrectionsManager);
   fConfigurations.Add(detectorConfiguration);
@@ -201,6 +224,17 @@ void QnCorrectionsDetector::IncludeQnVectors(TList *list) {
   }
 }
 
+/// Attaches the detector to an instrumentation table
+///
+/// The request is transmitted to the attached detector configurations
+/// \param instrumentation the instrumentation table, NULL for detaching the detector
+void QnCorrectionsDetector::AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation) {
+
+  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast(); ixConfiguration++) {
+    fConfigurations.At(ixConfiguration)->AttachInstrumentation(instrumentation);
+  }
+}
+
 /// Include the name of each detector configuration into the passed list
 ///
 /// \param list the list where to incorporate detector configurations name
@@ -210,6 +244,16 @@ void QnCorrectionsDetector::FillDetectorConfigurationNameList(TList *list) const
   }
 }
 
+/// Include each detector configuration into the passed list
+///
+/// The list should not own the detector configurations.
+/// \param list the list where to incorporate the detector configurations
+void QnCorrectionsDetector::FillDetectorConfigurationList(TList *list) const {
+  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast(); ixConfiguration++) {
+    list->Add(fConfigurations.At(ixConfiguration));
+  }
+}
+
 /// Include the name of the input correction steps on each detector
 /// configuration into the passed list
 ///
@@ -245,4 +289,12 @@ void QnCorrectionsDetector::ReportOnCorrections(TList *steps, TList *calib, TLis
   }
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+///
+/// The request is transmitted to the attached detector configurations
+void QnCorrectionsDetector::FlushHistograms() {
+  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast(); ixConfiguration++) {
+    fConfigurations.At(ixConfiguration)->FlushHistograms();
+  }
+}
 
@@ -37,6 +37,14 @@ class QnCorrectionsManager;
 /// as such it should distribute the different commands to the
 /// defined detector configurations.
 ///
+/// The detector configurations that accepted the last data vector
+/// are kept as a bit mask, bit i for the configuration at position i, and
+/// the configuration names are only looked up when asked for. The mask
+/// covers the first 64 configurations. Detectors with more configurations
+/// keep, in addition, the set of configurations that accepted the last
+/// data vector, as it was done before the mask, so that all of them are
+/// reported by GetAcceptedDataDetectorConfigurationName(index).
+///
 /// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
 /// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
 /// \author Víctor González <victor.gonzalez@cern.ch>, UCM
@@ -58,33 +66,50 @@ public:
   Bool_t CreateQAHistograms(TList *list);
   Bool_t CreateNveQAHistograms(TList *list);
   Bool_t AttachCorrectionInputs(TList *list);
+  void PrepareCorrectionInputs(TList *list);
   virtual void AfterInputsAttachActions();
   Bool_t ProcessCorrections(const Float_t *variableContainer);
   Bool_t ProcessDataCollection(const Float_t *variableContainer);
   void IncludeQnVectors(TList *list);
+  void AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation);
 
   /// Gets the name of the detector configuration at index that accepted last data vector
   /// \param index the position in the list of accepted data vector configuration
   /// \return the configuration name
   const char *GetAcceptedDataDetectorConfigurationName(Int_t index) const
-  { return fDataVectorAcceptedConfigurations.At(index)->GetName(); }
+  { return (fConfigurations.GetEntriesFast() > nMaxNoOfConfigurations)
+      ? ((index < fDataVectorAcceptedConfigurations.GetEntriesFast()) ? fDataVectorAcceptedConfigurations.At(index)->GetName() : NULL)
+      : GetAcceptedDataDetectorConfigurationName(fDataVectorAcceptedConfigurationsMask, index); }
+  const char *GetAcceptedDataDetectorConfigurationName(ULong64_t acceptanceMask, Int_t index) const;
+  /// Gets the mask of the detector configurations that accepted last data vector
+  /// \return the acceptance mask, bit i set if the configuration at position i, below 64, accepted the data vector
+  ULong64_t GetAcceptedDataDetectorConfigurationsMask() const
+  { return fDataVectorAcceptedConfigurationsMask; }
 
   void AttachCorrectionsManager(QnCorrectionsManager *manager);
   void AddDetectorConfiguration(QnCorrectionsDetectorConfigurationBase *detectorConfiguration);
   QnCorrectionsDetectorConfigurationBase *FindDetectorConfiguration(const char *name);
   void FillDetectorConfigurationNameList(TList *list) const;
+  void FillDetectorConfigurationList(TList *list) const;
   void FillOverallInputCorrectionStepList(TList *list) const;
   void FillOverallQnVectorCorrectionStepList(TList *list) const;
   virtual void ReportOnCorrections(TList *steps, TList *calib, TList *apply) const;
+  void FlushHistograms();
 
   Int_t AddDataVector(const Float_t *variableContainer, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1);
+  ULong64_t AddDataVectorAcceptance(const Float_t *variableContainer, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1);
+  Int_t AddDataVectors(Float_t *variableContainer, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      Int_t nVariables = 0, const Int_t *variableId = NULL, const Float_t *variableValues = NULL);
 
   virtual void ClearDetector();
 
+  static const Int_t nMaxNoOfConfigurations;   ///< the number of configurations per detector covered by the acceptance mask
+
 private:
   Int_t fDetectorId;            ///< detector Id
   QnCorrectionsDetectorConfigurationsSet fConfigurations;  ///< the set of configurations defined for this detector
-  QnCorrectionsDetectorConfigurationsSet fDataVectorAcceptedConfigurations; ///< the set of configurations that accepted a data vector
+  ULong64_t fDataVectorAcceptedConfigurationsMask; //!<! the mask of the configurations that accepted the last data vector
+  QnCorrectionsDetectorConfigurationsSet fDataVectorAcceptedConfigurations; //!<! the set of configurations that accepted the last data vector, only beyond the mask capacity
   QnCorrectionsManager *fCorrectionsManager; ///< the framework correction manager
 
 private:
@@ -96,7 +121,7 @@ private:
   QnCorrectionsDetector& operator= (const QnCorrectionsDetector &);
 
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsDetector, 2);
+  ClassDef(QnCorrectionsDetector, 4);
 /// \endcond
 };
 
@@ -110,14 +135,89 @@ private:
 /// \param channelId the channel Id that originates the data vector
 /// \return the number of detector configurations that accepted and stored the data vector
 inline Int_t QnCorrectionsDetector::AddDataVector(const Float_t *variableContainer, Double_t phi, Double_t weight, Int_t channelId) {
-  fDataVectorAcceptedConfigurations.Clear();
-  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast(); ixConfiguration++) {
+  Int_t nAccepted = 0;
+  Int_t nConfigurations = fConfigurations.GetEntriesFast();
+  fDataVectorAcceptedConfigurationsMask = 0;
+  if (nConfigurations > nMaxNoOfConfigurations) {
+    /* beyond the mask capacity the accepting configurations are kept in the set as well */
+    fDataVectorAcceptedConfigurations.Clear();
+    for (Int_t ixConfiguration = 0; ixConfiguration < nConfigurations; ixConfiguration++) {
+      Bool_t ret = fConfigurations.At(ixConfiguration)->AddDataVector(variableContainer, phi, weight, channelId);
+      if (ret) {
+        if (ixConfiguration < nMaxNoOfConfigurations)
+          fDataVectorAcceptedConfigurationsMask |= ULong64_t(1) << ixConfiguration;
+        fDataVectorAcceptedConfigurations.Add(fConfigurations.At(ixConfiguration));
+        nAccepted++;
+      }
+    }
+    return nAccepted;
+  }
+  for (Int_t ixConfiguration = 0; ixConfiguration < nConfigurations; ixConfiguration++) {
     Bool_t ret = fConfigurations.At(ixConfiguration)->AddDataVector(variableContainer, phi, weight, channelId);
     if (ret) {
-      fDataVectorAcceptedConfigurations.Add(fConfigurations.At(ixConfiguration));
+      fDataVectorAcceptedConfigurationsMask |= ULong64_t(1) << ixConfiguration;
+      nAccepted++;
+    }
+  }
+  return nAccepted;
+}
+
+/// New data vector for the detector
+/// As AddDataVector but returning which detector configurations accepted
+/// and stored the data vector instead of how many of them did it.
+/// \param variableContainer pointer to the variable content bank
+/// \param phi azimuthal angle
+/// \param weight the weight of the data vector
+/// \param channelId the channel Id that originates the data vector
+/// Only the first 64 configurations are covered by the mask.
+/// \return the acceptance mask, bit i set if the configuration at position i accepted the data vector
+inline ULong64_t QnCorrectionsDetector::AddDataVectorAcceptance(const Float_t *variableContainer, Double_t phi, Double_t weight, Int_t channelId) {
+  AddDataVector(variableContainer, phi, weight, channelId);
+  return fDataVectorAcceptedConfigurationsMask;
+}
+
+/// Gets the name of the detector configuration at index within an acceptance mask
+/// \param acceptanceMask the acceptance mask as returned by AddDataVectorAcceptance
+/// \param index the position within the configurations set in the acceptance mask
+/// \return the configuration name, NULL if the mask has not so many configurations
+inline const char *QnCorrectionsDetector::GetAcceptedDataDetectorConfigurationName(ULong64_t acceptanceMask, Int_t index) const {
+  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast() && ixConfiguration < nMaxNoOfConfigurations; ixConfiguration++) {
+    if ((acceptanceMask >> ixConfiguration) & 0x1) {
+      if (index == 0)
+        return fConfigurations.At(ixConfiguration)->GetName();
+      index--;
     }
   }
-  return fDataVectorAcceptedConfigurations.GetEntries();
+  return NULL;
+}
+
+/// New set of data vectors for the detector
+/// The whole set is transmitted in one go to each of the attached
+/// detector configurations. As it happens for single data vectors, the
+/// detector configurations check the variable bank content, updated
+/// with the optional per data vector variables block, against their cuts.
+///
+/// The mask, and the set, of configurations that accepted the last data
+/// vector are not maintained for batched data vectors and they are left empty.
+/// \param variableContainer pointer to the variable content bank
+/// \param phi array of azimuthal angles
+/// \param weight array of data vector weights. NULL for unit weights
+/// \param channelId array of channel Ids that originates the data vectors
+/// \param n the number of data vectors in the arrays
+/// \param nVariables the number of variables per data vector in the variables block
+/// \param variableId array with the external Ids of the variables in the variables block
+/// \param variableValues the variables block, nVariables consecutive values per data vector
+/// \return the number of data vectors stored summed over the detector configurations
+inline Int_t QnCorrectionsDetector::AddDataVectors(Float_t *variableContainer, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+    Int_t nVariables, const Int_t *variableId, const Float_t *variableValues) {
+  Int_t nStored = 0;
+  fDataVectorAcceptedConfigurationsMask = 0;
+  if (fConfigurations.GetEntriesFast() > nMaxNoOfConfigurations)
+    fDataVectorAcceptedConfigurations.Clear();
+  for (Int_t ixConfiguration = 0; ixConfiguration < fConfigurations.GetEntriesFast(); ixConfiguration++) {
+    nStored += fConfigurations.At(ixConfiguration)->AddDataVectors(variableContainer, phi, weight, channelId, n, nVariables, variableId, variableValues);
+  }
+  return nStored;
 }
 
 /// Ask for processing corrections for the involved detector
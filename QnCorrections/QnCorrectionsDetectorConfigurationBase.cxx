@@ -33,6 +33,7 @@
 /// \brief Implementation of the base detector configuration class within Q vector correction framework
 
 #include "QnCorrectionsDetectorConfigurationBase.h"
+#include "QnCorrectionsManager.h"
 #include "QnCorrectionsLog.h"
 
 /// \cond CLASSIMP
@@ -53,6 +54,8 @@ QnCorrectionsDetectorConfigurationBase::QnCorrectionsDetectorConfigurationBase()
   fCuts = NULL;
   fDataVectorBank = NULL;
   fQnNormalizationMethod = QnCorrectionsQnVector::QVNORM_noCalibration;
+  fCorrectionsCounters = NULL;
+  fDataCollectionCounters = NULL;
   fEventClassVariables = NULL;
   fPlainQ2nVector.SetHarmonicMultiplier(2);
   fCorrectedQ2nVector.SetHarmonicMultiplier(2);
@@ -82,6 +85,8 @@ QnCorrectionsDetectorConfigurationBase::QnCorrectionsDetectorConfigurationBase(c
   fCuts = NULL;
   fDataVectorBank = NULL;
   fQnNormalizationMethod = QnCorrectionsQnVector::QVNORM_noCalibration;
+  fCorrectionsCounters = NULL;
+  fDataCollectionCounters = NULL;
   fEventClassVariables = eventClassesVariables;
   fPlainQ2nVector.SetHarmonicMultiplier(2);
   fCorrectedQ2nVector.SetHarmonicMultiplier(2);
@@ -119,6 +124,29 @@ void QnCorrectionsDetectorConfigurationBase::AddCorrectionOnInputData(QnCorrecti
       "QnCorrectionsDetectorConfigurationBase::AddCorrectionOnInputData()"));
 }
 
+/// Attaches the detector configuration to an instrumentation table
+///
+/// An entry per event processing phase for the whole detector configuration
+/// is added to the table and the request is transmitted to the Qn vector
+/// correction steps.
+/// \param instrumentation the instrumentation table, NULL for detaching the detector configuration
+void QnCorrectionsDetectorConfigurationBase::AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation) {
+
+  if (instrumentation != NULL) {
+    fCorrectionsCounters = instrumentation->AddEntry(GetName(),
+        QnCorrectionsInstrumentation::szConfigurationStepName, QnCorrectionsInstrumentation::kCorrections);
+    fDataCollectionCounters = instrumentation->AddEntry(GetName(),
+        QnCorrectionsInstrumentation::szConfigurationStepName, QnCorrectionsInstrumentation::kDataCollection);
+  }
+  else {
+    fCorrectionsCounters = NULL;
+    fDataCollectionCounters = NULL;
+  }
+  for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+    fQnVectorCorrections.At(ixCorrection)->AttachInstrumentation(instrumentation);
+  }
+}
+
 /// Get the corrected Qn vector from the step previous to the one given
 /// If not previous step the plain Qn vector is returned.
 /// The user is not able to modify it.
@@ -131,6 +159,17 @@ const QnCorrectionsQnVector *QnCorrectionsDetectorConfigurationBase::GetPrevious
     return &fPlainQnVector;
 }
 
+/// Get the current event bin coordinates of the event class variables set
+///
+/// They are kept by the framework manager and shared among all the
+/// histograms built on the same event class variables set.
+/// \return the event class bin coordinates, NULL if not attached to the framework manager
+const QnCorrectionsEventClassBins *QnCorrectionsDetectorConfigurationBase::GetEventClassBins() const {
+  if (fCorrectionsManager != NULL)
+    return fCorrectionsManager->GetEventClassBins(*fEventClassVariables);
+  return NULL;
+}
+
 /// Check if a concrete correction step is bein applied on this detector configuration
 /// It is not enough having the correction step configured or collecting data. To
 /// get an affirmative answer the correction step must be being applied.
@@ -142,6 +181,16 @@ Bool_t QnCorrectionsDetectorConfigurationBase::IsCorrectionStepBeingApplied(cons
   return fQnVectorCorrections.IsCorrectionStepBeingApplied(step);
 }
 
+/// Include the detector configurations whose Qn vectors are read by this one into the passed list
+///
+/// Transfers the request to the set of Qn vector corrections.
+/// \param list list where the referenced detector configurations should be added
+void QnCorrectionsDetectorConfigurationBase::FillReferencedConfigurations(TList *list) const {
+  for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+    fQnVectorCorrections.At(ixCorrection)->FillReferencedConfigurations(list);
+  }
+}
+
 
 /// Activate the processing for the passed harmonic
 /// \param harmonic the desired harmonic number to activate
@@ -24,8 +24,10 @@
 #include "QnCorrectionsCorrectionsSetOnInputData.h"
 #include "QnCorrectionsCorrectionsSetOnQvector.h"
 #include "QnCorrectionsEventClassVariablesSet.h"
+#include "QnCorrectionsEventClassBins.h"
 #include "QnCorrectionsQnVector.h"
 #include "QnCorrectionsQnVectorBuild.h"
+#include "QnCorrectionsDataVectorBank.h"
 
 class QnCorrectionsDetectorConfigurationsSet;
 class QnCorrectionsDetector;
@@ -97,13 +99,22 @@ public:
   /// Get the input data bank.
   /// Makes it available for input corrections steps.
   /// \return pointer to the input data bank
-  TClonesArray *GetInputDataBank()
+  QnCorrectionsDataVectorBank *GetDataVectorBank()
   { return fDataVectorBank; }
+  /// Get the input data bank content as an array of data vectors
+  ///
+  /// Kept for backward compatibility. The array is a snapshot of the
+  /// input data bank content built on each call, changes on it are not
+  /// transferred to the input data bank. Use GetDataVectorBank() instead.
+  /// \return pointer to the array of input data vectors
+  TClonesArray *GetInputDataBank()
+  { return fDataVectorBank->GetDataVectorsArray(); }
   /// Get the event class variables set
   /// Makes it available for corrections steps
   /// \return pointer to the event class variables set
   QnCorrectionsEventClassVariablesSet &GetEventClassVariablesSet()
   { return *fEventClassVariables; }
+  const QnCorrectionsEventClassBins *GetEventClassBins() const;
   /// Get the current Qn vector
   /// Makes it available for subsequent correction steps.
   /// It could have already supported previous correction steps
@@ -112,6 +123,7 @@ public:
   { return &fCorrectedQnVector; }
   const QnCorrectionsQnVector *GetPreviousCorrectedQnVector(QnCorrectionsCorrectionOnQvector *correctionOnQn) const;
   Bool_t IsCorrectionStepBeingApplied(const char *step) const;
+  void FillReferencedConfigurations(TList *list) const;
   /// Get the current Q2n vector
   /// Makes it available for subsequent correction steps.
   /// It could have already supported previous correction steps
@@ -195,6 +207,14 @@ public:
   /// \param list list where the input information should be found
   /// \return kTRUE if everything went OK
   virtual Bool_t AttachCorrectionInputs(TList *list) = 0;
+  /// Asks for preparing in advance the input information of the correction steps
+  ///
+  /// The request is transmitted to the different corrections. Intended
+  /// to be called from a thread other than the one processing events.
+  /// The inputs prepared are released once attached by AttachCorrectionInputs.
+  /// Pure virtual function
+  /// \param list list where the input information should be found
+  virtual void PrepareCorrectionInputs(TList *list) = 0;
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -246,6 +266,11 @@ public:
   /// \param calib list for incorporating the list of steps in calibrating status
   /// \param apply list for incorporating the list of steps in applying status
   virtual void ReportOnCorrections(TList *steps, TList *calib, TList *apply) const = 0;
+  virtual void AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation);
+  /// Transfers the accumulated content of the filled histograms to them
+  ///
+  /// Pure virtual function
+  virtual void FlushHistograms() = 0;
 
   /// New data vector for the detector configuration
   /// Pure virtual function
@@ -255,6 +280,24 @@ public:
   /// \param channelId the channel Id that originates the data vector
   /// \return kTRUE if the data vector was accepted and stored
   virtual Bool_t AddDataVector(const Float_t *variableContainer, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1) = 0;
+  /// New set of data vectors for the detector configuration
+  ///
+  /// Batched version of AddDataVector. If a per data vector variables
+  /// block is passed, the values of the variables for each data vector are
+  /// stored in the variable content bank before checking it against
+  /// the configuration cuts.
+  /// Pure virtual function
+  /// \param variableContainer pointer to the variable content bank
+  /// \param phi array of azimuthal angles
+  /// \param weight array of data vector weights. NULL for unit weights
+  /// \param channelId array of channel Ids that originates the data vectors
+  /// \param n the number of data vectors in the arrays
+  /// \param nVariables the number of variables per data vector in the variables block
+  /// \param variableId array with the external Ids of the variables in the variables block
+  /// \param variableValues the variables block, nVariables consecutive values per data vector
+  /// \return the number of data vectors accepted and stored
+  virtual Int_t AddDataVectors(Float_t *variableContainer, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      Int_t nVariables = 0, const Int_t *variableId = NULL, const Float_t *variableValues = NULL) = 0;
 
   virtual Bool_t IsSelected(const Float_t *variableContainer);
   virtual Bool_t IsSelected(const Float_t *variableContainer, Int_t nChannel);
@@ -272,7 +315,7 @@ protected:
   QnCorrectionsCutsSet *fCuts;         //->
 /// The default initial size of data vectors banks
 #define INITIALDATAVECTORBANKSIZE 100000
-  TClonesArray *fDataVectorBank;        //!<! input data for the current process / event
+  QnCorrectionsDataVectorBank *fDataVectorBank; //!<! input data for the current process / event
   QnCorrectionsQnVector fPlainQnVector;     ///< Qn vector from the post processed input data
   QnCorrectionsQnVector fPlainQ2nVector;     ///< Q2n vector from the post processed input data
   QnCorrectionsQnVector fCorrectedQnVector; ///< Qn vector after subsequent correction steps
@@ -281,6 +324,8 @@ protected:
   QnCorrectionsQnVectorBuild fTempQ2nVector; ///< temporary Qn vector for efficient Q vector building
   QnCorrectionsQnVector::QnVectorNormalizationMethod fQnNormalizationMethod; ///< the method for Q vector normalization
   QnCorrectionsCorrectionsSetOnQvector fQnVectorCorrections; ///< set of corrections to apply on Q vectors
+  ULong64_t *fCorrectionsCounters;     //!<! the instrumentation counters of the corrections phase, NULL if not instrumented
+  ULong64_t *fDataCollectionCounters;  //!<! the instrumentation counters of the data collection phase, NULL if not instrumented
   /// set of variables that define event classes
   QnCorrectionsEventClassVariablesSet    *fEventClassVariables; //->
 
@@ -293,7 +338,7 @@ private:
   QnCorrectionsDetectorConfigurationBase& operator= (const QnCorrectionsDetectorConfigurationBase &);
 
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsDetectorConfigurationBase, 3);
+  ClassDef(QnCorrectionsDetectorConfigurationBase, 4);
 /// \endcond
 };
 
@@ -41,18 +41,25 @@ ClassImp(QnCorrectionsDetectorConfigurationChannels);
 /// \endcond
 
 const char *QnCorrectionsDetectorConfigurationChannels::szRawQnVectorName = "raw";
+const Float_t QnCorrectionsDetectorConfigurationChannels::fMinimumSignificantValue = 1e-6;
 const char *QnCorrectionsDetectorConfigurationChannels::szQAMultiplicityHistoName = "Multiplicity";
 const char *QnCorrectionsDetectorConfigurationChannels::szQAQnAverageHistogramName = "Plain Qn avg ";
 
 /// Default constructor
 QnCorrectionsDetectorConfigurationChannels::QnCorrectionsDetectorConfigurationChannels() :
-    QnCorrectionsDetectorConfigurationBase(), fRawQnVector(), fInputDataCorrections() {
+    QnCorrectionsDetectorConfigurationBase(), fRawQnVector(), fTempRawQnVector(), fInputDataCorrections() {
 
   fNoOfChannels = 0;
   fUsedChannel = NULL;
   fChannelMap = NULL;
   fChannelGroup = NULL;
   fHardCodedGroupWeights = NULL;
+  fChannelAzimuth = NULL;
+  fChannelsTablesHighestHarmonic = -1;
+  fChannelsCosTable = NULL;
+  fChannelsSinTable = NULL;
+  fChannelsWeight = NULL;
+  fChannelsEqualizedWeight = NULL;
   /* QA section */
   fQACentralityVarId = -1;
   fQAnBinsMultiplicity = 100;
@@ -77,12 +84,19 @@ QnCorrectionsDetectorConfigurationChannels::QnCorrectionsDetectorConfigurationCh
       Int_t *harmonicMap) :
           QnCorrectionsDetectorConfigurationBase(name, eventClassesVariables, nNoOfHarmonics, harmonicMap),
           fRawQnVector(szRawQnVectorName, nNoOfHarmonics, harmonicMap),
+          fTempRawQnVector("tempraw", nNoOfHarmonics, harmonicMap),
           fInputDataCorrections() {
   fNoOfChannels = nNoOfChannels;
   fUsedChannel = NULL;
   fChannelMap = NULL;
   fChannelGroup = NULL;
   fHardCodedGroupWeights = NULL;
+  fChannelAzimuth = NULL;
+  fChannelsTablesHighestHarmonic = -1;
+  fChannelsCosTable = NULL;
+  fChannelsSinTable = NULL;
+  fChannelsWeight = NULL;
+  fChannelsEqualizedWeight = NULL;
   /* QA section */
   fQACentralityVarId = -1;
   fQAnBinsMultiplicity = 100;
@@ -101,6 +115,11 @@ QnCorrectionsDetectorConfigurationChannels::~QnCorrectionsDetectorConfigurationC
   if (fChannelMap != NULL) delete [] fChannelMap;
   if (fChannelGroup != NULL) delete [] fChannelGroup;
   if (fHardCodedGroupWeights != NULL) delete [] fHardCodedGroupWeights;
+  if (fChannelAzimuth != NULL) delete [] fChannelAzimuth;
+  if (fChannelsCosTable != NULL) delete [] fChannelsCosTable;
+  if (fChannelsSinTable != NULL) delete [] fChannelsSinTable;
+  if (fChannelsWeight != NULL) delete [] fChannelsWeight;
+  if (fChannelsEqualizedWeight != NULL) delete [] fChannelsEqualizedWeight;
   if (fQAQnAverageHistogram != NULL) delete fQAQnAverageHistogram;
 }
 
@@ -163,6 +182,24 @@ void QnCorrectionsDetectorConfigurationChannels::SetChannelsScheme(
   }
 }
 
+/// Registers the azimuthal angle of each of the detector channels
+///
+/// For channelized detectors the azimuthal angle of each channel is
+/// fixed by the detector geometry. Once registered, the harmonics of the
+/// channels azimuthal angles are precomputed when the support data
+/// structures are created and the Qn vectors are then built as a weighted
+/// sum over the channels with the registered azimuthal angles replacing
+/// the ones of the data vectors.
+/// \param phi array with the azimuthal angle of each channel
+void QnCorrectionsDetectorConfigurationChannels::SetChannelsAzimuth(const Float_t *phi) {
+  if (fChannelAzimuth == NULL)
+    fChannelAzimuth = new Float_t[fNoOfChannels];
+
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    fChannelAzimuth[ixChannel] = phi[ixChannel];
+  }
+}
+
 /// Stores the framework manager pointer
 /// Orders the base class to store the correction manager and informs the input data corrections
 /// and the Qn vector corrections they are now attached to the framework
@@ -184,12 +221,36 @@ void QnCorrectionsDetectorConfigurationChannels::AttachCorrectionsManager(QnCorr
 
 /// Asks for support data structures creation
 ///
-/// The input data vector bank is allocated and the request is
-/// transmitted to the input data corrections and then to the Q vector corrections.
+/// The input data vector bank is allocated, the cuts compiled and, if the channels azimuthal
+/// angles were registered, the channels harmonics tables are built. The
+/// tables are organized by harmonic, i.e. the value for harmonic k and channel c
+/// is at position \f$ k \times fNoOfChannels + c \f$.
+/// Then the request is transmitted to the input data corrections and then
+/// to the Q vector corrections.
 void QnCorrectionsDetectorConfigurationChannels::CreateSupportDataStructures() {
 
   /* this is executed in the remote node so, allocate the data bank */
-  fDataVectorBank = new TClonesArray("QnCorrectionsDataVectorChannelized", INITIALDATAVECTORBANKSIZE);
+  fDataVectorBank = new QnCorrectionsDataVectorBank(INITIALDATAVECTORBANKSIZE, kTRUE);
+
+  /* the cuts table reflects the cuts as they are now */
+  if (fCuts != NULL) fCuts->Compile();
+
+  /* and the channels tables if the channels azimuth is known */
+  if (fChannelAzimuth != NULL) {
+    Int_t nHighestHarmonic = TMath::Max(fTempQnVector.GetHighestHarmonicMultiple(), fTempQ2nVector.GetHighestHarmonicMultiple());
+    nHighestHarmonic = TMath::Max(nHighestHarmonic, fTempRawQnVector.GetHighestHarmonicMultiple());
+    fChannelsTablesHighestHarmonic = nHighestHarmonic;
+    fChannelsCosTable = new Float_t[(nHighestHarmonic + 1) * fNoOfChannels];
+    fChannelsSinTable = new Float_t[(nHighestHarmonic + 1) * fNoOfChannels];
+    fChannelsWeight = new Float_t[fNoOfChannels];
+    fChannelsEqualizedWeight = new Float_t[fNoOfChannels];
+    for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+      for (Int_t h = 0; h < nHighestHarmonic + 1; h++) {
+        fChannelsCosTable[h * fNoOfChannels + ixChannel] = TMath::Cos(h * fChannelAzimuth[ixChannel]);
+        fChannelsSinTable[h * fNoOfChannels + ixChannel] = TMath::Sin(h * fChannelAzimuth[ixChannel]);
+      }
+    }
+  }
 
   for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
     fInputDataCorrections.At(ixCorrection)->CreateSupportDataStructures();
@@ -337,6 +398,7 @@ Bool_t QnCorrectionsDetectorConfigurationChannels::CreateQAHistograms(TList *lis
       Form("%s %s", szQAQnAverageHistogramName, this->GetName()),
       Form("%s %s", szQAQnAverageHistogramName, this->GetName()),
       this->GetEventClassVariablesSet());
+  fQAQnAverageHistogram->SetEventClassBins(GetEventClassBins());
 
   /* get information about the configured harmonics to pass it for histogram creation */
   Int_t nNoOfHarmonics = this->GetNoOfHarmonics();
@@ -397,13 +459,15 @@ Bool_t QnCorrectionsDetectorConfigurationChannels::CreateNveQAHistograms(TList *
 ///
 /// The detector list is extracted from the passed list and then
 /// the request is transmitted to the input data corrections
-/// and then propagated to the Q vector corrections
+/// and then propagated to the Q vector corrections. Afterwards the
+/// inputs the corrections could have prepared in advance are released.
 /// \param list list where the input information should be found
 /// \return kTRUE if everything went OK
 Bool_t QnCorrectionsDetectorConfigurationChannels::AttachCorrectionInputs(TList *list) {
   TList *detectorConfigurationList = (TList *) list->FindObject(this->GetName());
+  Bool_t retValue = kFALSE;
   if (detectorConfigurationList != NULL) {
-    Bool_t retValue = kTRUE;
+    retValue = kTRUE;
     for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
       retValue = retValue && (fInputDataCorrections.At(ixCorrection)->AttachInput(detectorConfigurationList));
     }
@@ -412,9 +476,36 @@ Bool_t QnCorrectionsDetectorConfigurationChannels::AttachCorrectionInputs(TList
     for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
       retValue = retValue && (fQnVectorCorrections.At(ixCorrection)->AttachInput(detectorConfigurationList));
     }
-    return retValue;
   }
-  return kFALSE;
+
+  /* the attached corrections hold their own inputs already */
+  for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
+    fInputDataCorrections.At(ixCorrection)->ReleasePreparedInput();
+  }
+  for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+    fQnVectorCorrections.At(ixCorrection)->ReleasePreparedInput();
+  }
+  return retValue;
+}
+
+/// Asks for preparing in advance the input information of the correction steps
+///
+/// The detector list is extracted from the passed list and then
+/// the request is transmitted to the input data corrections
+/// and then propagated to the Q vector corrections
+/// \param list list where the input information should be found
+void QnCorrectionsDetectorConfigurationChannels::PrepareCorrectionInputs(TList *list) {
+  TList *detectorConfigurationList = (TList *) list->FindObject(this->GetName());
+  if (detectorConfigurationList != NULL) {
+    for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
+      fInputDataCorrections.At(ixCorrection)->PrepareInput(detectorConfigurationList);
+    }
+
+    /* now propagate it to Q vector corrections */
+    for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+      fQnVectorCorrections.At(ixCorrection)->PrepareInput(detectorConfigurationList);
+    }
+  }
 }
 
 /// Perform after calibration histograms attach actions
@@ -448,10 +539,8 @@ void QnCorrectionsDetectorConfigurationChannels::AddCorrectionOnInputData(QnCorr
 void QnCorrectionsDetectorConfigurationChannels::FillQAHistograms(const Float_t *variableContainer) {
   if (fQAMultiplicityBefore3D != NULL && fQAMultiplicityAfter3D != NULL) {
     for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
-      QnCorrectionsDataVectorChannelized *dataVector =
-          static_cast<QnCorrectionsDataVectorChannelized *>(fDataVectorBank->At(ixData));
-      fQAMultiplicityBefore3D->Fill(variableContainer[fQACentralityVarId], fChannelMap[dataVector->GetId()], dataVector->Weight());
-      fQAMultiplicityAfter3D->Fill(variableContainer[fQACentralityVarId], fChannelMap[dataVector->GetId()], dataVector->EqualizedWeight());
+      fQAMultiplicityBefore3D->Fill(variableContainer[fQACentralityVarId], fChannelMap[fDataVectorBank->GetId(ixData)], fDataVectorBank->Weight(ixData));
+      fQAMultiplicityAfter3D->Fill(variableContainer[fQACentralityVarId], fChannelMap[fDataVectorBank->GetId(ixData)], fDataVectorBank->EqualizedWeight(ixData));
     }
   }
   if (fQAQnAverageHistogram != NULL) {
@@ -516,6 +605,20 @@ void QnCorrectionsDetectorConfigurationChannels::FillOverallInputCorrectionStepL
   fInputDataCorrections.FillOverallCorrectionsList(list);
 }
 
+/// Attaches the detector configuration to an instrumentation table
+///
+/// Besides the whole detector configuration and the Qn vector correction
+/// steps entries, the request is transmitted to the input data correction
+/// steps.
+/// \param instrumentation the instrumentation table, NULL for detaching the detector configuration
+void QnCorrectionsDetectorConfigurationChannels::AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation) {
+
+  QnCorrectionsDetectorConfigurationBase::AttachInstrumentation(instrumentation);
+  for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
+    fInputDataCorrections.At(ixCorrection)->AttachInstrumentation(instrumentation);
+  }
+}
+
 /// Include only one instance of each Qn vector correction step
 /// in execution order
 ///
@@ -568,3 +671,18 @@ void QnCorrectionsDetectorConfigurationChannels::ReportOnCorrections(TList *step
   apply->Add(myapply);
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+///
+/// The own QA histograms are flushed and the request is transmitted
+/// to the input data and to the Q vector correction steps.
+void QnCorrectionsDetectorConfigurationChannels::FlushHistograms() {
+  if (fQAQnAverageHistogram != NULL)
+    fQAQnAverageHistogram->FlushAccumulator();
+  for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
+    fInputDataCorrections.At(ixCorrection)->FlushHistograms();
+  }
+  for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+    fQnVectorCorrections.At(ixCorrection)->FlushHistograms();
+  }
+}
+
@@ -31,6 +31,10 @@ class QnCorrectionsProfileComponents;
 /// According to that, the proper channelized data vector is used and an extra
 /// Q vector builder is incorporated.
 ///
+/// As the azimuthal angle of each channel is fixed by the detector geometry,
+/// it can be optionally registered. In that case the channels harmonics are
+/// precomputed and the Q vectors are built as weighted sums over channels.
+///
 /// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
 /// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
 /// \author Víctor González <victor.gonzalez@cern.ch>, UCM
@@ -68,6 +72,10 @@ public:
 
 
   void SetChannelsScheme(Bool_t *bUsedChannel, Int_t *nChannelGroup, Float_t *hardCodedGroupWeights = NULL);
+  void SetChannelsAzimuth(const Float_t *phi);
+  /// Gets the channels azimuthal angles
+  /// \return the registered azimuthal angle of each channel, NULL if not registered
+  const Float_t *GetChannelsAzimuth() const { return fChannelAzimuth; }
 
   /* QA section */
   /// Sets the variable id used for centrality in QA histograms.
@@ -91,8 +99,10 @@ public:
   /// Activate the processing for the passed harmonic
   /// \param harmonic the desired harmonic number to activate
   virtual void ActivateHarmonic(Int_t harmonic)
-  { QnCorrectionsDetectorConfigurationBase::ActivateHarmonic(harmonic); fRawQnVector.ActivateHarmonic(harmonic); }
+  { QnCorrectionsDetectorConfigurationBase::ActivateHarmonic(harmonic);
+    fRawQnVector.ActivateHarmonic(harmonic); fTempRawQnVector.ActivateHarmonic(harmonic); }
   virtual Bool_t AttachCorrectionInputs(TList *list);
+  virtual void PrepareCorrectionInputs(TList *list);
   virtual void AfterInputsAttachActions();
   virtual Bool_t ProcessCorrections(const Float_t *variableContainer);
   virtual Bool_t ProcessDataCollection(const Float_t *variableContainer);
@@ -100,13 +110,19 @@ public:
   virtual void AddCorrectionOnInputData(QnCorrectionsCorrectionOnInputData *correctionOnInputData);
 
   virtual Bool_t AddDataVector(const Float_t *variableContainer, Double_t phi, Double_t weight, Int_t channelId);
+  virtual Int_t AddDataVectors(Float_t *variableContainer, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      Int_t nVariables = 0, const Int_t *variableId = NULL, const Float_t *variableValues = NULL);
 
   virtual void BuildQnVector();
   void BuildRawQnVector();
+  void BuildRawAndQnVectors();
+  Int_t FillChannelsWeights(const Float_t *weight, Float_t *channelsWeight) const;
   virtual void IncludeQnVectors(TList *list);
   virtual void FillOverallInputCorrectionStepList(TList *list) const;
   virtual void FillOverallQnVectorCorrectionStepList(TList *list) const;
   virtual void ReportOnCorrections(TList *steps, TList *calib, TList *apply) const;
+  virtual void AttachInstrumentation(QnCorrectionsInstrumentation *instrumentation);
+  virtual void FlushHistograms();
 
   /// Checks if the current content of the variable bank applies to
   /// the detector configuration for the passed channel.
@@ -123,7 +139,9 @@ public:
 
 private:
   static const char *szRawQnVectorName;   ///< the name of the raw Qn vector from raw data without input data corrections
+  static const Float_t fMinimumSignificantValue; ///< the minimum value that will be considered as meaningful for processing
   QnCorrectionsQnVector fRawQnVector;     ///< Q vector from input data before pre-processing
+  QnCorrectionsQnVectorBuild fTempRawQnVector; ///< temporary raw Qn vector for building it together with the Qn vector
   Int_t fNoOfChannels;                    ///< The number of channels associated
   /// array, which of the detector channels is used for this configuration
   Bool_t *fUsedChannel;                   //[fNoOfChannels]
@@ -133,6 +151,13 @@ private:
   Int_t *fChannelGroup;                   //[fNoOfChannels]
   /// array, group hard coded weight
   Float_t *fHardCodedGroupWeights;         //[fNoOfChannels]
+  /// array, the azimuthal angle of each channel
+  Float_t *fChannelAzimuth;               //[fNoOfChannels]
+  Int_t fChannelsTablesHighestHarmonic;   //!<! the highest harmonic multiple covered by the channels tables
+  Float_t *fChannelsCosTable;             //!<! per harmonic \f$ \cos(k\varphi_c) \f$ table for the channels
+  Float_t *fChannelsSinTable;             //!<! per harmonic \f$ \sin(k\varphi_c) \f$ table for the channels
+  Float_t *fChannelsWeight;               //!<! per channel raw weight for the current event
+  Float_t *fChannelsEqualizedWeight;      //!<! per channel equalized weight for the current event
   QnCorrectionsCorrectionsSetOnInputData fInputDataCorrections; ///< set of corrections to apply on input data vectors
 
   /* QA section */
@@ -156,7 +181,7 @@ private:
   QnCorrectionsDetectorConfigurationChannels& operator= (const QnCorrectionsDetectorConfigurationChannels &);
 
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsDetectorConfigurationChannels, 2);
+  ClassDef(QnCorrectionsDetectorConfigurationChannels, 4);
 /// \endcond
 };
 
@@ -174,23 +199,91 @@ inline Bool_t QnCorrectionsDetectorConfigurationChannels::AddDataVector(
     const Float_t *variableContainer, Double_t phi, Double_t weight, Int_t channelId) {
   if (IsSelected(variableContainer, channelId)) {
     /// add the data vector to the bank
-    new (fDataVectorBank->ConstructedAt(fDataVectorBank->GetEntriesFast()))
-      QnCorrectionsDataVectorChannelized(channelId, phi, weight);
+    fDataVectorBank->AddDataVector(channelId, phi, weight);
     return kTRUE;
   }
   return kFALSE;
 }
 
+/// New set of data vectors for the detector configuration.
+/// For each data vector a check is made to match its channel Id with the
+/// ones assigned to the detector configuration. If a variables block is
+/// passed its values are stored in the variable bank and then an additional
+/// check is made to see if the bank content passes the associated cuts.
+/// Accepted data vectors are stored.
+/// \param variableContainer pointer to the variable content bank
+/// \param phi array of azimuthal angles
+/// \param weight array of data vector weights. NULL for unit weights.
+/// \param channelId array of channel Ids that originate the data vectors. NULL if the data vector i comes from channel i.
+/// \param n the number of data vectors in the arrays
+/// \param nVariables the number of variables per data vector in the variables block
+/// \param variableId array with the external Ids of the variables in the variables block
+/// \param variableValues the variables block, nVariables consecutive values per data vector
+/// \return the number of data vectors accepted and stored
+inline Int_t QnCorrectionsDetectorConfigurationChannels::AddDataVectors(Float_t *variableContainer,
+    const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+    Int_t nVariables, const Int_t *variableId, const Float_t *variableValues) {
+  Int_t nAccepted = 0;
+  const Float_t *dataVectorVariables = variableValues;
+  for (Int_t ixData = 0; ixData < n; ixData++) {
+    Int_t nChannel = ((channelId != NULL) ? channelId[ixData] : ixData);
+    if (fUsedChannel[nChannel]) {
+      for (Int_t ixVar = 0; ixVar < nVariables; ixVar++) {
+        variableContainer[variableId[ixVar]] = dataVectorVariables[ixVar];
+      }
+      if ((fCuts == NULL) || fCuts->IsSelected(variableContainer)) {
+        /// add the data vector to the bank
+        fDataVectorBank->AddDataVector(nChannel, phi[ixData], ((weight != NULL) ? weight[ixData] : 1.0));
+        nAccepted++;
+      }
+    }
+    dataVectorVariables += nVariables;
+  }
+  return nAccepted;
+}
+
+/// Fills the per channel weights from the data vectors in the bank
+///
+/// The weights of the data vectors coming from the same channel are
+/// accumulated. Data vectors with not significant weight are not considered
+/// as it happens when the Qn vector is built from each data vector.
+/// \param weight the data vector weights in the bank
+/// \param channelsWeight the array, one entry per channel, to fill
+/// \return the number of data vectors with significant weight
+inline Int_t QnCorrectionsDetectorConfigurationChannels::FillChannelsWeights(const Float_t *weight, Float_t *channelsWeight) const {
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    channelsWeight[ixChannel] = 0.0;
+  }
+  const Int_t *id = fDataVectorBank->GetIdArray();
+  Int_t nContributors = 0;
+  for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
+    if (weight[ixData] < fMinimumSignificantValue) continue;
+    channelsWeight[id[ixData]] += weight[ixData];
+    nContributors++;
+  }
+  return nContributors;
+}
+
 /// Builds raw Qn vector before Q vector corrections and before input
 /// data corrections but considering the chosen calibration method.
 /// This is a channelized configuration so this Q vector will NOT be
 /// the one to be used for subsequent Q vector corrections.
+///
+/// If the channels azimuthal angles were registered the precomputed
+/// channels tables are used.
 inline void QnCorrectionsDetectorConfigurationChannels::BuildRawQnVector() {
   fTempQnVector.Reset();
 
-  for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
-    QnCorrectionsDataVectorChannelized *dataVector = static_cast<QnCorrectionsDataVectorChannelized *>(fDataVectorBank->At(ixData));
-    fTempQnVector.Add(dataVector->Phi(), dataVector->Weight());
+  if (fChannelsCosTable != NULL && !(fChannelsTablesHighestHarmonic < fTempQnVector.GetHighestHarmonicMultiple())) {
+    Int_t nContributors = FillChannelsWeights(fDataVectorBank->GetWeightArray(), fChannelsWeight);
+    fTempQnVector.AddChannels(fNoOfChannels, fChannelsWeight, nContributors, fChannelsCosTable, fChannelsSinTable);
+  }
+  else {
+    const Float_t *phi = fDataVectorBank->GetPhiArray();
+    const Float_t *weight = fDataVectorBank->GetWeightArray();
+    for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
+      fTempQnVector.Add(phi[ixData], weight[ixData]);
+    }
   }
   fTempQnVector.CheckQuality();
   fTempQnVector.Normalize(fQnNormalizationMethod);
@@ -201,15 +294,88 @@ inline void QnCorrectionsDetectorConfigurationChannels::BuildRawQnVector() {
 /// and considering the chosen calibration method.
 /// The built Q vector is the one to be used for
 /// subsequent Q vector corrections.
+///
+/// The Qn and Q2n vectors are built in a single pass over the
+/// data vector bank sharing the harmonics evaluation of each data vector.
+/// If the channels azimuthal angles were registered the precomputed
+/// channels tables are used instead.
 inline void QnCorrectionsDetectorConfigurationChannels::BuildQnVector() {
   fTempQnVector.Reset();
   fTempQ2nVector.Reset();
 
+  const Float_t *phi = fDataVectorBank->GetPhiArray();
+  const Float_t *equalizedWeight = fDataVectorBank->GetEqualizedWeightArray();
+  Int_t nHighestHarmonic = TMath::Max(fTempQnVector.GetHighestHarmonicMultiple(), fTempQ2nVector.GetHighestHarmonicMultiple());
+  if (fChannelsCosTable != NULL && !(fChannelsTablesHighestHarmonic < nHighestHarmonic)) {
+    Int_t nContributors = FillChannelsWeights(equalizedWeight, fChannelsEqualizedWeight);
+    fTempQnVector.AddChannels(fNoOfChannels, fChannelsEqualizedWeight, nContributors, fChannelsCosTable, fChannelsSinTable);
+    fTempQ2nVector.AddChannels(fNoOfChannels, fChannelsEqualizedWeight, nContributors, fChannelsCosTable, fChannelsSinTable);
+  }
+  else if (nHighestHarmonic < HARMONICSTABLESIZE) {
+    Double_t cosTable[HARMONICSTABLESIZE];
+    Double_t sinTable[HARMONICSTABLESIZE];
+    for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
+      QnCorrectionsQnVectorBuild::FillHarmonicsTable(phi[ixData], nHighestHarmonic, cosTable, sinTable);
+      fTempQnVector.Add(cosTable, sinTable, equalizedWeight[ixData]);
+      fTempQ2nVector.Add(cosTable, sinTable, equalizedWeight[ixData]);
+    }
+  }
+  else {
+    for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
+      fTempQnVector.Add(phi[ixData], equalizedWeight[ixData]);
+      fTempQ2nVector.Add(phi[ixData], equalizedWeight[ixData]);
+    }
+  }
+  fTempQnVector.CheckQuality();
+  fTempQ2nVector.CheckQuality();
+  fTempQnVector.Normalize(fQnNormalizationMethod);
+  fTempQ2nVector.Normalize(fQnNormalizationMethod);
+  fPlainQnVector.Set(&fTempQnVector, kFALSE);
+  fPlainQ2nVector.Set(&fTempQ2nVector, kFALSE);
+  fCorrectedQnVector.Set(&fTempQnVector, kFALSE);
+  fCorrectedQ2nVector.Set(&fTempQ2nVector, kFALSE);
+}
+
+/// Builds the raw Qn vector, from raw weights, and the Qn and Q2n vectors,
+/// from equalized weights, in a single pass over the data vector bank.
+///
+/// Input data corrections only modify the equalized weights so, once
+/// they have been applied, the raw Qn vector could be built together
+/// with the Qn and Q2n vectors sharing the harmonics evaluation of each
+/// data vector. The outcome is the same as BuildRawQnVector followed by
+/// BuildQnVector.
+///
+/// If the channels azimuthal angles were registered the individual
+/// builders already use the precomputed channels tables.
+inline void QnCorrectionsDetectorConfigurationChannels::BuildRawAndQnVectors() {
+  Int_t nHighestHarmonic = TMath::Max(fTempQnVector.GetHighestHarmonicMultiple(), fTempQ2nVector.GetHighestHarmonicMultiple());
+  nHighestHarmonic = TMath::Max(nHighestHarmonic, fTempRawQnVector.GetHighestHarmonicMultiple());
+  if ((fChannelsCosTable != NULL) || !(nHighestHarmonic < HARMONICSTABLESIZE)) {
+    /* channels tables or not supported harmonic multipliers, go through the individual builders */
+    BuildRawQnVector();
+    BuildQnVector();
+    return;
+  }
+
+  fTempRawQnVector.Reset();
+  fTempQnVector.Reset();
+  fTempQ2nVector.Reset();
+
+  const Float_t *phi = fDataVectorBank->GetPhiArray();
+  const Float_t *weight = fDataVectorBank->GetWeightArray();
+  const Float_t *equalizedWeight = fDataVectorBank->GetEqualizedWeightArray();
+  Double_t cosTable[HARMONICSTABLESIZE];
+  Double_t sinTable[HARMONICSTABLESIZE];
   for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
-    QnCorrectionsDataVectorChannelized *dataVector = static_cast<QnCorrectionsDataVectorChannelized *>(fDataVectorBank->At(ixData));
-    fTempQnVector.Add(dataVector->Phi(), dataVector->EqualizedWeight());
-    fTempQ2nVector.Add(dataVector->Phi(), dataVector->EqualizedWeight());
+    QnCorrectionsQnVectorBuild::FillHarmonicsTable(phi[ixData], nHighestHarmonic, cosTable, sinTable);
+    fTempRawQnVector.Add(cosTable, sinTable, weight[ixData]);
+    fTempQnVector.Add(cosTable, sinTable, equalizedWeight[ixData]);
+    fTempQ2nVector.Add(cosTable, sinTable, equalizedWeight[ixData]);
   }
+  fTempRawQnVector.CheckQuality();
+  fTempRawQnVector.Normalize(fQnNormalizationMethod);
+  fRawQnVector.Set(&fTempRawQnVector, kFALSE);
+
   fTempQnVector.CheckQuality();
   fTempQ2nVector.CheckQuality();
   fTempQnVector.Normalize(fQnNormalizationMethod);
@@ -228,24 +394,26 @@ inline void QnCorrectionsDetectorConfigurationChannels::BuildQnVector() {
 /// The first not applied correction step breaks the loop and kFALSE is returned
 /// \return kTRUE if all correction steps were applied
 inline Bool_t QnCorrectionsDetectorConfigurationChannels::ProcessCorrections(const Float_t *variableContainer) {
+  Int_t nDataVectors = fDataVectorBank->GetEntriesFast();
+  QnCorrectionsInstrument(fCorrectionsCounters, nDataVectors);
 
-  /* first we build the raw Q vector with the chosen calibration */
-  BuildRawQnVector();
-
-  /* then we transfer the request to the input data correction steps */
+  /* first we transfer the request to the input data correction steps */
   for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
-    if (fInputDataCorrections.At(ixCorrection)->ProcessCorrections(variableContainer))
+    if (fInputDataCorrections.At(ixCorrection)->InstrumentedProcessCorrections(variableContainer, nDataVectors))
       continue;
-    else
+    else {
+      /* the raw Q vector is always built with the chosen calibration */
+      BuildRawQnVector();
       return kFALSE;
+    }
   }
 
-  /* input corrections were applied so let's build the Q vector with the chosen calibration */
-  BuildQnVector();
+  /* input corrections were applied so let's build the raw and the Q vector with the chosen calibration */
+  BuildRawAndQnVectors();
 
   /* now let's propagate it to Q vector corrections */
   for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
-    if (fQnVectorCorrections.At(ixCorrection)->ProcessCorrections(variableContainer))
+    if (fQnVectorCorrections.At(ixCorrection)->InstrumentedProcessCorrections(variableContainer, nDataVectors))
       continue;
     else
       return kFALSE;
@@ -261,10 +429,12 @@ inline Bool_t QnCorrectionsDetectorConfigurationChannels::ProcessCorrections(con
 /// The first not applied correction step should break the loop after collecting the data and kFALSE is returned
 /// \return kTRUE if all correction steps were applied
 inline Bool_t QnCorrectionsDetectorConfigurationChannels::ProcessDataCollection(const Float_t *variableContainer) {
+  Int_t nDataVectors = fDataVectorBank->GetEntriesFast();
+  QnCorrectionsInstrument(fDataCollectionCounters, nDataVectors);
 
   /* we transfer the request to the input data correction steps */
   for (Int_t ixCorrection = 0; ixCorrection < fInputDataCorrections.GetEntries(); ixCorrection++) {
-    if (fInputDataCorrections.At(ixCorrection)->ProcessDataCollection(variableContainer))
+    if (fInputDataCorrections.At(ixCorrection)->InstrumentedProcessDataCollection(variableContainer, nDataVectors))
       continue;
     else
       return kFALSE;
@@ -275,7 +445,7 @@ inline Bool_t QnCorrectionsDetectorConfigurationChannels::ProcessDataCollection(
 
   /* now let's propagate it to Q vector corrections */
   for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
-    if (fQnVectorCorrections.At(ixCorrection)->ProcessDataCollection(variableContainer))
+    if (fQnVectorCorrections.At(ixCorrection)->InstrumentedProcessDataCollection(variableContainer, nDataVectors))
       continue;
     else
       return kFALSE;
@@ -307,7 +477,7 @@ inline void QnCorrectionsDetectorConfigurationChannels::ClearConfiguration() {
   fCorrectedQnVector.Reset();
   fCorrectedQ2nVector.Reset();
   /* and now clear the the input data bank */
-  fDataVectorBank->Clear("C");
+  fDataVectorBank->Clear();
 }
 
 #endif // QNCORRECTIONS_DETECTORCONFCHANNEL_H
@@ -87,12 +87,15 @@ void QnCorrectionsDetectorConfigurationTracks::AttachCorrectionsManager(QnCorrec
 
 /// Asks for support data structures creation
 ///
-/// The input data vector bank is allocated and the request is
+/// The input data vector bank is allocated, the cuts compiled and the request is
 /// transmitted to the Q vector corrections.
 void QnCorrectionsDetectorConfigurationTracks::CreateSupportDataStructures() {
 
   /* this is executed in the remote node so, allocate the data bank */
-  fDataVectorBank = new TClonesArray("QnCorrectionsDataVector", INITIALDATAVECTORBANKSIZE);
+  fDataVectorBank = new QnCorrectionsDataVectorBank(INITIALDATAVECTORBANKSIZE, kFALSE);
+
+  /* the cuts table reflects the cuts as they are now */
+  if (fCuts != NULL) fCuts->Compile();
 
   for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
     fQnVectorCorrections.At(ixCorrection)->CreateSupportDataStructures();
@@ -144,6 +147,7 @@ Bool_t QnCorrectionsDetectorConfigurationTracks::CreateQAHistograms(TList *list)
       Form("%s %s", szQAQnAverageHistogramName, this->GetName()),
       Form("%s %s", szQAQnAverageHistogramName, this->GetName()),
       this->GetEventClassVariablesSet());
+  fQAQnAverageHistogram->SetEventClassBins(GetEventClassBins());
 
   /* get information about the configured harmonics to pass it for histogram creation */
   Int_t nNoOfHarmonics = this->GetNoOfHarmonics();
@@ -195,18 +199,39 @@ Bool_t QnCorrectionsDetectorConfigurationTracks::CreateNveQAHistograms(TList *li
 ///
 /// The detector list is extracted from the passed list and then
 /// the request is transmitted to the Q vector corrections with the found list.
+/// Afterwards the inputs the corrections could have prepared in advance
+/// are released.
 /// \param list list where the input information should be found
 /// \return kTRUE if everything went OK
 Bool_t QnCorrectionsDetectorConfigurationTracks::AttachCorrectionInputs(TList *list) {
   TList *detectorConfigurationList = (TList *) list->FindObject(this->GetName());
+  Bool_t retValue = kFALSE;
   if (detectorConfigurationList != NULL) {
-    Bool_t retValue = kTRUE;
+    retValue = kTRUE;
     for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
       retValue = retValue && (fQnVectorCorrections.At(ixCorrection)->AttachInput(detectorConfigurationList));
     }
-    return retValue;
   }
-  return kFALSE;
+
+  /* the attached corrections hold their own inputs already */
+  for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+    fQnVectorCorrections.At(ixCorrection)->ReleasePreparedInput();
+  }
+  return retValue;
+}
+
+/// Asks for preparing in advance the input information of the correction steps
+///
+/// The detector list is extracted from the passed list and then
+/// the request is transmitted to the Q vector corrections with the found list.
+/// \param list list where the input information should be found
+void QnCorrectionsDetectorConfigurationTracks::PrepareCorrectionInputs(TList *list) {
+  TList *detectorConfigurationList = (TList *) list->FindObject(this->GetName());
+  if (detectorConfigurationList != NULL) {
+    for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+      fQnVectorCorrections.At(ixCorrection)->PrepareInput(detectorConfigurationList);
+    }
+  }
 }
 
 /// Perform after calibration histograms attach actions
@@ -328,3 +353,15 @@ void QnCorrectionsDetectorConfigurationTracks::ReportOnCorrections(TList *steps,
   apply->Add(myapply);
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+///
+/// The own QA histograms are flushed and the request is transmitted
+/// to the Q vector correction steps.
+void QnCorrectionsDetectorConfigurationTracks::FlushHistograms() {
+  if (fQAQnAverageHistogram != NULL)
+    fQAQnAverageHistogram->FlushAccumulator();
+  for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
+    fQnVectorCorrections.At(ixCorrection)->FlushHistograms();
+  }
+}
+
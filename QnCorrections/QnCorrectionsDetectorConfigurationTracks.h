@@ -57,17 +57,21 @@ public:
   virtual Bool_t CreateQAHistograms(TList *list);
   virtual Bool_t CreateNveQAHistograms(TList *list);
   virtual Bool_t AttachCorrectionInputs(TList *list);
+  virtual void PrepareCorrectionInputs(TList *list);
   virtual void AfterInputsAttachActions();
 
   virtual Bool_t ProcessCorrections(const Float_t *variableContainer);
   virtual Bool_t ProcessDataCollection(const Float_t *variableContainer);
   virtual Bool_t AddDataVector(const Float_t *variableContainer, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1);
+  virtual Int_t AddDataVectors(Float_t *variableContainer, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      Int_t nVariables = 0, const Int_t *variableId = NULL, const Float_t *variableValues = NULL);
 
   virtual void BuildQnVector();
   virtual void IncludeQnVectors(TList *list);
   virtual void FillOverallInputCorrectionStepList(TList *list) const;
   virtual void FillOverallQnVectorCorrectionStepList(TList *list) const;
   virtual void ReportOnCorrections(TList *steps, TList *calib, TList *apply) const;
+  virtual void FlushHistograms();
 
   /// Checks if the current content of the variable bank applies to
   /// the detector configuration
@@ -104,13 +108,57 @@ inline Bool_t QnCorrectionsDetectorConfigurationTracks::AddDataVector(
     const Float_t *variableContainer, Double_t phi, Double_t weight, Int_t id) {
   if (IsSelected(variableContainer)) {
     /// add the data vector to the bank
-    new (fDataVectorBank->ConstructedAt(fDataVectorBank->GetEntriesFast()))
-        QnCorrectionsDataVector(id, phi, weight);
+    fDataVectorBank->AddDataVector(id, phi, weight);
     return kTRUE;
   }
   return kFALSE;
 }
 
+/// New set of data vectors for the detector configuration.
+/// If a variables block is passed, the data vectors are checked against
+/// the associated cuts in chunks, each of them producing a selection
+/// bit mask, taking the variables values from the block. Accepted data
+/// vectors are stored. On return the variable bank holds the variables
+/// block of the last data vector.
+/// \param variableContainer pointer to the variable content bank
+/// \param phi array of azimuthal angles
+/// \param weight array of data vector weights. NULL for unit weights, the usual case for track detectors.
+/// \param channelId array of Ids associated to the data vectors, usually the track ids. NULL for no Id (-1).
+/// \param n the number of data vectors in the arrays
+/// \param nVariables the number of variables per data vector in the variables block
+/// \param variableId array with the external Ids of the variables in the variables block
+/// \param variableValues the variables block, nVariables consecutive values per data vector
+/// \return the number of data vectors accepted and stored
+inline Int_t QnCorrectionsDetectorConfigurationTracks::AddDataVectors(Float_t *variableContainer,
+    const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+    Int_t nVariables, const Int_t *variableId, const Float_t *variableValues) {
+  Int_t nAccepted = 0;
+  for (Int_t ixChunk = 0; ixChunk < n; ixChunk += QnCorrectionsCutsSet::nSelectionMaskWordBits) {
+    Int_t nInChunk = TMath::Min(QnCorrectionsCutsSet::nSelectionMaskWordBits, n - ixChunk);
+    ULong64_t selectionMask = ~ULong64_t(0);
+    if (fCuts != NULL) {
+      fCuts->FillSelectionMask(variableContainer, nInChunk, nVariables, variableId,
+          ((nVariables > 0) ? variableValues + ixChunk * nVariables : NULL), &selectionMask);
+    }
+    for (Int_t ixBit = 0; ixBit < nInChunk; ixBit++) {
+      if ((selectionMask >> ixBit) & 0x1) {
+        Int_t ixData = ixChunk + ixBit;
+        /// add the data vector to the bank
+        fDataVectorBank->AddDataVector(((channelId != NULL) ? channelId[ixData] : -1), phi[ixData], ((weight != NULL) ? weight[ixData] : 1.0));
+        nAccepted++;
+      }
+    }
+  }
+  if ((fCuts == NULL) && (n > 0) && (nVariables > 0)) {
+    /* keep the variable bank as if the data vectors were added one by one */
+    const Float_t *lastVariables = variableValues + (n - 1) * nVariables;
+    for (Int_t ixVar = 0; ixVar < nVariables; ixVar++) {
+      variableContainer[variableId[ixVar]] = lastVariables[ixVar];
+    }
+  }
+  return nAccepted;
+}
+
 /// Clean the configuration to accept a new event
 ///
 /// Transfers the order to the Q vector correction steps and
@@ -127,7 +175,7 @@ inline void QnCorrectionsDetectorConfigurationTracks::ClearConfiguration() {
   fCorrectedQnVector.Reset();
   fCorrectedQ2nVector.Reset();
   /* and now clear the the input data bank */
-  fDataVectorBank->Clear("C");
+  fDataVectorBank->Clear();
 }
 
 /// Builds Qn vectors before Q vector corrections but
@@ -135,14 +183,30 @@ inline void QnCorrectionsDetectorConfigurationTracks::ClearConfiguration() {
 /// Remember, this configuration does not have a channelized
 /// approach so, the built Q vectors are the ones to be used for
 /// subsequent corrections.
+///
+/// The Qn and Q2n vectors are built in a single pass over the
+/// data vector bank sharing the harmonics evaluation of each data vector.
 inline void QnCorrectionsDetectorConfigurationTracks::BuildQnVector() {
   fTempQnVector.Reset();
   fTempQ2nVector.Reset();
 
-  for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
-    QnCorrectionsDataVector *dataVector = static_cast<QnCorrectionsDataVector *>(fDataVectorBank->At(ixData));
-    fTempQnVector.Add(dataVector->Phi(), dataVector->Weight());
-    fTempQ2nVector.Add(dataVector->Phi(), dataVector->Weight());
+  const Float_t *phi = fDataVectorBank->GetPhiArray();
+  const Float_t *weight = fDataVectorBank->GetWeightArray();
+  Int_t nHighestHarmonic = TMath::Max(fTempQnVector.GetHighestHarmonicMultiple(), fTempQ2nVector.GetHighestHarmonicMultiple());
+  if (nHighestHarmonic < HARMONICSTABLESIZE) {
+    Double_t cosTable[HARMONICSTABLESIZE];
+    Double_t sinTable[HARMONICSTABLESIZE];
+    for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
+      QnCorrectionsQnVectorBuild::FillHarmonicsTable(phi[ixData], nHighestHarmonic, cosTable, sinTable);
+      fTempQnVector.Add(cosTable, sinTable, weight[ixData]);
+      fTempQ2nVector.Add(cosTable, sinTable, weight[ixData]);
+    }
+  }
+  else {
+    for(Int_t ixData = 0; ixData < fDataVectorBank->GetEntriesFast(); ixData++){
+      fTempQnVector.Add(phi[ixData], weight[ixData]);
+      fTempQ2nVector.Add(phi[ixData], weight[ixData]);
+    }
   }
   /* check the quality of the Qn vector */
   fTempQnVector.CheckQuality();
@@ -162,13 +226,16 @@ inline void QnCorrectionsDetectorConfigurationTracks::BuildQnVector() {
 /// The first not applied correction step breaks the loop and kFALSE is returned
 /// \return kTRUE if all correction steps were applied
 inline Bool_t QnCorrectionsDetectorConfigurationTracks::ProcessCorrections(const Float_t *variableContainer) {
+  Int_t nDataVectors = fDataVectorBank->GetEntriesFast();
+  QnCorrectionsInstrument(fCorrectionsCounters, nDataVectors);
+
   /* first we build the Q vector with the chosen calibration */
   BuildQnVector();
 
   /* then we transfer the request to the Q vector correction steps */
   /* the loop is broken when a correction step has not been applied */
   for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
-    if (fQnVectorCorrections.At(ixCorrection)->ProcessCorrections(variableContainer))
+    if (fQnVectorCorrections.At(ixCorrection)->InstrumentedProcessCorrections(variableContainer, nDataVectors))
       continue;
     else
       return kFALSE;
@@ -183,6 +250,8 @@ inline Bool_t QnCorrectionsDetectorConfigurationTracks::ProcessCorrections(const
 /// The first not applied correction step breaks the loop and kFALSE is returned
 /// \return kTRUE if all correction steps were applied
 inline Bool_t QnCorrectionsDetectorConfigurationTracks::ProcessDataCollection(const Float_t *variableContainer) {
+  Int_t nDataVectors = fDataVectorBank->GetEntriesFast();
+  QnCorrectionsInstrument(fDataCollectionCounters, nDataVectors);
 
   /* fill QA information */
   FillQAHistograms(variableContainer);
@@ -190,7 +259,7 @@ inline Bool_t QnCorrectionsDetectorConfigurationTracks::ProcessDataCollection(co
   /* we transfer the request to the Q vector correction steps */
   /* the loop is broken when a correction step has not been applied */
   for (Int_t ixCorrection = 0; ixCorrection < fQnVectorCorrections.GetEntries(); ixCorrection++) {
-    if (fQnVectorCorrections.At(ixCorrection)->ProcessDataCollection(variableContainer))
+    if (fQnVectorCorrections.At(ixCorrection)->InstrumentedProcessDataCollection(variableContainer, nDataVectors))
       continue;
     else
       return kFALSE;
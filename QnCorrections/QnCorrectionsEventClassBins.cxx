@@ -0,0 +1,81 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsEventClassBins.cxx
+/// \brief Implementation of the event class bin coordinates cache class
+
+#include "QnCorrectionsEventClassBins.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsEventClassBins);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsEventClassBins::QnCorrectionsEventClassBins() : TObject(),
+    fEventClassVariables() {
+  fNoOfVariables = 0;
+  fCoordinates = NULL;
+}
+
+/// Normal constructor
+/// Allocates the bin coordinates storage
+/// \param ecvs the event class variables set
+QnCorrectionsEventClassBins::QnCorrectionsEventClassBins(const QnCorrectionsEventClassVariablesSet &ecvs) : TObject(),
+    fEventClassVariables(ecvs) {
+  fNoOfVariables = fEventClassVariables.GetEntriesFast();
+  fCoordinates = new Int_t[fNoOfVariables];
+  for (Int_t var = 0; var < fNoOfVariables; var++) {
+    fCoordinates[var] = 0;
+  }
+}
+
+/// Default destructor
+/// Releases the memory taken
+QnCorrectionsEventClassBins::~QnCorrectionsEventClassBins() {
+  if (fCoordinates != NULL) delete [] fCoordinates;
+}
+
+/// Checks whether the passed set is the one the bin coordinates are kept for
+///
+/// As the event class variables are not owned by the sets, the sets are
+/// the same if they contain the same event class variables in the same order.
+/// \param ecvs the event class variables set to check
+/// \return kTRUE if the set is the same
+Bool_t QnCorrectionsEventClassBins::IsSameVariablesSet(const QnCorrectionsEventClassVariablesSet &ecvs) const {
+  if (ecvs.GetEntriesFast() != fNoOfVariables)
+    return kFALSE;
+  for (Int_t var = 0; var < fNoOfVariables; var++) {
+    if (ecvs.At(var) != fEventClassVariables.At(var))
+      return kFALSE;
+  }
+  return kTRUE;
+}
+
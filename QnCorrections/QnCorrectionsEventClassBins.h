@@ -0,0 +1,98 @@
+#ifndef QNCORRECTIONS_EVENTCLASSBINS_H
+#define QNCORRECTIONS_EVENTCLASSBINS_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsEventClassBins.h
+/// \brief Class that caches the current event bin coordinates for a set of event class variables
+
+#include <TObject.h>
+#include <TMath.h>
+#include "QnCorrectionsEventClassVariablesSet.h"
+
+/// \class QnCorrectionsEventClassBins
+/// \brief The current event bin coordinates for an event class variables set
+///
+/// Most of the framework histograms are built on the same event class
+/// variables set, so they share the bin each event class variable
+/// falls in. An instance of this class is kept by the framework manager
+/// for each distinct event class variables set and its bin
+/// coordinates are updated once per event. Histograms attached to it
+/// then avoid searching the bins on their own axes.
+///
+/// The bin coordinates follow the TAxis convention: 0 for underflow,
+/// 1 to number of bins for the regular bins and number of bins plus one
+/// for overflow. As the histograms axes are built from the event class
+/// variables bins, the coordinates match the ones the histograms would find.
+///
+/// Two sets are considered the same if they contain the same event
+/// class variables objects in the same order.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsEventClassBins : public TObject {
+public:
+  QnCorrectionsEventClassBins();
+  QnCorrectionsEventClassBins(const QnCorrectionsEventClassVariablesSet &ecvs);
+  virtual ~QnCorrectionsEventClassBins();
+
+  Bool_t IsSameVariablesSet(const QnCorrectionsEventClassVariablesSet &ecvs) const;
+  void UpdateBins(const Float_t *variableContainer);
+
+  /// Gets the number of event class variables
+  /// \return the number of variables in the set
+  Int_t GetNoOfVariables() const { return fNoOfVariables; }
+  /// Gets the current event bin coordinates
+  /// \return the bin coordinate for each of the event class variables
+  const Int_t *GetCoordinates() const { return fCoordinates; }
+
+private:
+  QnCorrectionsEventClassVariablesSet fEventClassVariables; ///< the event class variables set
+  Int_t fNoOfVariables;                                     ///< the number of variables in the set
+  Int_t *fCoordinates;                                      //!<! the current event bin coordinates
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsEventClassBins(const QnCorrectionsEventClassBins &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsEventClassBins& operator= (const QnCorrectionsEventClassBins &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsEventClassBins, 1);
+/// \endcond
+};
+
+/// Updates the bin coordinates for the current event
+///
+/// For each event class variable the bin its current value falls in
+/// is located as TAxis::FindBin does for variable bin size axes.
+/// \param variableContainer the current variables content addressed by var Id
+inline void QnCorrectionsEventClassBins::UpdateBins(const Float_t *variableContainer) {
+  for (Int_t var = 0; var < fNoOfVariables; var++) {
+    QnCorrectionsEventClassVariable *variable = fEventClassVariables.At(var);
+    const Double_t *bins = variable->GetBins();
+    Int_t nBins = variable->GetNBins();
+    Double_t value = variableContainer[variable->GetVariableId()];
+
+    if (value < bins[0])
+      fCoordinates[var] = 0;
+    else if (!(value < bins[nBins]))
+      fCoordinates[var] = nBins + 1;
+    else
+      fCoordinates[var] = 1 + Int_t(TMath::BinarySearch(Long64_t(nBins + 1), bins, value));
+  }
+}
+
+#endif /* QNCORRECTIONS_EVENTCLASSBINS_H */
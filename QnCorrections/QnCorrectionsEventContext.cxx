@@ -0,0 +1,536 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsEventContext.cxx
+/// \brief Implementation of the per event state handed to the correction framework
+
+#include <TList.h>
+#include <TString.h>
+
+#include "QnCorrectionsDetector.h"
+#include "QnCorrectionsQnVector.h"
+#include "QnCorrectionsEventContext.h"
+#include "QnCorrectionsManager.h"
+#include "QnCorrectionsLog.h"
+
+#include <cstring>
+#include <iostream>
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsEventContext);
+/// \endcond
+
+const char QnCorrectionsEventContext::szStreamMagic[4] = {'Q', 'N', 'E', 'C'};
+const UInt_t QnCorrectionsEventContext::nStreamVersion = 1;
+
+/// Default constructor
+QnCorrectionsEventContext::QnCorrectionsEventContext() : TObject() {
+  fDataContainer = NULL;
+  fNoOfVariables = 0;
+  fNoOfDataVectors = 0;
+  fDataVectorsCapacity = 0;
+  fPhi = NULL;
+  fWeight = NULL;
+  fChannelId = NULL;
+  fNoOfVariableIds = 0;
+  fVariableIdsCapacity = 0;
+  fVariableId = NULL;
+  fNoOfVariableValues = 0;
+  fVariableValuesCapacity = 0;
+  fVariableValues = NULL;
+  fNoOfBlocks = 0;
+  fBlocksCapacity = 0;
+  fBlockDetectorId = NULL;
+  fBlockFirstDataVector = NULL;
+  fBlockNoOfVariables = NULL;
+  fBlockFirstVariableId = NULL;
+  fBlockFirstVariableValue = NULL;
+  fQnVectorList = NULL;
+  fQnVectorListVersion = 0;
+}
+
+/// Normal constructor
+/// Allocates the variables bank
+/// \param nNoOfVariables the number of variables the bank should support
+QnCorrectionsEventContext::QnCorrectionsEventContext(Int_t nNoOfVariables) : TObject() {
+  fDataContainer = new Float_t[nNoOfVariables];
+  fNoOfVariables = nNoOfVariables;
+  fNoOfDataVectors = 0;
+  fDataVectorsCapacity = 0;
+  fPhi = NULL;
+  fWeight = NULL;
+  fChannelId = NULL;
+  fNoOfVariableIds = 0;
+  fVariableIdsCapacity = 0;
+  fVariableId = NULL;
+  fNoOfVariableValues = 0;
+  fVariableValuesCapacity = 0;
+  fVariableValues = NULL;
+  fNoOfBlocks = 0;
+  fBlocksCapacity = 0;
+  fBlockDetectorId = NULL;
+  fBlockFirstDataVector = NULL;
+  fBlockNoOfVariables = NULL;
+  fBlockFirstVariableId = NULL;
+  fBlockFirstVariableValue = NULL;
+  fQnVectorList = NULL;
+  fQnVectorListVersion = 0;
+}
+
+/// Default destructor
+/// Releases the memory taken
+QnCorrectionsEventContext::~QnCorrectionsEventContext() {
+  if (fDataContainer != NULL) delete [] fDataContainer;
+  if (fPhi != NULL) delete [] fPhi;
+  if (fWeight != NULL) delete [] fWeight;
+  if (fChannelId != NULL) delete [] fChannelId;
+  if (fVariableId != NULL) delete [] fVariableId;
+  if (fVariableValues != NULL) delete [] fVariableValues;
+  if (fBlockDetectorId != NULL) delete [] fBlockDetectorId;
+  if (fBlockFirstDataVector != NULL) delete [] fBlockFirstDataVector;
+  if (fBlockNoOfVariables != NULL) delete [] fBlockNoOfVariables;
+  if (fBlockFirstVariableId != NULL) delete [] fBlockFirstVariableId;
+  if (fBlockFirstVariableValue != NULL) delete [] fBlockFirstVariableValue;
+  if (fQnVectorList != NULL) delete fQnVectorList;
+}
+
+/// Helper for expanding a staging array keeping its used content
+/// \param array the array to expand
+/// \param nUsed the number of used positions
+/// \param nSize the new size
+template<typename T>
+static void ExpandArray(T *&array, Int_t nUsed, Int_t nSize) {
+  T *newArray = new T[nSize];
+  if (array != NULL) {
+    for (Int_t i = 0; i < nUsed; i++) newArray[i] = array[i];
+    delete [] array;
+  }
+  array = newArray;
+}
+
+/// Expands the data vectors staging arrays
+/// The capacity is at least doubled to amortize the expansions
+/// \param nDataVectors the minimum number of data vectors to support
+void QnCorrectionsEventContext::ExpandDataVectors(Int_t nDataVectors) {
+  Int_t nCapacity = (fDataVectorsCapacity < 64) ? 64 : 2 * fDataVectorsCapacity;
+  while (nCapacity < nDataVectors) nCapacity *= 2;
+  ExpandArray(fPhi, fNoOfDataVectors, nCapacity);
+  ExpandArray(fWeight, fNoOfDataVectors, nCapacity);
+  ExpandArray(fChannelId, fNoOfDataVectors, nCapacity);
+  fDataVectorsCapacity = nCapacity;
+}
+
+/// Expands the per data vector variables staging arrays
+/// \param nVariableIds the minimum number of variables ids to support
+/// \param nVariableValues the minimum number of variables values to support
+void QnCorrectionsEventContext::ExpandVariables(Int_t nVariableIds, Int_t nVariableValues) {
+  if (fVariableIdsCapacity < nVariableIds) {
+    Int_t nCapacity = (fVariableIdsCapacity < 16) ? 16 : 2 * fVariableIdsCapacity;
+    while (nCapacity < nVariableIds) nCapacity *= 2;
+    ExpandArray(fVariableId, fNoOfVariableIds, nCapacity);
+    fVariableIdsCapacity = nCapacity;
+  }
+  if (fVariableValuesCapacity < nVariableValues) {
+    Int_t nCapacity = (fVariableValuesCapacity < 64) ? 64 : 2 * fVariableValuesCapacity;
+    while (nCapacity < nVariableValues) nCapacity *= 2;
+    ExpandArray(fVariableValues, fNoOfVariableValues, nCapacity);
+    fVariableValuesCapacity = nCapacity;
+  }
+}
+
+/// Expands the data vectors blocks arrays
+void QnCorrectionsEventContext::ExpandBlocks() {
+  Int_t nCapacity = (fBlocksCapacity < 16) ? 16 : 2 * fBlocksCapacity;
+  ExpandArray(fBlockDetectorId, fNoOfBlocks, nCapacity);
+  ExpandArray(fBlockFirstDataVector, fNoOfBlocks, nCapacity);
+  ExpandArray(fBlockNoOfVariables, fNoOfBlocks, nCapacity);
+  ExpandArray(fBlockFirstVariableId, fNoOfBlocks, nCapacity);
+  ExpandArray(fBlockFirstVariableValue, fNoOfBlocks, nCapacity);
+  fBlocksCapacity = nCapacity;
+}
+
+/// Stages a new set of data vectors
+///
+/// The set is kept as a block which will be handed in one go to the
+/// detector. The semantic of the variables block is the one of
+/// QnCorrectionsManager::AddDataVectors.
+/// \param detectorId id of the involved detector
+/// \param phi array of azimuthal angles
+/// \param weight array of data vector weights. NULL for unit weights
+/// \param channelId array of channel Ids that originates the data vectors. NULL for default ones
+/// \param n the number of data vectors in the arrays
+/// \param nVariables the number of variables per data vector in the variables block
+/// \param variableId array with the external Ids of the variables in the variables block
+/// \param variableValues the variables block, nVariables consecutive values per data vector
+void QnCorrectionsEventContext::AddDataVectors(Int_t detectorId, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+    Int_t nVariables, const Int_t *variableId, const Float_t *variableValues) {
+  if (n < 1) return;
+  if (!(fNoOfBlocks < fBlocksCapacity)) ExpandBlocks();
+  if (fDataVectorsCapacity < fNoOfDataVectors + n) ExpandDataVectors(fNoOfDataVectors + n);
+  if (nVariables > 0) ExpandVariables(fNoOfVariableIds + nVariables, fNoOfVariableValues + n * nVariables);
+
+  fBlockDetectorId[fNoOfBlocks] = detectorId;
+  fBlockFirstDataVector[fNoOfBlocks] = fNoOfDataVectors;
+  fBlockNoOfVariables[fNoOfBlocks] = nVariables;
+  fBlockFirstVariableId[fNoOfBlocks] = fNoOfVariableIds;
+  fBlockFirstVariableValue[fNoOfBlocks] = fNoOfVariableValues;
+  fNoOfBlocks++;
+
+  for (Int_t i = 0; i < n; i++) {
+    fPhi[fNoOfDataVectors + i] = phi[i];
+    fWeight[fNoOfDataVectors + i] = (weight != NULL) ? weight[i] : 1.0;
+    fChannelId[fNoOfDataVectors + i] = (channelId != NULL) ? channelId[i] : -1;
+  }
+  fNoOfDataVectors += n;
+  if (nVariables > 0) {
+    for (Int_t i = 0; i < nVariables; i++) {
+      fVariableId[fNoOfVariableIds + i] = variableId[i];
+    }
+    fNoOfVariableIds += nVariables;
+    for (Int_t i = 0; i < n * nVariables; i++) {
+      fVariableValues[fNoOfVariableValues + i] = variableValues[i];
+    }
+    fNoOfVariableValues += n * nVariables;
+  }
+}
+
+/// Hands the staged data vectors to the detectors
+///
+/// Each block is transmitted in one go to its detector together with
+/// the context variables bank.
+/// \param detectorsIdMap the map between external detector Id and internal detector
+/// \return the number of data vectors stored summed over the detector configurations
+Int_t QnCorrectionsEventContext::DispatchDataVectors(QnCorrectionsDetector **detectorsIdMap) {
+  Int_t nStored = 0;
+  for (Int_t ixBlock = 0; ixBlock < fNoOfBlocks; ixBlock++) {
+    Int_t first = fBlockFirstDataVector[ixBlock];
+    Int_t n = ((ixBlock + 1 < fNoOfBlocks) ? fBlockFirstDataVector[ixBlock + 1] : fNoOfDataVectors) - first;
+    Int_t nVariables = fBlockNoOfVariables[ixBlock];
+    nStored += detectorsIdMap[fBlockDetectorId[ixBlock]]->AddDataVectors(fDataContainer,
+        fPhi + first, fWeight + first, fChannelId + first, n,
+        nVariables,
+        (nVariables > 0) ? fVariableId + fBlockFirstVariableId[ixBlock] : NULL,
+        (nVariables > 0) ? fVariableValues + fBlockFirstVariableValue[ixBlock] : NULL);
+  }
+  return nStored;
+}
+
+/// Writes the events stream header
+///
+/// The stream identification, the format version and the variables bank
+/// positions written with each event.
+/// \param stream the output stream, opened in binary mode
+/// \param nVariables the number of variables of the bank written with each event
+/// \param variableId array with the external Ids of the variables written with each event
+/// \return kTRUE if everything went OK
+Bool_t QnCorrectionsEventContext::WriteStreamHeader(std::ostream &stream, Int_t nVariables, const Int_t *variableId) {
+  UInt_t header[2] = {nStreamVersion, (UInt_t) nVariables};
+  stream.write(szStreamMagic, sizeof(szStreamMagic));
+  stream.write((const char *) header, sizeof(header));
+  stream.write((const char *) variableId, nVariables * sizeof(Int_t));
+  return stream.good();
+}
+
+/// Reads and checks the events stream header
+///
+/// The stream must have been written by this format version with the
+/// same variables bank positions.
+/// \param stream the input stream, opened in binary mode
+/// \param nVariables the number of variables of the bank expected with each event
+/// \param variableId array with the external Ids of the variables expected with each event
+/// \return kFALSE if the header is not the expected one
+Bool_t QnCorrectionsEventContext::ReadStreamHeader(std::istream &stream, Int_t nVariables, const Int_t *variableId) {
+  char magic[sizeof(szStreamMagic)];
+  UInt_t header[2];
+  if (!stream.read(magic, sizeof(magic)) || memcmp(magic, szStreamMagic, sizeof(szStreamMagic)) != 0) return kFALSE;
+  if (!stream.read((char *) header, sizeof(header))) return kFALSE;
+  if (header[0] != nStreamVersion || header[1] != (UInt_t) nVariables) return kFALSE;
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    Int_t id;
+    if (!stream.read((char *) &id, sizeof(Int_t)) || id != variableId[ixVariable]) return kFALSE;
+  }
+  return kTRUE;
+}
+
+/// Writes the event input to a binary stream
+///
+/// The passed variables bank positions and the staged data vectors,
+/// with their blocks structure, are written in the native binary format,
+/// after a stream header written with WriteStreamHeader.
+/// \param stream the output stream, opened in binary mode
+/// \param nVariables the number of variables of the bank to write
+/// \param variableId array with the external Ids of the variables to write
+/// \return kTRUE if everything went OK
+Bool_t QnCorrectionsEventContext::WriteEvent(std::ostream &stream, Int_t nVariables, const Int_t *variableId) const {
+  Int_t header[4] = {fNoOfBlocks, fNoOfDataVectors, fNoOfVariableIds, fNoOfVariableValues};
+  stream.write((const char *) header, sizeof(header));
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    stream.write((const char *) &fDataContainer[variableId[ixVariable]], sizeof(Float_t));
+  }
+  stream.write((const char *) fBlockDetectorId, fNoOfBlocks * sizeof(Int_t));
+  stream.write((const char *) fBlockFirstDataVector, fNoOfBlocks * sizeof(Int_t));
+  stream.write((const char *) fBlockNoOfVariables, fNoOfBlocks * sizeof(Int_t));
+  stream.write((const char *) fBlockFirstVariableId, fNoOfBlocks * sizeof(Int_t));
+  stream.write((const char *) fBlockFirstVariableValue, fNoOfBlocks * sizeof(Int_t));
+  stream.write((const char *) fPhi, fNoOfDataVectors * sizeof(Float_t));
+  stream.write((const char *) fWeight, fNoOfDataVectors * sizeof(Float_t));
+  stream.write((const char *) fChannelId, fNoOfDataVectors * sizeof(Int_t));
+  stream.write((const char *) fVariableId, fNoOfVariableIds * sizeof(Int_t));
+  stream.write((const char *) fVariableValues, fNoOfVariableValues * sizeof(Float_t));
+  return stream.good();
+}
+
+/// Reads the event input from a binary stream
+///
+/// The staged data vectors are replaced by the read ones and the passed
+/// variables bank positions get the read values. The rest of the bank
+/// is not touched.
+///
+/// The event size declared by its header is checked against the bytes
+/// left in the stream before anything is allocated, and the blocks
+/// structure, the detector ids and the variables ids against the
+/// context and framework ranges once read. If any check fails the
+/// error is reported and the staged data vectors are cleared.
+/// \param stream the input stream, opened in binary mode, as written by WriteEvent
+/// \param nVariables the number of variables of the bank to read
+/// \param variableId array with the external Ids of the variables to read
+/// \param nAvailable the bytes left in the stream, decreased by the bytes read
+/// \return kFALSE if no complete and consistent event could be read
+Bool_t QnCorrectionsEventContext::ReadEvent(std::istream &stream, Int_t nVariables, const Int_t *variableId, Long64_t &nAvailable) {
+  Int_t header[4];
+  Clear();
+  if (nAvailable < (Long64_t) sizeof(header) || !stream.read((char *) header, sizeof(header))) return kFALSE;
+  if (header[0] < 0 || header[1] < 0 || header[2] < 0 || header[3] < 0) {
+    QnCorrectionsError("Events stream: negative counts in the event header");
+    return kFALSE;
+  }
+  Long64_t eventSize = sizeof(header) + (Long64_t) nVariables * sizeof(Float_t)
+      + (Long64_t) header[0] * 5 * sizeof(Int_t)
+      + (Long64_t) header[1] * (2 * sizeof(Float_t) + sizeof(Int_t))
+      + (Long64_t) header[2] * sizeof(Int_t)
+      + (Long64_t) header[3] * sizeof(Float_t);
+  if (nAvailable < eventSize) {
+    QnCorrectionsError(Form("Events stream: the event declares %lld bytes while only %lld are left", eventSize, nAvailable));
+    return kFALSE;
+  }
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    if (variableId[ixVariable] < 0 || !(variableId[ixVariable] < fNoOfVariables)) {
+      QnCorrectionsError(Form("Events stream: variable id %d out of the variables bank range [0, %d)", variableId[ixVariable], fNoOfVariables));
+      return kFALSE;
+    }
+    stream.read((char *) &fDataContainer[variableId[ixVariable]], sizeof(Float_t));
+  }
+  while (fBlocksCapacity < header[0]) ExpandBlocks();
+  if (fDataVectorsCapacity < header[1]) ExpandDataVectors(header[1]);
+  ExpandVariables(header[2], header[3]);
+  fNoOfBlocks = header[0];
+  fNoOfDataVectors = header[1];
+  fNoOfVariableIds = header[2];
+  fNoOfVariableValues = header[3];
+  stream.read((char *) fBlockDetectorId, fNoOfBlocks * sizeof(Int_t));
+  stream.read((char *) fBlockFirstDataVector, fNoOfBlocks * sizeof(Int_t));
+  stream.read((char *) fBlockNoOfVariables, fNoOfBlocks * sizeof(Int_t));
+  stream.read((char *) fBlockFirstVariableId, fNoOfBlocks * sizeof(Int_t));
+  stream.read((char *) fBlockFirstVariableValue, fNoOfBlocks * sizeof(Int_t));
+  stream.read((char *) fPhi, fNoOfDataVectors * sizeof(Float_t));
+  stream.read((char *) fWeight, fNoOfDataVectors * sizeof(Float_t));
+  stream.read((char *) fChannelId, fNoOfDataVectors * sizeof(Int_t));
+  stream.read((char *) fVariableId, fNoOfVariableIds * sizeof(Int_t));
+  stream.read((char *) fVariableValues, fNoOfVariableValues * sizeof(Float_t));
+  if (!stream.good()) {
+    Clear();
+    return kFALSE;
+  }
+  nAvailable -= eventSize;
+
+  /* the blocks must be consecutive and within the read arrays */
+  Bool_t valid = kTRUE;
+  for (Int_t ixBlock = 0; ixBlock < fNoOfBlocks && valid; ixBlock++) {
+    Int_t first = fBlockFirstDataVector[ixBlock];
+    Int_t next = (ixBlock + 1 < fNoOfBlocks) ? fBlockFirstDataVector[ixBlock + 1] : fNoOfDataVectors;
+    Int_t nBlockVariables = fBlockNoOfVariables[ixBlock];
+    valid = (fBlockDetectorId[ixBlock] >= 0) && (fBlockDetectorId[ixBlock] < QnCorrectionsManager::GetMaxNoOfDetectors())
+        && (first >= 0) && (first <= next) && (next <= fNoOfDataVectors) && (nBlockVariables >= 0);
+    if (valid && nBlockVariables > 0) {
+      Int_t firstId = fBlockFirstVariableId[ixBlock];
+      Int_t firstValue = fBlockFirstVariableValue[ixBlock];
+      valid = (firstId >= 0) && (nBlockVariables <= fNoOfVariableIds - firstId)
+          && (firstValue >= 0) && ((Long64_t) (next - first) * nBlockVariables <= fNoOfVariableValues - firstValue);
+      for (Int_t ixVariable = 0; ixVariable < nBlockVariables && valid; ixVariable++) {
+        valid = (fVariableId[firstId + ixVariable] >= 0) && (fVariableId[firstId + ixVariable] < fNoOfVariables);
+      }
+    }
+  }
+  if (!valid) {
+    QnCorrectionsError("Events stream: inconsistent data vectors blocks, detector or variable ids out of range");
+    Clear();
+    return kFALSE;
+  }
+  return kTRUE;
+}
+
+/// Builds the own copy of the Qn vectors list
+///
+/// The structure of the passed list, one list per detector configuration
+/// with its Qn vectors, is replicated but the Qn vectors are owned.
+/// \param qnVectorList the framework Qn vectors list
+void QnCorrectionsEventContext::BuildQnVectorList(const TList *qnVectorList) {
+  if (fQnVectorList != NULL) delete fQnVectorList;
+
+  fQnVectorList = new TList();
+  fQnVectorList->SetOwner(kTRUE);
+  TIter nextSource(qnVectorList);
+  TList *source;
+  while ((source = (TList *) nextSource()) != NULL) {
+    TList *configurationList = new TList();
+    configurationList->SetName(source->GetName());
+    configurationList->SetOwner(kTRUE);
+    TIter nextQnVector(source);
+    QnCorrectionsQnVector *qnVector;
+    while ((qnVector = (QnCorrectionsQnVector *) nextQnVector()) != NULL) {
+      configurationList->Add(new QnCorrectionsQnVector(*qnVector));
+    }
+    fQnVectorList->Add(configurationList);
+  }
+  fQnVectorListVersion++;
+}
+
+/// Stores the current event Qn vectors
+///
+/// The own copy of the Qn vectors list is built the first time and
+/// whenever the framework list changed its structure. Afterwards the
+/// Qn vectors are just refreshed.
+/// \param qnVectorList the framework Qn vectors list
+void QnCorrectionsEventContext::StoreQnVectors(const TList *qnVectorList) {
+  if (qnVectorList == NULL) return;
+
+  Bool_t rebuild = (fQnVectorList == NULL) || (fQnVectorList->GetEntries() != qnVectorList->GetEntries());
+  if (!rebuild) {
+    TIter nextSource(qnVectorList);
+    TIter nextTarget(fQnVectorList);
+    TList *source;
+    while (!rebuild && ((source = (TList *) nextSource()) != NULL)) {
+      TList *target = (TList *) nextTarget();
+      rebuild = (source->GetEntries() != target->GetEntries()) || !TString(source->GetName()).EqualTo(target->GetName());
+    }
+  }
+  if (rebuild) {
+    BuildQnVectorList(qnVectorList);
+    return;
+  }
+
+  TIter nextSource(qnVectorList);
+  TIter nextTarget(fQnVectorList);
+  TList *source;
+  while ((source = (TList *) nextSource()) != NULL) {
+    TIter nextSourceQnVector(source);
+    TIter nextTargetQnVector((TList *) nextTarget());
+    QnCorrectionsQnVector *qnVector;
+    while ((qnVector = (QnCorrectionsQnVector *) nextSourceQnVector()) != NULL) {
+      ((QnCorrectionsQnVector *) nextTargetQnVector())->Set(qnVector, kFALSE);
+    }
+  }
+}
+
+/// Get the detector configuration Qn vector list of the last processed event
+/// \param subdetector the name of the detector configuration of interest
+/// \return the found Qn vector list
+const TList *QnCorrectionsEventContext::GetDetectorQnVectorList(const char *subdetector) const {
+  if (fQnVectorList == NULL) return NULL;
+  return dynamic_cast<TList*> (fQnVectorList->FindObject(subdetector));
+}
+
+/// Get out of the detector configuration Qn vector list of the last processed event
+/// the Qn vector which complies the expected or alternative correction step
+/// \param subdetector the name of the detector configuration of interest
+/// \param expectedstep the name of the expected last correction applied
+/// \param altstep the name of the alternative correction step if the expected one is not found
+/// \return pointer to the found Qn vector
+const QnCorrectionsQnVector *QnCorrectionsEventContext::GetDetectorQnVector(
+    const char *subdetector,
+    const char *expectedstep,
+    const char *altstep) const {
+  return FindDetectorQnVector(fQnVectorList, subdetector, expectedstep, altstep);
+}
+
+/// Get out of a Qn vectors list the Qn vector of a detector configuration
+/// which complies the expected or alternative correction step
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+/// \param subdetector the name of the detector configuration of interest
+/// \param expectedstep the name of the expected last correction applied
+/// \param altstep the name of the alternative correction step if the expected one is not found
+/// \return pointer to the found Qn vector
+const QnCorrectionsQnVector *QnCorrectionsEventContext::FindDetectorQnVector(
+    const TList *qnVectorList,
+    const char *subdetector,
+    const char *expectedstep,
+    const char *altstep) {
+
+  const QnCorrectionsQnVector *theQnVector = NULL;
+
+  if (qnVectorList == NULL) return NULL;
+
+  TList *pQvecList = dynamic_cast<TList*> (qnVectorList->FindObject(subdetector));
+  if (pQvecList != NULL) {
+    /* the detector is present */
+    if (TString(expectedstep).EqualTo("latest"))
+      theQnVector = (QnCorrectionsQnVector*) pQvecList->First();
+    else
+      theQnVector = (QnCorrectionsQnVector*) pQvecList->FindObject(expectedstep);
+
+    if (theQnVector == NULL || !(theQnVector->IsGoodQuality()) || !(theQnVector->GetN() != 0)) {
+      /* the Qn vector for the expected step was not there or did not have the proper quality */
+      if (TString(altstep).EqualTo("latest"))
+        theQnVector = (QnCorrectionsQnVector*) pQvecList->First();
+      else
+        theQnVector = (QnCorrectionsQnVector*) pQvecList->FindObject(altstep);
+    }
+  }
+  if (theQnVector != NULL) {
+    /* check the Qn vector quality */
+    if (!(theQnVector->IsGoodQuality()) || !(theQnVector->GetN() != 0))
+      /* not good quality, discarded */
+      theQnVector = NULL;
+  }
+  return theQnVector;
+}
+
+/// Drops the staged data vectors
+///
+/// The variables bank content and the Qn vectors of the last processed
+/// event are kept until they are overwritten.
+/// \param option not used
+void QnCorrectionsEventContext::Clear(Option_t *) {
+  fNoOfDataVectors = 0;
+  fNoOfVariableIds = 0;
+  fNoOfVariableValues = 0;
+  fNoOfBlocks = 0;
+}
@@ -0,0 +1,166 @@
+#ifndef QNCORRECTIONS_EVENTCONTEXT_H
+#define QNCORRECTIONS_EVENTCONTEXT_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsEventContext.h
+/// \brief The per event state handed to the correction framework
+
+#include <TObject.h>
+#include <iosfwd>
+#include "QnCorrectionsQnVectorHandle.h"
+
+class TList;
+class QnCorrectionsDetector;
+
+/// \class QnCorrectionsEventContext
+/// \brief Holds the whole per event state: variables bank, data vectors and resulting Qn vectors
+///
+/// An event context is filled with the event variables and its data
+/// vectors independently of the framework, so that the next event can be
+/// prepared while the current one is being corrected. The data vectors
+/// are only staged; they are handed to the detectors, and checked against
+/// the detector configurations cuts, when the context is processed by
+/// QnCorrectionsManager::ProcessEvent. At that point the variables bank
+/// of the context has to hold the event variables; per data vector
+/// variables, the track charge for instance, must then be passed in the
+/// variables block of AddDataVectors instead of being written in the bank.
+///
+/// The variables bank, restricted to the passed variables, and the staged
+/// data vectors can be written to and read back from a binary stream so
+/// that the event input can be replayed. Unlike QnCorrectionsEventRecorder
+/// the values are kept exactly as staged, blocks structure included. The
+/// stream starts with a header, see WriteStreamHeader, and each event is
+/// checked against the bytes left in the stream and the framework ranges
+/// when read back.
+///
+/// Once processed the context keeps a copy of the corrected Qn vectors of
+/// the event, with the same structure as the manager Qn vectors list,
+/// which stays valid until the context is processed again.
+///
+/// Contexts are obtained from and returned to the manager pool, see
+/// QnCorrectionsManager::GetEventContext and QnCorrectionsManager::ClearEvent.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsEventContext : public TObject {
+public:
+  static const char szStreamMagic[4];  ///< the events stream identification
+  static const UInt_t nStreamVersion;  ///< the events stream format version
+
+  QnCorrectionsEventContext();
+  QnCorrectionsEventContext(Int_t nNoOfVariables);
+  virtual ~QnCorrectionsEventContext();
+
+  /// Gets a pointer to the context variables bank
+  /// \return the pointer to the data container
+  Float_t *GetDataContainer() { return fDataContainer; }
+  /// Gets the number of variables the bank supports
+  /// \return the variables bank size
+  Int_t GetNoOfVariables() const { return fNoOfVariables; }
+  /// Gets the number of staged data vectors
+  /// \return the number of data vectors
+  Int_t GetNoOfDataVectors() const { return fNoOfDataVectors; }
+
+  void AddDataVector(Int_t detectorId, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1);
+  void AddDataVectors(Int_t detectorId, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      Int_t nVariables = 0, const Int_t *variableId = NULL, const Float_t *variableValues = NULL);
+  Int_t DispatchDataVectors(QnCorrectionsDetector **detectorsIdMap);
+  Bool_t WriteEvent(std::ostream &stream, Int_t nVariables, const Int_t *variableId) const;
+  Bool_t ReadEvent(std::istream &stream, Int_t nVariables, const Int_t *variableId, Long64_t &nAvailable);
+  static Bool_t WriteStreamHeader(std::ostream &stream, Int_t nVariables, const Int_t *variableId);
+  static Bool_t ReadStreamHeader(std::istream &stream, Int_t nVariables, const Int_t *variableId);
+
+  void StoreQnVectors(const TList *qnVectorList);
+  /// Gets the Qn vectors of the last processed event
+  /// \return the list of detector configurations Qn vectors lists
+  TList *GetQnVectorList() const { return fQnVectorList; }
+  const TList *GetDetectorQnVectorList(const char *subdetector) const;
+  const QnCorrectionsQnVector *GetDetectorQnVector(const char *subdetector, const char *expectedstep = "latest", const char *altstep = "latest") const;
+  /// Gets the Qn vector a handle refers to out of the last processed event
+  /// \param handle the Qn vector handle, see QnCorrectionsManager::GetDetectorQnVectorHandle
+  /// \return the Qn vector, NULL if none with good quality
+  const QnCorrectionsQnVector *GetDetectorQnVector(QnCorrectionsQnVectorHandle &handle) const
+  { return handle.GetQnVector(fQnVectorList, fQnVectorListVersion); }
+  static const QnCorrectionsQnVector *FindDetectorQnVector(const TList *qnVectorList, const char *subdetector, const char *expectedstep, const char *altstep);
+
+  virtual void Clear(Option_t *option = "");
+
+private:
+  void ExpandDataVectors(Int_t nDataVectors);
+  void ExpandVariables(Int_t nVariableIds, Int_t nVariableValues);
+  void ExpandBlocks();
+  void BuildQnVectorList(const TList *qnVectorList);
+
+  Float_t *fDataContainer;            //!<! the variables bank
+  Int_t fNoOfVariables;               //!<! the variables bank size
+  Int_t fNoOfDataVectors;             //!<! the number of staged data vectors
+  Int_t fDataVectorsCapacity;         //!<! the allocated size of the data vectors arrays
+  Float_t *fPhi;                      //!<! array, the staged data vectors azimuthal angles
+  Float_t *fWeight;                   //!<! array, the staged data vectors weights
+  Int_t *fChannelId;                  //!<! array, the staged data vectors channel ids
+  Int_t fNoOfVariableIds;             //!<! the number of stored per data vector variables ids
+  Int_t fVariableIdsCapacity;         //!<! the allocated size of the variables ids array
+  Int_t *fVariableId;                 //!<! array, the per data vector variables ids of each block
+  Int_t fNoOfVariableValues;          //!<! the number of stored per data vector variables values
+  Int_t fVariableValuesCapacity;      //!<! the allocated size of the variables values array
+  Float_t *fVariableValues;           //!<! array, the per data vector variables values of each block
+  Int_t fNoOfBlocks;                  //!<! the number of staged data vectors blocks
+  Int_t fBlocksCapacity;              //!<! the allocated size of the blocks arrays
+  Int_t *fBlockDetectorId;            //!<! array, per block the external detector id
+  Int_t *fBlockFirstDataVector;       //!<! array, per block the position of its first data vector
+  Int_t *fBlockNoOfVariables;         //!<! array, per block the number of variables per data vector
+  Int_t *fBlockFirstVariableId;       //!<! array, per block the position of its first variable id
+  Int_t *fBlockFirstVariableValue;    //!<! array, per block the position of its first variable value
+  TList *fQnVectorList;               //!<! the copy of the Qn vectors of the last processed event, owned
+  Int_t fQnVectorListVersion;         //!<! the structure version of the Qn vectors list copy
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsEventContext(const QnCorrectionsEventContext &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsEventContext& operator= (const QnCorrectionsEventContext &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsEventContext, 2);
+/// \endcond
+};
+
+/// Stages a new data vector
+///
+/// Consecutive data vectors of the same detector are kept in the same
+/// block so that they are handed in one go to the detector.
+/// \param detectorId id of the involved detector
+/// \param phi azimuthal angle
+/// \param weight the weight of the data vector
+/// \param channelId the channel Id that originates the data vector
+inline void QnCorrectionsEventContext::AddDataVector(Int_t detectorId, Double_t phi, Double_t weight, Int_t channelId) {
+  if (!((fNoOfBlocks > 0) && (fBlockDetectorId[fNoOfBlocks - 1] == detectorId) && (fBlockNoOfVariables[fNoOfBlocks - 1] == 0))) {
+    if (!(fNoOfBlocks < fBlocksCapacity)) ExpandBlocks();
+    fBlockDetectorId[fNoOfBlocks] = detectorId;
+    fBlockFirstDataVector[fNoOfBlocks] = fNoOfDataVectors;
+    fBlockNoOfVariables[fNoOfBlocks] = 0;
+    fBlockFirstVariableId[fNoOfBlocks] = fNoOfVariableIds;
+    fBlockFirstVariableValue[fNoOfBlocks] = fNoOfVariableValues;
+    fNoOfBlocks++;
+  }
+  if (!(fNoOfDataVectors < fDataVectorsCapacity)) ExpandDataVectors(fNoOfDataVectors + 1);
+  fPhi[fNoOfDataVectors] = phi;
+  fWeight[fNoOfDataVectors] = weight;
+  fChannelId[fNoOfDataVectors] = channelId;
+  fNoOfDataVectors++;
+}
+
+#endif /* QNCORRECTIONS_EVENTCONTEXT_H */
@@ -0,0 +1,526 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsEventGenerator.cxx
+/// \brief Implementation of the synthetic events generator
+
+#include <TMath.h>
+#include <TRandom3.h>
+
+#include "QnCorrectionsManager.h"
+#include "QnCorrectionsEventContext.h"
+#include "QnCorrectionsEventGenerator.h"
+#include "QnCorrectionsLog.h"
+
+/// the number of independent lanes of the fast random numbers generator
+#define FASTRANDOMNOOFLANES 8
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsEventGenerator);
+/// \endcond
+
+/// Default constructor
+///
+/// The generator is seeded with the TRandom3 default seed.
+QnCorrectionsEventGenerator::QnCorrectionsEventGenerator() : TObject(),
+    fEventVariableId(), fEventVariableMin(), fEventVariableMax(), fFlowHarmonic(), fFlowVn(),
+    fHoleMin(), fHoleMax(), fHoleEfficiency(), fChannelGain(), fChannelPhi(), fChannelId(),
+    fEventVariables(), fReactionPlane(), fMultiplicity(), fFirstTrack(), fTrackPhi(), fTrackCharge(),
+    fChannelWeight(), fCandidatePhi(), fCandidateTest() {
+  fSeed = 0;
+  fFastRandom = kFALSE;
+  fCentralityIndex = -1;
+  fMultiplicityDistribution = kFixedMultiplicity;
+  fMultiplicityPar1 = 0.0;
+  fMultiplicityPar2 = 0.0;
+  fTracksDetectorId = -1;
+  fChargeVarId = -1;
+  fPositiveFraction = 0.5;
+  fChannelsDetectorId = -1;
+  fNoOfChannels = 0;
+  fNoOfSectors = 1;
+  fRotation = 0.0;
+  fChannelsSignalScale = 1.0;
+  fRandom = new TRandom3();
+  fFastState = new UInt_t[4 * FASTRANDOMNOOFLANES];
+  fNoOfEvents = 0;
+  fFirstTrack.push_back(0);
+  SetSeed(4357);
+}
+
+/// Normal constructor
+/// \param seed the random seed
+QnCorrectionsEventGenerator::QnCorrectionsEventGenerator(UInt_t seed) : TObject(),
+    fEventVariableId(), fEventVariableMin(), fEventVariableMax(), fFlowHarmonic(), fFlowVn(),
+    fHoleMin(), fHoleMax(), fHoleEfficiency(), fChannelGain(), fChannelPhi(), fChannelId(),
+    fEventVariables(), fReactionPlane(), fMultiplicity(), fFirstTrack(), fTrackPhi(), fTrackCharge(),
+    fChannelWeight(), fCandidatePhi(), fCandidateTest() {
+  fSeed = 0;
+  fFastRandom = kFALSE;
+  fCentralityIndex = -1;
+  fMultiplicityDistribution = kFixedMultiplicity;
+  fMultiplicityPar1 = 0.0;
+  fMultiplicityPar2 = 0.0;
+  fTracksDetectorId = -1;
+  fChargeVarId = -1;
+  fPositiveFraction = 0.5;
+  fChannelsDetectorId = -1;
+  fNoOfChannels = 0;
+  fNoOfSectors = 1;
+  fRotation = 0.0;
+  fChannelsSignalScale = 1.0;
+  fRandom = new TRandom3();
+  fFastState = new UInt_t[4 * FASTRANDOMNOOFLANES];
+  fNoOfEvents = 0;
+  fFirstTrack.push_back(0);
+  SetSeed(seed);
+}
+
+/// Default destructor
+QnCorrectionsEventGenerator::~QnCorrectionsEventGenerator() {
+  delete fRandom;
+  delete [] fFastState;
+}
+
+/// Sets the random seed
+///
+/// Both random numbers paths are restarted. The fast path lanes
+/// states are derived from the seed with the splitmix64 sequence.
+/// \param seed the random seed
+void QnCorrectionsEventGenerator::SetSeed(UInt_t seed) {
+  fSeed = seed;
+  fRandom->SetSeed(seed);
+
+  ULong64_t x = seed;
+  for (Int_t ixWord = 0; ixWord < 4 * FASTRANDOMNOOFLANES; ixWord += 2) {
+    x += 0x9E3779B97F4A7C15ULL;
+    ULong64_t z = x;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+    fFastState[ixWord] = UInt_t(z);
+    fFastState[ixWord + 1] = UInt_t(z >> 32);
+  }
+}
+
+/// Adds an event variable
+///
+/// The variable values are uniformly distributed within the passed range.
+/// \param varId the variable id in the variables bank
+/// \param min the range lower limit
+/// \param max the range upper limit
+void QnCorrectionsEventGenerator::AddEventVariable(Int_t varId, Double_t min, Double_t max) {
+  fEventVariableId.push_back(varId);
+  fEventVariableMin.push_back(min);
+  fEventVariableMax.push_back(max);
+}
+
+/// Adds the centrality event variable
+///
+/// The centrality drives the kCentralityMultiplicity distribution; the
+/// multiplicity decreases from the lower to the upper range limit.
+/// \param varId the variable id in the variables bank
+/// \param min the range lower limit
+/// \param max the range upper limit
+void QnCorrectionsEventGenerator::SetCentralityVariable(Int_t varId, Double_t min, Double_t max) {
+  fCentralityIndex = fEventVariableId.size();
+  AddEventVariable(varId, min, max);
+}
+
+/// Sets the multiplicity distribution
+/// \param distribution the distribution
+/// \param par1 the first distribution parameter
+/// \param par2 the second distribution parameter
+void QnCorrectionsEventGenerator::SetMultiplicity(MultiplicityDistribution distribution, Double_t par1, Double_t par2) {
+  fMultiplicityDistribution = distribution;
+  fMultiplicityPar1 = par1;
+  fMultiplicityPar2 = par2;
+}
+
+/// Sets the flow coefficient of an harmonic
+/// \param harmonic the harmonic number
+/// \param vn the flow coefficient
+void QnCorrectionsEventGenerator::SetFlow(Int_t harmonic, Double_t vn) {
+  if (harmonic < 1) {
+    QnCorrectionsError(Form("Wrong harmonic %d for the flow coefficient", harmonic));
+    return;
+  }
+  for (UInt_t ix = 0; ix < fFlowHarmonic.size(); ix++) {
+    if (fFlowHarmonic[ix] == harmonic) {
+      fFlowVn[ix] = vn;
+      return;
+    }
+  }
+  fFlowHarmonic.push_back(harmonic);
+  fFlowVn.push_back(vn);
+}
+
+/// Adds an acceptance hole to the tracking detector
+///
+/// The particles with azimuthal angle within [phiMin, phiMax) are only
+/// detected with the passed efficiency. The angles are within \f$ [0, 2\pi) \f$.
+/// \param phiMin the hole lower limit
+/// \param phiMax the hole upper limit
+/// \param efficiency the detection efficiency within the hole
+void QnCorrectionsEventGenerator::AddAcceptanceHole(Double_t phiMin, Double_t phiMax, Double_t efficiency) {
+  fHoleMin.push_back(phiMin);
+  fHoleMax.push_back(phiMax);
+  fHoleEfficiency.push_back(efficiency);
+}
+
+/// Sets the tracking detector
+/// \param detectorId the detector id, -1 for no tracking detector
+/// \param chargeVarId the id of the track charge variable, -1 for not passing the charge
+/// \param positiveFraction the fraction of positive tracks
+void QnCorrectionsEventGenerator::SetTracksDetector(Int_t detectorId, Int_t chargeVarId, Double_t positiveFraction) {
+  fTracksDetectorId = detectorId;
+  fChargeVarId = chargeVarId;
+  fPositiveFraction = positiveFraction;
+}
+
+/// Sets the channelized detector
+///
+/// The channels gains are set to one.
+/// \param detectorId the detector id, -1 for no channelized detector
+/// \param nChannels the number of channels
+/// \param nSectors the number of azimuthal sectors the channels are distributed in
+/// \param rotation the rotation of the sectors with respect to their nominal position
+void QnCorrectionsEventGenerator::SetChannelsDetector(Int_t detectorId, Int_t nChannels, Int_t nSectors, Double_t rotation) {
+  if (detectorId < 0) {
+    fChannelsDetectorId = -1;
+    fNoOfChannels = 0;
+    return;
+  }
+  if (nChannels < 1 || nSectors < 1) {
+    QnCorrectionsError(Form("Wrong channelized detector with %d channels in %d sectors", nChannels, nSectors));
+    return;
+  }
+  fChannelsDetectorId = detectorId;
+  fNoOfChannels = nChannels;
+  fNoOfSectors = nSectors;
+  fRotation = rotation;
+  fChannelGain.assign(nChannels, 1.0);
+  fChannelPhi.resize(nChannels);
+  fChannelId.resize(nChannels);
+  for (Int_t ixChannel = 0; ixChannel < nChannels; ixChannel++) {
+    fChannelPhi[ixChannel] = (ixChannel % nSectors) * TMath::TwoPi() / nSectors + rotation;
+    fChannelId[ixChannel] = ixChannel;
+  }
+}
+
+/// Sets the channels gains of the channelized detector
+/// \param gains array with the gain of each channel
+void QnCorrectionsEventGenerator::SetChannelGains(const Float_t *gains) {
+  if (fNoOfChannels == 0) {
+    QnCorrectionsError("The channelized detector has to be set before its gains");
+    return;
+  }
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    fChannelGain[ixChannel] = gains[ixChannel];
+  }
+}
+
+/// Generates uniform random numbers in the bulk path
+///
+/// They come from the fast path or from the standard generator
+/// as selected.
+/// \param n the number of random numbers
+/// \param values the array to store them
+void QnCorrectionsEventGenerator::Uniform(Int_t n, Float_t *values) {
+  if (fFastRandom)
+    FastUniform(n, values);
+  else
+    fRandom->RndmArray(n, values);
+}
+
+/// Generates uniform random numbers within [0,1) in the fast path
+///
+/// The xoshiro128+ generator runs on several independent lanes kept
+/// in local arrays, so that the lanes loop is vectorized. Each random
+/// number takes the upper 24 bits of the lane output.
+/// \param n the number of random numbers
+/// \param values the array to store them
+void QnCorrectionsEventGenerator::FastUniform(Int_t n, Float_t *values) {
+  const Float_t scale = 1.0f / 16777216.0f;
+  UInt_t s0[FASTRANDOMNOOFLANES];
+  UInt_t s1[FASTRANDOMNOOFLANES];
+  UInt_t s2[FASTRANDOMNOOFLANES];
+  UInt_t s3[FASTRANDOMNOOFLANES];
+  UInt_t result[FASTRANDOMNOOFLANES];
+
+  for (Int_t lane = 0; lane < FASTRANDOMNOOFLANES; lane++) {
+    s0[lane] = fFastState[lane];
+    s1[lane] = fFastState[FASTRANDOMNOOFLANES + lane];
+    s2[lane] = fFastState[2 * FASTRANDOMNOOFLANES + lane];
+    s3[lane] = fFastState[3 * FASTRANDOMNOOFLANES + lane];
+  }
+
+  Int_t ix = 0;
+  while (ix < n) {
+    for (Int_t lane = 0; lane < FASTRANDOMNOOFLANES; lane++) {
+      result[lane] = s0[lane] + s3[lane];
+      UInt_t t = s1[lane] << 9;
+      s2[lane] ^= s0[lane];
+      s3[lane] ^= s1[lane];
+      s1[lane] ^= s2[lane];
+      s0[lane] ^= s3[lane];
+      s2[lane] ^= t;
+      s3[lane] = (s3[lane] << 11) | (s3[lane] >> 21);
+    }
+    Int_t nBlock = ((n - ix) < FASTRANDOMNOOFLANES) ? (n - ix) : FASTRANDOMNOOFLANES;
+    for (Int_t lane = 0; lane < nBlock; lane++) {
+      values[ix + lane] = (result[lane] >> 8) * scale;
+    }
+    ix += nBlock;
+  }
+
+  for (Int_t lane = 0; lane < FASTRANDOMNOOFLANES; lane++) {
+    fFastState[lane] = s0[lane];
+    fFastState[FASTRANDOMNOOFLANES + lane] = s1[lane];
+    fFastState[2 * FASTRANDOMNOOFLANES + lane] = s2[lane];
+    fFastState[3 * FASTRANDOMNOOFLANES + lane] = s3[lane];
+  }
+}
+
+/// Generates the number of produced particles of an event
+/// \param eventVariables the event variables values
+/// \return the event multiplicity
+Int_t QnCorrectionsEventGenerator::GenerateMultiplicity(const Float_t *eventVariables) {
+  Double_t multiplicity = 0.0;
+  switch (fMultiplicityDistribution) {
+  case kFixedMultiplicity:
+    multiplicity = fMultiplicityPar1;
+    break;
+  case kUniformMultiplicity:
+    multiplicity = fRandom->Uniform(fMultiplicityPar1, fMultiplicityPar2 + 1.0);
+    break;
+  case kPoissonMultiplicity:
+    multiplicity = fRandom->Poisson(fMultiplicityPar1);
+    break;
+  case kGaussianMultiplicity:
+    multiplicity = fRandom->Gaus(fMultiplicityPar1, fMultiplicityPar2);
+    break;
+  case kCentralityMultiplicity: {
+      Double_t min = fEventVariableMin[fCentralityIndex];
+      Double_t max = fEventVariableMax[fCentralityIndex];
+      Double_t fraction = (max - eventVariables[fCentralityIndex]) / (max - min);
+      multiplicity = fMultiplicityPar1 + fRandom->Rndm() * fraction * fMultiplicityPar2;
+    }
+    break;
+  default:
+    break;
+  }
+  return (multiplicity < 0.0) ? 0 : Int_t(multiplicity);
+}
+
+/// Generates the detected tracks of an event and appends them to the batch
+///
+/// The produced particles azimuthal angles are obtained by acceptance
+/// rejection against the flow modulation, computed in vectorizable
+/// loops over blocks of candidates. The acceptance holes are then
+/// applied and the charges assigned.
+/// \param nMultiplicity the number of produced particles
+/// \param psiRP the reaction plane angle
+void QnCorrectionsEventGenerator::GenerateTracks(Int_t nMultiplicity, Double_t psiRP) {
+  Int_t nFirst = fTrackPhi.size();
+  fTrackPhi.resize(nFirst + nMultiplicity);
+  fTrackCharge.resize(nFirst + nMultiplicity);
+  Float_t *phi = &fTrackPhi[nFirst];
+
+  Double_t maxModulation = 1.0;
+  for (UInt_t h = 0; h < fFlowVn.size(); h++) {
+    maxModulation += 2.0 * TMath::Abs(fFlowVn[h]);
+  }
+
+  /* the produced particles */
+  Int_t nProduced = 0;
+  while (nProduced < nMultiplicity) {
+    /* as many candidates as expected to be needed */
+    Int_t nCandidates = Int_t((nMultiplicity - nProduced) * maxModulation) + FASTRANDOMNOOFLANES;
+    if (fCandidatePhi.size() < UInt_t(nCandidates)) {
+      fCandidatePhi.resize(nCandidates);
+      fCandidateTest.resize(nCandidates);
+    }
+    Float_t *candidatePhi = &fCandidatePhi[0];
+    Float_t *candidateTest = &fCandidateTest[0];
+    Uniform(nCandidates, candidatePhi);
+    Uniform(nCandidates, candidateTest);
+    for (Int_t ix = 0; ix < nCandidates; ix++) {
+      candidatePhi[ix] = candidatePhi[ix] * TMath::TwoPi();
+      candidateTest[ix] = candidateTest[ix] * maxModulation - 1.0;
+    }
+    /* accepted if below the modulation */
+    for (UInt_t h = 0; h < fFlowHarmonic.size(); h++) {
+      Float_t twoVn = 2.0 * fFlowVn[h];
+      Float_t harmonic = fFlowHarmonic[h];
+      for (Int_t ix = 0; ix < nCandidates; ix++) {
+        candidateTest[ix] -= twoVn * TMath::Cos(harmonic * (candidatePhi[ix] - psiRP));
+      }
+    }
+    for (Int_t ix = 0; (ix < nCandidates) && (nProduced < nMultiplicity); ix++) {
+      if (candidateTest[ix] < 0.0) {
+        phi[nProduced] = candidatePhi[ix];
+        nProduced++;
+      }
+    }
+  }
+
+  /* the acceptance holes and the charges */
+  if (fCandidatePhi.size() < UInt_t(nMultiplicity)) {
+    fCandidatePhi.resize(nMultiplicity);
+    fCandidateTest.resize(nMultiplicity);
+  }
+  Float_t *holeTest = &fCandidateTest[0];
+  Float_t *chargeTest = &fCandidatePhi[0];
+  Float_t *charge = &fTrackCharge[nFirst];
+  Uniform(nMultiplicity, holeTest);
+  Uniform(nMultiplicity, chargeTest);
+  Int_t nDetected = 0;
+  for (Int_t ix = 0; ix < nMultiplicity; ix++) {
+    Bool_t detected = kTRUE;
+    for (UInt_t ixHole = 0; ixHole < fHoleMin.size(); ixHole++) {
+      if (!(phi[ix] < fHoleMin[ixHole]) && (phi[ix] < fHoleMax[ixHole]) && !(holeTest[ix] < fHoleEfficiency[ixHole])) {
+        detected = kFALSE;
+        break;
+      }
+    }
+    if (!detected) continue;
+    phi[nDetected] = phi[ix];
+    charge[nDetected] = (chargeTest[ix] < fPositiveFraction) ? 1.0 : -1.0;
+    nDetected++;
+  }
+  fTrackPhi.resize(nFirst + nDetected);
+  fTrackCharge.resize(nFirst + nDetected);
+}
+
+/// Generates the channels signals of an event
+///
+/// The flow modulation is taken at the sectors nominal positions, the
+/// detector rotation being an effect to be corrected.
+/// \param nMultiplicity the number of produced particles
+/// \param psiRP the reaction plane angle
+/// \param weights the array to store the channels signals
+void QnCorrectionsEventGenerator::GenerateChannels(Int_t nMultiplicity, Double_t psiRP, Float_t *weights) {
+  Double_t scale = fChannelsSignalScale * nMultiplicity / fNoOfChannels;
+  Uniform(fNoOfChannels, weights);
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    Double_t modulation = 1.0;
+    for (UInt_t h = 0; h < fFlowHarmonic.size(); h++) {
+      modulation += 2.0 * fFlowVn[h] * TMath::Cos(fFlowHarmonic[h] * (fChannelPhi[ixChannel] - fRotation - psiRP));
+    }
+    weights[ixChannel] *= fChannelGain[ixChannel] * scale * modulation;
+  }
+}
+
+/// Generates a new batch of events
+///
+/// The previous batch is discarded.
+/// \param nEvents the number of events of the batch
+void QnCorrectionsEventGenerator::GenerateEvents(Int_t nEvents) {
+  if (fMultiplicityDistribution == kCentralityMultiplicity && fCentralityIndex < 0) {
+    QnCorrectionsFatal("The centrality multiplicity distribution needs the centrality variable. FIX IT, PLEASE.");
+    return;
+  }
+  Int_t nVariables = fEventVariableId.size();
+
+  fNoOfEvents = nEvents;
+  fEventVariables.resize(nEvents * nVariables);
+  fReactionPlane.resize(nEvents);
+  fMultiplicity.resize(nEvents);
+  fFirstTrack.resize(nEvents + 1);
+  fFirstTrack[0] = 0;
+  fTrackPhi.clear();
+  fTrackCharge.clear();
+  fChannelWeight.resize(nEvents * fNoOfChannels);
+
+  for (Int_t ixEvent = 0; ixEvent < nEvents; ixEvent++) {
+    Float_t *eventVariables = (nVariables > 0) ? &fEventVariables[ixEvent * nVariables] : NULL;
+    for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+      eventVariables[ixVariable] = fRandom->Uniform(fEventVariableMin[ixVariable], fEventVariableMax[ixVariable]);
+    }
+    Double_t psiRP = fRandom->Uniform(0.0, TMath::TwoPi());
+    fReactionPlane[ixEvent] = psiRP;
+    Int_t nMultiplicity = GenerateMultiplicity(eventVariables);
+    fMultiplicity[ixEvent] = nMultiplicity;
+
+    if (fTracksDetectorId >= 0)
+      GenerateTracks(nMultiplicity, psiRP);
+    fFirstTrack[ixEvent + 1] = fTrackPhi.size();
+    if (fChannelsDetectorId >= 0)
+      GenerateChannels(nMultiplicity, psiRP, &fChannelWeight[ixEvent * fNoOfChannels]);
+  }
+}
+
+/// Hands an event of the current batch to the framework manager
+///
+/// The event variables are stored in the manager variables bank and
+/// the data vectors of each detector are added in one go. The track
+/// charge, if its variable was declared, goes as per data vector variable.
+/// \param manager the framework manager
+/// \param ixEvent the event within the batch
+void QnCorrectionsEventGenerator::FeedEvent(QnCorrectionsManager *manager, Int_t ixEvent) const {
+  Float_t *dataContainer = manager->GetDataContainer();
+  Int_t nVariables = fEventVariableId.size();
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    dataContainer[fEventVariableId[ixVariable]] = fEventVariables[ixEvent * nVariables + ixVariable];
+  }
+
+  if (fChannelsDetectorId >= 0)
+    manager->AddDataVectors(fChannelsDetectorId, &fChannelPhi[0], GetChannelWeight(ixEvent), &fChannelId[0], fNoOfChannels);
+  Int_t nTracks = GetNoOfTracks(ixEvent);
+  if ((fTracksDetectorId >= 0) && (nTracks > 0)) {
+    if (fChargeVarId >= 0)
+      manager->AddDataVectors(fTracksDetectorId, GetTrackPhi(ixEvent), NULL, NULL, nTracks, 1, &fChargeVarId, GetTrackCharge(ixEvent));
+    else
+      manager->AddDataVectors(fTracksDetectorId, GetTrackPhi(ixEvent), NULL, NULL, nTracks);
+  }
+}
+
+/// Hands an event of the current batch to an event context
+/// \param context the event context
+/// \param ixEvent the event within the batch
+void QnCorrectionsEventGenerator::FeedEvent(QnCorrectionsEventContext *context, Int_t ixEvent) const {
+  Float_t *dataContainer = context->GetDataContainer();
+  Int_t nVariables = fEventVariableId.size();
+  for (Int_t ixVariable = 0; ixVariable < nVariables; ixVariable++) {
+    dataContainer[fEventVariableId[ixVariable]] = fEventVariables[ixEvent * nVariables + ixVariable];
+  }
+
+  if (fChannelsDetectorId >= 0)
+    context->AddDataVectors(fChannelsDetectorId, &fChannelPhi[0], GetChannelWeight(ixEvent), &fChannelId[0], fNoOfChannels);
+  Int_t nTracks = GetNoOfTracks(ixEvent);
+  if ((fTracksDetectorId >= 0) && (nTracks > 0)) {
+    if (fChargeVarId >= 0)
+      context->AddDataVectors(fTracksDetectorId, GetTrackPhi(ixEvent), NULL, NULL, nTracks, 1, &fChargeVarId, GetTrackCharge(ixEvent));
+    else
+      context->AddDataVectors(fTracksDetectorId, GetTrackPhi(ixEvent), NULL, NULL, nTracks);
+  }
+}
@@ -0,0 +1,193 @@
+#ifndef QNCORRECTIONS_EVENTGENERATOR_H
+#define QNCORRECTIONS_EVENTGENERATOR_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsEventGenerator.h
+/// \brief Synthetic events generator for feeding the framework
+
+#include <TObject.h>
+#include <vector>
+
+class TRandom;
+class QnCorrectionsManager;
+class QnCorrectionsEventContext;
+
+/// \class QnCorrectionsEventGenerator
+/// \brief Generates reproducible synthetic events and hands them to the framework
+///
+/// Each event has a set of event variables, uniformly distributed
+/// within their configured ranges, a random reaction plane and, if
+/// configured, the data vectors of a tracking detector and of a
+/// channelized detector.
+///
+/// The number of produced particles follows the configured multiplicity
+/// distribution. Their azimuthal angles follow
+/// \f[
+///    \frac{dN}{d\varphi} \propto 1 + 2 \sum_n v_n \cos(n(\varphi - \Psi_{RP}))
+/// \f]
+/// with the configured \f$ v_n \f$ values. Particles falling within an
+/// acceptance hole are only detected with the hole efficiency. Each
+/// detected track gets a charge, positive with the configured fraction,
+/// which is passed as a per data vector variable if a charge variable
+/// was declared.
+///
+/// The channelized detector channels are distributed in sectors, the
+/// azimuthal angle of a channel being the one of its sector plus an
+/// overall rotation. The signal of each channel is a uniform random
+/// fraction of its gain times the signal scale times the event
+/// multiplicity per channel, modulated with the same flow.
+///
+/// Events are generated in batches, so that they can be prepared out of
+/// a timed loop, and each of them is later handed to a framework manager
+/// or an event context through the usual AddDataVectors interface.
+///
+/// The per event quantities are drawn from a TRandom3 generator. The
+/// bulk of random numbers, the per track and per channel ones, are
+/// drawn from it as well unless the fast path is selected. In that case
+/// they come from an inlined xoshiro128+ generator running several
+/// independent lanes, whose loop the compiler vectorizes. Both paths
+/// are reproducible for a given seed but produce different events.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsEventGenerator : public TObject {
+public:
+  /// The supported multiplicity distributions
+  enum MultiplicityDistribution {
+    kFixedMultiplicity = 0,      ///< always the first parameter
+    kUniformMultiplicity,        ///< uniform between the two parameters
+    kPoissonMultiplicity,        ///< Poisson with the first parameter as mean
+    kGaussianMultiplicity,       ///< Gaussian with the first parameter as mean and the second as sigma, truncated at zero
+    kCentralityMultiplicity      ///< the first parameter plus a uniform fraction, decreasing with centrality, of the second one
+  };
+
+  QnCorrectionsEventGenerator();
+  QnCorrectionsEventGenerator(UInt_t seed);
+  virtual ~QnCorrectionsEventGenerator();
+
+  void SetSeed(UInt_t seed);
+  /// Selects the fast random numbers path for the per track and per channel random numbers
+  /// \param fast kTRUE for the fast path
+  void SetFastRandom(Bool_t fast = kTRUE) { fFastRandom = fast; }
+  void AddEventVariable(Int_t varId, Double_t min, Double_t max);
+  void SetCentralityVariable(Int_t varId, Double_t min = 0.0, Double_t max = 100.0);
+  void SetMultiplicity(MultiplicityDistribution distribution, Double_t par1, Double_t par2 = 0.0);
+  void SetFlow(Int_t harmonic, Double_t vn);
+  void AddAcceptanceHole(Double_t phiMin, Double_t phiMax, Double_t efficiency = 0.0);
+  void SetTracksDetector(Int_t detectorId, Int_t chargeVarId = -1, Double_t positiveFraction = 0.5);
+  void SetChannelsDetector(Int_t detectorId, Int_t nChannels, Int_t nSectors, Double_t rotation = 0.0);
+  void SetChannelGains(const Float_t *gains);
+  /// Sets the channels signal scale
+  /// \param scale the mean channel signal, at unit gain and no flow, in units of the event multiplicity per channel
+  void SetChannelsSignalScale(Double_t scale) { fChannelsSignalScale = scale; }
+
+  void GenerateEvents(Int_t nEvents);
+  /// Generates a batch of just one event
+  void GenerateEvent() { GenerateEvents(1); }
+
+  /// Gets the number of events of the current batch
+  /// \return the number of events
+  Int_t GetNoOfEvents() const { return fNoOfEvents; }
+  /// Gets the reaction plane of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the reaction plane angle
+  Float_t GetReactionPlane(Int_t ixEvent = 0) const { return fReactionPlane[ixEvent]; }
+  /// Gets the number of produced particles of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the event multiplicity
+  Int_t GetMultiplicity(Int_t ixEvent = 0) const { return fMultiplicity[ixEvent]; }
+  /// Gets the number of detected tracks of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the number of tracks
+  Int_t GetNoOfTracks(Int_t ixEvent = 0) const { return fFirstTrack[ixEvent + 1] - fFirstTrack[ixEvent]; }
+  /// Gets the tracks azimuthal angles of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the azimuthal angles array
+  const Float_t *GetTrackPhi(Int_t ixEvent = 0) const { return &fTrackPhi[fFirstTrack[ixEvent]]; }
+  /// Gets the tracks charges of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the charges array
+  const Float_t *GetTrackCharge(Int_t ixEvent = 0) const { return &fTrackCharge[fFirstTrack[ixEvent]]; }
+  /// Gets the channels signals of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the signals array
+  const Float_t *GetChannelWeight(Int_t ixEvent = 0) const { return &fChannelWeight[ixEvent * fNoOfChannels]; }
+  /// Gets the event variables values of an event of the current batch
+  /// \param ixEvent the event within the batch
+  /// \return the event variables values in the order they were added
+  const Float_t *GetEventVariables(Int_t ixEvent = 0) const { return &fEventVariables[ixEvent * fEventVariableId.size()]; }
+
+  void FeedEvent(QnCorrectionsManager *manager, Int_t ixEvent = 0) const;
+  void FeedEvent(QnCorrectionsEventContext *context, Int_t ixEvent = 0) const;
+
+private:
+  Int_t GenerateMultiplicity(const Float_t *eventVariables);
+  void GenerateTracks(Int_t nMultiplicity, Double_t psiRP);
+  void GenerateChannels(Int_t nMultiplicity, Double_t psiRP, Float_t *weights);
+  void Uniform(Int_t n, Float_t *values);
+  void FastUniform(Int_t n, Float_t *values);
+
+  UInt_t fSeed;                                ///< the random seed
+  Bool_t fFastRandom;                          ///< kTRUE if the bulk random numbers come from the fast path
+  std::vector<Int_t> fEventVariableId;         ///< the event variables ids
+  std::vector<Float_t> fEventVariableMin;      ///< the event variables lower limits
+  std::vector<Float_t> fEventVariableMax;      ///< the event variables upper limits
+  Int_t fCentralityIndex;                      ///< the position of the centrality among the event variables, -1 if none
+  Int_t fMultiplicityDistribution;             ///< the multiplicity distribution
+  Double_t fMultiplicityPar1;                  ///< the first multiplicity distribution parameter
+  Double_t fMultiplicityPar2;                  ///< the second multiplicity distribution parameter
+  std::vector<Int_t> fFlowHarmonic;            ///< the harmonics with flow
+  std::vector<Float_t> fFlowVn;                ///< the flow coefficient of each harmonic with flow
+  std::vector<Float_t> fHoleMin;               ///< the acceptance holes lower limits
+  std::vector<Float_t> fHoleMax;               ///< the acceptance holes upper limits
+  std::vector<Float_t> fHoleEfficiency;        ///< the acceptance holes efficiencies
+  Int_t fTracksDetectorId;                     ///< the tracking detector id, -1 if none
+  Int_t fChargeVarId;                          ///< the track charge variable id, -1 if none
+  Double_t fPositiveFraction;                  ///< the fraction of positive tracks
+  Int_t fChannelsDetectorId;                   ///< the channelized detector id, -1 if none
+  Int_t fNoOfChannels;                         ///< the number of channels of the channelized detector
+  Int_t fNoOfSectors;                          ///< the number of sectors of the channelized detector
+  Double_t fRotation;                          ///< the rotation of the channelized detector sectors
+  Double_t fChannelsSignalScale;               ///< the channels mean signal in units of the multiplicity per channel
+  std::vector<Float_t> fChannelGain;           ///< the channels gains
+  std::vector<Float_t> fChannelPhi;            //!<! the channels azimuthal angles
+  std::vector<Int_t> fChannelId;               //!<! the channels ids
+
+  TRandom *fRandom;                            //!<! the per event, and standard path, random numbers generator
+  UInt_t *fFastState;                          //!<! the fast random numbers generator state, four words per lane, word major
+  Int_t fNoOfEvents;                           //!<! the number of events of the current batch
+  std::vector<Float_t> fEventVariables;        //!<! the event variables values, event major
+  std::vector<Float_t> fReactionPlane;         //!<! the events reaction planes
+  std::vector<Int_t> fMultiplicity;            //!<! the events multiplicities
+  std::vector<Int_t> fFirstTrack;              //!<! the first track of each event plus the end
+  std::vector<Float_t> fTrackPhi;              //!<! the tracks azimuthal angles
+  std::vector<Float_t> fTrackCharge;           //!<! the tracks charges
+  std::vector<Float_t> fChannelWeight;         //!<! the channels signals, event major
+  std::vector<Float_t> fCandidatePhi;          //!<! work area for the candidate particles azimuthal angles
+  std::vector<Float_t> fCandidateTest;         //!<! work area for the candidate particles random numbers
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsEventGenerator(const QnCorrectionsEventGenerator &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsEventGenerator& operator= (const QnCorrectionsEventGenerator &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsEventGenerator, 1);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_EVENTGENERATOR_H */
@@ -0,0 +1,470 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsEventReader.cxx
+/// \brief Implementation of the framework input events reader
+
+#include "QnCorrectionsManager.h"
+#include "QnCorrectionsEventContext.h"
+#include "QnCorrectionsEventRecorder.h"
+#include "QnCorrectionsEventReader.h"
+#include "QnCorrectionsLog.h"
+
+#include <cstring>
+#include <fstream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsEventReader);
+/// \endcond
+
+/// Extracts a variable length encoded unsigned integer without going beyond the buffer end
+/// \param buffer the buffer position, advanced past the value
+/// \param end the buffer end
+/// \param value the decoded value
+/// \return kFALSE if the value is not complete within the buffer or it is malformed
+static Bool_t GetCheckedVarInt(const UChar_t *&buffer, const UChar_t *end, UInt_t &value) {
+  value = 0;
+  for (Int_t shift = 0; shift < 35; shift += 7) {
+    if (!(buffer < end)) return kFALSE;
+    UChar_t byte = *buffer++;
+    value |= ((UInt_t) (byte & 0x7f)) << shift;
+    if (!(byte & 0x80)) return kTRUE;
+  }
+  return kFALSE;
+}
+
+/// Default constructor
+QnCorrectionsEventReader::QnCorrectionsEventReader() : TObject(),
+    fFileName(), fEventVariables(), fFirstDataVector(), fDetectorId(), fPhi(), fWeight(), fChannelId(),
+    fDataVectorVariables() {
+  fData = NULL;
+  fSize = 0;
+  fMapped = kFALSE;
+  fHalfPrecisionWeights = kFALSE;
+  fNoOfEventVariables = 0;
+  fEventVariableId = NULL;
+  fNoOfDataVectorVariables = 0;
+  fDataVectorVariableId = NULL;
+  fMaxVariableId = -1;
+  fNoOfChunks = 0;
+  fChunkOffset = NULL;
+  fNoOfEvents = 0;
+  fChunk = -1;
+  fChunkNoOfEvents = 0;
+  fEvent = -1;
+}
+
+/// Normal constructor
+///
+/// The file is mapped in memory, its header checked and its chunks
+/// index read. The recorded variables ids must fit in the framework
+/// variables bank, otherwise the reader is closed.
+/// \param fileName the name of the file produced by QnCorrectionsEventRecorder
+QnCorrectionsEventReader::QnCorrectionsEventReader(const char *fileName) : TObject(),
+    fFileName(fileName), fEventVariables(), fFirstDataVector(), fDetectorId(), fPhi(), fWeight(), fChannelId(),
+    fDataVectorVariables() {
+  fData = NULL;
+  fSize = 0;
+  fMapped = kFALSE;
+  fHalfPrecisionWeights = kFALSE;
+  fNoOfEventVariables = 0;
+  fEventVariableId = NULL;
+  fNoOfDataVectorVariables = 0;
+  fDataVectorVariableId = NULL;
+  fMaxVariableId = -1;
+  fNoOfChunks = 0;
+  fChunkOffset = NULL;
+  fNoOfEvents = 0;
+  fChunk = -1;
+  fChunkNoOfEvents = 0;
+  fEvent = -1;
+
+#ifndef _WIN32
+  Int_t fd = open(fileName, O_RDONLY);
+  if (fd >= 0) {
+    struct stat fileStatus;
+    if (fstat(fd, &fileStatus) == 0 && fileStatus.st_size > 0) {
+      void *mapped = mmap(NULL, fileStatus.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapped != MAP_FAILED) {
+        fData = (const UChar_t *) mapped;
+        fSize = fileStatus.st_size;
+        fMapped = kTRUE;
+      }
+    }
+    close(fd);
+  }
+#endif
+  if (fData == NULL) {
+    /* not mapped, read it in one go */
+    std::ifstream inputFile(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+    if (inputFile.is_open()) {
+      fSize = inputFile.tellg();
+      UChar_t *data = new UChar_t[fSize];
+      inputFile.seekg(0);
+      if (inputFile.read((char *) data, fSize))
+        fData = data;
+      else
+        delete [] data;
+    }
+  }
+  if (fData == NULL) {
+    QnCorrectionsError(Form("Recording file %s could not be read", fileName));
+    return;
+  }
+
+  /* the header and the trailer */
+  const Long64_t trailerSize = sizeof(ULong64_t) + sizeof(UInt_t) + sizeof(QnCorrectionsEventRecorder::szMagic);
+  const Long64_t headerSize = sizeof(QnCorrectionsEventRecorder::szMagic) + 4 * sizeof(UInt_t);
+  UInt_t header[4];
+  if (fSize < headerSize + trailerSize
+      || memcmp(fData, QnCorrectionsEventRecorder::szMagic, sizeof(QnCorrectionsEventRecorder::szMagic)) != 0
+      || memcmp(fData + fSize - sizeof(QnCorrectionsEventRecorder::szMagic), QnCorrectionsEventRecorder::szMagic, sizeof(QnCorrectionsEventRecorder::szMagic)) != 0) {
+    QnCorrectionsError(Form("File %s is not a complete events recording", fileName));
+    Close();
+    return;
+  }
+  memcpy(header, fData + sizeof(QnCorrectionsEventRecorder::szMagic), sizeof(header));
+  if (header[0] != QnCorrectionsEventRecorder::nVersion) {
+    QnCorrectionsError(Form("Events recording %s has unsupported version %u", fileName, header[0]));
+    Close();
+    return;
+  }
+  /* the recording content lies between the header and the trailer */
+  const ULong64_t contentEnd = fSize - trailerSize;
+  if ((ULong64_t) headerSize + ((ULong64_t) header[2] + header[3]) * sizeof(Int_t) > contentEnd) {
+    QnCorrectionsError(Form("Events recording %s has a corrupted header", fileName));
+    Close();
+    return;
+  }
+  fHalfPrecisionWeights = ((header[1] & QnCorrectionsEventRecorder::kHalfPrecisionWeights) != 0);
+  fNoOfEventVariables = header[2];
+  fNoOfDataVectorVariables = header[3];
+  fEventVariableId = new Int_t[fNoOfEventVariables];
+  memcpy(fEventVariableId, fData + headerSize, fNoOfEventVariables * sizeof(Int_t));
+  if (fNoOfDataVectorVariables > 0) {
+    fDataVectorVariableId = new Int_t[fNoOfDataVectorVariables];
+    memcpy(fDataVectorVariableId, fData + headerSize + fNoOfEventVariables * sizeof(Int_t), fNoOfDataVectorVariables * sizeof(Int_t));
+  }
+  for (Int_t ixVariable = 0; ixVariable < fNoOfEventVariables + fNoOfDataVectorVariables; ixVariable++) {
+    Int_t variableId = (ixVariable < fNoOfEventVariables) ?
+        fEventVariableId[ixVariable] : fDataVectorVariableId[ixVariable - fNoOfEventVariables];
+    if (variableId < 0 || !(variableId < QnCorrectionsManager::GetMaxNoOfDataVariables())) {
+      QnCorrectionsError(Form("Events recording %s has variable id %d out of the variables bank range [0, %d)", fileName,
+          variableId, QnCorrectionsManager::GetMaxNoOfDataVariables()));
+      Close();
+      return;
+    }
+    if (fMaxVariableId < variableId) fMaxVariableId = variableId;
+  }
+
+  ULong64_t indexOffset;
+  UInt_t nChunks;
+  memcpy(&indexOffset, fData + fSize - trailerSize, sizeof(ULong64_t));
+  memcpy(&nChunks, fData + fSize - trailerSize + sizeof(ULong64_t), sizeof(UInt_t));
+  const ULong64_t indexEntrySize = sizeof(ULong64_t) + sizeof(UInt_t);
+  if (indexOffset > contentEnd || nChunks > (contentEnd - indexOffset) / indexEntrySize) {
+    QnCorrectionsError(Form("Events recording %s has a corrupted chunks index", fileName));
+    Close();
+    return;
+  }
+  fNoOfChunks = nChunks;
+  fChunkOffset = new ULong64_t[fNoOfChunks];
+  const UChar_t *index = fData + indexOffset;
+  for (Int_t ixChunk = 0; ixChunk < fNoOfChunks; ixChunk++) {
+    UInt_t nEvents;
+    memcpy(&fChunkOffset[ixChunk], index, sizeof(ULong64_t));
+    memcpy(&nEvents, index + sizeof(ULong64_t), sizeof(UInt_t));
+    index += indexEntrySize;
+    /* the chunk, its header and its columns, must be within the recording content */
+    const ULong64_t chunkHeaderSize = (3 + QnCorrectionsEventRecorder::kNoOfColumns) * sizeof(UInt_t);
+    Bool_t valid = (fChunkOffset[ixChunk] <= indexOffset) && (chunkHeaderSize <= indexOffset - fChunkOffset[ixChunk]);
+    if (valid) {
+      UInt_t chunkHeader[3 + QnCorrectionsEventRecorder::kNoOfColumns];
+      memcpy(chunkHeader, fData + fChunkOffset[ixChunk], sizeof(chunkHeader));
+      ULong64_t chunkSize = chunkHeaderSize;
+      for (Int_t ixColumn = 0; ixColumn < QnCorrectionsEventRecorder::kNoOfColumns; ixColumn++)
+        chunkSize += chunkHeader[3 + ixColumn];
+      valid = (chunkSize <= indexOffset - fChunkOffset[ixChunk]) && (chunkHeader[0] == nEvents);
+    }
+    if (!valid) {
+      QnCorrectionsError(Form("Events recording %s has a corrupted chunk %d", fileName, ixChunk));
+      Close();
+      return;
+    }
+    fNoOfEvents += nEvents;
+  }
+}
+
+/// Default destructor
+QnCorrectionsEventReader::~QnCorrectionsEventReader() {
+  Close();
+}
+
+/// Releases the file content
+void QnCorrectionsEventReader::Close() {
+  if (fData != NULL) {
+#ifndef _WIN32
+    if (fMapped)
+      munmap((void *) fData, fSize);
+    else
+#endif
+      delete [] fData;
+  }
+  fData = NULL;
+  fSize = 0;
+  fMapped = kFALSE;
+  if (fEventVariableId != NULL) delete [] fEventVariableId;
+  if (fDataVectorVariableId != NULL) delete [] fDataVectorVariableId;
+  if (fChunkOffset != NULL) delete [] fChunkOffset;
+  fEventVariableId = NULL;
+  fDataVectorVariableId = NULL;
+  fMaxVariableId = -1;
+  fChunkOffset = NULL;
+  fNoOfChunks = 0;
+  fNoOfEvents = 0;
+  fChunk = -1;
+  fChunkNoOfEvents = 0;
+  fEvent = -1;
+}
+
+/// Goes back to the first recorded event
+void QnCorrectionsEventReader::Rewind() {
+  fChunk = -1;
+  fChunkNoOfEvents = 0;
+  fEvent = -1;
+}
+
+/// Decodes a chunk into the replay arrays
+///
+/// The chunk bounds were checked when the file was opened. The decoded
+/// counts are checked against the columns sizes and the detector ids
+/// against the framework detectors id map. If they do not fit, the chunk
+/// is corrupted, the error is reported and the reader is closed.
+/// \param chunk the chunk index
+/// \return kTRUE if the chunk was properly decoded
+Bool_t QnCorrectionsEventReader::DecodeChunk(Int_t chunk) {
+  const UChar_t *position = fData + fChunkOffset[chunk];
+  UInt_t header[3 + QnCorrectionsEventRecorder::kNoOfColumns];
+  memcpy(header, position, sizeof(header));
+  position += sizeof(header);
+  UInt_t nEvents = header[0];
+  UInt_t nDataVectors = header[1];
+  UInt_t flags = header[2];
+  const UChar_t *columns[QnCorrectionsEventRecorder::kNoOfColumns];
+  const UChar_t *columnsEnd[QnCorrectionsEventRecorder::kNoOfColumns];
+  for (Int_t ixColumn = 0; ixColumn < QnCorrectionsEventRecorder::kNoOfColumns; ixColumn++) {
+    columns[ixColumn] = position;
+    position += header[3 + ixColumn];
+    columnsEnd[ixColumn] = position;
+  }
+
+  /* the fixed size columns must hold the declared counts */
+  ULong64_t weightSize = (flags & QnCorrectionsEventRecorder::kUnitWeights) ? 0 : (fHalfPrecisionWeights ? sizeof(UShort_t) : sizeof(Float_t));
+  if ((ULong64_t) nEvents * fNoOfEventVariables * sizeof(Float_t) > header[3 + QnCorrectionsEventRecorder::kEventVariables]
+      || (ULong64_t) nDataVectors * sizeof(UShort_t) > header[3 + QnCorrectionsEventRecorder::kPhi]
+      || (ULong64_t) nDataVectors * weightSize > header[3 + QnCorrectionsEventRecorder::kWeights]
+      || (ULong64_t) nDataVectors * fNoOfDataVectorVariables * sizeof(Float_t) > header[3 + QnCorrectionsEventRecorder::kDataVectorVariables]) {
+    QnCorrectionsError(Form("Events recording %s chunk %d: the columns do not hold the declared events and data vectors", fFileName.Data(), chunk));
+    Close();
+    return kFALSE;
+  }
+
+  /* the event variables, kept variable major */
+  fEventVariables.resize(nEvents * fNoOfEventVariables);
+  if (fEventVariables.size() != 0)
+    memcpy(&fEventVariables[0], columns[QnCorrectionsEventRecorder::kEventVariables], fEventVariables.size() * sizeof(Float_t));
+  /* the events boundaries */
+  fFirstDataVector.resize(nEvents + 1);
+  const UChar_t *buffer = columns[QnCorrectionsEventRecorder::kNoOfDataVectors];
+  const UChar_t *end = columnsEnd[QnCorrectionsEventRecorder::kNoOfDataVectors];
+  Bool_t valid = kTRUE;
+  fFirstDataVector[0] = 0;
+  for (UInt_t ixEvent = 0; ixEvent < nEvents && valid; ixEvent++) {
+    UInt_t nEventDataVectors;
+    valid = GetCheckedVarInt(buffer, end, nEventDataVectors) && (nEventDataVectors <= nDataVectors - fFirstDataVector[ixEvent]);
+    fFirstDataVector[ixEvent + 1] = valid ? fFirstDataVector[ixEvent] + nEventDataVectors : nDataVectors;
+  }
+  valid = valid && (fFirstDataVector[nEvents] == nDataVectors);
+  /* the detector ids */
+  fDetectorId.resize(nDataVectors);
+  buffer = columns[QnCorrectionsEventRecorder::kDetectorIds];
+  end = columnsEnd[QnCorrectionsEventRecorder::kDetectorIds];
+  for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors && valid; ) {
+    UInt_t nRun;
+    valid = (buffer < end);
+    if (!valid) break;
+    Int_t detectorId = *buffer++;
+    if (!(detectorId < QnCorrectionsManager::GetMaxNoOfDetectors())) {
+      QnCorrectionsError(Form("Events recording %s chunk %d: detector id %d out of the supported range [0, %d)", fFileName.Data(), chunk,
+          detectorId, QnCorrectionsManager::GetMaxNoOfDetectors()));
+      Close();
+      return kFALSE;
+    }
+    valid = GetCheckedVarInt(buffer, end, nRun) && (nRun != 0) && (nRun <= nDataVectors - ixDataVector);
+    if (!valid) break;
+    for (UInt_t i = 0; i < nRun; i++) fDetectorId[ixDataVector++] = detectorId;
+  }
+  /* the azimuthal angles */
+  fPhi.resize(nDataVectors);
+  for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) {
+    UShort_t quantized;
+    memcpy(&quantized, columns[QnCorrectionsEventRecorder::kPhi] + ixDataVector * sizeof(UShort_t), sizeof(UShort_t));
+    fPhi[ixDataVector] = QnCorrectionsEventRecorder::DequantizePhi(quantized);
+  }
+  /* the weights */
+  fWeight.resize(nDataVectors);
+  if (flags & QnCorrectionsEventRecorder::kUnitWeights) {
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) fWeight[ixDataVector] = 1.0;
+  }
+  else if (fHalfPrecisionWeights) {
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) {
+      UShort_t half;
+      memcpy(&half, columns[QnCorrectionsEventRecorder::kWeights] + ixDataVector * sizeof(UShort_t), sizeof(UShort_t));
+      fWeight[ixDataVector] = QnCorrectionsEventRecorder::HalfToFloat(half);
+    }
+  }
+  else if (nDataVectors > 0) {
+    memcpy(&fWeight[0], columns[QnCorrectionsEventRecorder::kWeights], nDataVectors * sizeof(Float_t));
+  }
+  /* the channel ids */
+  fChannelId.resize(nDataVectors);
+  if (flags & QnCorrectionsEventRecorder::kDefaultChannelIds) {
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) fChannelId[ixDataVector] = -1;
+  }
+  else {
+    buffer = columns[QnCorrectionsEventRecorder::kChannelIds];
+    end = columnsEnd[QnCorrectionsEventRecorder::kChannelIds];
+    Int_t previous = -1;
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors && valid; ixDataVector++) {
+      UInt_t zigzag;
+      valid = GetCheckedVarInt(buffer, end, zigzag);
+      Int_t delta = (Int_t) (zigzag >> 1) ^ -((Int_t) (zigzag & 1));
+      previous += delta;
+      fChannelId[ixDataVector] = previous;
+    }
+  }
+  /* the per data vector variables, data vector major as AddDataVectors expects */
+  fDataVectorVariables.resize(nDataVectors * fNoOfDataVectorVariables);
+  for (Int_t ixVariable = 0; ixVariable < fNoOfDataVectorVariables; ixVariable++) {
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) {
+      memcpy(&fDataVectorVariables[ixDataVector * fNoOfDataVectorVariables + ixVariable],
+          columns[QnCorrectionsEventRecorder::kDataVectorVariables] + (ixVariable * nDataVectors + ixDataVector) * sizeof(Float_t),
+          sizeof(Float_t));
+    }
+  }
+
+  if (!valid) {
+    QnCorrectionsError(Form("Events recording %s chunk %d: corrupted variable length encoded column", fFileName.Data(), chunk));
+    Close();
+    return kFALSE;
+  }
+
+  fChunk = chunk;
+  fChunkNoOfEvents = nEvents;
+  fEvent = -1;
+  return kTRUE;
+}
+
+/// Moves to the next recorded event, decoding the next chunk if needed
+/// \return kFALSE if there are no more events
+Bool_t QnCorrectionsEventReader::AdvanceEvent() {
+  if (fData == NULL) return kFALSE;
+  fEvent++;
+  while (!(fEvent < (Int_t) fChunkNoOfEvents)) {
+    if (!(fChunk + 1 < fNoOfChunks)) return kFALSE;
+    if (!DecodeChunk(fChunk + 1)) return kFALSE;
+    fEvent = 0;
+  }
+  return kTRUE;
+}
+
+/// Replays the next event on the framework manager
+///
+/// The recorded event variables are set in the manager variables bank
+/// and the data vectors handed to the manager. The event is then ready
+/// to be processed.
+/// \param manager the framework manager
+/// \return kFALSE if there are no more events
+Bool_t QnCorrectionsEventReader::NextEvent(QnCorrectionsManager *manager) {
+  if (!AdvanceEvent()) return kFALSE;
+
+  Float_t *variableContainer = manager->GetDataContainer();
+  for (Int_t ixVariable = 0; ixVariable < fNoOfEventVariables; ixVariable++) {
+    variableContainer[fEventVariableId[ixVariable]] = fEventVariables[ixVariable * fChunkNoOfEvents + fEvent];
+  }
+  UInt_t last = fFirstDataVector[fEvent + 1];
+  for (UInt_t first = fFirstDataVector[fEvent]; first < last; ) {
+    UInt_t end = first + 1;
+    while (end < last && fDetectorId[end] == fDetectorId[first]) end++;
+    manager->AddDataVectors(fDetectorId[first], &fPhi[first], &fWeight[first], &fChannelId[first], end - first,
+        fNoOfDataVectorVariables, fDataVectorVariableId,
+        (fNoOfDataVectorVariables > 0) ? &fDataVectorVariables[first * fNoOfDataVectorVariables] : NULL);
+    first = end;
+  }
+  return kTRUE;
+}
+
+/// Replays the next event on an event context
+///
+/// The recorded event variables are set in the context variables bank
+/// and the data vectors staged in the context. The recorded variables ids
+/// must fit in the context variables bank.
+/// \param context the event context
+/// \return kFALSE if there are no more events or they do not fit in the context
+Bool_t QnCorrectionsEventReader::NextEvent(QnCorrectionsEventContext *context) {
+  if (!(fMaxVariableId < context->GetNoOfVariables())) {
+    QnCorrectionsError(Form("Events recording %s has variable id %d beyond the context variables bank size %d", fFileName.Data(),
+        fMaxVariableId, context->GetNoOfVariables()));
+    return kFALSE;
+  }
+  if (!AdvanceEvent()) return kFALSE;
+
+  Float_t *variableContainer = context->GetDataContainer();
+  for (Int_t ixVariable = 0; ixVariable < fNoOfEventVariables; ixVariable++) {
+    variableContainer[fEventVariableId[ixVariable]] = fEventVariables[ixVariable * fChunkNoOfEvents + fEvent];
+  }
+  UInt_t last = fFirstDataVector[fEvent + 1];
+  for (UInt_t first = fFirstDataVector[fEvent]; first < last; ) {
+    UInt_t end = first + 1;
+    while (end < last && fDetectorId[end] == fDetectorId[first]) end++;
+    context->AddDataVectors(fDetectorId[first], &fPhi[first], &fWeight[first], &fChannelId[first], end - first,
+        fNoOfDataVectorVariables, fDataVectorVariableId,
+        (fNoOfDataVectorVariables > 0) ? &fDataVectorVariables[first * fNoOfDataVectorVariables] : NULL);
+    first = end;
+  }
+  return kTRUE;
+}
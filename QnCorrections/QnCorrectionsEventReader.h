@@ -0,0 +1,112 @@
+#ifndef QNCORRECTIONS_EVENTREADER_H
+#define QNCORRECTIONS_EVENTREADER_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsEventReader.h
+/// \brief Replay of the framework input events recorded by QnCorrectionsEventRecorder
+
+#include <TObject.h>
+#include <TString.h>
+#include <vector>
+
+class QnCorrectionsManager;
+class QnCorrectionsEventContext;
+
+/// \class QnCorrectionsEventReader
+/// \brief Reads back the events recorded by QnCorrectionsEventRecorder
+///
+/// The whole file is memory mapped, or read in one go if mapping is
+/// not possible, and decoded one chunk at a time in arrays ready to be
+/// handed to the framework. Each event is then replayed either on the
+/// manager, its variables bank and AddDataVectors, or on an event
+/// context. The data vectors of consecutive runs of the same detector
+/// are handed in one go.
+///
+/// Only the recorded event variables are set in the variables bank, the
+/// rest of the bank is not touched.
+///
+/// The recorded variables ids are checked against the framework
+/// variables bank size when the file is opened, and against the context
+/// bank size when replaying on a context. The detector ids are checked
+/// against the framework detectors id map size when decoding each chunk.
+/// A recording not passing the checks is reported and not replayed.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsEventReader : public TObject {
+public:
+  QnCorrectionsEventReader();
+  QnCorrectionsEventReader(const char *fileName);
+  virtual ~QnCorrectionsEventReader();
+
+  /// Checks whether the input file is ready
+  /// \return kTRUE if the file is open
+  Bool_t IsOpen() const { return (fData != NULL); }
+  /// Gets the number of recorded events
+  /// \return the number of events
+  Long64_t GetNoOfEvents() const { return fNoOfEvents; }
+  /// Gets the number of recorded event variables
+  /// \return the number of event variables
+  Int_t GetNoOfEventVariables() const { return fNoOfEventVariables; }
+  /// Gets the recorded event variables ids
+  /// \return array with the external Ids of the event variables
+  const Int_t *GetEventVariablesIds() const { return fEventVariableId; }
+
+  Bool_t NextEvent(QnCorrectionsManager *manager);
+  Bool_t NextEvent(QnCorrectionsEventContext *context);
+  void Rewind();
+  void Close();
+
+private:
+  Bool_t AdvanceEvent();
+  Bool_t DecodeChunk(Int_t chunk);
+
+  TString fFileName;                          ///< the input file name
+  const UChar_t *fData;                       //!<! the file content
+  Long64_t fSize;                             //!<! the file size
+  Bool_t fMapped;                             //!<! kTRUE if the file content is memory mapped
+  Bool_t fHalfPrecisionWeights;               //!<! kTRUE if the weights are stored as half precision floats
+  Int_t fNoOfEventVariables;                  //!<! the number of event variables
+  Int_t *fEventVariableId;                    //!<! the event variables ids
+  Int_t fNoOfDataVectorVariables;             //!<! the number of per data vector variables
+  Int_t *fDataVectorVariableId;               //!<! the per data vector variables ids
+  Int_t fMaxVariableId;                       //!<! the highest recorded variable id
+  Int_t fNoOfChunks;                          //!<! the number of chunks
+  ULong64_t *fChunkOffset;                    //!<! the position of each chunk in the file
+  Long64_t fNoOfEvents;                       //!<! the number of recorded events
+  Int_t fChunk;                               //!<! the decoded chunk
+  UInt_t fChunkNoOfEvents;                    //!<! the number of events of the decoded chunk
+  Int_t fEvent;                               //!<! the current event within the decoded chunk
+  std::vector<Float_t> fEventVariables;       //!<! the decoded chunk event variables, variable major
+  std::vector<UInt_t> fFirstDataVector;       //!<! the decoded chunk first data vector of each event plus the end
+  std::vector<Int_t> fDetectorId;             //!<! the decoded chunk data vectors detector ids
+  std::vector<Float_t> fPhi;                  //!<! the decoded chunk data vectors azimuthal angles
+  std::vector<Float_t> fWeight;               //!<! the decoded chunk data vectors weights
+  std::vector<Int_t> fChannelId;              //!<! the decoded chunk data vectors channel ids
+  std::vector<Float_t> fDataVectorVariables;  //!<! the decoded chunk per data vector variables, data vector major
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsEventReader(const QnCorrectionsEventReader &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsEventReader& operator= (const QnCorrectionsEventReader &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsEventReader, 2);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_EVENTREADER_H */
@@ -0,0 +1,398 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsEventRecorder.cxx
+/// \brief Implementation of the framework input events recorder
+
+#include <TMath.h>
+
+#include "QnCorrectionsEventRecorder.h"
+#include "QnCorrectionsLog.h"
+
+#include <cstring>
+#include <fstream>
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsEventRecorder);
+/// \endcond
+
+const char QnCorrectionsEventRecorder::szMagic[4] = {'Q', 'N', 'R', 'P'};
+const UInt_t QnCorrectionsEventRecorder::nVersion = 1;
+const Int_t QnCorrectionsEventRecorder::nDefaultChunkSize = 1024;
+const Float_t QnCorrectionsEventRecorder::fPhiQuantum = 2.0 * TMath::Pi() / 65536.0;
+const Int_t QnCorrectionsEventRecorder::nMaxDetectorId = 255;
+
+/// Default constructor
+QnCorrectionsEventRecorder::QnCorrectionsEventRecorder() : TObject(),
+    fFileName(), fEventVariables(), fEventNoOfDataVectors(), fDetectorId(), fPhi(), fWeight(), fChannelId(),
+    fDataVectorVariables(), fChunkOffset(), fChunkNoOfEvents() {
+  fStream = NULL;
+  fNoOfEventVariables = 0;
+  fEventVariableId = NULL;
+  fNoOfDataVectorVariables = 0;
+  fDataVectorVariableId = NULL;
+  fHalfPrecisionWeights = kFALSE;
+  fChunkSize = nDefaultChunkSize;
+  fNoOfEvents = 0;
+  fNoOfEventDataVectors = 0;
+}
+
+/// Normal constructor
+///
+/// The output file is created and the header written.
+/// \param fileName the output file name
+/// \param nEventVariables the number of event variables to record
+/// \param eventVariableId array with the external Ids of the event variables
+/// \param nDataVectorVariables the number of per data vector variables to record
+/// \param dataVectorVariableId array with the external Ids of the per data vector variables
+/// \param halfPrecisionWeights kTRUE for storing the weights as half precision floats
+QnCorrectionsEventRecorder::QnCorrectionsEventRecorder(const char *fileName, Int_t nEventVariables, const Int_t *eventVariableId,
+    Int_t nDataVectorVariables, const Int_t *dataVectorVariableId, Bool_t halfPrecisionWeights) : TObject(),
+    fFileName(fileName), fEventVariables(), fEventNoOfDataVectors(), fDetectorId(), fPhi(), fWeight(), fChannelId(),
+    fDataVectorVariables(), fChunkOffset(), fChunkNoOfEvents() {
+  fNoOfEventVariables = nEventVariables;
+  fEventVariableId = new Int_t[nEventVariables];
+  for (Int_t ixVariable = 0; ixVariable < nEventVariables; ixVariable++) {
+    fEventVariableId[ixVariable] = eventVariableId[ixVariable];
+  }
+  fNoOfDataVectorVariables = nDataVectorVariables;
+  fDataVectorVariableId = NULL;
+  if (nDataVectorVariables > 0) {
+    fDataVectorVariableId = new Int_t[nDataVectorVariables];
+    for (Int_t ixVariable = 0; ixVariable < nDataVectorVariables; ixVariable++) {
+      fDataVectorVariableId[ixVariable] = dataVectorVariableId[ixVariable];
+    }
+  }
+  fHalfPrecisionWeights = halfPrecisionWeights;
+  fChunkSize = nDefaultChunkSize;
+  fNoOfEvents = 0;
+  fNoOfEventDataVectors = 0;
+
+  fStream = new std::ofstream(fileName, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!fStream->is_open()) {
+    QnCorrectionsError(Form("Recording file %s could not be created", fileName));
+    delete fStream;
+    fStream = NULL;
+    return;
+  }
+  UInt_t header[4] = {nVersion, (fHalfPrecisionWeights ? (UInt_t) kHalfPrecisionWeights : 0u),
+      (UInt_t) fNoOfEventVariables, (UInt_t) fNoOfDataVectorVariables};
+  fStream->write(szMagic, sizeof(szMagic));
+  fStream->write((const char *) header, sizeof(header));
+  fStream->write((const char *) fEventVariableId, fNoOfEventVariables * sizeof(Int_t));
+  if (fNoOfDataVectorVariables > 0)
+    fStream->write((const char *) fDataVectorVariableId, fNoOfDataVectorVariables * sizeof(Int_t));
+}
+
+/// Default destructor
+/// Closes the file if still open
+QnCorrectionsEventRecorder::~QnCorrectionsEventRecorder() {
+  Close();
+  if (fEventVariableId != NULL) delete [] fEventVariableId;
+  if (fDataVectorVariableId != NULL) delete [] fDataVectorVariableId;
+}
+
+/// Converts a float to half precision
+///
+/// Rounds to the nearest, values beyond the half precision range
+/// become infinite and the too small ones zero.
+/// \param value the value to convert
+/// \return the half precision bits
+UShort_t QnCorrectionsEventRecorder::FloatToHalf(Float_t value) {
+  UInt_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  UInt_t sign = (bits >> 16) & 0x8000;
+  Int_t exponent = (Int_t) ((bits >> 23) & 0xff) - 127 + 15;
+  UInt_t mantissa = bits & 0x7fffff;
+
+  if (((bits >> 23) & 0xff) == 0xff)
+    /* infinite or not a number */
+    return sign | 0x7c00 | ((mantissa != 0) ? 0x200 : 0);
+  if (exponent >= 0x1f)
+    /* overflow */
+    return sign | 0x7c00;
+  if (exponent <= 0) {
+    /* subnormal or zero */
+    if (exponent < -10) return sign;
+    mantissa |= 0x800000;
+    UInt_t shift = 14 - exponent;
+    UInt_t half = mantissa >> shift;
+    if ((mantissa >> (shift - 1)) & 1) half++;
+    return sign | half;
+  }
+  UInt_t half = sign | (exponent << 10) | (mantissa >> 13);
+  /* the rounding carry can correctly propagate to the exponent */
+  if (mantissa & 0x1000) half++;
+  return half;
+}
+
+/// Converts a half precision float to float
+/// \param half the half precision bits
+/// \return the float value
+Float_t QnCorrectionsEventRecorder::HalfToFloat(UShort_t half) {
+  UInt_t sign = ((UInt_t) (half & 0x8000)) << 16;
+  Int_t exponent = (half >> 10) & 0x1f;
+  UInt_t mantissa = half & 0x3ff;
+  UInt_t bits;
+
+  if (exponent == 0) {
+    if (mantissa == 0)
+      bits = sign;
+    else {
+      /* subnormal: normalize it */
+      exponent = 1;
+      while (!(mantissa & 0x400)) {
+        mantissa <<= 1;
+        exponent--;
+      }
+      mantissa &= 0x3ff;
+      bits = sign | ((UInt_t) (exponent + 127 - 15) << 23) | (mantissa << 13);
+    }
+  }
+  else if (exponent == 0x1f)
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  else
+    bits = sign | ((UInt_t) (exponent + 127 - 15) << 23) | (mantissa << 13);
+  Float_t value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/// Quantizes an azimuthal angle to 16 bits over \f$ 2\pi \f$
+/// \param phi the azimuthal angle, any range
+/// \return the quantized angle
+UShort_t QnCorrectionsEventRecorder::QuantizePhi(Double_t phi) {
+  Long64_t quantized = (Long64_t) TMath::Floor(phi / fPhiQuantum + 0.5);
+  return (UShort_t) (quantized & 0xffff);
+}
+
+/// Appends a variable length encoded unsigned integer
+///
+/// Seven bits per byte, the most significant bit flags a following byte.
+/// \param buffer the buffer where to append
+/// \param value the value to encode
+void QnCorrectionsEventRecorder::PutVarInt(std::vector<UChar_t> &buffer, UInt_t value) {
+  while (value >= 0x80) {
+    buffer.push_back((UChar_t) ((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back((UChar_t) value);
+}
+
+/// Extracts a variable length encoded unsigned integer
+/// \param buffer the buffer position, advanced past the value
+/// \return the decoded value
+UInt_t QnCorrectionsEventRecorder::GetVarInt(const UChar_t *&buffer) {
+  UInt_t value = 0;
+  Int_t shift = 0;
+  while (*buffer & 0x80) {
+    value |= ((UInt_t) (*buffer & 0x7f)) << shift;
+    shift += 7;
+    buffer++;
+  }
+  value |= ((UInt_t) *buffer) << shift;
+  buffer++;
+  return value;
+}
+
+/// Reports a data vector whose detector id the format cannot store
+/// \param detectorId the rejected detector id
+void QnCorrectionsEventRecorder::RejectDataVector(Int_t detectorId) const {
+  QnCorrectionsError(Form("Recording %s: detector id %d out of the recordable range [0, %d], not recorded",
+      fFileName.Data(), detectorId, nMaxDetectorId));
+}
+
+/// Records a set of data vectors for the current event
+///
+/// A set with a detector id the format cannot store is reported once and
+/// not recorded.
+/// \param detectorId id of the involved detector
+/// \param phi array of azimuthal angles
+/// \param weight array of data vector weights. NULL for unit weights
+/// \param channelId array of channel Ids that originates the data vectors. NULL for default ones
+/// \param n the number of data vectors in the arrays
+/// \param variableValues the declared per data vector variables, consecutive values per data vector. NULL if none declared
+void QnCorrectionsEventRecorder::AddDataVectors(Int_t detectorId, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+    const Float_t *variableValues) {
+  if (detectorId < 0 || nMaxDetectorId < detectorId) {
+    RejectDataVector(detectorId);
+    return;
+  }
+  for (Int_t i = 0; i < n; i++) {
+    AddDataVector(detectorId, phi[i],
+        (weight != NULL) ? weight[i] : 1.0,
+        (channelId != NULL) ? channelId[i] : -1,
+        (fNoOfDataVectorVariables > 0) ? variableValues + i * fNoOfDataVectorVariables : NULL);
+  }
+}
+
+/// Closes the current event
+///
+/// The declared event variables are taken from the passed variables bank
+/// and the event joins the current chunk together with the data vectors
+/// recorded since the previous event.
+/// \param variableContainer the variables bank
+void QnCorrectionsEventRecorder::RecordEvent(const Float_t *variableContainer) {
+  for (Int_t ixVariable = 0; ixVariable < fNoOfEventVariables; ixVariable++) {
+    fEventVariables.push_back(variableContainer[fEventVariableId[ixVariable]]);
+  }
+  fEventNoOfDataVectors.push_back(fNoOfEventDataVectors);
+  fNoOfEventDataVectors = 0;
+  fNoOfEvents++;
+  if (!(fEventNoOfDataVectors.size() < (size_t) fChunkSize))
+    FlushChunk();
+}
+
+/// Encodes and writes the current chunk
+///
+/// Each column is first encoded in its own buffer so that the chunk
+/// header, with the columns sizes, precedes them.
+void QnCorrectionsEventRecorder::FlushChunk() {
+  UInt_t nEvents = fEventNoOfDataVectors.size();
+  UInt_t nDataVectors = fDetectorId.size();
+  if (fStream == NULL || nEvents == 0) return;
+
+  std::vector<UChar_t> columns[kNoOfColumns];
+  UInt_t flags = 0;
+
+  /* the event variables, variable major */
+  columns[kEventVariables].resize(nEvents * fNoOfEventVariables * sizeof(Float_t));
+  for (Int_t ixVariable = 0; ixVariable < fNoOfEventVariables; ixVariable++) {
+    for (UInt_t ixEvent = 0; ixEvent < nEvents; ixEvent++) {
+      memcpy(&columns[kEventVariables][(ixVariable * nEvents + ixEvent) * sizeof(Float_t)],
+          &fEventVariables[ixEvent * fNoOfEventVariables + ixVariable], sizeof(Float_t));
+    }
+  }
+  /* the number of data vectors per event */
+  for (UInt_t ixEvent = 0; ixEvent < nEvents; ixEvent++) {
+    PutVarInt(columns[kNoOfDataVectors], fEventNoOfDataVectors[ixEvent]);
+  }
+  /* the detector ids, as detector id and run length pairs */
+  for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ) {
+    UInt_t ixEnd = ixDataVector + 1;
+    while (ixEnd < nDataVectors && fDetectorId[ixEnd] == fDetectorId[ixDataVector]) ixEnd++;
+    columns[kDetectorIds].push_back(fDetectorId[ixDataVector]);
+    PutVarInt(columns[kDetectorIds], ixEnd - ixDataVector);
+    ixDataVector = ixEnd;
+  }
+  /* the quantized azimuthal angles */
+  columns[kPhi].resize(nDataVectors * sizeof(UShort_t));
+  if (nDataVectors > 0)
+    memcpy(&columns[kPhi][0], &fPhi[0], nDataVectors * sizeof(UShort_t));
+  /* the weights, if not all of them are one */
+  Bool_t unitWeights = kTRUE;
+  for (UInt_t ixDataVector = 0; unitWeights && ixDataVector < nDataVectors; ixDataVector++) {
+    unitWeights = (fWeight[ixDataVector] == 1.0);
+  }
+  if (unitWeights)
+    flags |= kUnitWeights;
+  else if (fHalfPrecisionWeights) {
+    columns[kWeights].resize(nDataVectors * sizeof(UShort_t));
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) {
+      UShort_t half = FloatToHalf(fWeight[ixDataVector]);
+      memcpy(&columns[kWeights][ixDataVector * sizeof(UShort_t)], &half, sizeof(UShort_t));
+    }
+  }
+  else {
+    columns[kWeights].resize(nDataVectors * sizeof(Float_t));
+    memcpy(&columns[kWeights][0], &fWeight[0], nDataVectors * sizeof(Float_t));
+  }
+  /* the channel ids, if any was given, as zig-zag encoded differences */
+  Bool_t defaultChannelIds = kTRUE;
+  for (UInt_t ixDataVector = 0; defaultChannelIds && ixDataVector < nDataVectors; ixDataVector++) {
+    defaultChannelIds = (fChannelId[ixDataVector] == -1);
+  }
+  if (defaultChannelIds)
+    flags |= kDefaultChannelIds;
+  else {
+    Int_t previous = -1;
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) {
+      Int_t delta = fChannelId[ixDataVector] - previous;
+      PutVarInt(columns[kChannelIds], (((UInt_t) delta) << 1) ^ ((UInt_t) (delta >> 31)));
+      previous = fChannelId[ixDataVector];
+    }
+  }
+  /* the per data vector variables, variable major */
+  columns[kDataVectorVariables].resize(nDataVectors * fNoOfDataVectorVariables * sizeof(Float_t));
+  for (Int_t ixVariable = 0; ixVariable < fNoOfDataVectorVariables; ixVariable++) {
+    for (UInt_t ixDataVector = 0; ixDataVector < nDataVectors; ixDataVector++) {
+      memcpy(&columns[kDataVectorVariables][(ixVariable * nDataVectors + ixDataVector) * sizeof(Float_t)],
+          &fDataVectorVariables[ixDataVector * fNoOfDataVectorVariables + ixVariable], sizeof(Float_t));
+    }
+  }
+
+  /* now the chunk itself */
+  UInt_t header[3 + kNoOfColumns] = {nEvents, nDataVectors, flags};
+  for (Int_t ixColumn = 0; ixColumn < kNoOfColumns; ixColumn++) {
+    header[3 + ixColumn] = columns[ixColumn].size();
+  }
+  fChunkOffset.push_back((ULong64_t) fStream->tellp());
+  fChunkNoOfEvents.push_back(nEvents);
+  fStream->write((const char *) header, sizeof(header));
+  for (Int_t ixColumn = 0; ixColumn < kNoOfColumns; ixColumn++) {
+    if (columns[ixColumn].size() != 0)
+      fStream->write((const char *) &columns[ixColumn][0], columns[ixColumn].size());
+  }
+
+  fEventVariables.clear();
+  fEventNoOfDataVectors.clear();
+  fDetectorId.clear();
+  fPhi.clear();
+  fWeight.clear();
+  fChannelId.clear();
+  fDataVectorVariables.clear();
+}
+
+/// Closes the output file
+///
+/// The pending events are flushed and the chunks index and the trailer,
+/// index position, number of chunks and file identification, written.
+/// Data vectors recorded after the last RecordEvent are discarded.
+void QnCorrectionsEventRecorder::Close() {
+  if (fStream == NULL) return;
+
+  FlushChunk();
+  ULong64_t indexOffset = (ULong64_t) fStream->tellp();
+  UInt_t nChunks = fChunkOffset.size();
+  for (UInt_t ixChunk = 0; ixChunk < nChunks; ixChunk++) {
+    fStream->write((const char *) &fChunkOffset[ixChunk], sizeof(ULong64_t));
+    fStream->write((const char *) &fChunkNoOfEvents[ixChunk], sizeof(UInt_t));
+  }
+  fStream->write((const char *) &indexOffset, sizeof(ULong64_t));
+  fStream->write((const char *) &nChunks, sizeof(UInt_t));
+  fStream->write(szMagic, sizeof(szMagic));
+  if (!fStream->good())
+    QnCorrectionsError(Form("Failed writing the recording file %s", fFileName.Data()));
+  fStream->close();
+  delete fStream;
+  fStream = NULL;
+  QnCorrectionsInfo(Form("Recorded %lld events in %u chunks into %s", fNoOfEvents, nChunks, fFileName.Data()));
+}
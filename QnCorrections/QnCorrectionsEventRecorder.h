@@ -0,0 +1,177 @@
+#ifndef QNCORRECTIONS_EVENTRECORDER_H
+#define QNCORRECTIONS_EVENTRECORDER_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsEventRecorder.h
+/// \brief Recording of the framework input events in a compact columnar binary format
+
+#include <TObject.h>
+#include <TString.h>
+#include <iosfwd>
+#include <vector>
+
+/// \class QnCorrectionsEventRecorder
+/// \brief Records the framework input stream for being replayed by QnCorrectionsEventReader
+///
+/// For each event the values of the declared event variables, usually
+/// the event class variables and the ones used by the event level cuts,
+/// and its data vectors, detector id, azimuthal angle, weight and channel
+/// id plus, optionally, a declared set of per data vector variables, are
+/// recorded.
+///
+/// The events are grouped in chunks and, within each chunk, stored in
+/// columns, one per quantity, each of them compacted according to its
+/// nature:
+///   - the event variables as 32 bits floats,
+///   - the number of data vectors of each event as variable length integers,
+///   - the detector ids run length encoded, one byte per run id, so only
+///     ids within [0, 255] are accepted,
+///   - the azimuthal angles quantized to 16 bits over \f$ 2\pi \f$, the
+///     resolution is below \f$ 10^{-4} \f$ rad and the angles are
+///     recovered within \f$ [0, 2\pi) \f$,
+///   - the weights as 32 bits floats or, optionally, 16 bits half
+///     precision floats, and not stored at all if all of them are one,
+///   - the channel ids as zig-zag variable length integers of the
+///     difference with the previous one, not stored if none is given,
+///   - the per data vector variables as 32 bits floats.
+///
+/// The file starts with a header holding the declared variables and
+/// ends with the chunks index. All quantities are written in the native
+/// byte order. As the file is never modified once written it is
+/// suitable for being memory mapped by the reader.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsEventRecorder : public TObject {
+public:
+  /// The columns of each chunk in storage order
+  enum Column {
+    kEventVariables = 0,     ///< the event variables values, variable major
+    kNoOfDataVectors,        ///< the number of data vectors per event
+    kDetectorIds,            ///< the run length encoded detector ids
+    kPhi,                    ///< the quantized azimuthal angles
+    kWeights,                ///< the weights
+    kChannelIds,             ///< the delta encoded channel ids
+    kDataVectorVariables,    ///< the per data vector variables values, variable major
+    kNoOfColumns             ///< the number of columns
+  };
+  /// The file level flags
+  enum FileFlags {
+    kHalfPrecisionWeights = 0x1 ///< the weights are stored as half precision floats
+  };
+  /// The chunk level flags
+  enum ChunkFlags {
+    kUnitWeights = 0x1,      ///< all weights are one, the weights column is empty
+    kDefaultChannelIds = 0x2 ///< no channel id was given, the channel ids column is empty
+  };
+
+  static const char szMagic[4];      ///< the file identification
+  static const UInt_t nVersion;      ///< the format version
+  static const Int_t nDefaultChunkSize; ///< the default number of events per chunk
+  static const Float_t fPhiQuantum;   ///< the azimuthal angle quantization step
+  static const Int_t nMaxDetectorId;  ///< the highest detector id the format can store
+
+  QnCorrectionsEventRecorder();
+  QnCorrectionsEventRecorder(const char *fileName, Int_t nEventVariables, const Int_t *eventVariableId,
+      Int_t nDataVectorVariables = 0, const Int_t *dataVectorVariableId = NULL, Bool_t halfPrecisionWeights = kFALSE);
+  virtual ~QnCorrectionsEventRecorder();
+
+  /// Sets the number of events per chunk
+  /// \param nEvents the number of events
+  void SetChunkSize(Int_t nEvents) { fChunkSize = (nEvents < 1) ? 1 : nEvents; }
+  /// Checks whether the output file is ready
+  /// \return kTRUE if the file is open
+  Bool_t IsOpen() const { return (fStream != NULL); }
+  /// Gets the number of recorded events
+  /// \return the number of events
+  Long64_t GetNoOfEvents() const { return fNoOfEvents; }
+
+  void AddDataVector(Int_t detectorId, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1, const Float_t *variableValues = NULL);
+  void AddDataVectors(Int_t detectorId, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      const Float_t *variableValues = NULL);
+  void RecordEvent(const Float_t *variableContainer);
+  void Close();
+
+  static UShort_t FloatToHalf(Float_t value);
+  static Float_t HalfToFloat(UShort_t half);
+  static UShort_t QuantizePhi(Double_t phi);
+  /// Recovers a quantized azimuthal angle
+  /// \param quantizedPhi the quantized angle
+  /// \return the azimuthal angle within \f$ [0, 2\pi) \f$
+  static Float_t DequantizePhi(UShort_t quantizedPhi) { return quantizedPhi * fPhiQuantum; }
+  static void PutVarInt(std::vector<UChar_t> &buffer, UInt_t value);
+  static UInt_t GetVarInt(const UChar_t *&buffer);
+
+private:
+  void FlushChunk();
+  void RejectDataVector(Int_t detectorId) const;
+
+  TString fFileName;                          ///< the output file name
+  std::ofstream *fStream;                     //!<! the output file
+  Int_t fNoOfEventVariables;                  ///< the number of event variables
+  Int_t *fEventVariableId;                    //[fNoOfEventVariables] the event variables ids
+  Int_t fNoOfDataVectorVariables;             ///< the number of per data vector variables
+  Int_t *fDataVectorVariableId;               //[fNoOfDataVectorVariables] the per data vector variables ids
+  Bool_t fHalfPrecisionWeights;               ///< kTRUE if the weights are stored as half precision floats
+  Int_t fChunkSize;                           ///< the number of events per chunk
+  Long64_t fNoOfEvents;                       ///< the number of recorded events
+  UInt_t fNoOfEventDataVectors;               //!<! the number of data vectors of the event being recorded
+  std::vector<Float_t> fEventVariables;       //!<! the chunk event variables, event major
+  std::vector<UInt_t> fEventNoOfDataVectors;  //!<! the chunk number of data vectors per event
+  std::vector<UChar_t> fDetectorId;           //!<! the chunk data vectors detector ids
+  std::vector<UShort_t> fPhi;                 //!<! the chunk data vectors quantized azimuthal angles
+  std::vector<Float_t> fWeight;               //!<! the chunk data vectors weights
+  std::vector<Int_t> fChannelId;              //!<! the chunk data vectors channel ids
+  std::vector<Float_t> fDataVectorVariables;  //!<! the chunk per data vector variables, data vector major
+  std::vector<ULong64_t> fChunkOffset;        //!<! the position of each chunk in the file
+  std::vector<UInt_t> fChunkNoOfEvents;       //!<! the number of events of each chunk
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsEventRecorder(const QnCorrectionsEventRecorder &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsEventRecorder& operator= (const QnCorrectionsEventRecorder &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsEventRecorder, 1);
+/// \endcond
+};
+
+/// Records a new data vector for the current event
+///
+/// Data vectors with a detector id the format cannot store are reported
+/// and not recorded.
+/// \param detectorId id of the involved detector
+/// \param phi azimuthal angle
+/// \param weight the weight of the data vector
+/// \param channelId the channel Id that originates the data vector
+/// \param variableValues the values of the declared per data vector variables. NULL if none declared
+inline void QnCorrectionsEventRecorder::AddDataVector(Int_t detectorId, Double_t phi, Double_t weight, Int_t channelId, const Float_t *variableValues) {
+  if (detectorId < 0 || nMaxDetectorId < detectorId) {
+    RejectDataVector(detectorId);
+    return;
+  }
+  fDetectorId.push_back((UChar_t) detectorId);
+  fPhi.push_back(QuantizePhi(phi));
+  fWeight.push_back(weight);
+  fChannelId.push_back(channelId);
+  for (Int_t ixVariable = 0; ixVariable < fNoOfDataVectorVariables; ixVariable++) {
+    fDataVectorVariables.push_back(variableValues[ixVariable]);
+  }
+  fNoOfEventDataVectors++;
+}
+
+#endif /* QNCORRECTIONS_EVENTRECORDER_H */
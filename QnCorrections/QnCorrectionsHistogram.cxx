@@ -95,8 +95,9 @@ Bool_t QnCorrectionsHistogram::CreateHistogram(TList *histogramList) {
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsHistogram::GetBin(const Float_t *variableContainer) {
 
+  if (fEventClassBins != NULL)
+    return fValues->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
-  /* store the channel number */
   return fValues->GetBin(fBinAxesValues);
 }
 
@@ -146,9 +147,9 @@ void QnCorrectionsHistogram::Fill(const Float_t *variableContainer, Float_t weig
   /* keep the total entries in fValues updated */
   Double_t nEntries = fValues->GetEntries();
 
-  FillBinAxesValues(variableContainer);
+  Long64_t bin = GetBin(variableContainer);
   /* and now update the bin */
-  fValues->Fill(fBinAxesValues, weight);
+  fValues->FillBin(bin, weight);
   fValues->SetEntries(nEntries + 1);
 }
 
@@ -35,7 +35,10 @@ ClassImp(QnCorrectionsHistogramBase);
 QnCorrectionsHistogramBase::QnCorrectionsHistogramBase() :
   TNamed(),
   fEventClassVariables(),
-  fBinAxesValues(NULL) {
+  fBinAxesValues(NULL),
+  fEventClassBins(NULL),
+  fBinAxesCoordinates(NULL),
+  fAccumulator(NULL) {
 
   fErrorMode = kERRORMEAN;
   fMinNoOfEntriesToValidate = nDefaultMinNoOfEntriesValidated;
@@ -47,6 +50,10 @@ QnCorrectionsHistogramBase::QnCorrectionsHistogramBase() :
 QnCorrectionsHistogramBase::~QnCorrectionsHistogramBase() {
   if (fBinAxesValues != NULL)
     delete [] fBinAxesValues;
+  if (fBinAxesCoordinates != NULL)
+    delete [] fBinAxesCoordinates;
+  if (fAccumulator != NULL)
+    delete fAccumulator;
 }
 
 /// Normal constructor
@@ -73,10 +80,14 @@ QnCorrectionsHistogramBase::QnCorrectionsHistogramBase(const char *name,
     Option_t *option) :
   TNamed(name, title),
   fEventClassVariables(ecvs),
-  fBinAxesValues(NULL) {
+  fBinAxesValues(NULL),
+  fEventClassBins(NULL),
+  fBinAxesCoordinates(NULL),
+  fAccumulator(NULL) {
 
   /* one place more for storing the channel number by inherited classes */
   fBinAxesValues = new Double_t[fEventClassVariables.GetEntries() + 1];
+  fBinAxesCoordinates = new Int_t[fEventClassVariables.GetEntries() + 1];
 
   TString opt = option;
   opt.ToLower();
@@ -115,6 +126,23 @@ Bool_t QnCorrectionsHistogramBase::AttachHistograms(TList *histogramList, const
   return kFALSE;
 }
 
+/// Attaches the current event bin coordinates of the event classes
+///
+/// Once attached, the bin numbers are obtained from the bin coordinates
+/// instead of from the passed variable container, so the bin coordinates
+/// must be updated for each event before the histogram is used.
+/// They are only accepted if they are kept for the histogram event
+/// class variables set.
+///
+/// \param eventClassBins the event class bin coordinates. NULL to detach them
+void QnCorrectionsHistogramBase::SetEventClassBins(const QnCorrectionsEventClassBins *eventClassBins) {
+  if ((eventClassBins != NULL) && !eventClassBins->IsSameVariablesSet(fEventClassVariables)) {
+    QnCorrectionsWarning(Form("The event class bins are not for the event class variables of histogram %s. Ignored.", GetName()));
+    fEventClassBins = NULL;
+    return;
+  }
+  fEventClassBins = eventClassBins;
+}
 
 /// Get the bin number for the current variable content
 ///
@@ -153,6 +181,23 @@ Long64_t QnCorrectionsHistogramBase::GetBin(const Float_t *variableContainer, In
   return -1;
 }
 
+/// Get the total number of bins, under and overflow included
+///
+/// Bin numbers returned by GetBin are always below this value so
+/// it can be used to size tables addressed by bin number.
+///
+/// Interface declaration function.
+/// Default behavior. Base class should not be instantiated.
+/// Run time error to support debugging.
+///
+/// \return the number of bins of the histogram
+Long64_t QnCorrectionsHistogramBase::GetNoOfBins() {
+  QnCorrectionsFatal(Form("You have reached base member %s. This means you have instantiated a base class or\n" \
+      "you are using a histogram which does not support bin tables. FIX IT, PLEASE.",
+      "QnCorrectionsHistogramBase::GetNoOfBins()"));
+  return 0;
+}
+
 /// Get the bin content for the passed bin number
 ///
 /// The bin number identifies a desired event class whose content is
@@ -6,6 +6,8 @@
 
 #include <THn.h>
 #include "QnCorrectionsEventClassVariablesSet.h"
+#include "QnCorrectionsEventClassBins.h"
+#include "QnCorrectionsProfileAccumulator.h"
 
 /// \class QnCorrectionsHistogramBase
 /// \brief Base class for the Q vector correction histograms
@@ -28,6 +30,11 @@
 /// The encapsulated bin axes values provide an efficient
 /// runtime storage for computing bin numbers.
 ///
+/// Optionally, the histograms can be attached to the current event
+/// bin coordinates of their event class variables set, kept by the
+/// framework manager. If so, bin numbers are computed from them without
+/// searching the bins on the histograms axes.
+///
 /// Provides the interface for the whole set of histogram
 /// classes providing error information that helps debugging.
 ///
@@ -58,9 +65,11 @@ public:
   virtual Bool_t AttachHistograms(TList *histogramList);
   virtual Bool_t AttachHistograms(TList *histogramList, const Bool_t *bUsedChannel, const Int_t *nChannelGroup);
 
+  void SetEventClassBins(const QnCorrectionsEventClassBins *eventClassBins);
 
   virtual Long64_t GetBin(const Float_t *variableContainer);
   virtual Long64_t GetBin(const Float_t *variableContainer, Int_t nChannel);
+  virtual Long64_t GetNoOfBins();
   /// Check the validity of the content of the passed bin
   /// Pure virtual function
   /// \param bin the bin to check its content validity
@@ -107,18 +116,28 @@ public:
   virtual void FillYX(Int_t harmonic, const Float_t *variableContainer, Float_t weight);
   virtual void FillYY(Int_t harmonic, const Float_t *variableContainer, Float_t weight);
 
+  /// Transfers the accumulated content to the histograms
+  ///
+  /// Histograms filled through a dense accumulator only get its
+  /// content when flushed. Default behavior: nothing to flush.
+  virtual void FlushAccumulator() {}
+
 protected:
   void FillBinAxesValues(const Float_t *variableContainer, Int_t chgrpId = -1);
+  const Int_t *FillBinAxesCoordinates(Int_t chgrpBin);
   THnF* DivideTHnF(THnF* values, THnI* entries, THnC *valid = NULL);
   void CopyTHnF(THnF *hDest, THnF *hSource, Int_t *binsArray);
   void CopyTHnFDimension(THnF *hDest, THnF *hSource, Int_t *binsArray, Int_t dimension);
 
   QnCorrectionsEventClassVariablesSet fEventClassVariables;  //!<! The variables set that determines the event classes
   Double_t *fBinAxesValues;                                  //!<! Runtime place holder for computing bin number
+  const QnCorrectionsEventClassBins *fEventClassBins;        //!<! The current event bin coordinates of the event classes, NULL if not available
+  Int_t *fBinAxesCoordinates;                                //!<! Runtime place holder for computing bin number from bin coordinates
+  QnCorrectionsProfileAccumulator *fAccumulator;             //!<! The dense accumulator for filled profiles, NULL if not used
   QnCorrectionHistogramErrorMode fErrorMode;                 //!<! The error type for the current instance
   Int_t fMinNoOfEntriesToValidate;                           ///< the minimum number of entries for validating a bin content
   /// \cond CLASSIMP
-  ClassDef(QnCorrectionsHistogramBase, 2);
+  ClassDef(QnCorrectionsHistogramBase, 3);
   /// \endcond
   static const char *szChannelAxisTitle;                 ///< The title for the channel extra axis
   static const char *szGroupAxisTitle;                   ///< The title for the channel group extra axis
@@ -154,5 +173,21 @@ inline void QnCorrectionsHistogramBase::FillBinAxesValues(const Float_t *variabl
   fBinAxesValues[fEventClassVariables.GetEntriesFast()] = chgrpId;
 }
 
+/// Fills the axes bin coordinates from the current event class bin coordinates
+///
+/// Used by the channelized histograms when attached to the event class bin
+/// coordinates. The extra channel or group axis bin is stored after them.
+///
+/// \param chgrpBin the channel or group axis bin
+/// \return the bin coordinates for all axes
+inline const Int_t *QnCorrectionsHistogramBase::FillBinAxesCoordinates(Int_t chgrpBin) {
+  const Int_t *coordinates = fEventClassBins->GetCoordinates();
+  for (Int_t var = 0; var < fEventClassVariables.GetEntriesFast(); var++) {
+    fBinAxesCoordinates[var] = coordinates[var];
+  }
+  fBinAxesCoordinates[fEventClassVariables.GetEntriesFast()] = chgrpBin;
+  return fBinAxesCoordinates;
+}
+
 
 #endif
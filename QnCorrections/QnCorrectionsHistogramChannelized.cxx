@@ -155,8 +155,10 @@ Bool_t QnCorrectionsHistogramChannelized::CreateChannelizedHistogram(TList *hist
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsHistogramChannelized::GetBin(const Float_t *variableContainer, Int_t nChannel) {
 
-  FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
+  if (fEventClassBins != NULL)
+    return fValues->GetBin(FillBinAxesCoordinates(fValues->GetAxis(fEventClassVariables.GetEntriesFast())->FindBin(fChannelMap[nChannel])));
   /* store the channel number */
+  FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
   return fValues->GetBin(fBinAxesValues);
 }
 
@@ -207,9 +209,9 @@ void QnCorrectionsHistogramChannelized::Fill(const Float_t *variableContainer, I
   /* keep the total entries in fValues updated */
   Double_t nEntries = fValues->GetEntries();
 
-  FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
+  Long64_t bin = GetBin(variableContainer, nChannel);
   /* and now update the bin */
-  fValues->Fill(fBinAxesValues, weight);
+  fValues->FillBin(bin, weight);
   fValues->SetEntries(nEntries + 1);
 }
 
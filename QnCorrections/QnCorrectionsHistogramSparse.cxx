@@ -93,8 +93,9 @@ Bool_t QnCorrectionsHistogramSparse::CreateHistogram(TList *histogramList) {
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsHistogramSparse::GetBin(const Float_t *variableContainer) {
 
+  if (fEventClassBins != NULL)
+    return fValues->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
-  /* store the channel number */
   return fValues->GetBin(fBinAxesValues);
 }
 
@@ -144,9 +145,9 @@ void QnCorrectionsHistogramSparse::Fill(const Float_t *variableContainer, Float_
   /* keep the total entries in fValues updated */
   Double_t nEntries = fValues->GetEntries();
 
-  FillBinAxesValues(variableContainer);
+  Long64_t bin = GetBin(variableContainer);
   /* and now update the bin */
-  fValues->Fill(fBinAxesValues, weight);
+  fValues->FillBin(bin, weight);
   fValues->SetEntries(nEntries + 1);
 }
 
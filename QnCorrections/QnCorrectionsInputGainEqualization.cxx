@@ -72,6 +72,7 @@ QnCorrectionsInputGainEqualization::QnCorrectionsInputGainEqualization() :
   fUseChannelGroupsWeights = kFALSE;
   fHardCodedWeights = NULL;
   fMinNoOfEntriesToValidate = fDefaultMinNoOfEntries;
+  fParametersTable = NULL;
 }
 
 /// Default destructor
@@ -87,26 +88,167 @@ QnCorrectionsInputGainEqualization::~QnCorrectionsInputGainEqualization() {
     delete fQAMultiplicityAfter;
   if (fQANotValidatedBin != NULL)
     delete fQANotValidatedBin;
+  ReleaseParametersTable();
 }
 
 /// Attaches the needed input information to the correction step
 ///
-/// If the attachment succeeded asks for hard coded group weights to
-/// the detector configuration
+/// If the equalization parameters table extracted from the same list
+/// was already published by another instance, i.e. a manager replica,
+/// it is shared and only the input histograms binning is attached.
+/// Otherwise the input histograms are fully attached and, if the
+/// attachment succeeded, the hard coded group weights are asked to
+/// the detector configuration and the table is built and published.
 /// \param list list where the inputs should be found
 /// \return kTRUE if everything went OK
 Bool_t QnCorrectionsInputGainEqualization::AttachInput(TList *list) {
   QnCorrectionsDetectorConfigurationChannels *ownerConfiguration =
       static_cast<QnCorrectionsDetectorConfigurationChannels *>(fDetectorConfiguration);
+
+  ReleaseParametersTable();
+  fParametersTable = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (fParametersTable != NULL) {
+    if (fInputHistograms->AttachBinning(list,
+        ownerConfiguration->GetUsedChannelsMask(), ownerConfiguration->GetChannelsGroups())) {
+      fState = QCORRSTEP_applyCollect;
+      fHardCodedWeights = ownerConfiguration->GetHardCodedGroupWeights();
+      return kTRUE;
+    }
+    ReleaseParametersTable();
+    return kFALSE;
+  }
+
   if (fInputHistograms->AttachHistograms(list,
       ownerConfiguration->GetUsedChannelsMask(), ownerConfiguration->GetChannelsGroups())) {
     fState = QCORRSTEP_applyCollect;
     fHardCodedWeights = ownerConfiguration->GetHardCodedGroupWeights();
+    fParametersTable = BuildParametersTable(list, fInputHistograms);
     return kTRUE;
   }
   return kFALSE;
 }
 
+/// Prepares in advance the input information of a calibration list
+///
+/// The input histograms fully attachment, the expensive part of
+/// AttachInput, is performed on private input histograms, the
+/// equalization parameters table is built out of them and published
+/// and the private histograms are discarded. A reference to the table
+/// is held so that AttachInput for the same list only needs to attach
+/// the input histograms binning.
+/// \param list list where the inputs should be found
+/// \return kTRUE if the equalization parameters table is available
+Bool_t QnCorrectionsInputGainEqualization::PrepareInput(TList *list) {
+  QnCorrectionsDetectorConfigurationChannels *ownerConfiguration =
+      static_cast<QnCorrectionsDetectorConfigurationChannels *>(fDetectorConfiguration);
+
+  const QnCorrectionsCalibrationSnapshot *table = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (table == NULL) {
+    QnCorrectionsProfileChannelizedIngress *inputHistograms = NewInputHistograms();
+    if (inputHistograms->AttachHistograms(list,
+        ownerConfiguration->GetUsedChannelsMask(), ownerConfiguration->GetChannelsGroups()))
+      table = BuildParametersTable(list, inputHistograms);
+    delete inputHistograms;
+  }
+  if (table == NULL) return kFALSE;
+  HoldPreparedInput(table);
+  return kTRUE;
+}
+
+/// Creates the input histograms of the correction step
+///
+/// Their event class bins are not set, so the caller should
+/// set them if the histograms are going to be used for event processing.
+/// \return the new input histograms
+QnCorrectionsProfileChannelizedIngress *QnCorrectionsInputGainEqualization::NewInputHistograms() const {
+  QnCorrectionsDetectorConfigurationChannels *ownerConfiguration =
+      static_cast<QnCorrectionsDetectorConfigurationChannels *>(fDetectorConfiguration);
+
+  TString histoNameAndTitle = Form("%s %s",
+      szSupportHistogramName,
+      fDetectorConfiguration->GetName());
+
+  QnCorrectionsProfileChannelizedIngress *inputHistograms =
+      new QnCorrectionsProfileChannelizedIngress((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
+          ownerConfiguration->GetEventClassVariablesSet(),ownerConfiguration->GetNoOfChannels(), "s");
+  inputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  return inputHistograms;
+}
+
+/// Builds the equalization parameters table out of the input histograms
+///
+/// For each event class and channel bin the validation flag is stored
+/// together with the scale and offset that, according to the equalization
+/// method, transform the channel weight as
+/// \f$ \mbox{M}' = \mbox{scale} \cdot \mbox{M} + \mbox{offset} \f$.
+/// Not significant averages get zero scale and offset. The group weight,
+/// either extracted from the channels multiplicity or hard coded, is
+/// folded into the scale and offset so, the channel groups histogram is
+/// not needed at equalization time.
+///
+/// The table is shared with any other instance of the correction step
+/// attached to the same calibration list.
+/// \param list the list the inputs were found in
+/// \param inputHistograms the input histograms fully attached to the list
+/// \return the equalization parameters table with a reference taken
+const QnCorrectionsCalibrationSnapshot *QnCorrectionsInputGainEqualization::BuildParametersTable(TList *list,
+    QnCorrectionsProfileChannelizedIngress *inputHistograms) {
+  const Float_t *hardCodedWeights =
+      static_cast<QnCorrectionsDetectorConfigurationChannels *>(fDetectorConfiguration)->GetHardCodedGroupWeights();
+
+  QnCorrectionsCalibrationSnapshot *table =
+      new QnCorrectionsCalibrationSnapshot(list, GetName(), inputHistograms->GetNoOfBins(), 1, 2);
+
+  for (Long64_t bin = 0; bin < table->GetNoOfBins(); bin++) {
+    table->SetBinValidated(bin, inputHistograms->BinContentValidated(bin));
+    Float_t *parameters = table->GetParametersToBuild(bin);
+    parameters[0] = 1.0;
+    parameters[1] = 0.0;
+    if (!table->IsBinValidated(bin)) continue;
+
+    Float_t average = inputHistograms->GetBinContent(bin);
+    if (!(fMinimumSignificantValue < average)) {
+      parameters[0] = 0.0;
+      continue;
+    }
+    switch (fEqualizationMethod) {
+    case GEQUAL_noEqualization:
+      break;
+    case GEQUAL_averageEqualization:
+      parameters[0] = 1.0 / average;
+      break;
+    case GEQUAL_widthEqualization: {
+      Float_t width = inputHistograms->GetBinError(bin);
+      parameters[0] = fScale / width;
+      parameters[1] = fShift - fScale * average / width;
+    }
+      break;
+    }
+
+    /* let's handle the potential group weights usage */
+    Float_t groupweight = 1.0;
+    if (fUseChannelGroupsWeights) {
+      groupweight = inputHistograms->GetGrpBinContentOfBin(bin);
+    }
+    else {
+      if (hardCodedWeights != NULL) {
+        Int_t nChannel = inputHistograms->GetBinChannel(bin);
+        if (!(nChannel < 0))
+          groupweight = hardCodedWeights[nChannel];
+      }
+    }
+    parameters[0] *= groupweight;
+    parameters[1] *= groupweight;
+  }
+  return QnCorrectionsCalibrationSnapshot::Publish(table);
+}
+
+/// Releases the reference to the equalization parameters table
+void QnCorrectionsInputGainEqualization::ReleaseParametersTable() {
+  QnCorrectionsCalibrationSnapshot::Release(fParametersTable);
+  fParametersTable = NULL;
+}
+
 /// Asks for support data structures creation
 ///
 /// Does nothing for the time being
@@ -134,11 +276,11 @@ Bool_t QnCorrectionsInputGainEqualization::CreateSupportHistograms(TList *list)
 QnCorrectionsDetectorConfigurationChannels *ownerConfiguration =
       static_cast<QnCorrectionsDetectorConfigurationChannels *>(fDetectorConfiguration);
   if (fInputHistograms != NULL) delete fInputHistograms;
-  fInputHistograms = new QnCorrectionsProfileChannelizedIngress((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
-      ownerConfiguration->GetEventClassVariablesSet(),ownerConfiguration->GetNoOfChannels(), "s");
-  fInputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  fInputHistograms = NewInputHistograms();
+  fInputHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fCalibrationHistograms = new QnCorrectionsProfileChannelized((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
       ownerConfiguration->GetEventClassVariablesSet(),ownerConfiguration->GetNoOfChannels(), "s");
+  fCalibrationHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fCalibrationHistograms->CreateProfileHistograms(list,
       ownerConfiguration->GetUsedChannelsMask(), ownerConfiguration->GetChannelsGroups());
   return kTRUE;
@@ -172,12 +314,14 @@ Bool_t QnCorrectionsInputGainEqualization::CreateQAHistograms(TList *list) {
       (const char *) beforeName,
       (const char *) beforeTitle,
       ownerConfiguration->GetEventClassVariablesSet(),ownerConfiguration->GetNoOfChannels());
+  fQAMultiplicityBefore->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fQAMultiplicityBefore->CreateProfileHistograms(list,
       ownerConfiguration->GetUsedChannelsMask(), ownerConfiguration->GetChannelsGroups());
   fQAMultiplicityAfter = new QnCorrectionsProfileChannelized(
       (const char *) afterName,
       (const char *) afterTitle,
       ownerConfiguration->GetEventClassVariablesSet(),ownerConfiguration->GetNoOfChannels());
+  fQAMultiplicityAfter->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fQAMultiplicityAfter->CreateProfileHistograms(list,
       ownerConfiguration->GetUsedChannelsMask(), ownerConfiguration->GetChannelsGroups());
   return kTRUE;
@@ -196,6 +340,7 @@ Bool_t QnCorrectionsInputGainEqualization::CreateNveQAHistograms(TList *list) {
       Form("%s %s", szQANotValidatedHistogramName, fDetectorConfiguration->GetName()),
       ownerConfiguration->GetEventClassVariablesSet(),
       ownerConfiguration->GetNoOfChannels());
+  fQANotValidatedBin->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fQANotValidatedBin->CreateChannelizedHistogram(list, ownerConfiguration->GetUsedChannelsMask());
   return kTRUE;
 }
@@ -210,104 +355,57 @@ Bool_t QnCorrectionsInputGainEqualization::CreateNveQAHistograms(TList *list) {
 /// structures should be included.
 /// \return kTRUE if the correction step was applied
 Bool_t QnCorrectionsInputGainEqualization::ProcessCorrections(const Float_t *variableContainer) {
+  QnCorrectionsDataVectorBank *dataBank = fDetectorConfiguration->GetDataVectorBank();
+  const Int_t *id = dataBank->GetIdArray();
+  Float_t *equalizedWeight = dataBank->GetEqualizedWeightArray();
+
   switch (fState) {
   case QCORRSTEP_calibration:
     /* collect the data needed to further produce equalization parameters */
-    for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-      QnCorrectionsDataVectorChannelized *dataVector =
-          static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-      fCalibrationHistograms->Fill(variableContainer, dataVector->GetId(), dataVector->EqualizedWeight());
+    for(Int_t ixData = 0; ixData < dataBank->GetEntriesFast(); ixData++){
+      fCalibrationHistograms->Fill(variableContainer, id[ixData], equalizedWeight[ixData]);
     }
     return kFALSE;
     break;
   case QCORRSTEP_applyCollect:
     /* collect the data needed to further produce equalization parameters */
-    for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-      QnCorrectionsDataVectorChannelized *dataVector =
-          static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-      fCalibrationHistograms->Fill(variableContainer, dataVector->GetId(), dataVector->EqualizedWeight());
+    for(Int_t ixData = 0; ixData < dataBank->GetEntriesFast(); ixData++){
+      fCalibrationHistograms->Fill(variableContainer, id[ixData], equalizedWeight[ixData]);
     }
     /* and proceed to ... */
   case QCORRSTEP_apply: /* apply the equalization */
     /* collect QA data if asked */
     if (fQAMultiplicityBefore != NULL) {
-      for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-        QnCorrectionsDataVectorChannelized *dataVector =
-            static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-        fQAMultiplicityBefore->Fill(variableContainer, dataVector->GetId(), dataVector->EqualizedWeight());
+      for(Int_t ixData = 0; ixData < dataBank->GetEntriesFast(); ixData++){
+        fQAMultiplicityBefore->Fill(variableContainer, id[ixData], equalizedWeight[ixData]);
       }
     }
     /* store the equalized weights in the data vector bank according to equalization method */
     switch (fEqualizationMethod) {
     case GEQUAL_noEqualization:
-      for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-        QnCorrectionsDataVectorChannelized *dataVector =
-            static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-        dataVector->SetEqualizedWeight(dataVector->EqualizedWeight());
-      }
+      /* the equalized weights are already there */
       break;
     case GEQUAL_averageEqualization:
-      for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-        QnCorrectionsDataVectorChannelized *dataVector =
-            static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-        Long64_t bin = fInputHistograms->GetBin(variableContainer, dataVector->GetId());
-        if (fInputHistograms->BinContentValidated(bin)) {
-          Float_t average = fInputHistograms->GetBinContent(bin);
-          /* let's handle the potential group weights usage */
-          Float_t groupweight = 1.0;
-          if (fUseChannelGroupsWeights) {
-            groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBin(variableContainer, dataVector->GetId()));
-          }
-          else {
-            if (fHardCodedWeights != NULL) {
-              groupweight = fHardCodedWeights[dataVector->GetId()];
-            }
-          }
-          if (fMinimumSignificantValue < average)
-            dataVector->SetEqualizedWeight((dataVector->EqualizedWeight() / average) * groupweight);
-          else
-            dataVector->SetEqualizedWeight(0.0);
-        }
-        else {
-          if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, dataVector->GetId(), 1.0);
-        }
-      }
-      break;
     case GEQUAL_widthEqualization:
-      for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-        QnCorrectionsDataVectorChannelized *dataVector =
-            static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-        Long64_t bin = fInputHistograms->GetBin(variableContainer, dataVector->GetId());
-        if (fInputHistograms->BinContentValidated(bin)) {
-          Float_t average = fInputHistograms->GetBinContent(fInputHistograms->GetBin(variableContainer, dataVector->GetId()));
-          Float_t width = fInputHistograms->GetBinError(fInputHistograms->GetBin(variableContainer, dataVector->GetId()));
-          /* let's handle the potential group weights usage */
-          Float_t groupweight = 1.0;
-          if (fUseChannelGroupsWeights) {
-            groupweight = fInputHistograms->GetGrpBinContent(fInputHistograms->GetGrpBin(variableContainer, dataVector->GetId()));
-          }
-          else {
-            if (fHardCodedWeights != NULL) {
-              groupweight = fHardCodedWeights[dataVector->GetId()];
-            }
-          }
-          if (fMinimumSignificantValue < average)
-            dataVector->SetEqualizedWeight((fShift + fScale * (dataVector->EqualizedWeight() - average) / width) * groupweight);
-          else
-            dataVector->SetEqualizedWeight(0.0);
+      for(Int_t ixData = 0; ixData < dataBank->GetEntriesFast(); ixData++){
+        Long64_t bin = fInputHistograms->GetBin(variableContainer, id[ixData]);
+        if (fParametersTable->IsBinValidated(bin)) {
+          /* the group weights are already folded into the table */
+          QnCorrectionsInstrumentBin(fCorrectionsCounters, kTRUE);
+          const Float_t *parameters = fParametersTable->GetParameters(bin);
+          equalizedWeight[ixData] = parameters[0] * equalizedWeight[ixData] + parameters[1];
         }
         else {
-          if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, dataVector->GetId(), 1.0);
+          QnCorrectionsInstrumentBin(fCorrectionsCounters, kFALSE);
+          if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, id[ixData], 1.0);
         }
       }
       break;
     }
     /* collect QA data if asked */
     if (fQAMultiplicityAfter != NULL) {
-      for(Int_t ixData = 0; ixData < fDetectorConfiguration->GetInputDataBank()->GetEntriesFast(); ixData++){
-        QnCorrectionsDataVectorChannelized *dataVector =
-            static_cast<QnCorrectionsDataVectorChannelized *>(fDetectorConfiguration->GetInputDataBank()->At(ixData));
-        fQAMultiplicityAfter->Fill(variableContainer, dataVector->GetId(), dataVector->EqualizedWeight());
+      for(Int_t ixData = 0; ixData < dataBank->GetEntriesFast(); ixData++){
+        fQAMultiplicityAfter->Fill(variableContainer, id[ixData], equalizedWeight[ixData]);
       }
     }
     break;
@@ -375,3 +473,13 @@ Bool_t QnCorrectionsInputGainEqualization::ReportUsage(TList *calibrationList, T
   return kTRUE;
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+void QnCorrectionsInputGainEqualization::FlushHistograms() {
+  if (fCalibrationHistograms != NULL)
+    fCalibrationHistograms->FlushAccumulator();
+  if (fQAMultiplicityBefore != NULL)
+    fQAMultiplicityBefore->FlushAccumulator();
+  if (fQAMultiplicityAfter != NULL)
+    fQAMultiplicityAfter->FlushAccumulator();
+}
+
@@ -51,6 +51,7 @@
 /// further phase, the calibration histograms.
 
 #include "QnCorrectionsCorrectionOnInputData.h"
+#include "QnCorrectionsCalibrationSnapshot.h"
 
 class QnCorrectionsProfileChannelizedIngress;
 class QnCorrectionsProfileChannelized;
@@ -143,6 +144,7 @@ public:
   /// No action for input gain equalization
   virtual void AttachedToFrameworkManager() {}
   virtual Bool_t AttachInput(TList *list);
+  virtual Bool_t PrepareInput(TList *list);
   virtual void CreateSupportDataStructures();
   virtual Bool_t CreateSupportHistograms(TList *list);
   virtual Bool_t CreateQAHistograms(TList *list);
@@ -153,9 +155,14 @@ public:
   /// Clean the correction to accept a new event
   /// Does nothing for the time being
   virtual void ClearCorrectionStep() {}
+  virtual void FlushHistograms();
   virtual Bool_t ReportUsage(TList *calibrationList, TList *applyList);
 
 private:
+  QnCorrectionsProfileChannelizedIngress *NewInputHistograms() const;
+  const QnCorrectionsCalibrationSnapshot *BuildParametersTable(TList *list, QnCorrectionsProfileChannelizedIngress *inputHistograms);
+  void ReleaseParametersTable();
+
   static const Float_t  fMinimumSignificantValue;     ///< the minimum value that will be considered as meaningful for processing
   static const Int_t fDefaultMinNoOfEntries;         ///< the minimum number of entries for bin content validation
   static const char *szCorrectionName;               ///< the name of the correction step
@@ -176,8 +183,10 @@ private:
   const Float_t *fHardCodedWeights;             //!<! group hard coded weights stored in the detector configuration
   Int_t fMinNoOfEntriesToValidate;              ///< number of entries for bin content validation threshold
 
+  const QnCorrectionsCalibrationSnapshot *fParametersTable; //!<! shared, per bin the scale and offset to apply to the channel weight
+
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsInputGainEqualization, 2);
+  ClassDef(QnCorrectionsInputGainEqualization, 4);
 /// \endcond
 };
 
@@ -0,0 +1,199 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsInstrumentation.cxx
+/// \brief Implementation of the per detector configuration and correction step timing and counters
+
+#include <TList.h>
+#include <TH1D.h>
+
+#include "QnCorrectionsInstrumentation.h"
+#include "QnCorrectionsLog.h"
+
+#include <iostream>
+#include <iomanip>
+
+using std::cout;
+using std::endl;
+using std::setw;
+
+/// the number of counters words per entry block, padded to two cache lines
+#define INSTRUMENTATIONBLOCKSIZE 16
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsInstrumentation);
+/// \endcond
+
+const char *QnCorrectionsInstrumentation::szConfigurationStepName = "all";
+const char *QnCorrectionsInstrumentation::szInstrumentationHistogramsKeyName = "InstrumentationHistograms";
+const char *QnCorrectionsInstrumentation::szPhaseName[nNoOfPhases] = {"corrections", "collection"};
+const char *QnCorrectionsInstrumentation::szCounterName[nNoOfCounters] = {"cycles", "calls", "data vectors", "validated bins", "not validated bins"};
+
+/// Default constructor
+QnCorrectionsInstrumentation::QnCorrectionsInstrumentation() : TObject(),
+    fConfigurationName(), fStepName(), fPhase(), fCounters() {
+  for (Int_t ixCounter = 0; ixCounter < nNoOfCounters; ixCounter++)
+    fHistograms[ixCounter] = NULL;
+}
+
+/// Default destructor
+/// Releases the counters blocks. The histograms belong to the list they were incorporated to
+QnCorrectionsInstrumentation::~QnCorrectionsInstrumentation() {
+  for (UInt_t entry = 0; entry < fCounters.size(); entry++)
+    delete [] fCounters[entry];
+}
+
+/// Adds a new entry to the table
+///
+/// Entries must be added before creating the histograms.
+/// \param configuration the detector configuration name
+/// \param step the correction step name, szConfigurationStepName for the whole detector configuration
+/// \param phase the event processing phase
+/// \return the counters block of the new entry
+ULong64_t *QnCorrectionsInstrumentation::AddEntry(const char *configuration, const char *step, Phase phase) {
+  if (fHistograms[0] != NULL) {
+    QnCorrectionsFatal("Instrumentation entries cannot be added once the histograms are created. FIX IT, PLEASE.");
+    return NULL;
+  }
+
+  ULong64_t *counters = new ULong64_t[INSTRUMENTATIONBLOCKSIZE];
+  for (Int_t ixCounter = 0; ixCounter < INSTRUMENTATIONBLOCKSIZE; ixCounter++)
+    counters[ixCounter] = 0;
+
+  fConfigurationName.push_back(TString(configuration));
+  fStepName.push_back(TString(step));
+  fPhase.push_back(phase);
+  fCounters.push_back(counters);
+  return counters;
+}
+
+/// Finds an entry of the table
+/// \param configuration the detector configuration name
+/// \param step the correction step name, szConfigurationStepName for the whole detector configuration
+/// \param phase the event processing phase
+/// \return the entry index, -1 if not found
+Int_t QnCorrectionsInstrumentation::FindEntry(const char *configuration, const char *step, Phase phase) const {
+  for (Int_t entry = 0; entry < GetNoOfEntries(); entry++) {
+    if (fPhase[entry] == phase && fConfigurationName[entry].EqualTo(configuration) && fStepName[entry].EqualTo(step))
+      return entry;
+  }
+  return -1;
+}
+
+/// Adds the counters of other instrumentation table
+///
+/// Both tables must have been built for the same framework configuration,
+/// as it is the case for the replicas of a manager, the entries being
+/// matched by position.
+/// \param instrumentation the table to add
+void QnCorrectionsInstrumentation::Add(const QnCorrectionsInstrumentation *instrumentation) {
+  if (instrumentation->GetNoOfEntries() != GetNoOfEntries()) {
+    QnCorrectionsError("The instrumentation tables do not match. Not added.");
+    return;
+  }
+  for (Int_t entry = 0; entry < GetNoOfEntries(); entry++) {
+    for (Int_t ixCounter = 0; ixCounter < nNoOfCounters; ixCounter++)
+      fCounters[entry][ixCounter] += instrumentation->fCounters[entry][ixCounter];
+  }
+}
+
+/// Zeroes the counters of all entries
+///
+/// Useful for discarding the warm up events. It must not be called
+/// while events are being processed.
+void QnCorrectionsInstrumentation::Reset() {
+  for (Int_t entry = 0; entry < GetNoOfEntries(); entry++) {
+    for (Int_t ixCounter = 0; ixCounter < nNoOfCounters; ixCounter++)
+      fCounters[entry][ixCounter] = 0;
+  }
+  UpdateHistograms();
+}
+
+/// Creates the counters histograms
+///
+/// One histogram per counter with one bin per entry, labeled as
+/// `<configuration>:<step>:<phase>`, is created and incorporated to
+/// the passed list for its persistence.
+/// \param list list where the histograms should be incorporated
+void QnCorrectionsInstrumentation::CreateHistograms(TList *list) {
+  Int_t nEntries = GetNoOfEntries();
+  if (nEntries == 0) return;
+
+  for (Int_t ixCounter = 0; ixCounter < nNoOfCounters; ixCounter++) {
+    fHistograms[ixCounter] = new TH1D(Form("Instrumentation %s", szCounterName[ixCounter]),
+        Form("Instrumentation %s", szCounterName[ixCounter]), nEntries, 0.0, nEntries);
+    for (Int_t entry = 0; entry < nEntries; entry++) {
+      fHistograms[ixCounter]->GetXaxis()->SetBinLabel(entry + 1,
+          Form("%s:%s:%s", fConfigurationName[entry].Data(), fStepName[entry].Data(), szPhaseName[fPhase[entry]]));
+    }
+    fHistograms[ixCounter]->SetYTitle(szCounterName[ixCounter]);
+    list->Add(fHistograms[ixCounter]);
+  }
+}
+
+/// Transfers the current counters values to the histograms
+///
+/// It should be called before any access to the histograms.
+void QnCorrectionsInstrumentation::UpdateHistograms() {
+  if (fHistograms[0] == NULL) return;
+
+  for (Int_t ixCounter = 0; ixCounter < nNoOfCounters; ixCounter++) {
+    Double_t total = 0.0;
+    for (Int_t entry = 0; entry < GetNoOfEntries(); entry++) {
+      fHistograms[ixCounter]->SetBinContent(entry + 1, fCounters[entry][ixCounter]);
+      total += fCounters[entry][ixCounter];
+    }
+    fHistograms[ixCounter]->SetEntries(total);
+  }
+}
+
+/// Prints the table
+///
+/// Besides the counters, the cycles per call and per data vector
+/// are shown.
+/// \param option not used
+void QnCorrectionsInstrumentation::Print(Option_t *) const {
+  cout << endl;
+  cout << setw(20) << "configuration" << setw(20) << "step" << setw(13) << "phase"
+      << setw(12) << "calls" << setw(16) << "cycles" << setw(12) << "cycles/call"
+      << setw(14) << "data vectors" << setw(12) << "cycles/dv"
+      << setw(12) << "valid bins" << setw(12) << "nve bins" << endl;
+  for (Int_t entry = 0; entry < GetNoOfEntries(); entry++) {
+    const ULong64_t *counters = fCounters[entry];
+    cout << setw(20) << fConfigurationName[entry].Data() << setw(20) << fStepName[entry].Data() << setw(13) << szPhaseName[fPhase[entry]]
+        << setw(12) << counters[kCalls] << setw(16) << counters[kCycles]
+        << setw(12) << ((counters[kCalls] != 0) ? counters[kCycles] / counters[kCalls] : 0)
+        << setw(14) << counters[kDataVectors]
+        << setw(12) << ((counters[kDataVectors] != 0) ? counters[kCycles] / counters[kDataVectors] : 0)
+        << setw(12) << counters[kValidatedBins] << setw(12) << counters[kNotValidatedBins] << endl;
+  }
+  cout << endl;
+}
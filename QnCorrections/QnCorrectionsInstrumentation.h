@@ -0,0 +1,209 @@
+#ifndef QNCORRECTIONS_INSTRUMENTATION_H
+#define QNCORRECTIONS_INSTRUMENTATION_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsInstrumentation.h
+/// \brief Per detector configuration and correction step timing and counters
+
+#include <TObject.h>
+#include <TString.h>
+#include <vector>
+#if !(defined(__x86_64__) || defined(__i386__))
+#include <time.h>
+#endif
+
+class TList;
+class TH1D;
+
+/// Whether the instrumentation is compiled in the framework
+///
+/// When zero, the default, the instrumentation points in the event
+/// processing path are removed at compile time.
+#ifndef QNCORRECTIONS_INSTRUMENTATION
+# define QNCORRECTIONS_INSTRUMENTATION 0
+#endif
+
+/// \class QnCorrectionsInstrumentation
+/// \brief Table of the event processing counters of each detector configuration and correction step
+///
+/// Each entry of the table corresponds to a detector configuration, as
+/// a whole, or to one of its correction steps, in one of the two event
+/// processing phases: the corrections and the data collection. For each
+/// entry it is accounted the number of calls, the elapsed cycles, the
+/// data vectors of the detector configuration processed and the number
+/// of correction parameters bins found validated and not validated.
+///
+/// Cycles are read from the processor time stamp counter where available
+/// and are nanoseconds of the monotonic clock otherwise.
+///
+/// Entries are created at framework initialization and each of them
+/// gets its own counters block, which is only updated by the thread
+/// processing its detector configuration. Blocks are padded so that
+/// detector configurations processed in parallel do not share cache
+/// lines.
+///
+/// The counters are kept in the table and, on request, transferred to a
+/// set of histograms, one per counter with one bin per entry, incorporated
+/// to the passed list for their persistence.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsInstrumentation : public TObject {
+public:
+  /// The event processing phases
+  enum Phase {
+    kCorrections = 0,          ///< the corrections phase
+    kDataCollection,           ///< the data collection phase
+    nNoOfPhases                ///< the number of phases
+  };
+  /// The counters of each entry
+  enum Counter {
+    kCycles = 0,               ///< the elapsed cycles
+    kCalls,                    ///< the number of calls
+    kDataVectors,              ///< the number of data vectors processed
+    kValidatedBins,            ///< the number of correction parameters bins found validated
+    kNotValidatedBins,         ///< the number of correction parameters bins found not validated
+    nNoOfCounters              ///< the number of counters
+  };
+
+  QnCorrectionsInstrumentation();
+  virtual ~QnCorrectionsInstrumentation();
+
+  ULong64_t *AddEntry(const char *configuration, const char *step, Phase phase);
+  Int_t FindEntry(const char *configuration, const char *step, Phase phase) const;
+  /// Gets the number of entries of the table
+  /// \return the number of entries
+  Int_t GetNoOfEntries() const { return fCounters.size(); }
+  /// Gets the detector configuration name of an entry
+  /// \param entry the entry index
+  /// \return the detector configuration name
+  const char *GetConfigurationName(Int_t entry) const { return fConfigurationName[entry].Data(); }
+  /// Gets the correction step name of an entry
+  /// \param entry the entry index
+  /// \return the correction step name, szConfigurationStepName for the whole detector configuration
+  const char *GetStepName(Int_t entry) const { return fStepName[entry].Data(); }
+  /// Gets the event processing phase of an entry
+  /// \param entry the entry index
+  /// \return the phase
+  Phase GetPhase(Int_t entry) const { return (Phase) fPhase[entry]; }
+  /// Gets a counter of an entry
+  /// \param entry the entry index
+  /// \param counter the counter
+  /// \return the counter value
+  ULong64_t GetCounter(Int_t entry, Counter counter) const { return fCounters[entry][counter]; }
+
+  void Add(const QnCorrectionsInstrumentation *instrumentation);
+  void Reset();
+  void CreateHistograms(TList *list);
+  void UpdateHistograms();
+  virtual void Print(Option_t *option = "") const;
+
+  static ULong64_t ReadCycleCounter();
+
+  static const char *szConfigurationStepName;          ///< the step name of the entries of the whole detector configuration
+  static const char *szInstrumentationHistogramsKeyName; ///< the name of the key under which the instrumentation histograms are stored
+
+private:
+  static const char *szPhaseName[nNoOfPhases];          ///< the names of the phases
+  static const char *szCounterName[nNoOfCounters];      ///< the names of the counters
+
+  std::vector<TString> fConfigurationName;  //!<! the detector configuration of each entry
+  std::vector<TString> fStepName;           //!<! the correction step of each entry
+  std::vector<Int_t> fPhase;                //!<! the event processing phase of each entry
+  std::vector<ULong64_t *> fCounters;       //!<! the counters block of each entry
+  TH1D *fHistograms[nNoOfCounters];         //!<! the histograms of each counter, not owned
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsInstrumentation(const QnCorrectionsInstrumentation &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsInstrumentation& operator= (const QnCorrectionsInstrumentation &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsInstrumentation, 1);
+/// \endcond
+};
+
+/// Reads the cycles counter
+/// \return the processor time stamp counter, or the monotonic clock nanoseconds where not available
+inline ULong64_t QnCorrectionsInstrumentation::ReadCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return ((ULong64_t) now.tv_sec) * 1000000000ULL + now.tv_nsec;
+#endif
+}
+
+/// \class QnCorrectionsInstrumentationScope
+/// \brief Accounts a call to an instrumented entry for the lifetime of the object
+///
+/// The call and the processed data vectors are accounted at construction
+/// and the elapsed cycles at destruction. Nothing is done if the entry
+/// counters block is NULL, the instrumentation not being active.
+///
+/// It should not be used directly but through the QnCorrectionsInstrument
+/// macro so that it is removed when the instrumentation is not compiled in.
+class QnCorrectionsInstrumentationScope {
+public:
+  /// Normal constructor
+  /// \param counters the entry counters block, NULL if not instrumented
+  /// \param nDataVectors the number of data vectors being processed
+  QnCorrectionsInstrumentationScope(ULong64_t *counters, Int_t nDataVectors) : fCounters(counters), fStart(0) {
+    if (fCounters != NULL) {
+      fCounters[QnCorrectionsInstrumentation::kCalls]++;
+      fCounters[QnCorrectionsInstrumentation::kDataVectors] += nDataVectors;
+      fStart = QnCorrectionsInstrumentation::ReadCycleCounter();
+    }
+  }
+  /// Destructor
+  /// Accounts the elapsed cycles
+  ~QnCorrectionsInstrumentationScope() {
+    if (fCounters != NULL)
+      fCounters[QnCorrectionsInstrumentation::kCycles] += QnCorrectionsInstrumentation::ReadCycleCounter() - fStart;
+  }
+
+private:
+  ULong64_t *fCounters;        ///< the entry counters block
+  ULong64_t fStart;            ///< the cycles counter at construction
+
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsInstrumentationScope(const QnCorrectionsInstrumentationScope &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsInstrumentationScope& operator= (const QnCorrectionsInstrumentationScope &);
+};
+
+#if QNCORRECTIONS_INSTRUMENTATION
+/// Instruments the rest of the enclosing scope
+/// \param counters the entry counters block, NULL if not instrumented
+/// \param nDataVectors the number of data vectors being processed
+# define QnCorrectionsInstrument(counters,nDataVectors) QnCorrectionsInstrumentationScope qnCorrectionsInstrumentationScope(counters, nDataVectors)
+/// Accounts a correction parameters bin lookup
+/// \param counters the entry counters block, NULL if not instrumented
+/// \param validated kTRUE if the bin was found validated
+# define QnCorrectionsInstrumentBin(counters,validated) \
+  do { if ((counters) != NULL) (counters)[(validated) ? QnCorrectionsInstrumentation::kValidatedBins : QnCorrectionsInstrumentation::kNotValidatedBins]++; } while(false)
+#else
+/// Instruments the rest of the enclosing scope: removed at compile time
+# define QnCorrectionsInstrument(counters,nDataVectors) do {} while(false)
+/// Accounts a correction parameters bin lookup: removed at compile time
+# define QnCorrectionsInstrumentBin(counters,validated) do {} while(false)
+#endif
+
+#endif /* QNCORRECTIONS_INSTRUMENTATION_H */
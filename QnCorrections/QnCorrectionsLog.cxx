@@ -34,7 +34,8 @@
 #include <TString.h>
 #include "QnCorrectionsLog.h"
 
-UInt_t nLoggingLevel = kError; ///< the current logging level
+UInt_t nQnCorrectionsLoggingLevel = kError; ///< the current logging level
+UInt_t nQnCorrectionsLoggingCategories = (0x1 << kQnCorrectionsLogNoOfCategories) - 1; ///< the mask of the currently active logging categories
 
 /// Sets the logging level
 /// Supported levels match ROOT logging levels currently
@@ -48,7 +49,25 @@ UInt_t nLoggingLevel = kError; ///< the current logging level
 void QnCorrectionsSetTracingLevel(UInt_t level) {
   if (level < UInt_t(kError))
     /* don't mask errors */
-    nLoggingLevel = level;
+    nQnCorrectionsLoggingLevel = level;
+}
+
+/// Switches on and off a logging category
+/// Info and Warning messages of a switched off category are not
+/// printed, not even built, whatever the logging level is.
+/// All categories are initially switched on.
+///
+/// Error and Fatal messages cannot be masked
+///
+/// \param category the logging category
+/// \param enable kTRUE to switch the category on, kFALSE to switch it off
+void QnCorrectionsSetTracingCategory(UInt_t category, Bool_t enable) {
+  if (category < UInt_t(kQnCorrectionsLogNoOfCategories)) {
+    if (enable)
+      nQnCorrectionsLoggingCategories |= (0x1 << category);
+    else
+      nQnCorrectionsLoggingCategories &= ~(0x1 << category);
+  }
 }
 
 /// Support function for printing logging messages. The message
@@ -71,7 +90,7 @@ void QnCorrectionsPrintMessageHandler(UInt_t type, const char* message,
   TString sLocation = Form("%s/%s::%s: (%s:%.0d)",module,className,function,file,line);
 
   if (message != NULL) {
-    if (!(type < nLoggingLevel)) {
+    if (!(type < nQnCorrectionsLoggingLevel)) {
       switch (type) {
       case kInfo:
         Info(Form("I-%s", (const char *) sLocation), "%s", message);
@@ -89,7 +108,7 @@ void QnCorrectionsPrintMessageHandler(UInt_t type, const char* message,
     }
   }
   else {
-    if (!(type < nLoggingLevel)) {
+    if (!(type < nQnCorrectionsLoggingLevel)) {
       switch (type) {
       case kInfo:
         Info(Form("I-%s", (const char *) sLocation), "%s", " ");
@@ -35,23 +35,87 @@
 # define FUNCTIONNAME() "???"
 #endif
 
+/// The minimum logging level compiled in the framework
+///
+/// Info and Warning messages below it are removed at compile time.
+/// Its values match ROOT logging levels: 0 keeps everything, 1001
+/// removes Info messages and 2001 removes Info and Warning messages.
+/// Error and Fatal messages are always kept.
+#ifndef QNCORRECTIONS_MINIMUM_LOGGING_LEVEL
+# define QNCORRECTIONS_MINIMUM_LOGGING_LEVEL 0
+#endif
+
+/// \typedef QnCorrectionsLogCategory
+/// \brief The categories the logging messages are classified in
+///
+/// Each category can be switched on and off at run time via
+/// QnCorrectionsSetTracingCategory.
+typedef enum {
+  kQnCorrectionsLogFramework = 0,     ///< framework configuration and control flow messages
+  kQnCorrectionsLogEventProcessing,   ///< per event processing messages
+  kQnCorrectionsLogNoOfCategories     ///< the number of logging categories
+} QnCorrectionsLogCategory;
+
 extern void QnCorrectionsPrintMessageHandler(UInt_t type, const char* message,
                           const char* module, const char* className,
                           const char* function, const char* file, Int_t line);
 extern void QnCorrectionsSetTracingLevel(UInt_t level);
+extern void QnCorrectionsSetTracingCategory(UInt_t category, Bool_t enable);
+
+extern UInt_t nQnCorrectionsLoggingLevel;         ///< the current logging level
+extern UInt_t nQnCorrectionsLoggingCategories;    ///< the mask of the currently active logging categories
+
+/// Checks whether a logging message will be printed
+///
+/// Error and Fatal messages are always printed. Otherwise the message
+/// level should reach the current logging level and its category should
+/// be active.
+/// \param lvl level of the logging message
+/// \param category category of the logging message
+/// \return kTRUE if the message will be printed
+inline Bool_t QnCorrectionsIsLoggingActive(UInt_t lvl, UInt_t category) {
+  if (!(lvl < UInt_t(kError)))
+    return kTRUE;
+  return (!(lvl < nQnCorrectionsLoggingLevel) && ((nQnCorrectionsLoggingCategories >> category) & 0x1));
+}
 
 /// Actual way to invoke the logging function. It is
 /// a macro that incorporates the additional information needed
 /// for locating the source code the message was raised.
+///
+/// The message is only built, and the logging function invoked,
+/// if the message is going to be printed.
+/// \param lvl level of the logging message
+/// \param category category of the logging message
+/// \param message meaningful message to print
+#define QnCorrectionsCategoryMessage(lvl,category,message) do { \
+      if (QnCorrectionsIsLoggingActive(lvl, category)) \
+        QnCorrectionsPrintMessageHandler(lvl, message, MODULENAME(), ClassName(), FUNCTIONNAME(), __FILE__, __LINE__);} while(false)
+
+/// Logging message of the framework category
 /// \param lvl level of the logging message
 /// \param message meaningful message to print
-#define QnCorrectionsMessage(lvl,message) do { \
-      QnCorrectionsPrintMessageHandler(lvl, message, MODULENAME(), ClassName(), FUNCTIONNAME(), __FILE__, __LINE__);} while(false)
+#define QnCorrectionsMessage(lvl,message)        QnCorrectionsCategoryMessage(lvl, kQnCorrectionsLogFramework, message)
+
+#if QNCORRECTIONS_MINIMUM_LOGGING_LEVEL > 1000
+/// User function for an Info message: removed at compile time
+# define QnCorrectionsCategoryInfo(category,message) do {} while(false)
+#else
+/// User function for an Info message of a given category
+# define QnCorrectionsCategoryInfo(category,message) QnCorrectionsCategoryMessage(kInfo, category, message)
+#endif
+#if QNCORRECTIONS_MINIMUM_LOGGING_LEVEL > 2000
+/// User function for a Warning message: removed at compile time
+# define QnCorrectionsCategoryWarning(category,message) do {} while(false)
+#else
+/// User function for a Warning message of a given category
+# define QnCorrectionsCategoryWarning(category,message) QnCorrectionsCategoryMessage(kWarning, category, message)
+#endif
 
 /// User function for an Info message
-#define QnCorrectionsInfo(message)               QnCorrectionsMessage(kInfo, message)
+#define QnCorrectionsInfo(message)               QnCorrectionsCategoryInfo(kQnCorrectionsLogFramework, message)
 /// User function for a Warning message
-#define QnCorrectionsWarning(message)            QnCorrectionsMessage(kWarning, message)
+#define QnCorrectionsWarning(message)            QnCorrectionsCategoryWarning(kQnCorrectionsLogFramework, message)
 /// User function for an Error message
 #define QnCorrectionsError(message)              QnCorrectionsMessage(kError, message)
 /// User function for a Fatal message: stop execution
@@ -34,6 +34,8 @@
 #include <TFile.h>
 #include <TList.h>
 #include <TKey.h>
+#include <TThread.h>
+#include "QnCorrectionsCalibrationSnapshot.h"
 #include "QnCorrectionsManager.h"
 #include "QnCorrectionsLog.h"
 
@@ -51,56 +53,137 @@ ClassImp(QnCorrectionsManager);
 
 const Int_t QnCorrectionsManager::nMaxNoOfDetectors = 32;
 const Int_t QnCorrectionsManager::nMaxNoOfDataVariables = 2048;
+const Int_t QnCorrectionsManager::nDefaultMaxNoOfCachedCalibrationLists = 4;
 const char *QnCorrectionsManager::szCalibrationHistogramsKeyName = "CalibrationHistograms";
 const char *QnCorrectionsManager::szCalibrationQAHistogramsKeyName = "CalibrationQAHistograms";
 const char *QnCorrectionsManager::szCalibrationNveQAHistogramsKeyName = "CalibrationQANveHistograms";
 const char *QnCorrectionsManager::szDummyProcessListName = "dummyprocess";
 const char *QnCorrectionsManager::szAllProcessesListName = "all data";
+const char *QnCorrectionsManager::szQnVectorTreeName = "QnVectorTree";
 
 /// Default constructor.
 /// The class owns the detectors and will be destroyed with it
 QnCorrectionsManager::QnCorrectionsManager() :
-    TObject(), fDetectorsSet(), fProcessListName(szDummyProcessListName) {
+    TObject(), fDetectorsSet(), fCalibrationListsCache(), fProcessListName(szDummyProcessListName), fEventClassBinsSet(), fReplicas(),
+    fEventContexts(), fFreeEventContexts() {
 
   fDetectorsSet.SetOwner(kTRUE);
+  fEventClassBinsSet.SetOwner(kTRUE);
+  fCalibrationListsCache.SetOwner(kTRUE);
+  fReplicas.SetOwner(kTRUE);
+  fEventContexts.SetOwner(kTRUE);
+  fFreeEventContexts.SetOwner(kFALSE);
   fDetectorsIdMap = NULL;
   fDataContainer = NULL;
   fCalibrationHistogramsList = NULL;
+  fCalibrationFile = NULL;
+  fMaxNoOfCachedCalibrationLists = nDefaultMaxNoOfCachedCalibrationLists;
+  fPrefetchThread = NULL;
+  fPrefetchedCalibrationList = NULL;
+  fPrefetchKnownCalibrationList = NULL;
   fSupportHistogramsList = NULL;
   fQAHistogramsList = NULL;
   fNveQAHistogramsList = NULL;
+  fInstrumentation = NULL;
+  fInstrumentationHistogramsList = NULL;
   fQnVectorTree = NULL;
   fQnVectorList = NULL;
+  fQnVectorListVersion = 0;
+  fQnVectorTreeWriter = NULL;
+  fQnVectorTreeQueueDepth = QnCorrectionsQnVectorTreeWriter::nDefaultQueueDepth;
   fFillOutputHistograms = kFALSE;
   fFillQAHistograms = kFALSE;
   fFillNveQAHistograms = kFALSE;
   fFillQnVectorTree = kFALSE;
+  fInstrument = kFALSE;
   fProcessesNames = NULL;
+  fMaster = NULL;
+  fNoOfConfigurationsWorkers = 0;
+  fConfigurationsScheduler = NULL;
 }
 
 /// Default destructor
 /// Deletes the memory taken
 QnCorrectionsManager::~QnCorrectionsManager() {
 
+  if (fConfigurationsScheduler != NULL) delete fConfigurationsScheduler;
+  if (fQnVectorTreeWriter != NULL && fMaster == NULL) delete fQnVectorTreeWriter;
+  if (fInstrumentation != NULL) delete fInstrumentation;
   if (fDetectorsIdMap != NULL) delete [] fDetectorsIdMap;
   if (fDataContainer != NULL) delete [] fDataContainer;
-  if (fCalibrationHistogramsList != NULL) delete fCalibrationHistogramsList;
+  WaitForCalibrationPrefetch();
+  WithdrawCalibrationSnapshots(&fCalibrationListsCache);
+  if (fCalibrationHistogramsList != NULL) {
+    WithdrawCalibrationSnapshots(fCalibrationHistogramsList);
+    delete fCalibrationHistogramsList;
+  }
   if (fProcessesNames != NULL) delete fProcessesNames;
 }
 
 /// Sets the base list that will own the input calibration histograms
+///
+/// In the default mode the whole calibration histograms list, for all the
+/// processes stored in the file, is read and kept.
+///
+/// In lazy mode nothing is read at this point. The calibration list of
+/// a process is only read when it is going to be attached, without cloning
+/// it, and kept in a bounded cache of the most recently used ones. The
+/// calibration file must then be kept open while the framework is running.
+/// Lazy mode requires the calibration histograms stored in a directory
+/// with one key per process, see WriteOutputHistogramsDirectory, so that
+/// only the needed process list is read from disk. Files with the whole
+/// list under a single key can only be read whole so, for them, lazy mode
+/// is turned off with a warning and the default mode is used. In the
+/// default mode files in the directory layout get their process lists
+/// read one by one.
 /// \param calibrationFile the file
-void QnCorrectionsManager::SetCalibrationHistogramsList(TFile *calibrationFile) {
+/// \param lazy kTRUE for lazy loading of the process calibration lists
+void QnCorrectionsManager::SetCalibrationHistogramsList(TFile *calibrationFile, Bool_t lazy) {
   if (calibrationFile) {
     if (calibrationFile->GetListOfKeys()->GetEntries() > 0) {
+      /* a pending prefetch belongs to the previous file */
+      WaitForCalibrationPrefetch();
       /* let's see if we already had a previous calibration histograms list */
-      if (fCalibrationHistogramsList != NULL){
+      if (fCalibrationHistogramsList != NULL || fCalibrationListsCache.GetEntries() != 0){
         QnCorrectionsInfo("Changed the calibration file. Deleting the current calibration histograms list");
         /* we delete it. WARNING: at this point the whole framework got orphan of input histograms this MUST be a transient situation */
-        delete fCalibrationHistogramsList;
+        if (fCalibrationHistogramsList != NULL) {
+          WithdrawCalibrationSnapshots(fCalibrationHistogramsList);
+          delete fCalibrationHistogramsList;
+        }
         fCalibrationHistogramsList = NULL;
+        WithdrawCalibrationSnapshots(&fCalibrationListsCache);
+        fCalibrationListsCache.Delete();
+      }
+      fCalibrationFile = NULL;
+      if (calibrationFile->GetListOfKeys()->FindObject(szCalibrationHistogramsKeyName) == NULL)
+        return;
+      TDirectory *calibrationDirectory = calibrationFile->GetDirectory(szCalibrationHistogramsKeyName);
+      if (lazy) {
+        if (calibrationDirectory != NULL) {
+          fCalibrationFile = calibrationFile;
+          QnCorrectionsInfo(Form("Calibration lists from file %s will be loaded on demand",
+              calibrationFile->GetName()));
+          return;
+        }
+        /* a single key would be read whole on each cache miss */
+        QnCorrectionsWarning(Form("Calibration file %s stores all the calibration lists under a single key. " \
+            "Lazy loading disabled, the whole list is read once", calibrationFile->GetName()));
+      }
+      if (calibrationDirectory != NULL) {
+        /* one key per process: the whole list is assembled out of them */
+        fCalibrationHistogramsList = new TList();
+        fCalibrationHistogramsList->SetName(szCalibrationHistogramsKeyName);
+        TIter nextKey(calibrationDirectory->GetListOfKeys());
+        TKey *processKey;
+        while ((processKey = (TKey *) nextKey()) != NULL) {
+          if (fCalibrationHistogramsList->FindObject(processKey->GetName()) != NULL) continue;
+          TList *processList = ReadCalibrationProcessList(calibrationFile, processKey->GetName());
+          if (processList != NULL) fCalibrationHistogramsList->Add(processList);
+        }
       }
-      fCalibrationHistogramsList = (TList*)((TKey*)calibrationFile->GetListOfKeys()->FindObject(szCalibrationHistogramsKeyName))->ReadObj()->Clone();
+      else
+        fCalibrationHistogramsList = (TList*)((TKey*)calibrationFile->GetListOfKeys()->FindObject(szCalibrationHistogramsKeyName))->ReadObj()->Clone();
       if (fCalibrationHistogramsList != NULL) {
         QnCorrectionsInfo(Form("Stored calibration list %s from file %s",
             fCalibrationHistogramsList->GetName(),
@@ -112,7 +195,266 @@ void QnCorrectionsManager::SetCalibrationHistogramsList(TFile *calibrationFile)
   }
 }
 
+/// Sets an already built list as the base list of the input calibration histograms
+///
+/// The list is expected with the same structure of the output histograms
+/// list, i.e. one list per process. Usually the output histograms list of
+/// a previous, finalized, pass within the same job.
+/// \param calibrationList the list, the manager takes its ownership
+void QnCorrectionsManager::SetCalibrationHistogramsList(TList *calibrationList) {
+  if (calibrationList == NULL) return;
+
+  /* a pending prefetch belongs to the previous file */
+  WaitForCalibrationPrefetch();
+  if (fCalibrationHistogramsList != NULL || fCalibrationListsCache.GetEntries() != 0){
+    QnCorrectionsInfo("Changed the calibration list. Deleting the current calibration histograms list");
+    if (fCalibrationHistogramsList != NULL) {
+      WithdrawCalibrationSnapshots(fCalibrationHistogramsList);
+      delete fCalibrationHistogramsList;
+    }
+    WithdrawCalibrationSnapshots(&fCalibrationListsCache);
+    fCalibrationListsCache.Delete();
+  }
+  fCalibrationFile = NULL;
+  fCalibrationHistogramsList = calibrationList;
+  fCalibrationHistogramsList->SetOwner(kTRUE);
+  QnCorrectionsInfo(Form("Stored calibration list %s", fCalibrationHistogramsList->GetName()));
+}
+
+/// Gets the calibration histograms list for the passed process name
+///
+/// In lazy mode the list is first looked for in the cache and, if not
+/// there, read from the calibration file and incorporated to the cache
+/// as the most recently used one. The cache is not trimmed here, so the
+/// list currently attached to the detectors survives until the new one
+/// is attached, see TrimCalibrationListsCache.
+///
+/// A pending prefetch is waited for first so that the correction inputs
+/// it prepared are available when the list is attached.
+/// \param name the process name
+/// \return the process calibration list, NULL if not available
+TList *QnCorrectionsManager::GetCalibrationProcessList(const char *name) {
+  /* replicas share the master calibration lists */
+  if (fMaster != NULL)
+    return fMaster->GetCalibrationProcessList(name);
+
+  /* a prefetched list, if any, joins the cache */
+  WaitForCalibrationPrefetch();
+
+  if (fCalibrationFile == NULL) {
+    if (fCalibrationHistogramsList != NULL)
+      return (TList *) fCalibrationHistogramsList->FindObject(name);
+    return NULL;
+  }
 
+  TList *processList = (TList *) fCalibrationListsCache.FindObject(name);
+  if (processList != NULL) {
+    /* most recently used goes first */
+    fCalibrationListsCache.Remove(processList);
+    fCalibrationListsCache.AddFirst(processList);
+    return processList;
+  }
+
+  processList = ReadCalibrationProcessList(fCalibrationFile, name);
+  if (processList != NULL) {
+    QnCorrectionsInfo(Form("Loaded calibration list %s from file %s",
+        processList->GetName(),
+        fCalibrationFile->GetName()));
+    fCalibrationListsCache.AddFirst(processList);
+  }
+  return processList;
+}
+
+/// Reads the calibration histograms list for the passed process name
+///
+/// Only reads from the calibration file, no manager state is touched so
+/// it can be run on the prefetch thread or by other tools. Files with the
+/// whole list under a single key have to be read whole for each process
+/// list so, the manager only uses it for files in the directory layout.
+/// \param calibrationFile the calibration file
+/// \param name the process name
+/// \return the process calibration list, NULL if not in the file
+TList *QnCorrectionsManager::ReadCalibrationProcessList(TDirectory *calibrationFile, const char *name) {
+  TList *processList = NULL;
+  TDirectory *calibrationDirectory = calibrationFile->GetDirectory(szCalibrationHistogramsKeyName);
+  if (calibrationDirectory != NULL) {
+    /* one key per process: read just the one needed */
+    TKey *processKey = calibrationDirectory->GetKey(name);
+    if (processKey != NULL)
+      processList = (TList *) processKey->ReadObj();
+  }
+  else {
+    /* single key: the whole list has to be read but only the needed process list is kept */
+    TList *calibrationList = (TList *) calibrationFile->GetKey(szCalibrationHistogramsKeyName)->ReadObj();
+    if (calibrationList != NULL) {
+      calibrationList->SetOwner(kTRUE);
+      processList = (TList *) calibrationList->FindObject(name);
+      if (processList != NULL)
+        calibrationList->Remove(processList);
+      delete calibrationList;
+    }
+  }
+
+  if (processList != NULL)
+    /* we need the histograms ownership once we go to the GRID */
+    processList->SetOwner(kTRUE);
+  return processList;
+}
+
+/// Announces the process that will come next
+///
+/// The inputs of the correction steps for the passed process name are
+/// prepared on a background thread while the current process keeps
+/// running. In lazy loading mode, if not already in the cache, the
+/// calibration list is first read from the calibration file. Out of
+/// the list, each correction step builds its correction parameters
+/// tables on private input histograms and publishes them. When later
+/// on the process becomes the current one the read list is just taken
+/// over and the correction steps find their tables already built, so
+/// the run boundary only has to attach them.
+///
+/// The calibration file must not be used by anyone else until the
+/// process is switched. ROOT must support threads, TThread::Initialize
+/// is invoked for that.
+///
+/// Replicas share the inputs prepared by their master so, they do not
+/// prefetch.
+/// \param name the name of the next process
+void QnCorrectionsManager::PrefetchProcessList(const char *name) {
+  if (fMaster != NULL) return;
+  if (fCalibrationFile == NULL && fCalibrationHistogramsList == NULL) {
+    /* there is nothing to prepare */
+    return;
+  }
+  /* only one prefetch at a time */
+  WaitForCalibrationPrefetch();
+
+  /* already there? then it only needs the inputs prepared */
+  if (fCalibrationFile == NULL)
+    fPrefetchKnownCalibrationList = (TList *) fCalibrationHistogramsList->FindObject(name);
+  else
+    fPrefetchKnownCalibrationList = (TList *) fCalibrationListsCache.FindObject(name);
+  if (fCalibrationFile == NULL && fPrefetchKnownCalibrationList == NULL)
+    return;
+
+  QnCorrectionsInfo(Form("Prefetching calibration list %s", name));
+  TThread::Initialize();
+  fPrefetchProcessListName = name;
+  fPrefetchThread = new TThread("QnCorrectionsPrefetch", (TThread::VoidRtnFunc_t) &PrefetchCalibrationProcessList, (void *) this);
+  fPrefetchThread->Run();
+}
+
+/// The prefetch thread function
+///
+/// Reads, if needed, the calibration list of the announced process and
+/// asks the detectors to prepare their correction inputs out of it. The
+/// read list is only looked at by the manager once the thread is joined.
+/// The detectors configuration is only read.
+/// \param manager the manager which launched the prefetch
+/// \return always NULL
+void *QnCorrectionsManager::PrefetchCalibrationProcessList(void *manager) {
+  QnCorrectionsManager *theManager = (QnCorrectionsManager *) manager;
+  TList *processList = theManager->fPrefetchKnownCalibrationList;
+  if (processList == NULL) {
+    processList = ReadCalibrationProcessList(theManager->fCalibrationFile, (const char *) theManager->fPrefetchProcessListName);
+    theManager->fPrefetchedCalibrationList = processList;
+  }
+  if (processList != NULL) {
+    for (Int_t ixDetector = 0; ixDetector < theManager->fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) theManager->fDetectorsSet.At(ixDetector))->PrepareCorrectionInputs(processList);
+    }
+  }
+  return NULL;
+}
+
+/// Waits for the ongoing calibration list prefetch, if any, to finish
+///
+/// The prefetched list joins the cache as the most recently used one.
+/// The inputs prepared out of it remain held by the correction steps
+/// until the list is attached.
+void QnCorrectionsManager::WaitForCalibrationPrefetch() {
+  if (fPrefetchThread != NULL) {
+    fPrefetchThread->Join();
+    delete fPrefetchThread;
+    fPrefetchThread = NULL;
+  }
+  fPrefetchKnownCalibrationList = NULL;
+  if (fPrefetchedCalibrationList != NULL) {
+    if (fCalibrationListsCache.FindObject(fPrefetchedCalibrationList->GetName()) == NULL)
+      fCalibrationListsCache.AddFirst(fPrefetchedCalibrationList);
+    else {
+      QnCorrectionsCalibrationSnapshot::Withdraw(fPrefetchedCalibrationList);
+      delete fPrefetchedCalibrationList;
+    }
+    fPrefetchedCalibrationList = NULL;
+  }
+}
+
+/// Trims the process calibration lists cache to its maximum size
+///
+/// The least recently used lists are deleted. Should be called once the
+/// detectors are attached to the most recently used list.
+void QnCorrectionsManager::TrimCalibrationListsCache() {
+  while (fCalibrationListsCache.GetEntries() > fMaxNoOfCachedCalibrationLists) {
+    TObject *leastRecentlyUsed = fCalibrationListsCache.Last();
+    fCalibrationListsCache.Remove(leastRecentlyUsed);
+    QnCorrectionsCalibrationSnapshot::Withdraw((TList *) leastRecentlyUsed);
+    delete leastRecentlyUsed;
+  }
+}
+
+/// Withdraws the shared correction parameters tables extracted from calibration lists
+///
+/// Should be called before deleting the process calibration lists so
+/// that the tables extracted from them are not taken for new lists
+/// allocated at the same place.
+/// \param processLists list of process calibration lists going to be deleted
+void QnCorrectionsManager::WithdrawCalibrationSnapshots(const TList *processLists) const {
+  TIter next(processLists);
+  TObject *processList;
+  while ((processList = next()) != NULL) {
+    QnCorrectionsCalibrationSnapshot::Withdraw((TList *) processList);
+  }
+}
+
+/// Writes the output histograms list for lazy loading
+///
+/// The output histograms are stored within a directory with the calibration
+/// histograms key name in the passed directory. Each process list is stored
+/// under its own key so that, once used as calibration file, only the
+/// needed process list has to be read.
+/// \param directory the directory, usually the output file, where to write
+void QnCorrectionsManager::WriteOutputHistogramsDirectory(TDirectory *directory) const {
+  if (fSupportHistogramsList == NULL) return;
+
+  TDirectory *outputDirectory = directory->GetDirectory(szCalibrationHistogramsKeyName);
+  if (outputDirectory == NULL)
+    outputDirectory = directory->mkdir(szCalibrationHistogramsKeyName);
+  /* each process list as a single key */
+  for (Int_t ixList = 0; ixList < fSupportHistogramsList->GetEntries(); ixList++) {
+    TList *processList = (TList *) fSupportHistogramsList->At(ixList);
+    outputDirectory->WriteTObject(processList, processList->GetName());
+  }
+}
+
+
+/// Gets the current event bin coordinates for the passed event class variables set
+///
+/// If the bin coordinates for the same event class variables set are not
+/// yet kept they are incorporated, so they will be updated at the beginning
+/// of each event processing.
+/// \param ecvs the event class variables set
+/// \return the event class bin coordinates kept for the set
+const QnCorrectionsEventClassBins *QnCorrectionsManager::GetEventClassBins(const QnCorrectionsEventClassVariablesSet &ecvs) {
+  for (Int_t ixBins = 0; ixBins < fEventClassBinsSet.GetEntriesFast(); ixBins++) {
+    QnCorrectionsEventClassBins *bins = (QnCorrectionsEventClassBins *) fEventClassBinsSet.At(ixBins);
+    if (bins->IsSameVariablesSet(ecvs))
+      return bins;
+  }
+  QnCorrectionsEventClassBins *bins = new QnCorrectionsEventClassBins(ecvs);
+  fEventClassBinsSet.Add(bins);
+  return bins;
+}
 
 /// Adds a new detector
 /// Checks for an already added detector and for a detector id
@@ -198,31 +540,67 @@ const QnCorrectionsQnVector *QnCorrectionsManager::GetDetectorQnVector(
     const char *expectedstep,
     const char *altstep) const {
 
-  const QnCorrectionsQnVector *theQnVector = NULL;
+  return QnCorrectionsEventContext::FindDetectorQnVector(fQnVectorList, subdetector, expectedstep, altstep);
+}
+
+/// Gets a handle to the Qn vector of a detector configuration
+/// which complies the expected or alternative correction step
+///
+/// The names are looked up once, here, instead of at each access.
+/// The handle stays usable if the Qn vectors list is rebuilt, it is
+/// then looked up again at its next use. It can also be used with
+/// the event contexts of this manager.
+/// \param subdetector the name of the detector configuration of interest
+/// \param expectedstep the name of the expected last correction applied
+/// \param altstep the name of the alternative correction step if the expected one is not found
+/// \return the resolved handle
+QnCorrectionsQnVectorHandle QnCorrectionsManager::GetDetectorQnVectorHandle(
+    const char *subdetector,
+    const char *expectedstep,
+    const char *altstep) const {
+
+  QnCorrectionsQnVectorHandle handle(subdetector, expectedstep, altstep);
+  handle.Resolve(fQnVectorList, fQnVectorListVersion);
+  return handle;
+}
 
-  TList *pQvecList = dynamic_cast<TList*> (fQnVectorList->FindObject(subdetector));
-  if (pQvecList != NULL) {
-    /* the detector is present */
-    if (TString(expectedstep).EqualTo("latest"))
-      theQnVector = (QnCorrectionsQnVector*) pQvecList->First();
-    else
-      theQnVector = (QnCorrectionsQnVector*) pQvecList->FindObject(expectedstep);
+/// Gets the number of correction steps of the whole framework
+///
+/// Each correction step needs its own calibration pass so this is also
+/// the number of passes needed to fully calibrate the framework.
+/// \return the number of distinct input data plus Qn vector correction steps
+Int_t QnCorrectionsManager::GetNoOfCorrectionSteps() const {
+  /* lists of correction instances we don't own */
+  TList inputCorrections;
+  TList vectorCorrections;
+  for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+    ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->FillOverallInputCorrectionStepList(&inputCorrections);
+    ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->FillOverallQnVectorCorrectionStepList(&vectorCorrections);
+  }
+  return inputCorrections.GetEntries() + vectorCorrections.GetEntries();
+}
 
-    if (theQnVector == NULL || !(theQnVector->IsGoodQuality()) || !(theQnVector->GetN() != 0)) {
-      /* the Qn vector for the expected step was not there or did not have the proper quality */
-      if (TString(altstep).EqualTo("latest"))
-        theQnVector = (QnCorrectionsQnVector*) pQvecList->First();
-      else
-        theQnVector = (QnCorrectionsQnVector*) pQvecList->FindObject(altstep);
-    }
+/// Gets the number of correction steps being applied
+///
+/// The highest number of steps applied to any detector configuration,
+/// i.e. the current calibration pass as reported by PrintFrameworkConfiguration.
+/// Only meaningful once the calibration histograms have been attached.
+/// \return the number of applied correction steps
+Int_t QnCorrectionsManager::GetNoOfAppliedCorrectionSteps() const {
+  TList steps; steps.SetOwner(kTRUE);
+  TList calib; calib.SetOwner(kTRUE);
+  TList apply; apply.SetOwner(kTRUE);
+  for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+    ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ReportOnCorrections(&steps, &calib, &apply);
   }
-  if (theQnVector != NULL) {
-    /* check the Qn vector quality */
-    if (!(theQnVector->IsGoodQuality()) || !(theQnVector->GetN() != 0))
-      /* not good quality, discarded */
-      theQnVector = NULL;
+  Int_t nApplied = 0;
+  TIter nextConfiguration(&apply);
+  TList *configurationList;
+  while ((configurationList = (TList *) nextConfiguration()) != NULL) {
+    if (nApplied < configurationList->GetEntries())
+      nApplied = configurationList->GetEntries();
   }
-  return theQnVector;
+  return nApplied;
 }
 
 /// Initializes the correction framework
@@ -306,8 +684,8 @@ void QnCorrectionsManager::InitializeQnCorrectionsFramework() {
 
   /* now get the process list on the calibration histograms list if any */
   /* and pass it to the detectors for input calibration histograms attachment, */
-  if (fCalibrationHistogramsList != NULL) {
-    TList *processList = (TList *)fCalibrationHistogramsList->FindObject((const char *)fProcessListName);
+  if (fCalibrationHistogramsList != NULL || fCalibrationFile != NULL) {
+    TList *processList = GetCalibrationProcessList((const char *)fProcessListName);
     if (processList != NULL) {
       QnCorrectionsInfo(Form("Assigned process list %s as the calibration histograms list",
           processList->GetName()));
@@ -319,6 +697,8 @@ void QnCorrectionsManager::InitializeQnCorrectionsFramework() {
       for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
         ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->AfterInputsAttachActions();
       }
+      /* the previously attached lists are no longer needed */
+      TrimCalibrationListsCache();
     }
   }
 
@@ -351,6 +731,22 @@ void QnCorrectionsManager::InitializeQnCorrectionsFramework() {
     }
   }
 
+  /* the event processing instrumentation if asked */
+  if (GetShouldInstrument()) {
+#if QNCORRECTIONS_INSTRUMENTATION
+    fInstrumentation = new QnCorrectionsInstrumentation();
+    for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->AttachInstrumentation(fInstrumentation);
+    }
+    fInstrumentationHistogramsList = new TList();
+    fInstrumentationHistogramsList->SetName(QnCorrectionsInstrumentation::szInstrumentationHistogramsKeyName);
+    fInstrumentationHistogramsList->SetOwner(kTRUE);
+    fInstrumentation->CreateHistograms(fInstrumentationHistogramsList);
+#else
+    QnCorrectionsWarning("The instrumentation is not compiled in the framework. Ignored.");
+#endif
+  }
+
   /* build the Qn vectors list */
   fQnVectorList = new TList();
   /* the list does not own the Qn vectors */
@@ -359,6 +755,32 @@ void QnCorrectionsManager::InitializeQnCorrectionsFramework() {
   for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
     ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->IncludeQnVectors(fQnVectorList);
   }
+  fQnVectorListVersion++;
+
+  /* the Qn vectors tree if asked, replicas fill the one of their master */
+  if (GetShouldFillQnVectorTree()) {
+    if (fMaster == NULL) {
+      fQnVectorTree = new TTree(szQnVectorTreeName, "Qn vectors");
+      fQnVectorTreeWriter = new QnCorrectionsQnVectorTreeWriter(fQnVectorTree, fQnVectorTreeQueueDepth);
+      fQnVectorTreeWriter->Start();
+    }
+    else {
+      fQnVectorTree = fMaster->fQnVectorTree;
+      fQnVectorTreeWriter = fMaster->fQnVectorTreeWriter;
+    }
+  }
+
+  /* the parallel processing of the detector configurations if asked */
+  if (fNoOfConfigurationsWorkers > 0) {
+    fConfigurationsScheduler = new QnCorrectionsConfigurationsScheduler();
+    fConfigurationsScheduler->BuildSchedule(&fDetectorsSet);
+    fConfigurationsScheduler->StartWorkers(fNoOfConfigurationsWorkers);
+  }
+
+  /* the replicas follow */
+  for (Int_t ixReplica = 0; ixReplica < fReplicas.GetEntriesFast(); ixReplica++) {
+    ((QnCorrectionsManager *) fReplicas.At(ixReplica))->InitializeQnCorrectionsFramework();
+  }
 }
 
 /// Set the name of the list that should be considered as assigned to the current process
@@ -402,8 +824,8 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
       /* now get the process list on the calibration histograms list if any */
       /* and pass it to the detectors for input calibration histograms attachment, */
       fProcessListName = name;
-      if (fCalibrationHistogramsList != NULL) {
-        TList *processList = (TList *)fCalibrationHistogramsList->FindObject((const char *)fProcessListName);
+      if (fCalibrationHistogramsList != NULL || fCalibrationFile != NULL) {
+        TList *processList = GetCalibrationProcessList((const char *)fProcessListName);
         if (processList != NULL) {
           QnCorrectionsInfo(Form("Assigned process list %s as the calibration histograms list",
               processList->GetName()));
@@ -415,6 +837,8 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
           for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
             ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->AfterInputsAttachActions();
           }
+          /* the previously attached lists are no longer needed */
+          TrimCalibrationListsCache();
         }
       }
       /* build the Qn vectors list  now that all histograms are loaded */
@@ -429,6 +853,7 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
       for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
         ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->IncludeQnVectors(fQnVectorList);
       }
+      fQnVectorListVersion++;
     }
     else {
       /* histograms list not yet created so, we just change the name */
@@ -438,6 +863,9 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
   else {
     QnCorrectionsInfo(Form("Changing process on the fly from %s to %s", fProcessListName.Data(), name));
 
+    /* the histograms of the ongoing process get their accumulated content */
+    FlushHistograms();
+
     if (fSupportHistogramsList != NULL) {
       /* check the list of concurrent processes */
       if (fProcessesNames != NULL && fProcessesNames->GetEntries() != 0) {
@@ -471,8 +899,8 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
       /* now get the process list on the calibration histograms list if any */
       /* and pass it to the detectors for input calibration histograms attachment, */
       fProcessListName = name;
-      if (fCalibrationHistogramsList != NULL) {
-        TList *processList = (TList *)fCalibrationHistogramsList->FindObject((const char *)fProcessListName);
+      if (fCalibrationHistogramsList != NULL || fCalibrationFile != NULL) {
+        TList *processList = GetCalibrationProcessList((const char *)fProcessListName);
         if (processList != NULL) {
           QnCorrectionsInfo(Form("Assigned process list %s as the calibration histograms list",
               processList->GetName()));
@@ -484,6 +912,8 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
           for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
             ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->AfterInputsAttachActions();
           }
+          /* the previously attached lists are no longer needed */
+          TrimCalibrationListsCache();
         }
       }
       /* build the Qn vectors list  now that all histograms are loaded */
@@ -498,6 +928,7 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
       for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
         ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->IncludeQnVectors(fQnVectorList);
       }
+      fQnVectorListVersion++;
     }
     else {
       /* histograms list not yet created so, we just change the name */
@@ -505,8 +936,14 @@ void QnCorrectionsManager::SetCurrentProcessListName(const char *name) {
     }
   }
 
+  /* the replicas follow */
+  for (Int_t ixReplica = 0; ixReplica < fReplicas.GetEntriesFast(); ixReplica++) {
+    ((QnCorrectionsManager *) fReplicas.At(ixReplica))->SetCurrentProcessListName(name);
+  }
+
   /* now that we have everything let's print the configuration before we start */
-  PrintFrameworkConfiguration();
+  if (fMaster == NULL)
+    PrintFrameworkConfiguration();
 }
 
 /// Produce an understandable picture of current correction configuration
@@ -746,10 +1183,181 @@ void QnCorrectionsManager::PrintFrameworkConfiguration() const {
 /// Produce the all data lists that collect data from all concurrent processes.
 void QnCorrectionsManager::FinalizeQnCorrectionsFramework() {
 
+  /* the histograms get their accumulated content */
+  FlushHistograms();
+
+  /* and incorporate the contribution of the replicas */
+  MergeReplicas();
+
+  /* the queued events get into the Qn vectors tree */
+  if (fQnVectorTreeWriter != NULL && fMaster == NULL)
+    fQnVectorTreeWriter->Stop();
+
   TList *processList = (TList *) fSupportHistogramsList->FindObject((const char *)fProcessListName);
   fSupportHistogramsList->Add(processList->Clone(szAllProcessesListName));
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+///
+/// The profiles filled by the framework accumulate their content in
+/// a dense storage which is transferred to the histograms only when
+/// flushed. It is done when finalizing the framework but it should be
+/// called before any access to the output or QA histograms lists in
+/// the middle of a run.
+///
+/// The request is transmitted to the different detectors
+void QnCorrectionsManager::FlushHistograms() {
+  for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+    ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->FlushHistograms();
+  }
+  if (fInstrumentation != NULL)
+    fInstrumentation->UpdateHistograms();
+}
+
+/// Creates replicas of the framework manager for multi-threaded processing
+///
+/// Each replica is a full copy of the current configuration, detectors,
+/// detector configurations, cuts and correction steps, which can process
+/// events on its own worker thread. Replicas only differ from the master
+/// manager in that they share the master calibration histograms, which
+/// are only read once attached, instead of having their own.
+///
+/// Replicas must be created once the framework is completely configured,
+/// before InitializeQnCorrectionsFramework. From then on the master
+/// manager passes its initialization and process changes to the replicas
+/// and merges, at FinalizeQnCorrectionsFramework, the replicas support and
+/// QA histograms into its own ones, always in the replicas order so the
+/// results are reproducible. Those calls must be done from a single thread
+/// while no replica is processing events. Only the event by event data
+/// loading, ProcessEvent and ClearEvent, is meant for the worker threads,
+/// each one on its own replica or on the master.
+/// \param nReplicas the number of replicas to create
+/// \return the total number of replicas
+Int_t QnCorrectionsManager::CreateReplicas(Int_t nReplicas) {
+  if (fMaster != NULL) {
+    QnCorrectionsFatal("Replicas cannot be replicated. FIX IT, PLEASE.");
+    return 0;
+  }
+  if (fSupportHistogramsList != NULL) {
+    QnCorrectionsFatal("Replicas must be created before initializing the framework. FIX IT, PLEASE.");
+    return 0;
+  }
 
+  /* the calibration histograms are not copied, they will be shared */
+  TList *calibrationHistogramsList = fCalibrationHistogramsList;
+  fCalibrationHistogramsList = NULL;
+  for (Int_t ixReplica = 0; ixReplica < nReplicas; ixReplica++) {
+    QnCorrectionsManager *replica = (QnCorrectionsManager *) Clone();
+    replica->fMaster = this;
+    /* make sure the detectors get the replica as their manager */
+    for (Int_t ixDetector = 0; ixDetector < replica->fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) replica->fDetectorsSet.At(ixDetector))->AttachCorrectionsManager(replica);
+    }
+    fReplicas.Add(replica);
+  }
+  fCalibrationHistogramsList = calibrationHistogramsList;
+  return fReplicas.GetEntriesFast();
+}
+
+/// Merges the replicas histograms into the master ones
+///
+/// The replicas histograms get first their accumulated content. The
+/// support, QA and non validated entries QA histograms lists are then
+/// merged, in the replicas order, into the corresponding master lists.
+/// The replicas instrumentation counters are added to the master ones.
+void QnCorrectionsManager::MergeReplicas() {
+  if (fReplicas.GetEntriesFast() == 0) return;
+
+  TList supportLists;
+  TList qaLists;
+  TList nveQALists;
+  for (Int_t ixReplica = 0; ixReplica < fReplicas.GetEntriesFast(); ixReplica++) {
+    QnCorrectionsManager *replica = (QnCorrectionsManager *) fReplicas.At(ixReplica);
+    replica->FlushHistograms();
+    if (replica->fSupportHistogramsList != NULL) supportLists.Add(replica->fSupportHistogramsList);
+    if (replica->fQAHistogramsList != NULL) qaLists.Add(replica->fQAHistogramsList);
+    if (replica->fNveQAHistogramsList != NULL) nveQALists.Add(replica->fNveQAHistogramsList);
+    if (fInstrumentation != NULL && replica->fInstrumentation != NULL) fInstrumentation->Add(replica->fInstrumentation);
+  }
+  if (fSupportHistogramsList != NULL && supportLists.GetEntries() != 0) fSupportHistogramsList->Merge(&supportLists);
+  if (fQAHistogramsList != NULL && qaLists.GetEntries() != 0) fQAHistogramsList->Merge(&qaLists);
+  if (fNveQAHistogramsList != NULL && nveQALists.GetEntries() != 0) fNveQAHistogramsList->Merge(&nveQALists);
+  if (fInstrumentation != NULL) fInstrumentation->UpdateHistograms();
+  QnCorrectionsInfo(Form("Merged the histograms of %d replicas", fReplicas.GetEntriesFast()));
+}
+
+/// Gets an event context for a new event
+///
+/// A context from the pool is reused if available, otherwise a new one
+/// is created. The pool is protected so that contexts can be obtained
+/// and returned from different threads.
+/// \return the event context, owned by the manager
+QnCorrectionsEventContext *QnCorrectionsManager::GetEventContext() {
+  QnCorrectionsEventContext *context = NULL;
+
+  TThread::Lock();
+  Int_t nFree = fFreeEventContexts.GetEntriesFast();
+  if (nFree > 0) {
+    context = (QnCorrectionsEventContext *) fFreeEventContexts.RemoveAt(nFree - 1);
+  }
+  else {
+    context = new QnCorrectionsEventContext(nMaxNoOfDataVariables);
+    fEventContexts.Add(context);
+  }
+  TThread::UnLock();
+  return context;
+}
 
+/// Process the event held in an event context
+///
+/// The staged data vectors are handed to the detectors and the event
+/// is processed, as ProcessEvent does, but with the context variables
+/// bank. The resulting Qn vectors are stored in the context and the
+/// detectors are cleared, so the manager is immediately ready for the
+/// next context while the processed one keeps its results until it is
+/// returned to the pool with ClearEvent.
+///
+/// Event contexts must be processed one at a time. Concurrent processing
+/// is achieved with replicas, each of them with its own contexts pool.
+/// \param context the event context
+void QnCorrectionsManager::ProcessEvent(QnCorrectionsEventContext *context) {
+  Float_t *variableContainer = context->GetDataContainer();
+
+  context->DispatchDataVectors(fDetectorsIdMap);
+  for (Int_t ixBins = 0; ixBins < fEventClassBinsSet.GetEntriesFast(); ixBins++) {
+    ((QnCorrectionsEventClassBins *) fEventClassBinsSet.At(ixBins))->UpdateBins(variableContainer);
+  }
+  if (fConfigurationsScheduler != NULL) {
+    fConfigurationsScheduler->ProcessEvent(variableContainer);
+  }
+  else {
+    for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ProcessCorrections(variableContainer);
+    }
+    for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ProcessDataCollection(variableContainer);
+    }
+  }
+  context->StoreQnVectors(fQnVectorList);
+  if (fQnVectorTreeWriter != NULL)
+    fQnVectorTreeWriter->Fill(fQnVectorList, fQnVectorListVersion);
+  ClearEvent();
+}
 
+/// Returns an event context to the pool
+///
+/// The staged data vectors are dropped and the context becomes available
+/// for a new event. Its Qn vectors should not be used afterwards.
+/// \param context the event context obtained from GetEventContext
+void QnCorrectionsManager::ClearEvent(QnCorrectionsEventContext *context) {
+  context->Clear();
+
+  TThread::Lock();
+  if (fEventContexts.IndexOf(context) < 0) {
+    TThread::UnLock();
+    QnCorrectionsFatal("The event context was not obtained from this manager");
+    return;
+  }
+  fFreeEventContexts.Add(context);
+  TThread::UnLock();
+}
@@ -28,6 +28,10 @@
 /// To improve performance a mapping between internal detector address
 /// and external detector id is maintained.
 ///
+/// Also to improve performance, the bin coordinates of the current event
+/// for each distinct event class variables set are computed once per
+/// event and shared by all the histograms built on the same set.
+///
 /// When the framework is in the calibration phase there are no complete
 /// calibration information available to fully implement the desired
 /// correction on the input data and on the subsequent Q vector. During
@@ -47,6 +51,38 @@
 /// different running instances. At merging time, only the contributions
 /// from instances of the same process must be merged.
 ///
+/// Calibration histograms can be loaded lazily. In that mode only the
+/// calibration list of the current process is read from the calibration
+/// file when it is needed, without cloning it, and the already read
+/// process lists are kept in a bounded least recently used cache. The
+/// calibration list of the next process can be announced in advance so
+/// that it is read on a background thread.
+///
+/// For multi-threaded processing within one process the manager can be
+/// replicated once configured. Each replica processes events on its own
+/// worker thread, sharing the calibration histograms with the master, which
+/// merges the replicas histograms when the framework is finalized.
+///
+/// Instead of the manager variables bank, events can be handed in their
+/// own QnCorrectionsEventContext, obtained from a pool of reusable contexts
+/// by GetEventContext. Several contexts can be filled while other one
+/// is being processed, which pipelines the input preparation with the
+/// corrections. Contexts are processed one at a time by ProcessEvent and
+/// returned to the pool by ClearEvent once their Qn vectors are consumed.
+///
+/// If asked, the Qn vectors of each processed event are stored in a tree
+/// with flat float branches, see QnCorrectionsQnVectorTreeWriter. The
+/// tree is created, in the current directory, when the framework is
+/// initialized and filled on a background thread until the framework
+/// is finalized. Replicas fill the tree of their master.
+///
+/// If asked, and the instrumentation is compiled in the framework, the
+/// event processing of each detector configuration and correction step
+/// is accounted in a QnCorrectionsInstrumentation table. Its counters
+/// are transferred to the instrumentation histograms list when the
+/// histograms are flushed. The master incorporates the replicas counters
+/// when the framework is finalized.
+///
 /// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
 /// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
 /// \author Víctor González <victor.gonzalez@cern.ch>, UCM
@@ -57,6 +93,15 @@
 #include <TList.h>
 #include <TTree.h>
 #include "QnCorrectionsDetector.h"
+#include "QnCorrectionsEventClassBins.h"
+#include "QnCorrectionsConfigurationsScheduler.h"
+#include "QnCorrectionsEventContext.h"
+#include "QnCorrectionsQnVectorTreeWriter.h"
+#include "QnCorrectionsInstrumentation.h"
+
+class TFile;
+class TDirectory;
+class TThread;
 
 class QnCorrectionsManager : public TObject {
 public:
@@ -67,7 +112,13 @@ public:
   /// \param names an array containing the processes names
   void SetListOfProcessesNames(TObjArray *names) { fProcessesNames = names; }
   void SetCurrentProcessListName(const char *name);
-  void SetCalibrationHistogramsList(TFile *calibrationFile);
+  void SetCalibrationHistogramsList(TFile *calibrationFile, Bool_t lazy = kFALSE);
+  void SetCalibrationHistogramsList(TList *calibrationList);
+  void PrefetchProcessList(const char *name);
+  void WaitForCalibrationPrefetch();
+  /// Sets the maximum number of process calibration lists kept in memory when lazy loading
+  /// \param nLists the number of lists, at least one
+  void SetMaxNoOfCachedCalibrationLists(Int_t nLists) { fMaxNoOfCachedCalibrationLists = (nLists < 1) ? 1 : nLists; }
   /// Enables disables the filling of histograms for building correction parameters
   /// \param enable kTRUE for enabling histograms filling
   void SetShouldFillOutputHistograms(Bool_t enable = kTRUE) { fFillOutputHistograms = enable; }
@@ -80,6 +131,23 @@ public:
   /// Enables disables the output of Qn vector on a TTree structure
   /// \param enable kTRUE for enabling Qn vector output into a TTree
   void SetShouldFillQnVectorTree(Bool_t enable = kTRUE) { fFillQnVectorTree = enable; }
+  /// Sets the number of events the Qn vectors tree queue can hold
+  ///
+  /// Must be set before initializing the framework.
+  /// \param nEvents the number of events
+  void SetQnVectorTreeQueueDepth(Int_t nEvents) { fQnVectorTreeQueueDepth = (nEvents < 1) ? 1 : nEvents; }
+  /// Enables disables the instrumentation of the event processing
+  ///
+  /// Must be set before initializing the framework. It only has effect
+  /// if the instrumentation is compiled in, see QNCORRECTIONS_INSTRUMENTATION.
+  /// \param enable kTRUE for enabling the instrumentation
+  void SetShouldInstrument(Bool_t enable = kTRUE) { fInstrument = enable; }
+  /// Sets the number of worker threads processing in parallel the detector configurations within an event
+  ///
+  /// Zero, the default, keeps the serial processing. Must be set before
+  /// initializing the framework. Each replica gets its own workers.
+  /// \param nWorkers the number of worker threads besides the one calling ProcessEvent
+  void SetNoOfConfigurationsWorkers(Int_t nWorkers) { fNoOfConfigurationsWorkers = (nWorkers < 0) ? 0 : nWorkers; }
 
   void AddDetector(QnCorrectionsDetector *detector);
 
@@ -91,6 +159,12 @@ public:
   /// Gets a pointer to the data variables bank
   /// \return the pointer to the data container
   Float_t *GetDataContainer() { return fDataContainer; }
+  /// Gets the size of the data variables bank
+  /// \return the maximum number of variables supported by the framework
+  static Int_t GetMaxNoOfDataVariables() { return nMaxNoOfDataVariables; }
+  /// Gets the size of the detectors id map
+  /// \return the number of detector ids supported by the framework
+  static Int_t GetMaxNoOfDetectors() { return nMaxNoOfDetectors; }
 
   /// Get whether the output histograms should be filled
   /// \return kTRUE if the output histograms should be filled
@@ -104,6 +178,9 @@ public:
   /// Get whether the Qn vector tree should be populated
   /// \return kTRUE if the Qn vector should be written into a TTree
   Bool_t GetShouldFillQnVectorTree() const { return fFillQnVectorTree; }
+  /// Get whether the event processing should be instrumented
+  /// \return kTRUE if the event processing should be instrumented
+  Bool_t GetShouldInstrument() const { return fInstrument; }
   /// Gets the output histograms list
   /// \return the list of histograms for building correction parameters
   TList *GetOutputHistogramsList() const { return fSupportHistogramsList; }
@@ -113,6 +190,12 @@ public:
   /// Gets the non validated entries QA histograms list
   /// \return the list of QA histograms
   TList *GetNveQAHistogramsList() const { return fNveQAHistogramsList; }
+  /// Gets the instrumentation table
+  /// \return the instrumentation table, NULL if the event processing is not instrumented
+  QnCorrectionsInstrumentation *GetInstrumentation() const { return fInstrumentation; }
+  /// Gets the instrumentation histograms list
+  /// \return the list of instrumentation histograms, NULL if the event processing is not instrumented
+  TList *GetInstrumentationHistogramsList() const { return fInstrumentationHistogramsList; }
   /// Gets the Qn vector tree
   /// \return the tree of histograms for building correction parameters
   TTree *GetQnVectorTree() const { return fQnVectorTree; }
@@ -121,29 +204,70 @@ public:
   TList *GetQnVectorList() const { return fQnVectorList; }
   const TList *GetDetectorQnVectorList(const char *subdetector) const;
   const QnCorrectionsQnVector *GetDetectorQnVector(const char *subdetector, const char *expectedstep = "latest", const char *altstep = "latest") const;
+  QnCorrectionsQnVectorHandle GetDetectorQnVectorHandle(const char *subdetector, const char *expectedstep = "latest", const char *altstep = "latest") const;
+  /// Gets the Qn vector a handle refers to for the current event
+  ///
+  /// Much cheaper than looking up the Qn vector by names. It should be
+  /// used when the same Qn vectors are accessed event by event.
+  /// \param handle the Qn vector handle, see GetDetectorQnVectorHandle
+  /// \return the Qn vector, NULL if none with good quality
+  const QnCorrectionsQnVector *GetDetectorQnVector(QnCorrectionsQnVectorHandle &handle) const
+  { return handle.GetQnVector(fQnVectorList, fQnVectorListVersion); }
   /// Gets the name of the calibration histograms container
   /// \return the calibration histograms container name
-  const char *GetCalibrationHistogramsContainerName() const
+  static const char *GetCalibrationHistogramsContainerName()
   { return szCalibrationHistogramsKeyName; }
   /// Gets the name of the calibration QA histograms container
   /// \return the calibration QA histograms container name
-  const char *GetCalibrationQAHistogramsContainerName() const
+  static const char *GetCalibrationQAHistogramsContainerName()
   { return szCalibrationQAHistogramsKeyName; }
   /// Gets the name of the non validated calibration entries QA histograms container
   /// \return the calibration QA histograms container name
-  const char *GetCalibrationNveQAHistogramsContainerName() const
+  static const char *GetCalibrationNveQAHistogramsContainerName()
   { return szCalibrationNveQAHistogramsKeyName; }
+  const QnCorrectionsEventClassBins *GetEventClassBins(const QnCorrectionsEventClassVariablesSet &ecvs);
 
 
   void PrintFrameworkConfiguration() const;
+  Int_t GetNoOfCorrectionSteps() const;
+  Int_t GetNoOfAppliedCorrectionSteps() const;
   void InitializeQnCorrectionsFramework();
   Int_t AddDataVector(Int_t detectorId, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1);
+  ULong64_t AddDataVectorAcceptance(Int_t detectorId, Double_t phi, Double_t weight = 1.0, Int_t channelId = -1);
+  Int_t AddDataVectors(Int_t detectorId, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+      Int_t nVariables = 0, const Int_t *variableId = NULL, const Float_t *variableValues = NULL);
   const char *GetAcceptedDataDetectorConfigurationName(Int_t detectorId, Int_t index) const;
+  const char *GetAcceptedDataDetectorConfigurationName(Int_t detectorId, ULong64_t acceptanceMask, Int_t index) const;
   void ProcessEvent();
   void ClearEvent();
+  QnCorrectionsEventContext *GetEventContext();
+  void ProcessEvent(QnCorrectionsEventContext *context);
+  void ClearEvent(QnCorrectionsEventContext *context);
+  void FlushHistograms();
   void FinalizeQnCorrectionsFramework();
+  void WriteOutputHistogramsDirectory(TDirectory *directory) const;
+  static TList *ReadCalibrationProcessList(TDirectory *calibrationFile, const char *name);
+
+  Int_t CreateReplicas(Int_t nReplicas);
+  /// Gets the number of replicas for multi-threaded processing
+  /// \return the number of replicas
+  Int_t GetNoOfReplicas() const { return fReplicas.GetEntriesFast(); }
+  /// Gets a replica for multi-threaded processing
+  /// \param i the replica index
+  /// \return the replica manager
+  QnCorrectionsManager *GetReplica(Int_t i) const { return (QnCorrectionsManager *) fReplicas.At(i); }
+  /// Checks whether the manager is a replica of other one
+  /// \return kTRUE if the manager is a replica
+  Bool_t IsReplica() const { return (fMaster != NULL); }
 
 private:
+  TList *GetCalibrationProcessList(const char *name);
+  static void *PrefetchCalibrationProcessList(void *manager);
+  void TrimCalibrationListsCache();
+  void WithdrawCalibrationSnapshots(const TList *processLists) const;
+  void MergeReplicas();
+
+  static const Int_t nDefaultMaxNoOfCachedCalibrationLists; ///< the default number of process calibration lists kept when lazy loading
   static const Int_t nMaxNoOfDetectors;              ///< the highest detector id currently supported by the framework
   static const Int_t nMaxNoOfDataVariables;          ///< the maximum number of variables currently supported by the framework
   static const char *szCalibrationHistogramsKeyName; ///< the name of the key under which calibration histograms lists are stored
@@ -151,21 +275,42 @@ private:
   static const char *szCalibrationNveQAHistogramsKeyName; ///< the name of the key under which non validated calibration entries QA histograms lists are stored
   static const char *szDummyProcessListName;         ///< accepted temporary name before getting the definitive one
   static const char *szAllProcessesListName;         ///< the name of the list that collects data from all concurrent processes
+  static const char *szQnVectorTreeName;             ///< the name of the Qn vectors tree
   TList fDetectorsSet;                  ///< the list of detectors
   QnCorrectionsDetector **fDetectorsIdMap; //!<! map between external detector Id and internal detector
   Float_t *fDataContainer;              //!<! the data variables bank
   TList *fCalibrationHistogramsList;    ///< the list of the input calibration histograms
+  TFile *fCalibrationFile;              //!<! the calibration file when lazy loading, not owned
+  TList fCalibrationListsCache;         //!<! the process calibration lists read when lazy loading, most recently used first
+  Int_t fMaxNoOfCachedCalibrationLists; ///< the maximum number of process calibration lists kept when lazy loading
+  TThread *fPrefetchThread;             //!<! the thread reading the next process calibration list
+  TString fPrefetchProcessListName;     //!<! the name of the process whose calibration list is being prefetched
+  TList *fPrefetchedCalibrationList;    //!<! the prefetched process calibration list, not yet in the cache
+  TList *fPrefetchKnownCalibrationList; //!<! the process calibration list being prepared when already in memory, not owned
   TList *fSupportHistogramsList;        //!<! the list of the support histograms
   TList *fQAHistogramsList;             //!<! the list of QA histograms
   TList *fNveQAHistogramsList;          //!<! the list of not validated entries QA histograms
+  QnCorrectionsInstrumentation *fInstrumentation; //!<! the event processing instrumentation table
+  TList *fInstrumentationHistogramsList; //!<! the list of instrumentation histograms
   TTree *fQnVectorTree;                 //!<! the tree to out Qn vectors
   TList *fQnVectorList;                 //!<! list that contains the current event corrected Qn vectors
+  Int_t fQnVectorListVersion;           //!<! the structure version of the Qn vectors list, increased each time it is rebuilt
+  QnCorrectionsQnVectorTreeWriter *fQnVectorTreeWriter; //!<! the Qn vectors tree filler, owned if not a replica
+  Int_t fQnVectorTreeQueueDepth;        ///< the number of events the Qn vectors tree queue can hold
   Bool_t fFillOutputHistograms;         ///< kTRUE if output histograms for building correction parameters must be filled
   Bool_t fFillQAHistograms;             ///< kTRUE if QA histograms must be filled
   Bool_t fFillNveQAHistograms;          ///< kTRUE if non validated entries QA histograms must be filled
   Bool_t fFillQnVectorTree;             ///< kTRUE if Qn vectors must be written in a TTree structure
+  Bool_t fInstrument;                   ///< kTRUE if the event processing must be instrumented
   TString fProcessListName;             ///< the name of the list associated to the current process
   TObjArray *fProcessesNames;           ///< array with the list of processes names
+  TObjArray fEventClassBinsSet;         //!<! the current event bin coordinates for each distinct event class variables set
+  TObjArray fReplicas;                  //!<! the replicas of this manager for multi-threaded processing
+  QnCorrectionsManager *fMaster;        //!<! the master manager if this is a replica, not owned
+  Int_t fNoOfConfigurationsWorkers;     ///< the number of worker threads processing the detector configurations within an event
+  QnCorrectionsConfigurationsScheduler *fConfigurationsScheduler; //!<! the detector configurations event processing scheduler
+  TObjArray fEventContexts;             //!<! the event contexts created by this manager
+  TObjArray fFreeEventContexts;         //!<! the event contexts available for a new event, not owned
 
 private:
   /// Copy constructor
@@ -176,7 +321,7 @@ private:
   QnCorrectionsManager& operator= (const QnCorrectionsManager &);
 
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsManager, 5);
+  ClassDef(QnCorrectionsManager, 15);
 /// \endcond
 };
 
@@ -192,6 +337,43 @@ inline Int_t QnCorrectionsManager::AddDataVector(Int_t detectorId, Double_t phi,
   return fDetectorsIdMap[detectorId]->AddDataVector(fDataContainer, phi, weight, channelId);
 }
 
+/// New data vector for the framework
+/// As AddDataVector but returning which detector configurations accepted
+/// and stored the data vector. No configuration name is involved, names are
+/// only looked up if asked for via GetAcceptedDataDetectorConfigurationName.
+/// \param detectorId id of the involved detector
+/// \param phi azimuthal angle
+/// \param weight the weight of the data vector
+/// \param channelId the channel Id that originates the data vector
+/// \return the acceptance mask, bit i set if the detector configuration at position i, below 64, accepted the data vector
+inline ULong64_t QnCorrectionsManager::AddDataVectorAcceptance(Int_t detectorId, Double_t phi, Double_t weight, Int_t channelId) {
+  return fDetectorsIdMap[detectorId]->AddDataVectorAcceptance(fDataContainer, phi, weight, channelId);
+}
+
+/// New set of data vectors for the framework
+/// The whole set is transmitted in one go to the passed detector together
+/// with the variable bank.
+///
+/// Data vectors which need per data vector variables for being
+/// accepted by the detector configurations cuts, the track charge or
+/// its transverse momentum for instance, pass them in the variables block.
+/// The block is organized as nVariables consecutive values per data vector
+/// which are stored, for each data vector, in the variable bank positions given
+/// by variableId before checking the cuts.
+/// \param detectorId id of the involved detector
+/// \param phi array of azimuthal angles
+/// \param weight array of data vector weights. NULL for unit weights
+/// \param channelId array of channel Ids that originates the data vectors. NULL for default ones
+/// \param n the number of data vectors in the arrays
+/// \param nVariables the number of variables per data vector in the variables block
+/// \param variableId array with the external Ids of the variables in the variables block
+/// \param variableValues the variables block, nVariables consecutive values per data vector
+/// \return the number of data vectors stored summed over the detector configurations
+inline Int_t QnCorrectionsManager::AddDataVectors(Int_t detectorId, const Float_t *phi, const Float_t *weight, const Int_t *channelId, Int_t n,
+    Int_t nVariables, const Int_t *variableId, const Float_t *variableValues) {
+  return fDetectorsIdMap[detectorId]->AddDataVectors(fDataContainer, phi, weight, channelId, n, nVariables, variableId, variableValues);
+}
+
 /// Gets the name of the detector configuration at index that accepted last data vector
 /// \param detectorId id of the involved detector
 /// \param index the position in the list of accepted data vector configuration
@@ -200,6 +382,15 @@ inline const char *QnCorrectionsManager::GetAcceptedDataDetectorConfigurationNam
   return fDetectorsIdMap[detectorId]->GetAcceptedDataDetectorConfigurationName(index);
 }
 
+/// Gets the name of the detector configuration at index within an acceptance mask
+/// \param detectorId id of the involved detector
+/// \param acceptanceMask the acceptance mask as returned by AddDataVectorAcceptance
+/// \param index the position within the configurations set in the acceptance mask
+/// \return the configuration name, NULL if the mask has not so many configurations
+inline const char *QnCorrectionsManager::GetAcceptedDataDetectorConfigurationName(Int_t detectorId, ULong64_t acceptanceMask, Int_t index) const {
+  return fDetectorsIdMap[detectorId]->GetAcceptedDataDetectorConfigurationName(acceptanceMask, index);
+}
+
 /// Process the current event
 ///
 /// The request is transmitted to the different detectors first for applying the different
@@ -207,13 +398,32 @@ inline const char *QnCorrectionsManager::GetAcceptedDataDetectorConfigurationNam
 ///
 /// Must be called only when the whole data vectors for the event
 /// have been incorporated to the framework.
+///
+/// Before that, the event class bin coordinates are updated with
+/// the current content of the variable bank.
+///
+/// If worker threads were requested the detector configurations are
+/// processed in parallel respecting their dependencies, see
+/// QnCorrectionsConfigurationsScheduler.
+///
+/// If asked, the resulting Qn vectors are queued for the Qn vectors tree.
 inline void QnCorrectionsManager::ProcessEvent() {
-  for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
-    ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ProcessCorrections(fDataContainer);
+  for (Int_t ixBins = 0; ixBins < fEventClassBinsSet.GetEntriesFast(); ixBins++) {
+    ((QnCorrectionsEventClassBins *) fEventClassBinsSet.At(ixBins))->UpdateBins(fDataContainer);
   }
-  for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
-    ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ProcessDataCollection(fDataContainer);
+  if (fConfigurationsScheduler != NULL) {
+    fConfigurationsScheduler->ProcessEvent(fDataContainer);
+  }
+  else {
+    for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ProcessCorrections(fDataContainer);
+    }
+    for (Int_t ixDetector = 0; ixDetector < fDetectorsSet.GetEntries(); ixDetector++) {
+      ((QnCorrectionsDetector *) fDetectorsSet.At(ixDetector))->ProcessDataCollection(fDataContainer);
+    }
   }
+  if (fQnVectorTreeWriter != NULL)
+    fQnVectorTreeWriter->Fill(fQnVectorList, fQnVectorListVersion);
 }
 
 /// Clear the current event
@@ -91,6 +91,11 @@ Bool_t QnCorrectionsProfile::CreateProfileHistograms(TList *histogramList) {
   histogramList->Add(fValues);
   histogramList->Add(fEntries);
 
+  /* the histograms are filled through the dense accumulator */
+  if (fAccumulator != NULL)
+    delete fAccumulator;
+  fAccumulator = new QnCorrectionsProfileAccumulator(fValues->GetNbins(), 1);
+
   delete [] minvals;
   delete [] maxvals;
   delete [] nbins;
@@ -134,6 +139,8 @@ Bool_t QnCorrectionsProfile::AttachHistograms(TList *histogramList) {
 /// \param variableContainer the current variables content addressed by var Id
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfile::GetBin(const Float_t *variableContainer) {
+  if (fEventClassBins != NULL)
+    return fEntries->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
   return fEntries->GetBin(fBinAxesValues);
 }
@@ -211,17 +218,22 @@ Float_t QnCorrectionsProfile::GetBinError(Long64_t bin) {
 ///
 /// The involved bin is computed according to the current variables
 /// content. The bin is then increased by the given weight and the
-/// entries also increased properly.
+/// entries also increased properly in the dense accumulator. The
+/// histograms get the content once the accumulator is flushed.
 ///
 /// \param variableContainer the current variables conten addressed by var Id
 /// \param weight the increment in the bin content
 void QnCorrectionsProfile::Fill(const Float_t *variableContainer, Float_t weight) {
-  /* keep the total entries in fValues updated */
-  Double_t nEntries = fValues->GetEntries();
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 0, weight);
+  fAccumulator->FillEntries(bin);
+}
 
-  FillBinAxesValues(variableContainer);
-  fValues->Fill(fBinAxesValues, weight);
-  fValues->SetEntries(nEntries + 1);
-  fEntries->Fill(fBinAxesValues, 1.0);
+/// Transfers the accumulated content to the histograms
+void QnCorrectionsProfile::FlushAccumulator() {
+  if (fAccumulator != NULL) {
+    THnF *values[1] = { fValues };
+    fAccumulator->Flush(values, fEntries);
+  }
 }
 
@@ -62,6 +62,8 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual void Fill(const Float_t *variableContainer, Int_t nChannel, Float_t weight)
   { QnCorrectionsHistogramBase::Fill(variableContainer, nChannel, weight); }
+
+  virtual void FlushAccumulator();
 private:
   THnF *fValues;   //!<! Cumulates values for each of the event classes
   THnI *fEntries;  //!<! Cumulates the number on each of the event classes
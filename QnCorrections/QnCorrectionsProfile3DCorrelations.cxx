@@ -406,6 +406,8 @@ Bool_t QnCorrectionsProfile3DCorrelations::AttachHistograms(TList *histogramList
 /// \param variableContainer the current variables content addressed by var Id
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfile3DCorrelations::GetBin(const Float_t *variableContainer) {
+  if (fEventClassBins != NULL)
+    return fEntries->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
   return fEntries->GetBin(fBinAxesValues);
 }
@@ -814,8 +816,8 @@ void QnCorrectionsProfile3DCorrelations::Fill(const QnCorrectionsQnVector *QnA,
     return;
   }
 
-  /* let's get the axis information */
-  FillBinAxesValues(variableContainer);
+  /* let's get the involved bin */
+  Long64_t bin = GetBin(variableContainer);
 
   /* consider all combinations */
   const QnCorrectionsQnVector *combQn[CORRELATIONSNOOFQNVECTORS] = {QnA,QnB,QnC};
@@ -834,10 +836,10 @@ void QnCorrectionsProfile3DCorrelations::Fill(const QnCorrectionsQnVector *QnA,
       Double_t nYXEntries = fYXValues[ixComb][nCurrentHarmonic]->GetEntries();
       Double_t nYYEntries = fYYValues[ixComb][nCurrentHarmonic]->GetEntries();
 
-      fXXValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues, combQn[ixComb]->Qx(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qx(nCurrentHarmonic));
-      fXYValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues, combQn[ixComb]->Qx(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qy(nCurrentHarmonic));
-      fYXValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues, combQn[ixComb]->Qy(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qx(nCurrentHarmonic));
-      fYYValues[ixComb][nCurrentHarmonic]->Fill(fBinAxesValues, combQn[ixComb]->Qy(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qy(nCurrentHarmonic));
+      fXXValues[ixComb][nCurrentHarmonic]->FillBin(bin, combQn[ixComb]->Qx(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qx(nCurrentHarmonic));
+      fXYValues[ixComb][nCurrentHarmonic]->FillBin(bin, combQn[ixComb]->Qx(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qy(nCurrentHarmonic));
+      fYXValues[ixComb][nCurrentHarmonic]->FillBin(bin, combQn[ixComb]->Qy(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qx(nCurrentHarmonic));
+      fYYValues[ixComb][nCurrentHarmonic]->FillBin(bin, combQn[ixComb]->Qy(nCurrentHarmonic) * combQn[(ixComb+1)%CORRELATIONSNOOFQNVECTORS]->Qy(nCurrentHarmonic));
 
       fXXValues[ixComb][nCurrentHarmonic]->SetEntries(nXXEntries + 1);
       fXYValues[ixComb][nCurrentHarmonic]->SetEntries(nXYEntries + 1);
@@ -849,5 +851,5 @@ void QnCorrectionsProfile3DCorrelations::Fill(const QnCorrectionsQnVector *QnA,
   }
 
   /* update the profile entries */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fEntries->FillBin(bin, 1.0);
 }
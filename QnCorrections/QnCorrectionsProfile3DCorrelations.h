@@ -66,6 +66,9 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual Long64_t GetBin(const Float_t *variableContainer, Int_t nChannel)
   { return QnCorrectionsHistogramBase::GetBin(variableContainer, nChannel); }
+  /// Get the total number of bins, under and overflow included
+  /// \return the number of bins of the histogram
+  virtual Long64_t GetNoOfBins() { return fEntries->GetNbins(); }
   virtual Bool_t BinContentValidated(Long64_t bin);
   virtual Float_t GetXXBinContent(const char *comb, Int_t harmonic, Long64_t bin);
   virtual Float_t GetXYBinContent(const char *comb, Int_t harmonic, Long64_t bin);
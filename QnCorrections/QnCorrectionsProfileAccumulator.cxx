@@ -0,0 +1,123 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsProfileAccumulator.cxx
+/// \brief Implementation of the dense profile accumulator class
+
+#include "QnCorrectionsProfileAccumulator.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsProfileAccumulator);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsProfileAccumulator::QnCorrectionsProfileAccumulator() : TObject() {
+  fNoOfBins = 0;
+  fNoOfComponents = 0;
+  fRecordSize = 0;
+  fRecords = NULL;
+  fComponentFills = NULL;
+  fEntriesFills = 0;
+}
+
+/// Normal constructor
+/// Allocates the bin records storage
+/// \param nBins the number of bins of the profile histograms, including underflow and overflow
+/// \param nComponents the number of components per bin
+QnCorrectionsProfileAccumulator::QnCorrectionsProfileAccumulator(Long64_t nBins, Int_t nComponents) : TObject() {
+  fNoOfBins = nBins;
+  fNoOfComponents = nComponents;
+  fRecordSize = 1 + 2 * nComponents;
+  fRecords = new Double_t[fNoOfBins * fRecordSize];
+  fComponentFills = new Long64_t[fNoOfComponents];
+  Reset();
+}
+
+/// Default destructor
+/// Releases the memory taken
+QnCorrectionsProfileAccumulator::~QnCorrectionsProfileAccumulator() {
+  if (fRecords != NULL)
+    delete [] fRecords;
+  if (fComponentFills != NULL)
+    delete [] fComponentFills;
+}
+
+/// Clears the accumulated content
+void QnCorrectionsProfileAccumulator::Reset() {
+  for (Long64_t i = 0; i < fNoOfBins * fRecordSize; i++) {
+    fRecords[i] = 0.0;
+  }
+  for (Int_t component = 0; component < fNoOfComponents; component++) {
+    fComponentFills[component] = 0;
+  }
+  fEntriesFills = 0;
+}
+
+/// Transfers the accumulated content to the profile histograms
+///
+/// The sum of each component is added to the bin content of its values
+/// histogram, the sum of squares to its bin error and the number of
+/// entries to the entries histogram bin content. The histograms entries
+/// are updated as if they had been filled directly. The accumulator
+/// is reset afterwards.
+/// \param values the values histogram for each component, NULL for not used components
+/// \param entries the entries histogram
+void QnCorrectionsProfileAccumulator::Flush(THnF **values, THnI *entries) {
+  if (fEntriesFills == 0) {
+    Bool_t bPending = kFALSE;
+    for (Int_t component = 0; component < fNoOfComponents; component++) {
+      if (fComponentFills[component] != 0)
+        bPending = kTRUE;
+    }
+    if (!bPending) return;
+  }
+
+  for (Long64_t bin = 0; bin < fNoOfBins; bin++) {
+    const Double_t *record = fRecords + bin * fRecordSize;
+    if (record[0] != 0.0)
+      entries->AddBinContent(bin, record[0]);
+    for (Int_t component = 0; component < fNoOfComponents; component++) {
+      if (values[component] == NULL) continue;
+      if ((record[1 + 2 * component] != 0.0) || (record[2 + 2 * component] != 0.0)) {
+        values[component]->AddBinContent(bin, record[1 + 2 * component]);
+        values[component]->AddBinError2(bin, record[2 + 2 * component]);
+      }
+    }
+  }
+  for (Int_t component = 0; component < fNoOfComponents; component++) {
+    if (values[component] == NULL) continue;
+    values[component]->SetEntries(values[component]->GetEntries() + fComponentFills[component]);
+  }
+  entries->SetEntries(entries->GetEntries() + fEntriesFills);
+
+  Reset();
+}
+
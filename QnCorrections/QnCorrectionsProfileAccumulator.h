@@ -0,0 +1,102 @@
+#ifndef QNCORRECTIONS_PROFILEACCUMULATOR_H
+#define QNCORRECTIONS_PROFILEACCUMULATOR_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsProfileAccumulator.h
+/// \brief Dense accumulator for the profiles of the Q vector correction framework
+
+#include <TObject.h>
+#include <THn.h>
+
+/// \class QnCorrectionsProfileAccumulator
+/// \brief Dense accumulation storage for profile histograms
+///
+/// Profiles built on multidimensional histograms keep for each
+/// bin the sum of values, the sum of squared values and the
+/// number of entries in separate histograms. Filling them is
+/// costly and the content of a bin is scattered along several
+/// arrays.
+///
+/// The accumulator keeps instead, for each bin, a contiguous record
+/// with the number of entries followed by the sum and the sum of
+/// squares for each of the profile components (X, Y, XX, ...). The
+/// bin number is the one of the profile histograms so filling it is
+/// just direct indexing.
+///
+/// The accumulated content is transferred to the profile histograms
+/// when flushed, leaving the histograms as if they had been filled
+/// directly, and the accumulator is reset.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 11, 2016
+class QnCorrectionsProfileAccumulator : public TObject {
+public:
+  QnCorrectionsProfileAccumulator();
+  QnCorrectionsProfileAccumulator(Long64_t nBins, Int_t nComponents);
+  virtual ~QnCorrectionsProfileAccumulator();
+
+  /// Gets the number of bins
+  /// \return the number of bins in the accumulator
+  Long64_t GetNoOfBins() const { return fNoOfBins; }
+  /// Gets the number of components
+  /// \return the number of components per bin
+  Int_t GetNoOfComponents() const { return fNoOfComponents; }
+
+  void Fill(Long64_t bin, Int_t component, Double_t value);
+  void FillEntries(Long64_t bin);
+  void Flush(THnF **values, THnI *entries);
+  void Reset();
+
+private:
+  Long64_t fNoOfBins;          ///< the number of bins
+  Int_t fNoOfComponents;       ///< the number of components per bin
+  Int_t fRecordSize;           ///< the size of each bin record: entries plus sum and sum of squares per component
+  Double_t *fRecords;          //!<! the bin records
+  Long64_t *fComponentFills;   //!<! the number of fills per component since last flush
+  Long64_t fEntriesFills;      //!<! the number of entries fills since last flush
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsProfileAccumulator(const QnCorrectionsProfileAccumulator &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsProfileAccumulator& operator= (const QnCorrectionsProfileAccumulator &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsProfileAccumulator, 1);
+/// \endcond
+};
+
+/// Accumulates a value in a component of a bin
+///
+/// \param bin the profile histograms bin number
+/// \param component the profile component
+/// \param value the value to accumulate
+inline void QnCorrectionsProfileAccumulator::Fill(Long64_t bin, Int_t component, Double_t value) {
+  Double_t *record = fRecords + bin * fRecordSize + 1 + 2 * component;
+  record[0] += value;
+  record[1] += value * value;
+  fComponentFills[component]++;
+}
+
+/// Increments the number of entries of a bin
+///
+/// \param bin the profile histograms bin number
+inline void QnCorrectionsProfileAccumulator::FillEntries(Long64_t bin) {
+  fRecords[bin * fRecordSize] += 1.0;
+  fEntriesFills++;
+}
+
+#endif /* QNCORRECTIONS_PROFILEACCUMULATOR_H */
@@ -166,6 +166,11 @@ Bool_t QnCorrectionsProfileChannelized::CreateProfileHistograms(TList *histogram
   histogramList->Add(fValues);
   histogramList->Add(fEntries);
 
+  /* the histograms are filled through the dense accumulator */
+  if (fAccumulator != NULL)
+    delete fAccumulator;
+  fAccumulator = new QnCorrectionsProfileAccumulator(fValues->GetNbins(), 1);
+
   delete [] minvals;
   delete [] maxvals;
   delete [] nbins;
@@ -184,8 +189,10 @@ Bool_t QnCorrectionsProfileChannelized::CreateProfileHistograms(TList *histogram
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfileChannelized::GetBin(const Float_t *variableContainer, Int_t nChannel) {
 
-  FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
+  if (fEventClassBins != NULL)
+    return fEntries->GetBin(FillBinAxesCoordinates(fEntries->GetAxis(fEventClassVariables.GetEntriesFast())->FindBin(fChannelMap[nChannel])));
   /* store the channel number */
+  FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
   return fEntries->GetBin(fBinAxesValues);
 }
 
@@ -263,19 +270,25 @@ Float_t QnCorrectionsProfileChannelized::GetBinError(Long64_t bin) {
 ///
 /// The involved bin is computed according to the current variables
 /// content and the passed external channel number. The bin is then
-/// increased by the given weight and the entries also increased properly.
+/// increased by the given weight and the entries also increased properly
+/// in the dense accumulator. The histograms get the content once the
+/// accumulator is flushed.
 ///
 /// \param variableContainer the current variables content addressed by var Id
 /// \param nChannel the interested external channel number
 /// \param weight the increment in the bin content
 void QnCorrectionsProfileChannelized::Fill(const Float_t *variableContainer, Int_t nChannel, Float_t weight) {
-  /* keep the total entries in fValues updated */
-  Double_t nEntries = fValues->GetEntries();
-
-  FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
+  Long64_t bin = GetBin(variableContainer, nChannel);
   /* and now update the bin */
-  fValues->Fill(fBinAxesValues, weight);
-  fValues->SetEntries(nEntries + 1);
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->Fill(bin, 0, weight);
+  fAccumulator->FillEntries(bin);
+}
+
+/// Transfers the accumulated content to the histograms
+void QnCorrectionsProfileChannelized::FlushAccumulator() {
+  if (fAccumulator != NULL) {
+    THnF *values[1] = { fValues };
+    fAccumulator->Flush(values, fEntries);
+  }
 }
 
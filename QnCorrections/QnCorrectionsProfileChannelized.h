@@ -75,6 +75,8 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual void Fill(const Float_t *variableContainer,Float_t weight)
   { QnCorrectionsHistogramBase::Fill(variableContainer, weight); }
+
+  virtual void FlushAccumulator();
 private:
   THnF *fValues;              //!<! Cumulates values for each of the event classes
   THnI *fEntries;             //!<! Cumulates the number on each of the event classes
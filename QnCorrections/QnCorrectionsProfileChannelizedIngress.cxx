@@ -15,6 +15,7 @@ ClassImp(QnCorrectionsProfileChannelizedIngress);
 QnCorrectionsProfileChannelizedIngress::QnCorrectionsProfileChannelizedIngress() :
     QnCorrectionsHistogramBase() {
 
+  fBinning = NULL;
   fValues = NULL;
   fGroupValues = NULL;
   fValidated = NULL;
@@ -52,6 +53,7 @@ QnCorrectionsProfileChannelizedIngress::QnCorrectionsProfileChannelizedIngress(c
     Int_t nNoOfChannels,
     Option_t *option) : QnCorrectionsHistogramBase(name, title, ecvs, option) {
 
+  fBinning = NULL;
   fValues = NULL;
   fGroupValues = NULL;
   fValidated = NULL;
@@ -116,78 +118,9 @@ Bool_t QnCorrectionsProfileChannelizedIngress::AttachHistograms(TList *histogram
   fValues = NULL;
   fGroupValues = NULL;
   fValidated = NULL;
-  if (fUsedChannel != NULL) delete [] fUsedChannel;
-  if (fChannelGroup != NULL) delete [] fChannelGroup;
-  if (fChannelMap != NULL) delete [] fChannelMap;
-  if (fUsedGroup != NULL) delete [] fUsedGroup;
-  if (fGroupMap != NULL) delete [] fGroupMap;
-
-
-  /* lets consider now the channel information */
-  fUsedChannel = new Bool_t[fNoOfChannels];
-  fChannelGroup = new Int_t[fNoOfChannels];
-  fChannelMap = new Int_t[fNoOfChannels];
-  for (Int_t i = 0; i < fNoOfChannels; i++) {
-    fUsedChannel[i] = kFALSE;
-    fChannelGroup[i] = 0;
-    fChannelMap[i] = -1;
-  }
+  fBinning = NULL;
 
-  Int_t nMinGroup = 0xFFFF;
-  Int_t nMaxGroup = 0x0000;
-  fActualNoOfChannels = 0;
-  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
-    if (bUsedChannel != NULL) {
-      fUsedChannel[ixChannel] = bUsedChannel[ixChannel];
-    }
-    else {
-      fUsedChannel[ixChannel] = kTRUE;
-    }
-    if (fUsedChannel[ixChannel]) {
-      if (nChannelGroup != NULL) {
-        fChannelGroup[ixChannel] = nChannelGroup[ixChannel];
-        /* update min max group number */
-        if (nChannelGroup[ixChannel] < nMinGroup)
-          nMinGroup = nChannelGroup[ixChannel];
-        if (nMaxGroup < nChannelGroup[ixChannel])
-          nMaxGroup = nChannelGroup[ixChannel];
-      }
-      else {
-        fChannelGroup[ixChannel] = 0;
-        nMinGroup = 0;
-        nMaxGroup = 0;
-      }
-      fChannelMap[ixChannel] = fActualNoOfChannels;
-      fActualNoOfChannels++;
-    }
-  }
-  fUseGroups = (nChannelGroup != NULL) && (nMinGroup != nMaxGroup);
-
-  if (fUseGroups) {
-    /* let's build the groups support structures */
-    fNoOfGroups = nMaxGroup + 1; /* just in case group number starts from zero */
-    fUsedGroup = new Bool_t[fNoOfGroups];
-    fGroupMap = new Int_t[fNoOfGroups];
-    for (Int_t i = 0; i < fNoOfGroups; i++) {
-      fUsedGroup[i] = kFALSE;
-      fGroupMap[i] = -1;
-    }
-    fActualNoOfGroups = 0;
-    for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
-      if (fUsedChannel[ixChannel]) {
-        if (fUsedGroup[fChannelGroup[ixChannel]]) {
-          /* group already considered */
-          continue;
-        }
-        else {
-          /* new group number */
-          fUsedGroup[fChannelGroup[ixChannel]] = kTRUE;
-          fGroupMap[fChannelGroup[ixChannel]] = fActualNoOfGroups;
-          fActualNoOfGroups++;
-        }
-      }
-    }
-  }
+  BuildChannelsMaps(bUsedChannel, nChannelGroup);
 
   /* let's first try the Values / Entries structure */
   THnI *origEntries = (THnI *) histogramList->FindObject((const char*) entriesHistoName);
@@ -222,6 +155,7 @@ Bool_t QnCorrectionsProfileChannelizedIngress::AttachHistograms(TList *histogram
     fValidated = new THnC(Form("%s_Validated",(const char *) histoName), Form("%s_Validated",(const char *) histoName),nVariables+1,nbins,minvals,maxvals);
     /* and now the definitive histogram value /error getting validation information */
     fValues = DivideTHnF(origValues, origEntries,fValidated);
+    fBinning = fValues;
 
     if (fUseGroups) {
       /* let's then build the groups histogram */
@@ -330,6 +264,129 @@ Bool_t QnCorrectionsProfileChannelizedIngress::AttachHistograms(TList *histogram
   return kTRUE;
 }
 
+/// Builds the channels and channels groups maps
+///
+/// If bUsedChannel is NULL all channels within fNoOfChannels are
+/// assigned to this profile. If nChannelGroup is NULL all channels
+/// assigned to this profile are allocated to the same group.
+/// \param bUsedChannel array of booleans one per each channel
+/// \param nChannelGroup array of group number for each channel
+void QnCorrectionsProfileChannelizedIngress::BuildChannelsMaps(const Bool_t *bUsedChannel, const Int_t *nChannelGroup) {
+  /* initialize. Remember we own the structures */
+  if (fUsedChannel != NULL) delete [] fUsedChannel;
+  if (fChannelGroup != NULL) delete [] fChannelGroup;
+  if (fChannelMap != NULL) delete [] fChannelMap;
+  if (fUsedGroup != NULL) delete [] fUsedGroup;
+  if (fGroupMap != NULL) delete [] fGroupMap;
+  fUsedGroup = NULL;
+  fGroupMap = NULL;
+
+  /* lets consider now the channel information */
+  fUsedChannel = new Bool_t[fNoOfChannels];
+  fChannelGroup = new Int_t[fNoOfChannels];
+  fChannelMap = new Int_t[fNoOfChannels];
+  for (Int_t i = 0; i < fNoOfChannels; i++) {
+    fUsedChannel[i] = kFALSE;
+    fChannelGroup[i] = 0;
+    fChannelMap[i] = -1;
+  }
+
+  Int_t nMinGroup = 0xFFFF;
+  Int_t nMaxGroup = 0x0000;
+  fActualNoOfChannels = 0;
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    if (bUsedChannel != NULL) {
+      fUsedChannel[ixChannel] = bUsedChannel[ixChannel];
+    }
+    else {
+      fUsedChannel[ixChannel] = kTRUE;
+    }
+    if (fUsedChannel[ixChannel]) {
+      if (nChannelGroup != NULL) {
+        fChannelGroup[ixChannel] = nChannelGroup[ixChannel];
+        /* update min max group number */
+        if (nChannelGroup[ixChannel] < nMinGroup)
+          nMinGroup = nChannelGroup[ixChannel];
+        if (nMaxGroup < nChannelGroup[ixChannel])
+          nMaxGroup = nChannelGroup[ixChannel];
+      }
+      else {
+        fChannelGroup[ixChannel] = 0;
+        nMinGroup = 0;
+        nMaxGroup = 0;
+      }
+      fChannelMap[ixChannel] = fActualNoOfChannels;
+      fActualNoOfChannels++;
+    }
+  }
+  fUseGroups = (nChannelGroup != NULL) && (nMinGroup != nMaxGroup);
+
+  if (fUseGroups) {
+    /* let's build the groups support structures */
+    fNoOfGroups = nMaxGroup + 1; /* just in case group number starts from zero */
+    fUsedGroup = new Bool_t[fNoOfGroups];
+    fGroupMap = new Int_t[fNoOfGroups];
+    for (Int_t i = 0; i < fNoOfGroups; i++) {
+      fUsedGroup[i] = kFALSE;
+      fGroupMap[i] = -1;
+    }
+    fActualNoOfGroups = 0;
+    for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+      if (fUsedChannel[ixChannel]) {
+        if (fUsedGroup[fChannelGroup[ixChannel]]) {
+          /* group already considered */
+          continue;
+        }
+        else {
+          /* new group number */
+          fUsedGroup[fChannelGroup[ixChannel]] = kTRUE;
+          fGroupMap[fChannelGroup[ixChannel]] = fActualNoOfGroups;
+          fActualNoOfGroups++;
+        }
+      }
+    }
+  }
+}
+
+/// Attaches just the binning of the existing histograms
+///
+/// Lighter version of AttachHistograms for when the correction
+/// parameters are already available, i.e. shared from another instance
+/// attached to the same list. The channel maps are built but neither the
+/// definitive value / error histogram nor the group one are created. The
+/// bin numbers are taken from the entries histogram in the passed list
+/// which is not owned and should persist while attached. Only bin numbers
+/// and channel information are then available.
+/// \param histogramList list where the histograms have to be located
+/// \param bUsedChannel array of booleans one per each channel
+/// \param nChannelGroup array of group number for each channel
+/// \return true if properly attached else false
+Bool_t QnCorrectionsProfileChannelizedIngress::AttachBinning(TList *histogramList, const Bool_t *bUsedChannel, const Int_t *nChannelGroup) {
+  /* let's build the histograms name */
+  TString entriesHistoName = GetName(); entriesHistoName += szEntriesHistoSuffix;
+
+  /* initialize. Remember we own the histograms */
+  if (fValues != NULL) delete fValues;
+  if (fGroupValues != NULL) delete fGroupValues;
+  if (fValidated != NULL) delete fValidated;
+  fValues = NULL;
+  fGroupValues = NULL;
+  fValidated = NULL;
+  fBinning = NULL;
+
+  BuildChannelsMaps(bUsedChannel, nChannelGroup);
+
+  THnI *origEntries = (THnI *) histogramList->FindObject((const char*) entriesHistoName);
+  if (origEntries != NULL && origEntries->GetEntries() != 0) {
+    /* let's check the channel axis */
+    if (fActualNoOfChannels != origEntries->GetAxis(fEventClassVariables.GetEntriesFast())->GetNbins())
+      return kFALSE;
+    fBinning = origEntries;
+    return kTRUE;
+  }
+  return kFALSE;
+}
+
 /// Get the bin number for the current variable content and passed channel
 ///
 /// The bin number identifies the event class the current
@@ -340,9 +397,49 @@ Bool_t QnCorrectionsProfileChannelizedIngress::AttachHistograms(TList *histogram
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfileChannelizedIngress::GetBin(const Float_t *variableContainer, Int_t nChannel) {
 
+  if (fEventClassBins != NULL)
+    return fBinning->GetBin(FillBinAxesCoordinates(fBinning->GetAxis(fEventClassVariables.GetEntriesFast())->FindBin(fChannelMap[nChannel])));
   /* store also the channel number */
   FillBinAxesValues(variableContainer, fChannelMap[nChannel]);
-  return fValues->GetBin(fBinAxesValues);
+  return fBinning->GetBin(fBinAxesValues);
+}
+
+/// Get the external channel number the passed bin corresponds to
+/// \param bin the interested bin number
+/// \return the external channel number, -1 for channel underflow or overflow bins
+Int_t QnCorrectionsProfileChannelizedIngress::GetBinChannel(Long64_t bin) {
+  Int_t nVariables = fEventClassVariables.GetEntriesFast();
+
+  fBinning->GetBinContent(bin, fBinAxesCoordinates);
+  Int_t histoChannel = fBinAxesCoordinates[nVariables] - 1;
+  if (histoChannel < 0 || !(histoChannel < fActualNoOfChannels))
+    return -1;
+  for (Int_t ixChannel = 0; ixChannel < fNoOfChannels; ixChannel++) {
+    if (fChannelMap[ixChannel] == histoChannel)
+      return ixChannel;
+  }
+  return -1;
+}
+
+/// Get the group bin content associated to the passed bin number
+///
+/// The group content is the one of the group the bin channel pertains
+/// to within the same event class. Only available once the histograms
+/// are fully attached.
+/// \param bin the interested bin number
+/// \return the group bin content, 1.0 if groups are not used
+Float_t QnCorrectionsProfileChannelizedIngress::GetGrpBinContentOfBin(Long64_t bin) {
+
+  /* check the groups structures are in place */
+  if (fUseGroups) {
+    Int_t nChannel = GetBinChannel(bin);
+    if (nChannel < 0)
+      return 1.0;
+    /* the coordinates of the bin are still there, just change the channel by its group */
+    fBinAxesCoordinates[fEventClassVariables.GetEntriesFast()] = fGroupMap[fChannelGroup[nChannel]] + 1;
+    return fGroupValues->GetBinContent(fGroupValues->GetBin(fBinAxesCoordinates));
+  }
+  return 1.0;
 }
 
 /// Check the validity of the content of the passed bin
@@ -396,6 +493,8 @@ Long64_t QnCorrectionsProfileChannelizedIngress::GetGrpBin(const Float_t *variab
 
   /* check the groups structures are in place */
   if (fUseGroups) {
+    if (fEventClassBins != NULL)
+      return fGroupValues->GetBin(FillBinAxesCoordinates(fGroupValues->GetAxis(fEventClassVariables.GetEntriesFast())->FindBin(fGroupMap[fChannelGroup[nChannel]])));
     /* store also the group number */
     FillBinAxesValues(variableContainer, fGroupMap[fChannelGroup[nChannel]]);
     return fGroupValues->GetBin(fBinAxesValues);
@@ -49,6 +49,7 @@ public:
   virtual ~QnCorrectionsProfileChannelizedIngress();
 
   virtual Bool_t AttachHistograms(TList *histogramList, const Bool_t *bUsedChannel, const Int_t *nChannelGroup);
+  Bool_t AttachBinning(TList *histogramList, const Bool_t *bUsedChannel, const Int_t *nChannelGroup);
   /// wrong call for this class invoke base class behavior
   virtual Bool_t AttachHistograms(TList *histogramList)
   { return QnCorrectionsHistogramBase::AttachHistograms(histogramList); }
@@ -58,6 +59,11 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual Long64_t GetBin(const Float_t *variableContainer)
   { return QnCorrectionsHistogramBase::GetBin(variableContainer); }
+  /// Get the total number of bins, under and overflow included
+  /// \return the number of bins of the histogram
+  virtual Long64_t GetNoOfBins() { return fBinning->GetNbins(); }
+  Int_t GetBinChannel(Long64_t bin);
+  Float_t GetGrpBinContentOfBin(Long64_t bin);
   virtual Bool_t BinContentValidated(Long64_t bin);
   virtual Float_t GetBinContent(Long64_t bin);
   virtual Float_t GetGrpBinContent(Long64_t bin);
@@ -65,6 +71,9 @@ public:
   virtual Float_t GetGrpBinError(Long64_t bin);
 
 private:
+  void BuildChannelsMaps(const Bool_t *bUsedChannel, const Int_t *nChannelGroup);
+
+  THnBase *fBinning;          //!<! the histogram providing the bin numbers, fValues or the calibration entries histogram
   THnF *fValues;              //!<! the values and errors on each event class and channel
   THnF *fGroupValues;         //!<! the values and errors on each event class and group
   THnC *fValidated;           //!<! bin content validated flag
@@ -81,7 +90,7 @@ private:
 
 
   /// \cond CLASSIMP
-  ClassDef(QnCorrectionsProfileChannelizedIngress, 2);
+  ClassDef(QnCorrectionsProfileChannelizedIngress, 3);
   /// \endcond
 };
 
@@ -194,6 +194,11 @@ Bool_t QnCorrectionsProfileComponents::CreateComponentsProfileHistograms(TList *
   /* and finally add the entries histogram to the list */
   histogramList->Add(fEntries);
 
+  /* the histograms are filled through the dense accumulator */
+  if (fAccumulator != NULL)
+    delete fAccumulator;
+  fAccumulator = new QnCorrectionsProfileAccumulator(fEntries->GetNbins(), 2 * nNumberOfSlots);
+
   delete [] minvals;
   delete [] maxvals;
   delete [] nbins;
@@ -272,6 +277,8 @@ Bool_t QnCorrectionsProfileComponents::AttachHistograms(TList *histogramList) {
 /// \param variableContainer the current variables content addressed by var Id
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfileComponents::GetBin(const Float_t *variableContainer) {
+  if (fEventClassBins != NULL)
+    return fEntries->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
   return fEntries->GetBin(fBinAxesValues);
 }
@@ -454,12 +461,8 @@ void QnCorrectionsProfileComponents::FillX(Int_t harmonic, const Float_t *variab
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fXValues[harmonic]->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fXValues[harmonic]->Fill(fBinAxesValues, weight);
-  fXValues[harmonic]->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 2 * harmonic, weight);
 
   /* update harmonic fill mask */
   fXharmonicFillMask |= harmonicNumberMask[harmonic];
@@ -468,7 +471,7 @@ void QnCorrectionsProfileComponents::FillX(Int_t harmonic, const Float_t *variab
   if (fXharmonicFillMask != fFullFilled) return;
   if (fYharmonicFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXharmonicFillMask = 0x0000;
   fYharmonicFillMask = 0x0000;
 }
@@ -497,12 +500,8 @@ void QnCorrectionsProfileComponents::FillY(Int_t harmonic, const Float_t *variab
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fYValues[harmonic]->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fYValues[harmonic]->Fill(fBinAxesValues, weight);
-  fYValues[harmonic]->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 2 * harmonic + 1, weight);
 
   /* update harmonic fill mask */
   fYharmonicFillMask |= harmonicNumberMask[harmonic];
@@ -511,9 +510,25 @@ void QnCorrectionsProfileComponents::FillY(Int_t harmonic, const Float_t *variab
   if (fYharmonicFillMask != fFullFilled) return;
   if (fXharmonicFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXharmonicFillMask = 0x0000;
   fYharmonicFillMask = 0x0000;
 }
 
+/// Transfers the accumulated content to the histograms
+///
+/// The accumulator components are the X and Y components for each
+/// harmonic slot consecutively.
+void QnCorrectionsProfileComponents::FlushAccumulator() {
+  if (fAccumulator != NULL) {
+    Int_t nNumberOfSlots = fAccumulator->GetNoOfComponents() / 2;
+    THnF **values = new THnF *[2 * nNumberOfSlots];
+    for (Int_t slot = 0; slot < nNumberOfSlots; slot++) {
+      values[2 * slot] = fXValues[slot];
+      values[2 * slot + 1] = fYValues[slot];
+    }
+    fAccumulator->Flush(values, fEntries);
+    delete [] values;
+  }
+}
 
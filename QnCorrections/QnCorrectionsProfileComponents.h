@@ -58,6 +58,9 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual Long64_t GetBin(const Float_t *variableContainer, Int_t nChannel)
   { return QnCorrectionsHistogramBase::GetBin(variableContainer, nChannel); }
+  /// Get the total number of bins, under and overflow included
+  /// \return the number of bins of the histogram
+  virtual Long64_t GetNoOfBins() { return fEntries->GetNbins(); }
   virtual Bool_t BinContentValidated(Long64_t bin);
   virtual Float_t GetXBinContent(Int_t harmonic, Long64_t bin);
   virtual Float_t GetYBinContent(Int_t harmonic, Long64_t bin);
@@ -67,6 +70,8 @@ public:
   virtual void FillX(Int_t harmonic, const Float_t *variableContainer, Float_t weight);
   virtual void FillY(Int_t harmonic, const Float_t *variableContainer, Float_t weight);
 
+  virtual void FlushAccumulator();
+
 private:
   THnF **fXValues;            //!<! X component histogram for each requested harmonic
   THnF **fYValues;            //!<! Y component histogram for each requested harmonic
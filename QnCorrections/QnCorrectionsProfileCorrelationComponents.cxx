@@ -168,6 +168,11 @@ Bool_t QnCorrectionsProfileCorrelationComponents::CreateCorrelationComponentsPro
   /* and finally add the entries histogram to the list */
   histogramList->Add(fEntries);
 
+  /* the histograms are filled through the dense accumulator */
+  if (fAccumulator != NULL)
+    delete fAccumulator;
+  fAccumulator = new QnCorrectionsProfileAccumulator(fEntries->GetNbins(), 4);
+
   delete [] minvals;
   delete [] maxvals;
   delete [] nbins;
@@ -239,6 +244,8 @@ Bool_t QnCorrectionsProfileCorrelationComponents::AttachHistograms(TList *histog
 /// \param variableContainer the current variables content addressed by var Id
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfileCorrelationComponents::GetBin(const Float_t *variableContainer) {
+  if (fEventClassBins != NULL)
+    return fEntries->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
   return fEntries->GetBin(fBinAxesValues);
 }
@@ -488,12 +495,8 @@ void QnCorrectionsProfileCorrelationComponents::FillXX(const Float_t *variableCo
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fXXValues->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fXXValues->Fill(fBinAxesValues, weight);
-  fXXValues->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 0, weight);
 
   /* update fill mask */
   fXXXYYXYYFillMask |= correlationXXmask;
@@ -501,7 +504,7 @@ void QnCorrectionsProfileCorrelationComponents::FillXX(const Float_t *variableCo
   /* now check if time for updating entries histogram */
   if (fXXXYYXYYFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXXYYXYYFillMask = 0x0000;
 }
 
@@ -524,12 +527,8 @@ void QnCorrectionsProfileCorrelationComponents::FillXY(const Float_t *variableCo
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fXYValues->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fXYValues->Fill(fBinAxesValues, weight);
-  fXYValues->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 1, weight);
 
   /* update fill mask */
   fXXXYYXYYFillMask |= correlationXYmask;
@@ -537,7 +536,7 @@ void QnCorrectionsProfileCorrelationComponents::FillXY(const Float_t *variableCo
   /* now check if time for updating entries histogram */
   if (fXXXYYXYYFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXXYYXYYFillMask = 0x0000;
 }
 
@@ -560,12 +559,8 @@ void QnCorrectionsProfileCorrelationComponents::FillYX(const Float_t *variableCo
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fYXValues->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fYXValues->Fill(fBinAxesValues, weight);
-  fYXValues->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 2, weight);
 
   /* update fill mask */
   fXXXYYXYYFillMask |= correlationYXmask;
@@ -573,7 +568,7 @@ void QnCorrectionsProfileCorrelationComponents::FillYX(const Float_t *variableCo
   /* now check if time for updating entries histogram */
   if (fXXXYYXYYFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXXYYXYYFillMask = 0x0000;
 }
 
@@ -596,12 +591,8 @@ void QnCorrectionsProfileCorrelationComponents::FillYY(const Float_t *variableCo
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fYYValues->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fYYValues->Fill(fBinAxesValues, weight);
-  fYYValues->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 3, weight);
 
   /* update harmonic fill mask */
   fXXXYYXYYFillMask |= correlationYYmask;
@@ -609,8 +600,17 @@ void QnCorrectionsProfileCorrelationComponents::FillYY(const Float_t *variableCo
   /* now check if time for updating entries histogram */
   if (fXXXYYXYYFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXXYYXYYFillMask = 0x0000;
 }
 
+/// Transfers the accumulated content to the histograms
+///
+/// The accumulator components are the XX, XY, YX and YY components.
+void QnCorrectionsProfileCorrelationComponents::FlushAccumulator() {
+  if (fAccumulator != NULL) {
+    THnF *values[4] = { fXXValues, fXYValues, fYXValues, fYYValues };
+    fAccumulator->Flush(values, fEntries);
+  }
+}
 
@@ -42,6 +42,9 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual Long64_t GetBin(const Float_t *variableContainer, Int_t nChannel)
   { return QnCorrectionsHistogramBase::GetBin(variableContainer, nChannel); }
+  /// Get the total number of bins, under and overflow included
+  /// \return the number of bins of the histogram
+  virtual Long64_t GetNoOfBins() { return fEntries->GetNbins(); }
   virtual Bool_t BinContentValidated(Long64_t bin);
   virtual Float_t GetXXBinContent(Long64_t bin);
   virtual Float_t GetXYBinContent(Long64_t bin);
@@ -96,6 +99,8 @@ public:
   virtual void FillYY(Int_t harmonic, const Float_t *variableContainer, Float_t weight)
   { return QnCorrectionsHistogramBase::FillYY(harmonic, variableContainer, weight); }
 
+  virtual void FlushAccumulator();
+
 private:
   THnF *fXXValues;            //!<! XX component histogram
   THnF *fXYValues;            //!<! XY component histogram
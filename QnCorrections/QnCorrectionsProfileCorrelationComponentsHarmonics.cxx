@@ -237,6 +237,11 @@ Bool_t QnCorrectionsProfileCorrelationComponentsHarmonics::CreateCorrelationComp
   /* and finally add the entries histogram to the list */
   histogramList->Add(fEntries);
 
+  /* the histograms are filled through the dense accumulator */
+  if (fAccumulator != NULL)
+    delete fAccumulator;
+  fAccumulator = new QnCorrectionsProfileAccumulator(fEntries->GetNbins(), 4 * nNumberOfSlots);
+
   delete [] minvals;
   delete [] maxvals;
   delete [] nbins;
@@ -334,6 +339,8 @@ Bool_t QnCorrectionsProfileCorrelationComponentsHarmonics::AttachHistograms(TLis
 /// \param variableContainer the current variables content addressed by var Id
 /// \return the associated bin to the current variables content
 Long64_t QnCorrectionsProfileCorrelationComponentsHarmonics::GetBin(const Float_t *variableContainer) {
+  if (fEventClassBins != NULL)
+    return fEntries->GetBin(fEventClassBins->GetCoordinates());
   FillBinAxesValues(variableContainer);
   return fEntries->GetBin(fBinAxesValues);
 }
@@ -652,12 +659,8 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillXX(Int_t harmonic,
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fXXValues[harmonic]->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fXXValues[harmonic]->Fill(fBinAxesValues, weight);
-  fXXValues[harmonic]->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 4 * harmonic, weight);
 
   /* update harmonic fill mask */
   fXXharmonicFillMask |= harmonicNumberMask[harmonic];
@@ -668,7 +671,7 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillXX(Int_t harmonic,
   if (fYXharmonicFillMask != fFullFilled) return;
   if (fYYharmonicFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXharmonicFillMask = 0x0000;
   fXYharmonicFillMask = 0x0000;
   fYXharmonicFillMask = 0x0000;
@@ -699,12 +702,8 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillXY(Int_t harmonic,
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fXYValues[harmonic]->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fXYValues[harmonic]->Fill(fBinAxesValues, weight);
-  fXYValues[harmonic]->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 4 * harmonic + 1, weight);
 
   /* update harmonic fill mask */
   fXYharmonicFillMask |= harmonicNumberMask[harmonic];
@@ -715,7 +714,7 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillXY(Int_t harmonic,
   if (fYXharmonicFillMask != fFullFilled) return;
   if (fYYharmonicFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXharmonicFillMask = 0x0000;
   fXYharmonicFillMask = 0x0000;
   fYXharmonicFillMask = 0x0000;
@@ -746,12 +745,8 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillYX(Int_t harmonic,
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fYXValues[harmonic]->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fYXValues[harmonic]->Fill(fBinAxesValues, weight);
-  fYXValues[harmonic]->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 4 * harmonic + 2, weight);
 
   /* update harmonic fill mask */
   fYXharmonicFillMask |= harmonicNumberMask[harmonic];
@@ -762,7 +757,7 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillYX(Int_t harmonic,
   if (fYXharmonicFillMask != fFullFilled) return;
   if (fYYharmonicFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXharmonicFillMask = 0x0000;
   fXYharmonicFillMask = 0x0000;
   fYXharmonicFillMask = 0x0000;
@@ -793,12 +788,8 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillYY(Int_t harmonic,
 
   /* now it's safe to continue */
 
-  /* keep total entries in fValues updated */
-  Double_t nEntries = fYYValues[harmonic]->GetEntries();
-
-  FillBinAxesValues(variableContainer);
-  fYYValues[harmonic]->Fill(fBinAxesValues, weight);
-  fYYValues[harmonic]->SetEntries(nEntries + 1);
+  Long64_t bin = GetBin(variableContainer);
+  fAccumulator->Fill(bin, 4 * harmonic + 3, weight);
 
   /* update harmonic fill mask */
   fYYharmonicFillMask |= harmonicNumberMask[harmonic];
@@ -809,10 +800,29 @@ void QnCorrectionsProfileCorrelationComponentsHarmonics::FillYY(Int_t harmonic,
   if (fYXharmonicFillMask != fFullFilled) return;
   if (fYYharmonicFillMask != fFullFilled) return;
   /* update entries and reset the masks */
-  fEntries->Fill(fBinAxesValues, 1.0);
+  fAccumulator->FillEntries(bin);
   fXXharmonicFillMask = 0x0000;
   fXYharmonicFillMask = 0x0000;
   fYXharmonicFillMask = 0x0000;
   fYYharmonicFillMask = 0x0000;
 }
 
+/// Transfers the accumulated content to the histograms
+///
+/// The accumulator components are the XX, XY, YX and YY components for
+/// each harmonic slot consecutively.
+void QnCorrectionsProfileCorrelationComponentsHarmonics::FlushAccumulator() {
+  if (fAccumulator != NULL) {
+    Int_t nNumberOfSlots = fAccumulator->GetNoOfComponents() / 4;
+    THnF **values = new THnF *[4 * nNumberOfSlots];
+    for (Int_t slot = 0; slot < nNumberOfSlots; slot++) {
+      values[4 * slot] = fXXValues[slot];
+      values[4 * slot + 1] = fXYValues[slot];
+      values[4 * slot + 2] = fYXValues[slot];
+      values[4 * slot + 3] = fYYValues[slot];
+    }
+    fAccumulator->Flush(values, fEntries);
+    delete [] values;
+  }
+}
+
@@ -53,6 +53,9 @@ public:
   /// wrong call for this class invoke base class behavior
   virtual Long64_t GetBin(const Float_t *variableContainer, Int_t nChannel)
   { return QnCorrectionsHistogramBase::GetBin(variableContainer, nChannel); }
+  /// Get the total number of bins, under and overflow included
+  /// \return the number of bins of the histogram
+  virtual Long64_t GetNoOfBins() { return fEntries->GetNbins(); }
   virtual Bool_t BinContentValidated(Long64_t bin);
   virtual Float_t GetXXBinContent(Int_t harmonic, Long64_t bin);
   virtual Float_t GetXYBinContent(Int_t harmonic, Long64_t bin);
@@ -106,6 +109,7 @@ public:
   virtual void FillYY(const Float_t *variableContainer, Float_t weight)
   { return QnCorrectionsHistogramBase::FillYY(variableContainer, weight); }
 
+  virtual void FlushAccumulator();
 
 
 private:
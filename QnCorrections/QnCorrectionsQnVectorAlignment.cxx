@@ -65,6 +65,7 @@ QnCorrectionsQnVectorAlignment::QnCorrectionsQnVectorAlignment() :
   fHarmonicForAlignment = -1;
   fDetectorConfigurationForAlignment = NULL;
   fMinNoOfEntriesToValidate = fDefaultMinNoOfEntries;
+  fParametersTable = NULL;
 }
 
 /// Default destructor
@@ -78,6 +79,7 @@ QnCorrectionsQnVectorAlignment::~QnCorrectionsQnVectorAlignment() {
     delete fQANotValidatedBin;
   if (fQAQnAverageHistogram != NULL)
     delete fQAQnAverageHistogram;
+  ReleaseParametersTable();
 }
 
 /// Set the detector configuration used as reference for alignment
@@ -153,11 +155,11 @@ Bool_t QnCorrectionsQnVectorAlignment::CreateSupportHistograms(TList *list) {
       fDetectorConfigurationForAlignment->GetName());
 
   if (fInputHistograms != NULL) delete fInputHistograms;
-  fInputHistograms = new QnCorrectionsProfileCorrelationComponents((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
-      fDetectorConfiguration->GetEventClassVariablesSet());
-  fInputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  fInputHistograms = NewInputHistograms();
+  fInputHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fCalibrationHistograms = new QnCorrectionsProfileCorrelationComponents((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
       fDetectorConfiguration->GetEventClassVariablesSet());
+  fCalibrationHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
 
   fCalibrationHistograms->CreateCorrelationComponentsProfileHistograms(list);
   return kTRUE;
@@ -169,12 +171,121 @@ Bool_t QnCorrectionsQnVectorAlignment::CreateSupportHistograms(TList *list) {
 Bool_t QnCorrectionsQnVectorAlignment::AttachInput(TList *list) {
 
   if (fInputHistograms->AttachHistograms(list)) {
+    ReleaseParametersTable();
+    fParametersTable = BuildParametersTable(list, fInputHistograms);
     fState = QCORRSTEP_applyCollect;
     return kTRUE;
   }
   return kFALSE;
 }
 
+/// Prepares in advance the input information of a calibration list
+///
+/// The correction parameters table is built out of private input
+/// histograms and published. A reference to it is held so that
+/// AttachInput for the same list finds it already built.
+/// \param list list where the inputs should be found
+/// \return kTRUE if the correction parameters table is available
+Bool_t QnCorrectionsQnVectorAlignment::PrepareInput(TList *list) {
+
+  const QnCorrectionsCalibrationSnapshot *table = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (table == NULL) {
+    QnCorrectionsProfileCorrelationComponents *inputHistograms = NewInputHistograms();
+    if (inputHistograms->AttachHistograms(list))
+      table = BuildParametersTable(list, inputHistograms);
+    delete inputHistograms;
+  }
+  if (table == NULL) return kFALSE;
+  HoldPreparedInput(table);
+  return kTRUE;
+}
+
+/// Creates the input histograms of the correction step
+///
+/// Their event class bins are not set, so the caller should
+/// set them if the histograms are going to be used for event processing.
+/// \return the new input histograms
+QnCorrectionsProfileCorrelationComponents *QnCorrectionsQnVectorAlignment::NewInputHistograms() const {
+
+  TString histoNameAndTitle = Form("%s %s#times%s ",
+      szSupportHistogramName,
+      fDetectorConfiguration->GetName(),
+      fDetectorConfigurationForAlignment->GetName());
+
+  QnCorrectionsProfileCorrelationComponents *inputHistograms =
+      new QnCorrectionsProfileCorrelationComponents((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
+          fDetectorConfiguration->GetEventClassVariablesSet());
+  inputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  return inputHistograms;
+}
+
+/// Builds the correction parameters table out of the input histograms
+///
+/// For each event class bin the validation flag is stored together with,
+/// for each configured harmonic, the cosine and sine of the rotation angle
+/// to apply. Bins where the correction is not significant get the identity
+/// rotation. The table is addressed by the histograms bin number and the
+/// harmonic number so, the correction apply only needs a table lookup.
+///
+/// The table is shared with any other instance of the correction step
+/// attached to the same calibration list so, it is only built if none
+/// of them has already published it.
+/// \param list the list the inputs were found in
+/// \param inputHistograms the input histograms attached to the list
+/// \return the correction parameters table with a reference taken
+const QnCorrectionsCalibrationSnapshot *QnCorrectionsQnVectorAlignment::BuildParametersTable(TList *list,
+    QnCorrectionsProfileCorrelationComponents *inputHistograms) {
+
+  const QnCorrectionsCalibrationSnapshot *published = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (published != NULL) return published;
+
+  Int_t nNoOfHarmonics = fDetectorConfiguration->GetNoOfHarmonics();
+  Int_t *harmonicsMap = new Int_t[nNoOfHarmonics];
+  fDetectorConfiguration->GetHarmonicMap(harmonicsMap);
+  Int_t nNoOfSlots = 0;
+  for (Int_t h = 0; h < nNoOfHarmonics; h++) {
+    if (nNoOfSlots < harmonicsMap[h] + 1) nNoOfSlots = harmonicsMap[h] + 1;
+  }
+
+  QnCorrectionsCalibrationSnapshot *table =
+      new QnCorrectionsCalibrationSnapshot(list, GetName(), inputHistograms->GetNoOfBins(), nNoOfSlots, 2);
+
+  for (Long64_t bin = 0; bin < table->GetNoOfBins(); bin++) {
+    table->SetBinValidated(bin, inputHistograms->BinContentValidated(bin));
+    Float_t *parameters = table->GetParametersToBuild(bin);
+    for (Int_t slot = 0; slot < nNoOfSlots * 2; slot += 2) {
+      parameters[slot + 0] = 1.0;
+      parameters[slot + 1] = 0.0;
+    }
+    if (table->IsBinValidated(bin)) {
+      Double_t XX  = inputHistograms->GetXXBinContent(bin);
+      Double_t YY  = inputHistograms->GetYYBinContent(bin);
+      Double_t XY  = inputHistograms->GetXYBinContent(bin);
+      Double_t YX  = inputHistograms->GetYXBinContent(bin);
+      Double_t eXY = inputHistograms->GetXYBinError(bin);
+      Double_t eYX = inputHistograms->GetYXBinError(bin);
+
+      Double_t deltaPhi = - TMath::ATan2((XY-YX),(XX+YY)) * (1.0 / fHarmonicForAlignment);
+
+      /* significant correction? */
+      if (!(TMath::Sqrt((XY-YX)*(XY-YX)/(eXY*eXY+eYX*eYX)) < 2.0)) {
+        for (Int_t h = 0; h < nNoOfHarmonics; h++) {
+          parameters[harmonicsMap[h] * 2 + 0] = TMath::Cos(((Double_t) harmonicsMap[h]) * deltaPhi);
+          parameters[harmonicsMap[h] * 2 + 1] = TMath::Sin(((Double_t) harmonicsMap[h]) * deltaPhi);
+        }
+      } /* if the correction is not significant we keep the identity rotation */
+    }
+  }
+  delete [] harmonicsMap;
+  return QnCorrectionsCalibrationSnapshot::Publish(table);
+}
+
+/// Releases the reference to the correction parameters table
+void QnCorrectionsQnVectorAlignment::ReleaseParametersTable() {
+  QnCorrectionsCalibrationSnapshot::Release(fParametersTable);
+  fParametersTable = NULL;
+}
+
 /// Asks for QA histograms creation
 ///
 /// Allocates the histogram objects and creates the QA histograms.
@@ -186,6 +297,7 @@ Bool_t QnCorrectionsQnVectorAlignment::CreateQAHistograms(TList *list) {
       Form("%s %s", szQAQnAverageHistogramName, fDetectorConfiguration->GetName()),
       Form("%s %s", szQAQnAverageHistogramName, fDetectorConfiguration->GetName()),
       fDetectorConfiguration->GetEventClassVariablesSet());
+  fQAQnAverageHistogram->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
 
   /* get information about the configured harmonics to pass it for histogram creation */
   Int_t nNoOfHarmonics = fDetectorConfiguration->GetNoOfHarmonics();
@@ -207,6 +319,7 @@ Bool_t QnCorrectionsQnVectorAlignment::CreateNveQAHistograms(TList *list) {
       Form("%s %s", szQANotValidatedHistogramName, fDetectorConfiguration->GetName()),
       Form("%s %s", szQANotValidatedHistogramName, fDetectorConfiguration->GetName()),
       fDetectorConfiguration->GetEventClassVariablesSet());
+  fQANotValidatedBin->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fQANotValidatedBin->CreateHistogram(list);
   return kTRUE;
 }
@@ -227,41 +340,35 @@ Bool_t QnCorrectionsQnVectorAlignment::ProcessCorrections(const Float_t *variabl
     /* and proceed to ... */
   case QCORRSTEP_apply: /* apply the correction if the current Qn vector is good enough */
     /* logging */
-    QnCorrectionsInfo(Form("Alignment process in detector %s with reference %s: applying correction.",
+    QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Alignment process in detector %s with reference %s: applying correction.",
         fDetectorConfiguration->GetName(),
         fDetectorConfigurationForAlignment->GetName()));
     if (fDetectorConfiguration->GetCurrentQnVector()->IsGoodQuality()) {
       /* we get the properties of the current Qn vector but its name */
       fCorrectedQnVector->Set(fDetectorConfiguration->GetCurrentQnVector(),kFALSE);
 
-      /* let's check the correction histograms */
+      /* let's check the correction parameters table */
       Long64_t bin = fInputHistograms->GetBin(variableContainer);
-      if (fInputHistograms->BinContentValidated(bin)) {
+      if (fParametersTable->IsBinValidated(bin)) {
         /* the bin content is validated so, apply the correction */
-        Double_t XX  = fInputHistograms->GetXXBinContent(bin);
-        Double_t YY  = fInputHistograms->GetYYBinContent(bin);
-        Double_t XY  = fInputHistograms->GetXYBinContent(bin);
-        Double_t YX  = fInputHistograms->GetYXBinContent(bin);
-        Double_t eXY = fInputHistograms->GetXYBinError(bin);
-        Double_t eYX = fInputHistograms->GetYXBinError(bin);
-
-        Double_t deltaPhi = - TMath::ATan2((XY-YX),(XX+YY)) * (1.0 / fHarmonicForAlignment);
-
-        /* significant correction? */
-        if (!(TMath::Sqrt((XY-YX)*(XY-YX)/(eXY*eXY+eYX*eYX)) < 2.0)) {
-          Int_t harmonic = fDetectorConfiguration->GetCurrentQnVector()->GetFirstHarmonic();
-          while (harmonic != -1) {
-            fCorrectedQnVector->SetQx(harmonic,
-                fDetectorConfiguration->GetCurrentQnVector()->Qx(harmonic) * TMath::Cos(((Double_t) harmonic) * deltaPhi)
-                + fDetectorConfiguration->GetCurrentQnVector()->Qy(harmonic) * TMath::Sin (((Double_t) harmonic) * deltaPhi));
-            fCorrectedQnVector->SetQy(harmonic,
-                fDetectorConfiguration->GetCurrentQnVector()->Qy(harmonic) * TMath::Cos(((Double_t) harmonic) * deltaPhi)
-                - fDetectorConfiguration->GetCurrentQnVector()->Qx(harmonic) * TMath::Sin (((Double_t) harmonic) * deltaPhi));
-            harmonic = fDetectorConfiguration->GetCurrentQnVector()->GetNextHarmonic(harmonic);
-          }
-        } /* if the correction is not significant we leave the Q vector untouched */
+        QnCorrectionsInstrumentBin(fCorrectionsCounters, kTRUE);
+        /* not significant corrections are stored as the identity rotation */
+        const Float_t *parameters = fParametersTable->GetParameters(bin);
+        Int_t harmonic = fDetectorConfiguration->GetCurrentQnVector()->GetFirstHarmonic();
+        while (harmonic != -1) {
+          Float_t cosDeltaPhi = parameters[harmonic * 2 + 0];
+          Float_t sinDeltaPhi = parameters[harmonic * 2 + 1];
+          fCorrectedQnVector->SetQx(harmonic,
+              fDetectorConfiguration->GetCurrentQnVector()->Qx(harmonic) * cosDeltaPhi
+              + fDetectorConfiguration->GetCurrentQnVector()->Qy(harmonic) * sinDeltaPhi);
+          fCorrectedQnVector->SetQy(harmonic,
+              fDetectorConfiguration->GetCurrentQnVector()->Qy(harmonic) * cosDeltaPhi
+              - fDetectorConfiguration->GetCurrentQnVector()->Qx(harmonic) * sinDeltaPhi);
+          harmonic = fDetectorConfiguration->GetCurrentQnVector()->GetNextHarmonic(harmonic);
+        }
       } /* if the correction bin is not validated we leave the Q vector untouched */
       else {
+        QnCorrectionsInstrumentBin(fCorrectionsCounters, kFALSE);
         if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, 1.0);
       }
     }
@@ -288,7 +395,7 @@ Bool_t QnCorrectionsQnVectorAlignment::ProcessDataCollection(const Float_t *vari
   switch (fState) {
   case QCORRSTEP_calibration:
     /* logging */
-    QnCorrectionsInfo(Form("Alignment process in detector %s with reference %s: collecting data.",
+    QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Alignment process in detector %s with reference %s: collecting data.",
         fDetectorConfiguration->GetName(),
         fDetectorConfigurationForAlignment->GetName()));
     /* collect the data needed to further produce correction parameters if both current Qn vectors are good enough */
@@ -312,7 +419,7 @@ Bool_t QnCorrectionsQnVectorAlignment::ProcessDataCollection(const Float_t *vari
     break;
   case QCORRSTEP_applyCollect:
     /* logging */
-    QnCorrectionsInfo(Form("Alignment process in detector %s with reference %s: collecting data.",
+    QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Alignment process in detector %s with reference %s: collecting data.",
         fDetectorConfiguration->GetName(),
         fDetectorConfigurationForAlignment->GetName()));
     /* collect the data needed to further produce correction parameters if both current Qn vectors are good enough */
@@ -409,3 +516,17 @@ Bool_t QnCorrectionsQnVectorAlignment::ReportUsage(TList *calibrationList, TList
   return kTRUE;
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+void QnCorrectionsQnVectorAlignment::FlushHistograms() {
+  if (fCalibrationHistograms != NULL)
+    fCalibrationHistograms->FlushAccumulator();
+  if (fQAQnAverageHistogram != NULL)
+    fQAQnAverageHistogram->FlushAccumulator();
+}
+
+/// Include the reference detector configuration for alignment into the passed list
+/// \param list list where the referenced detector configurations should be added
+void QnCorrectionsQnVectorAlignment::FillReferencedConfigurations(TList *list) const {
+  if (fDetectorConfigurationForAlignment != NULL)
+    list->Add(fDetectorConfigurationForAlignment);
+}
@@ -48,6 +48,7 @@
 /// defined within the involved detector configuration
 
 #include "QnCorrectionsCorrectionOnQvector.h"
+#include "QnCorrectionsCalibrationSnapshot.h"
 
 /// \class QnCorrectionsQnVectorAlignment
 /// \brief Encapsulates Qn vector rotation for alignment correction
@@ -104,6 +105,7 @@ public:
 
   virtual void AttachedToFrameworkManager();
   virtual Bool_t AttachInput(TList *list);
+  virtual Bool_t PrepareInput(TList *list);
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -119,10 +121,16 @@ public:
   virtual Bool_t ProcessCorrections(const Float_t *variableContainer);
   virtual Bool_t ProcessDataCollection(const Float_t *variableContainer);
   virtual void ClearCorrectionStep();
+  virtual void FlushHistograms();
   virtual Bool_t IsBeingApplied() const;
   virtual Bool_t ReportUsage(TList *calibrationList, TList *applyList);
+  virtual void FillReferencedConfigurations(TList *list) const;
 
 private:
+  QnCorrectionsProfileCorrelationComponents *NewInputHistograms() const;
+  const QnCorrectionsCalibrationSnapshot *BuildParametersTable(TList *list, QnCorrectionsProfileCorrelationComponents *inputHistograms);
+  void ReleaseParametersTable();
+
   static const Int_t fDefaultMinNoOfEntries;         ///< the minimum number of entries for bin content validation
   static const char *szCorrectionName;               ///< the name of the correction step
   static const char *szKey;                          ///< the key of the correction step for ordering purpose
@@ -140,8 +148,10 @@ private:
   QnCorrectionsDetectorConfigurationBase *fDetectorConfigurationForAlignment; ///< pointer to the detector configuration used as reference for alingment
   Int_t fMinNoOfEntriesToValidate;              ///< number of entries for bin content validation threshold
 
+  const QnCorrectionsCalibrationSnapshot *fParametersTable; //!<! shared, per bin and harmonic the \f$ \cos(n \Delta\Phi), \sin(n \Delta\Phi) \f$ rotation
+
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsQnVectorAlignment, 3);
+  ClassDef(QnCorrectionsQnVectorAlignment, 5);
 /// \endcond
 };
 
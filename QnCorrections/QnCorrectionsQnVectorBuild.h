@@ -16,6 +16,10 @@
 
 #include "QnCorrectionsQnVector.h"
 
+/// The size of the harmonics tables used to build several Q vectors in one go.
+/// It covers the supported harmonics with up to a double harmonic multiplier.
+#define HARMONICSTABLESIZE (2*MAXHARMONICNUMBERSUPPORTED+1)
+
 /// \class QnCorrectionsQnVectorBuild
 /// \brief Class that models and encapsulates a Q vector set while building it
 ///
@@ -42,6 +46,14 @@ public:
 
   void Add(QnCorrectionsQnVectorBuild* qvec);
   void Add(Double_t phi, Double_t weight = 1.0);
+  void Add(const Double_t *cosTable, const Double_t *sinTable, Double_t weight = 1.0);
+
+  /// Gets the highest harmonic, including the harmonic multiplier, the Q vector needs
+  /// \return the highest harmonic times the harmonic multiplier
+  Int_t GetHighestHarmonicMultiple() const { return fHighestHarmonic * fHarmonicMultiplier; }
+  static void FillHarmonicsTable(Double_t phi, Int_t nHighestHarmonic, Double_t *cosTable, Double_t *sinTable);
+  void AddChannels(Int_t nChannels, const Float_t *channelsWeight, Int_t nContributors,
+      const Float_t *channelsCosTable, const Float_t *channelsSinTable);
 
   /// Check the quality of the constructed Qn vector
   /// Current criteria is number of contributors should be at least one.
@@ -73,21 +85,124 @@ private:
 /// Adds a contribution to the build Q vector
 /// A check for weight significant value is made. Not passing it ignores the contribution.
 /// The process of incorporating contributions takes into account the harmonic multiplier
+///
+/// Only the fundamental harmonic is evaluated with trigonometric functions (the
+/// compiler fuses the cosine and sine of the same argument in a single sincos call).
+/// Higher harmonics are obtained by the complex multiplication recurrence
+/// \f$ e^{i(h+1)m\varphi} = e^{ihm\varphi} e^{im\varphi} \f$, with \f$ m \f$ the harmonic
+/// multiplier, so that the cost per contribution is linear in the number of harmonics
+/// instead of requiring two transcendental calls per active harmonic. The recurrence is
+/// run up to the highest harmonic in use and only the harmonics in the mask are accumulated.
+///
+/// The accumulated round-off of the recurrence grows linearly with the harmonic
+/// number. For the highest supported harmonic it stays below 1e-14 per term, several
+/// orders of magnitude below the single precision storage of the Q vector components.
 /// \param phi azimuthal angle contribution
 /// \param weight the weight of the contribution
 inline void QnCorrectionsQnVectorBuild::Add(Double_t phi, Double_t weight) {
 
+  if (weight < fMinimumSignificantValue) return;
+  Double_t cosPhi = TMath::Cos(fHarmonicMultiplier*phi);
+  Double_t sinPhi = TMath::Sin(fHarmonicMultiplier*phi);
+  Double_t cosHPhi = cosPhi;
+  Double_t sinHPhi = sinPhi;
+  for(Int_t h = 1; h < fHighestHarmonic + 1; h++){
+    if ((fHarmonicMask & harmonicNumberMask[h]) == harmonicNumberMask[h]) {
+      fQnX[h] += (weight * cosHPhi);
+      fQnY[h] += (weight * sinHPhi);
+    }
+    /* next harmonic: cos((h+1)x) = cos(hx)cos(x) - sin(hx)sin(x), sin((h+1)x) = sin(hx)cos(x) + cos(hx)sin(x) */
+    Double_t cosNextHPhi = cosHPhi * cosPhi - sinHPhi * sinPhi;
+    sinHPhi = sinHPhi * cosPhi + cosHPhi * sinPhi;
+    cosHPhi = cosNextHPhi;
+  }
+  fSumW += weight;
+  fN += 1;
+}
+
+
+/// Adds a contribution to the build Q vector from its harmonics tables
+///
+/// Allows building several Q vectors, i.e. with different harmonic multipliers
+/// or different weights, out of the same contribution by evaluating its harmonics
+/// only once. The tables should be filled by FillHarmonicsTable up to, at least,
+/// the value returned by GetHighestHarmonicMultiple.
+/// A check for weight significant value is made. Not passing it ignores the contribution.
+/// \param cosTable the table of \f$ \cos(k\varphi) \f$ values for the contribution
+/// \param sinTable the table of \f$ \sin(k\varphi) \f$ values for the contribution
+/// \param weight the weight of the contribution
+inline void QnCorrectionsQnVectorBuild::Add(const Double_t *cosTable, const Double_t *sinTable, Double_t weight) {
+
   if (weight < fMinimumSignificantValue) return;
   for(Int_t h = 1; h < fHighestHarmonic + 1; h++){
     if ((fHarmonicMask & harmonicNumberMask[h]) == harmonicNumberMask[h]) {
-      fQnX[h] += (weight * TMath::Cos(h*fHarmonicMultiplier*phi));
-      fQnY[h] += (weight * TMath::Sin(h*fHarmonicMultiplier*phi));
+      fQnX[h] += (weight * cosTable[h*fHarmonicMultiplier]);
+      fQnY[h] += (weight * sinTable[h*fHarmonicMultiplier]);
     }
   }
   fSumW += weight;
   fN += 1;
 }
 
+/// Fills the harmonics tables for a contribution
+///
+/// The fundamental harmonic is evaluated with trigonometric functions and
+/// the rest by the complex multiplication recurrence, as Add(phi, weight) does.
+/// \param phi azimuthal angle of the contribution
+/// \param nHighestHarmonic the highest harmonic to include in the tables, it should be lower than HARMONICSTABLESIZE
+/// \param cosTable the table to store \f$ \cos(k\varphi) \f$ values
+/// \param sinTable the table to store \f$ \sin(k\varphi) \f$ values
+inline void QnCorrectionsQnVectorBuild::FillHarmonicsTable(Double_t phi, Int_t nHighestHarmonic, Double_t *cosTable, Double_t *sinTable) {
+  Double_t cosPhi = TMath::Cos(phi);
+  Double_t sinPhi = TMath::Sin(phi);
+  cosTable[1] = cosPhi;
+  sinTable[1] = sinPhi;
+  for (Int_t k = 2; k < nHighestHarmonic + 1; k++) {
+    cosTable[k] = cosTable[k-1] * cosPhi - sinTable[k-1] * sinPhi;
+    sinTable[k] = sinTable[k-1] * cosPhi + cosTable[k-1] * sinPhi;
+  }
+}
+
+/// Adds the contributions of a set of channels with fixed azimuthal angles
+///
+/// The harmonics of the channels azimuthal angles are taken from precomputed
+/// tables organized by harmonic, i.e. the value for harmonic k and channel c
+/// is at position \f$ k \times nChannels + c \f$, so that the contribution of
+/// each harmonic is a weighted dot product over the channels.
+/// The tables should cover, at least, up to the value returned by
+/// GetHighestHarmonicMultiple.
+///
+/// The channels weights should be zero for channels without contribution or
+/// with not significant weight.
+/// \param nChannels the number of channels
+/// \param channelsWeight the weight of each channel
+/// \param nContributors the number of channels with significant weight
+/// \param channelsCosTable the table of \f$ \cos(k\varphi_c) \f$ values
+/// \param channelsSinTable the table of \f$ \sin(k\varphi_c) \f$ values
+inline void QnCorrectionsQnVectorBuild::AddChannels(Int_t nChannels, const Float_t *channelsWeight, Int_t nContributors,
+    const Float_t *channelsCosTable, const Float_t *channelsSinTable) {
+
+  Double_t sumW = 0.0;
+  for (Int_t ixChannel = 0; ixChannel < nChannels; ixChannel++) {
+    sumW += channelsWeight[ixChannel];
+  }
+  for(Int_t h = 1; h < fHighestHarmonic + 1; h++){
+    if ((fHarmonicMask & harmonicNumberMask[h]) == harmonicNumberMask[h]) {
+      const Float_t *cosHPhi = channelsCosTable + h * fHarmonicMultiplier * nChannels;
+      const Float_t *sinHPhi = channelsSinTable + h * fHarmonicMultiplier * nChannels;
+      Double_t qx = 0.0;
+      Double_t qy = 0.0;
+      for (Int_t ixChannel = 0; ixChannel < nChannels; ixChannel++) {
+        qx += channelsWeight[ixChannel] * cosHPhi[ixChannel];
+        qy += channelsWeight[ixChannel] * sinHPhi[ixChannel];
+      }
+      fQnX[h] += qx;
+      fQnY[h] += qy;
+    }
+  }
+  fSumW += sumW;
+  fN += nContributors;
+}
 
 /// Calibrates the Q vector according to the method passed
 /// \param method the method of calibration
@@ -0,0 +1,137 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsQnVectorHandle.cxx
+/// \brief Implementation of the resolved once access to a detector configuration Qn vector
+
+#include <TList.h>
+
+#include "QnCorrectionsQnVectorHandle.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsQnVectorHandle);
+/// \endcond
+
+/// Default constructor
+QnCorrectionsQnVectorHandle::QnCorrectionsQnVectorHandle() : TObject(),
+    fDetectorConfigurationName(), fExpectedStep("latest"), fAlternativeStep("latest") {
+  fQnVectorList = NULL;
+  fVersion = -1;
+  fExpectedQnVector = NULL;
+  fAlternativeQnVector = NULL;
+}
+
+/// Normal constructor
+///
+/// The handle is not resolved until its first use.
+/// \param subdetector the name of the detector configuration of interest
+/// \param expectedstep the name of the expected last correction applied
+/// \param altstep the name of the alternative correction step if the expected one is not found
+QnCorrectionsQnVectorHandle::QnCorrectionsQnVectorHandle(const char *subdetector, const char *expectedstep, const char *altstep) : TObject(),
+    fDetectorConfigurationName(subdetector), fExpectedStep(expectedstep), fAlternativeStep(altstep) {
+  fQnVectorList = NULL;
+  fVersion = -1;
+  fExpectedQnVector = NULL;
+  fAlternativeQnVector = NULL;
+}
+
+/// Copy constructor
+/// \param handle the handle to copy
+QnCorrectionsQnVectorHandle::QnCorrectionsQnVectorHandle(const QnCorrectionsQnVectorHandle &handle) : TObject(handle),
+    fDetectorConfigurationName(handle.fDetectorConfigurationName),
+    fExpectedStep(handle.fExpectedStep),
+    fAlternativeStep(handle.fAlternativeStep) {
+  fQnVectorList = handle.fQnVectorList;
+  fVersion = handle.fVersion;
+  fExpectedQnVector = handle.fExpectedQnVector;
+  fAlternativeQnVector = handle.fAlternativeQnVector;
+}
+
+/// Assignment operator
+/// \param handle the handle to assign
+/// \return the assigned handle
+QnCorrectionsQnVectorHandle& QnCorrectionsQnVectorHandle::operator= (const QnCorrectionsQnVectorHandle &handle) {
+  if (this != &handle) {
+    TObject::operator=(handle);
+    fDetectorConfigurationName = handle.fDetectorConfigurationName;
+    fExpectedStep = handle.fExpectedStep;
+    fAlternativeStep = handle.fAlternativeStep;
+    fQnVectorList = handle.fQnVectorList;
+    fVersion = handle.fVersion;
+    fExpectedQnVector = handle.fExpectedQnVector;
+    fAlternativeQnVector = handle.fAlternativeQnVector;
+  }
+  return *this;
+}
+
+/// Default destructor
+QnCorrectionsQnVectorHandle::~QnCorrectionsQnVectorHandle() {
+}
+
+/// Gets the Qn vector of a correction step within a detector configuration Qn vectors list
+///
+/// The first Qn vector in the list is the latest one, which takes the
+/// name of the last applied step, so it is only considered when the
+/// latest Qn vector is asked for.
+/// \param detectorConfigurationList the detector configuration Qn vectors list
+/// \param step the name of the correction step, `latest` for the latest one
+/// \return the Qn vector, NULL if the step is not in the list
+const QnCorrectionsQnVector *QnCorrectionsQnVectorHandle::FindStepQnVector(const TList *detectorConfigurationList, const char *step) {
+  if (TString(step).EqualTo("latest"))
+    return (const QnCorrectionsQnVector *) detectorConfigurationList->First();
+
+  TIter next(detectorConfigurationList);
+  next();
+  const QnCorrectionsQnVector *qnVector;
+  while ((qnVector = (const QnCorrectionsQnVector *) next()) != NULL) {
+    if (TString(qnVector->GetName()).EqualTo(step))
+      return qnVector;
+  }
+  return NULL;
+}
+
+/// Looks up the Qn vectors the handle refers to
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+/// \param version the current structure version of the list
+void QnCorrectionsQnVectorHandle::Resolve(const TList *qnVectorList, Int_t version) {
+  fQnVectorList = qnVectorList;
+  fVersion = version;
+  fExpectedQnVector = NULL;
+  fAlternativeQnVector = NULL;
+
+  if (qnVectorList == NULL) return;
+
+  const TList *detectorConfigurationList = dynamic_cast<const TList *> (qnVectorList->FindObject(fDetectorConfigurationName));
+  if (detectorConfigurationList != NULL) {
+    fExpectedQnVector = FindStepQnVector(detectorConfigurationList, fExpectedStep);
+    fAlternativeQnVector = FindStepQnVector(detectorConfigurationList, fAlternativeStep);
+  }
+}
@@ -0,0 +1,105 @@
+#ifndef QNCORRECTIONS_QNVECTORHANDLE_H
+#define QNCORRECTIONS_QNVECTORHANDLE_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsQnVectorHandle.h
+/// \brief Resolved once access to a detector configuration Qn vector
+
+#include <TObject.h>
+#include <TString.h>
+#include "QnCorrectionsQnVector.h"
+
+class TList;
+
+/// \class QnCorrectionsQnVectorHandle
+/// \brief Keeps the resolved Qn vectors of a detector configuration request
+///
+/// A request for the Qn vector of a detector configuration at an expected
+/// correction step, with an alternative step if the expected one is not
+/// there or has not good quality, involves looking up by name the
+/// configuration and the steps in the Qn vectors list. The handle does it
+/// once and keeps the found Qn vectors so that getting the Qn vector of
+/// each event just checks their quality.
+///
+/// The handle is bound to the Qn vectors list it was resolved on and to
+/// its structure version. If the list is rebuilt, the correction steps
+/// being applied changing with the process for instance, the handle is
+/// resolved again transparently at the next access.
+///
+/// Handles are obtained from QnCorrectionsManager::GetDetectorQnVectorHandle
+/// and used with QnCorrectionsManager::GetDetectorQnVector or
+/// QnCorrectionsEventContext::GetDetectorQnVector.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsQnVectorHandle : public TObject {
+public:
+  QnCorrectionsQnVectorHandle();
+  QnCorrectionsQnVectorHandle(const char *subdetector, const char *expectedstep = "latest", const char *altstep = "latest");
+  QnCorrectionsQnVectorHandle(const QnCorrectionsQnVectorHandle &handle);
+  QnCorrectionsQnVectorHandle& operator= (const QnCorrectionsQnVectorHandle &handle);
+  virtual ~QnCorrectionsQnVectorHandle();
+
+  /// Gets the name of the detector configuration
+  /// \return the detector configuration name
+  const char *GetDetectorConfigurationName() const { return fDetectorConfigurationName.Data(); }
+  /// Checks whether the detector configuration was found at the last resolution
+  /// \return kTRUE if the detector configuration is in the Qn vectors list
+  Bool_t IsValid() const { return (fExpectedQnVector != NULL) || (fAlternativeQnVector != NULL); }
+
+  const QnCorrectionsQnVector *GetQnVector(const TList *qnVectorList, Int_t version);
+  void Resolve(const TList *qnVectorList, Int_t version);
+
+  static const QnCorrectionsQnVector *FindStepQnVector(const TList *detectorConfigurationList, const char *step);
+
+private:
+
+  TString fDetectorConfigurationName;                 ///< the name of the detector configuration
+  TString fExpectedStep;                              ///< the name of the expected correction step
+  TString fAlternativeStep;                           ///< the name of the alternative correction step
+  const TList *fQnVectorList;                         //!<! the Qn vectors list the handle was resolved on
+  Int_t fVersion;                                     //!<! the structure version of the list at resolution
+  const QnCorrectionsQnVector *fExpectedQnVector;     //!<! the Qn vector of the expected step, not owned
+  const QnCorrectionsQnVector *fAlternativeQnVector;  //!<! the Qn vector of the alternative step, not owned
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsQnVectorHandle, 1);
+/// \endcond
+};
+
+/// Gets the Qn vector the handle refers to for the current event
+///
+/// The handle is resolved again if the Qn vectors list is not the one
+/// it was resolved on or its structure changed. Otherwise the expected
+/// step Qn vector is returned if it has good quality and was built from
+/// some data, the alternative one if that is the case for it, NULL
+/// otherwise.
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+/// \param version the current structure version of the list
+/// \return the Qn vector, NULL if none with good quality
+inline const QnCorrectionsQnVector *QnCorrectionsQnVectorHandle::GetQnVector(const TList *qnVectorList, Int_t version) {
+  if ((qnVectorList != fQnVectorList) || (version != fVersion))
+    Resolve(qnVectorList, version);
+
+  const QnCorrectionsQnVector *theQnVector = fExpectedQnVector;
+  if (theQnVector == NULL || !(theQnVector->IsGoodQuality()) || !(theQnVector->GetN() != 0))
+    theQnVector = fAlternativeQnVector;
+  if (theQnVector != NULL) {
+    if (!(theQnVector->IsGoodQuality()) || !(theQnVector->GetN() != 0))
+      theQnVector = NULL;
+  }
+  return theQnVector;
+}
+
+#endif /* QNCORRECTIONS_QNVECTORHANDLE_H */
@@ -60,6 +60,7 @@ QnCorrectionsQnVectorRecentering::QnCorrectionsQnVectorRecentering() :
   fQAQnAverageHistogram = NULL;
   fApplyWidthEqualization = kFALSE;
   fMinNoOfEntriesToValidate = fDefaultMinNoOfEntries;
+  fParametersTable = NULL;
 }
 
 /// Default destructor
@@ -73,6 +74,7 @@ QnCorrectionsQnVectorRecentering::~QnCorrectionsQnVectorRecentering() {
     delete fQANotValidatedBin;
   if (fQAQnAverageHistogram != NULL)
     delete fQAQnAverageHistogram;
+  ReleaseParametersTable();
 }
 
 /// Asks for support data structures creation
@@ -106,11 +108,11 @@ Bool_t QnCorrectionsQnVectorRecentering::CreateSupportHistograms(TList *list) {
       fDetectorConfiguration->GetName());
 
   if (fInputHistograms != NULL) delete fInputHistograms;
-  fInputHistograms = new QnCorrectionsProfileComponents((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
-      fDetectorConfiguration->GetEventClassVariablesSet(), "s");
-  fInputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  fInputHistograms = NewInputHistograms();
+  fInputHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fCalibrationHistograms = new QnCorrectionsProfileComponents((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
       fDetectorConfiguration->GetEventClassVariablesSet(), "s");
+  fCalibrationHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
 
   /* get information about the configured harmonics to pass it for histogram creation */
   Int_t nNoOfHarmonics = fDetectorConfiguration->GetNoOfHarmonics();
@@ -128,12 +130,115 @@ Bool_t QnCorrectionsQnVectorRecentering::AttachInput(TList *list) {
 
   if (fInputHistograms->AttachHistograms(list)) {
     QnCorrectionsInfo(Form("Recentering on %s going to be applied", fDetectorConfiguration->GetName()));
+    ReleaseParametersTable();
+    fParametersTable = BuildParametersTable(list, fInputHistograms);
     fState = QCORRSTEP_applyCollect;
     return kTRUE;
   }
   return kFALSE;
 }
 
+/// Prepares in advance the input information of a calibration list
+///
+/// The correction parameters table is built out of private input
+/// histograms and published. A reference to it is held so that
+/// AttachInput for the same list finds it already built.
+/// \param list list where the inputs should be found
+/// \return kTRUE if the correction parameters table is available
+Bool_t QnCorrectionsQnVectorRecentering::PrepareInput(TList *list) {
+
+  const QnCorrectionsCalibrationSnapshot *table = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (table == NULL) {
+    QnCorrectionsProfileComponents *inputHistograms = NewInputHistograms();
+    if (inputHistograms->AttachHistograms(list))
+      table = BuildParametersTable(list, inputHistograms);
+    delete inputHistograms;
+  }
+  if (table == NULL) return kFALSE;
+  HoldPreparedInput(table);
+  return kTRUE;
+}
+
+/// Creates the input histograms of the correction step
+///
+/// Their event class bins are not set, so the caller should
+/// set them if the histograms are going to be used for event processing.
+/// \return the new input histograms
+QnCorrectionsProfileComponents *QnCorrectionsQnVectorRecentering::NewInputHistograms() const {
+
+  TString histoNameAndTitle = Form("%s %s ",
+      szSupportHistogramName,
+      fDetectorConfiguration->GetName());
+
+  QnCorrectionsProfileComponents *inputHistograms =
+      new QnCorrectionsProfileComponents((const char *) histoNameAndTitle, (const char *) histoNameAndTitle,
+          fDetectorConfiguration->GetEventClassVariablesSet(), "s");
+  inputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  return inputHistograms;
+}
+
+/// Builds the correction parameters table out of the input histograms
+///
+/// For each event class bin the validation flag is stored together with,
+/// for each configured harmonic, the Qn components averages and the widths
+/// to apply. Widths are set to one if width equalization is not requested.
+/// The table is addressed by the histograms bin number and the harmonic
+/// number so, the correction apply only needs a table lookup.
+///
+/// The table is shared with any other instance of the correction step
+/// attached to the same calibration list so, it is only built if none
+/// of them has already published it.
+/// \param list the list the inputs were found in
+/// \param inputHistograms the input histograms attached to the list
+/// \return the correction parameters table with a reference taken
+const QnCorrectionsCalibrationSnapshot *QnCorrectionsQnVectorRecentering::BuildParametersTable(TList *list,
+    QnCorrectionsProfileComponents *inputHistograms) {
+
+  const QnCorrectionsCalibrationSnapshot *published = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (published != NULL) return published;
+
+  Int_t nNoOfHarmonics = fDetectorConfiguration->GetNoOfHarmonics();
+  Int_t *harmonicsMap = new Int_t[nNoOfHarmonics];
+  fDetectorConfiguration->GetHarmonicMap(harmonicsMap);
+  Int_t nNoOfSlots = 0;
+  for (Int_t h = 0; h < nNoOfHarmonics; h++) {
+    if (nNoOfSlots < harmonicsMap[h] + 1) nNoOfSlots = harmonicsMap[h] + 1;
+  }
+
+  QnCorrectionsCalibrationSnapshot *table =
+      new QnCorrectionsCalibrationSnapshot(list, GetName(), inputHistograms->GetNoOfBins(), nNoOfSlots, 4);
+
+  for (Long64_t bin = 0; bin < table->GetNoOfBins(); bin++) {
+    table->SetBinValidated(bin, inputHistograms->BinContentValidated(bin));
+    Float_t *parameters = table->GetParametersToBuild(bin);
+    for (Int_t slot = 0; slot < nNoOfSlots * 4; slot += 4) {
+      parameters[slot + 0] = 0.0;
+      parameters[slot + 1] = 0.0;
+      parameters[slot + 2] = 1.0;
+      parameters[slot + 3] = 1.0;
+    }
+    if (table->IsBinValidated(bin)) {
+      for (Int_t h = 0; h < nNoOfHarmonics; h++) {
+        Float_t *harmonicParameters = parameters + harmonicsMap[h] * 4;
+        harmonicParameters[0] = inputHistograms->GetXBinContent(harmonicsMap[h], bin);
+        harmonicParameters[1] = inputHistograms->GetYBinContent(harmonicsMap[h], bin);
+        if (fApplyWidthEqualization) {
+          harmonicParameters[2] = inputHistograms->GetXBinError(harmonicsMap[h], bin);
+          harmonicParameters[3] = inputHistograms->GetYBinError(harmonicsMap[h], bin);
+        }
+      }
+    }
+  }
+  delete [] harmonicsMap;
+  return QnCorrectionsCalibrationSnapshot::Publish(table);
+}
+
+/// Releases the reference to the correction parameters table
+void QnCorrectionsQnVectorRecentering::ReleaseParametersTable() {
+  QnCorrectionsCalibrationSnapshot::Release(fParametersTable);
+  fParametersTable = NULL;
+}
+
 /// Asks for QA histograms creation
 ///
 /// Allocates the histogram objects and creates the QA histograms.
@@ -145,6 +250,7 @@ Bool_t QnCorrectionsQnVectorRecentering::CreateQAHistograms(TList *list) {
       Form("%s %s", szQAQnAverageHistogramName, fDetectorConfiguration->GetName()),
       Form("%s %s", szQAQnAverageHistogramName, fDetectorConfiguration->GetName()),
       fDetectorConfiguration->GetEventClassVariablesSet());
+  fQAQnAverageHistogram->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
 
   /* get information about the configured harmonics to pass it for histogram creation */
   Int_t nNoOfHarmonics = fDetectorConfiguration->GetNoOfHarmonics();
@@ -166,6 +272,7 @@ Bool_t QnCorrectionsQnVectorRecentering::CreateNveQAHistograms(TList *list) {
       Form("%s %s", szQANotValidatedHistogramName, fDetectorConfiguration->GetName()),
       Form("%s %s", szQANotValidatedHistogramName, fDetectorConfiguration->GetName()),
       fDetectorConfiguration->GetEventClassVariablesSet());
+  fQANotValidatedBin->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   fQANotValidatedBin->CreateHistogram(list);
   return kTRUE;
 }
@@ -186,33 +293,31 @@ Bool_t QnCorrectionsQnVectorRecentering::ProcessCorrections(const Float_t *varia
     /* collect the data needed to further produce correction parameters if the current Qn vector is good enough */
     /* and proceed to ... */
   case QCORRSTEP_apply: /* apply the correction if the current Qn vector is good enough */
-    QnCorrectionsInfo(Form("Recentering process in detector %s: applying correction.", fDetectorConfiguration->GetName()));
+    QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Recentering process in detector %s: applying correction.", fDetectorConfiguration->GetName()));
     if (fDetectorConfiguration->GetCurrentQnVector()->IsGoodQuality()) {
       /* we get the properties of the current Qn vector but its name */
       fCorrectedQnVector->Set(fDetectorConfiguration->GetCurrentQnVector(),kFALSE);
       harmonic = fDetectorConfiguration->GetCurrentQnVector()->GetFirstHarmonic();
 
-      /* let's check the correction histograms */
+      /* let's check the correction parameters table */
       Long64_t bin = fInputHistograms->GetBin(variableContainer);
-      if (fInputHistograms->BinContentValidated(bin)) {
+      if (fParametersTable->IsBinValidated(bin)) {
         /* correction information validated */
+        QnCorrectionsInstrumentBin(fCorrectionsCounters, kTRUE);
+        const Float_t *parameters = fParametersTable->GetParameters(bin);
         while (harmonic != -1) {
-          Float_t widthX = 1.0;
-          Float_t widthY = 1.0;
-          if (fApplyWidthEqualization) {
-            widthX = fInputHistograms->GetXBinError(harmonic, bin);
-            widthY = fInputHistograms->GetYBinError(harmonic, bin);
-          }
+          const Float_t *harmonicParameters = parameters + harmonic * 4;
           fCorrectedQnVector->SetQx(harmonic, (fDetectorConfiguration->GetCurrentQnVector()->Qx(harmonic)
-              - fInputHistograms->GetXBinContent(harmonic, bin))
-              / widthX);
+              - harmonicParameters[0])
+              / harmonicParameters[2]);
           fCorrectedQnVector->SetQy(harmonic, (fDetectorConfiguration->GetCurrentQnVector()->Qy(harmonic)
-              - fInputHistograms->GetYBinContent(harmonic, bin))
-              / widthY);
+              - harmonicParameters[1])
+              / harmonicParameters[3]);
           harmonic = fDetectorConfiguration->GetCurrentQnVector()->GetNextHarmonic(harmonic);
         }
       } /* correction information not validated, we leave the Q vector untouched */
       else {
+        QnCorrectionsInstrumentBin(fCorrectionsCounters, kFALSE);
         if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, 1.0);
       }
     }
@@ -239,7 +344,7 @@ Bool_t QnCorrectionsQnVectorRecentering::ProcessDataCollection(const Float_t *va
   Int_t harmonic;
   switch (fState) {
   case QCORRSTEP_calibration:
-    QnCorrectionsInfo(Form("Recentering process in detector %s: collecting data.", fDetectorConfiguration->GetName()));
+    QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Recentering process in detector %s: collecting data.", fDetectorConfiguration->GetName()));
     /* collect the data needed to further produce correction parameters if the current Qn vector is good enough */
     if (fInputQnVector->IsGoodQuality()) {
       harmonic = fInputQnVector->GetFirstHarmonic();
@@ -253,7 +358,7 @@ Bool_t QnCorrectionsQnVectorRecentering::ProcessDataCollection(const Float_t *va
     return kFALSE;
     break;
   case QCORRSTEP_applyCollect:
-    QnCorrectionsInfo(Form("Recentering process in detector %s: collecting data.", fDetectorConfiguration->GetName()));
+    QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Recentering process in detector %s: collecting data.", fDetectorConfiguration->GetName()));
     /* collect the data needed to further produce correction parameters if the current Qn vector is good enough */
     if (fInputQnVector->IsGoodQuality()) {
       harmonic = fInputQnVector->GetFirstHarmonic();
@@ -341,3 +446,11 @@ Bool_t QnCorrectionsQnVectorRecentering::ReportUsage(TList *calibrationList, TLi
   return kTRUE;
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+void QnCorrectionsQnVectorRecentering::FlushHistograms() {
+  if (fCalibrationHistograms != NULL)
+    fCalibrationHistograms->FlushAccumulator();
+  if (fQAQnAverageHistogram != NULL)
+    fQAQnAverageHistogram->FlushAccumulator();
+}
+
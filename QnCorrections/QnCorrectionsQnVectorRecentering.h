@@ -52,6 +52,7 @@
 /// defined within the involved detector configuration
 
 #include "QnCorrectionsCorrectionOnQvector.h"
+#include "QnCorrectionsCalibrationSnapshot.h"
 
 /// \class QnCorrectionsQnVectorRecentering
 /// \brief Encapsulates recentering and width equalization on Q vector
@@ -118,6 +119,7 @@ public:
   /// No action for Qn vector recentering
   virtual void AttachedToFrameworkManager() {}
   virtual Bool_t AttachInput(TList *list);
+  virtual Bool_t PrepareInput(TList *list);
   /// Perform after calibration histograms attach actions
   /// It is used to inform the different correction step that
   /// all conditions for running the network are in place so
@@ -133,10 +135,15 @@ public:
   virtual Bool_t ProcessCorrections(const Float_t *variableContainer);
   virtual Bool_t ProcessDataCollection(const Float_t *variableContainer);
   virtual void ClearCorrectionStep();
+  virtual void FlushHistograms();
   virtual Bool_t IsBeingApplied() const;
   virtual Bool_t ReportUsage(TList *calibrationList, TList *applyList);
 
 private:
+  QnCorrectionsProfileComponents *NewInputHistograms() const;
+  const QnCorrectionsCalibrationSnapshot *BuildParametersTable(TList *list, QnCorrectionsProfileComponents *inputHistograms);
+  void ReleaseParametersTable();
+
   static const Int_t fDefaultMinNoOfEntries;         ///< the minimum number of entries for bin content validation
   static const char *szCorrectionName;               ///< the name of the correction step
   static const char *szKey;                          ///< the key of the correction step for ordering purpose
@@ -152,8 +159,10 @@ private:
   Bool_t fApplyWidthEqualization;              ///< apply the width equalization step
   Int_t fMinNoOfEntriesToValidate;              ///< number of entries for bin content validation threshold
 
+  const QnCorrectionsCalibrationSnapshot *fParametersTable; //!<! shared, per bin and harmonic the \f$ \langle Q_x \rangle, \langle Q_y \rangle, \sigma_{Q_x}, \sigma_{Q_y} \f$ values
+
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsQnVectorRecentering, 3);
+  ClassDef(QnCorrectionsQnVectorRecentering, 5);
 /// \endcond
 };
 
@@ -0,0 +1,374 @@
+/**************************************************************************************************
+ *                                                                                                *
+ * Package:       FlowVectorCorrections                                                           *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch                              *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com                             *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch                                   *
+ *                Contributors are mentioned in the code where appropriate.                       *
+ * Development:   2012-2016                                                                       *
+ *                                                                                                *
+ * This file is part of FlowVectorCorrections, a software package that corrects Q-vector          *
+ * measurements for effects of nonuniform detector acceptance. The corrections in this package    *
+ * are based on publication:                                                                      *
+ *                                                                                                *
+ *  [1] "Effects of non-uniform acceptance in anisotropic flow measurements"                      *
+ *  Ilya Selyuzhenkov and Sergei Voloshin                                                         *
+ *  Phys. Rev. C 77, 034904 (2008)                                                                *
+ *                                                                                                *
+ * The procedure proposed in [1] is extended with the following steps:                            *
+ * (*) alignment correction between subevents                                                     *
+ * (*) possibility to extract the twist and rescaling corrections                                 *
+ *      for the case of three detector subevents                                                  *
+ *      (currently limited to the case of two “hit-only” and one “tracking” detectors)            *
+ * (*) (optional) channel equalization                                                            *
+ * (*) flow vector width equalization                                                             *
+ *                                                                                                *
+ * FlowVectorCorrections is distributed under the terms of the GNU General Public License (GPL)   *
+ * (https://en.wikipedia.org/wiki/GNU_General_Public_License)                                     *
+ * either version 3 of the License, or (at your option) any later version.                        *
+ *                                                                                                *
+ **************************************************************************************************/
+
+/// \file QnCorrectionsQnVectorTreeWriter.cxx
+/// \brief Implementation of the asynchronous Qn vectors tree filling
+
+#include <TList.h>
+#include <TTree.h>
+#include <TThread.h>
+#include <TMutex.h>
+#include <TCondition.h>
+#include <cctype>
+#include <cstring>
+
+#include "QnCorrectionsQnVector.h"
+#include "QnCorrectionsQnVectorHandle.h"
+#include "QnCorrectionsQnVectorTreeWriter.h"
+#include "QnCorrectionsLog.h"
+
+/// \cond CLASSIMP
+ClassImp(QnCorrectionsQnVectorTreeWriter);
+/// \endcond
+
+const Int_t QnCorrectionsQnVectorTreeWriter::nDefaultQueueDepth = 1024;
+
+/// Builds a branch name only with alphanumeric characters and underscores
+/// \param configuration the detector configuration name
+/// \param step the Qn vector step name
+/// \param quantity the stored quantity
+/// \return the branch name
+static TString BuildBranchName(const char *configuration, const char *step, const char *quantity) {
+  TString name = Form("%s_%s_%s", configuration, step, quantity);
+  for (Int_t ixChar = 0; ixChar < name.Length(); ixChar++) {
+    if (!isalnum(name[ixChar])) name[ixChar] = '_';
+  }
+  return name;
+}
+
+/// Default constructor
+QnCorrectionsQnVectorTreeWriter::QnCorrectionsQnVectorTreeWriter() : TObject(),
+    fVectorConfiguration(), fVectorStep(), fResolvedList(), fResolvedVersion(), fResolvedVector() {
+  fTree = NULL;
+  fQueueDepth = nDefaultQueueDepth;
+  fNoOfConfigurations = 0;
+  fNoOfVectors = 0;
+  fVectorFirstHarmonic = NULL;
+  fHarmonic = NULL;
+  fRecordSize = 0;
+  fQueue = NULL;
+  fBranchesBuffer = NULL;
+  fQueueHead = 0;
+  fQueueTail = 0;
+  fNoOfQueued = 0;
+  fStopWriter = kFALSE;
+  fWriterThread = NULL;
+  fMutex = NULL;
+  fDataCondition = NULL;
+  fSpaceCondition = NULL;
+}
+
+/// Normal constructor
+///
+/// The branches are created at the first event.
+/// \param tree the tree to fill, not owned
+/// \param nQueueDepth the number of events the queue can hold
+QnCorrectionsQnVectorTreeWriter::QnCorrectionsQnVectorTreeWriter(TTree *tree, Int_t nQueueDepth) : TObject(),
+    fVectorConfiguration(), fVectorStep(), fResolvedList(), fResolvedVersion(), fResolvedVector() {
+  fTree = tree;
+  fQueueDepth = (nQueueDepth < 1) ? 1 : nQueueDepth;
+  fNoOfConfigurations = 0;
+  fNoOfVectors = 0;
+  fVectorFirstHarmonic = NULL;
+  fHarmonic = NULL;
+  fRecordSize = 0;
+  fQueue = NULL;
+  fBranchesBuffer = NULL;
+  fQueueHead = 0;
+  fQueueTail = 0;
+  fNoOfQueued = 0;
+  fStopWriter = kFALSE;
+  fWriterThread = NULL;
+  fMutex = new TMutex();
+  fDataCondition = new TCondition(fMutex);
+  fSpaceCondition = new TCondition(fMutex);
+}
+
+/// Default destructor
+///
+/// The writer thread, if still running, fills the queued events before
+/// being released.
+QnCorrectionsQnVectorTreeWriter::~QnCorrectionsQnVectorTreeWriter() {
+  if (fWriterThread != NULL) Stop();
+  if (fSpaceCondition != NULL) delete fSpaceCondition;
+  if (fDataCondition != NULL) delete fDataCondition;
+  if (fMutex != NULL) delete fMutex;
+  if (fVectorFirstHarmonic != NULL) delete [] fVectorFirstHarmonic;
+  if (fHarmonic != NULL) delete [] fHarmonic;
+  if (fQueue != NULL) delete [] fQueue;
+  if (fBranchesBuffer != NULL) delete [] fBranchesBuffer;
+}
+
+/// Starts the writer thread
+///
+/// ROOT must support threads. TThread::Initialize is invoked. If the
+/// writer thread is not started the tree is filled within Fill.
+void QnCorrectionsQnVectorTreeWriter::Start() {
+  if (fWriterThread != NULL || fTree == NULL) return;
+
+  TThread::Initialize();
+  fStopWriter = kFALSE;
+  fWriterThread = new TThread("QnCorrectionsQnVectorTreeWriter",
+      (TThread::VoidRtnFunc_t) &WriterLoop, (void *) this);
+  fWriterThread->Run();
+}
+
+/// Stops the writer thread once all the queued events are filled
+///
+/// The tree branches are detached from the writer buffers so the tree
+/// can be used on its own afterwards. No more events are accepted.
+void QnCorrectionsQnVectorTreeWriter::Stop() {
+  fMutex->Lock();
+  fStopWriter = kTRUE;
+  fDataCondition->Broadcast();
+  fMutex->UnLock();
+  if (fWriterThread != NULL) {
+    fWriterThread->Join();
+    delete fWriterThread;
+    fWriterThread = NULL;
+  }
+  if (fTree != NULL && fBranchesBuffer != NULL)
+    fTree->ResetBranchAddresses();
+}
+
+/// Builds the tree branches out of the Qn vectors list structure
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+void QnCorrectionsQnVectorTreeWriter::BuildLayout(const TList *qnVectorList) {
+  /* first the sizes */
+  fNoOfConfigurations = 0;
+  Int_t nVectors = 0;
+  Int_t nHarmonics = 0;
+  TIter nextConfiguration(qnVectorList);
+  TList *configurationList;
+  while ((configurationList = (TList *) nextConfiguration()) != NULL) {
+    fNoOfConfigurations++;
+    TIter nextVector(configurationList);
+    QnCorrectionsQnVector *qnVector;
+    while ((qnVector = (QnCorrectionsQnVector *) nextVector()) != NULL) {
+      nVectors++;
+      nHarmonics += qnVector->GetNoOfHarmonics();
+    }
+  }
+  fNoOfVectors = nVectors;
+  fVectorFirstHarmonic = new Int_t[nVectors + 1];
+  fHarmonic = new Int_t[(nHarmonics > 0) ? nHarmonics : 1];
+  fRecordSize = 2 * nHarmonics + 3 * nVectors;
+  fQueue = new Float_t[fQueueDepth * ((fRecordSize > 0) ? fRecordSize : 1)];
+  fBranchesBuffer = new Float_t[(fRecordSize > 0) ? fRecordSize : 1];
+
+  /* now the branches */
+  Int_t ixVector = 0;
+  Int_t ixHarmonic = 0;
+  Int_t ixValue = 0;
+  nextConfiguration.Reset();
+  while ((configurationList = (TList *) nextConfiguration()) != NULL) {
+    TIter nextVector(configurationList);
+    QnCorrectionsQnVector *qnVector;
+    Bool_t latest = kTRUE;
+    while ((qnVector = (QnCorrectionsQnVector *) nextVector()) != NULL) {
+      /* the first one is the latest Qn vector which changes its name */
+      const char *step = latest ? "latest" : qnVector->GetName();
+      latest = kFALSE;
+      fVectorConfiguration.push_back(TString(configurationList->GetName()));
+      fVectorStep.push_back(TString(step));
+      fVectorFirstHarmonic[ixVector] = ixHarmonic;
+      Int_t harmonic = qnVector->GetFirstHarmonic();
+      while (harmonic != -1) {
+        fHarmonic[ixHarmonic++] = harmonic;
+        TString name = BuildBranchName(configurationList->GetName(), step, Form("Qx%d", harmonic));
+        fTree->Branch(name, &fBranchesBuffer[ixValue++], Form("%s/F", name.Data()));
+        name = BuildBranchName(configurationList->GetName(), step, Form("Qy%d", harmonic));
+        fTree->Branch(name, &fBranchesBuffer[ixValue++], Form("%s/F", name.Data()));
+        harmonic = qnVector->GetNextHarmonic(harmonic);
+      }
+      TString name = BuildBranchName(configurationList->GetName(), step, "N");
+      fTree->Branch(name, &fBranchesBuffer[ixValue++], Form("%s/F", name.Data()));
+      name = BuildBranchName(configurationList->GetName(), step, "SumW");
+      fTree->Branch(name, &fBranchesBuffer[ixValue++], Form("%s/F", name.Data()));
+      name = BuildBranchName(configurationList->GetName(), step, "quality");
+      fTree->Branch(name, &fBranchesBuffer[ixValue++], Form("%s/F", name.Data()));
+      ixVector++;
+    }
+  }
+  fVectorFirstHarmonic[nVectors] = ixHarmonic;
+  QnCorrectionsInfo(Form("Qn vectors tree with %d branches for %d detector configurations",
+      fRecordSize, fNoOfConfigurations));
+}
+
+/// Gets the resolution of the layout Qn vectors on a Qn vectors list
+///
+/// The layout is resolved again on the list if it was not resolved on
+/// it before or if the list structure changed since then.
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+/// \param version the current structure version of the list
+/// \return the slot of the resolution
+Int_t QnCorrectionsQnVectorTreeWriter::GetResolution(const TList *qnVectorList, Int_t version) {
+  Int_t slot = 0;
+  while (slot < Int_t(fResolvedList.size()) && fResolvedList[slot] != qnVectorList) slot++;
+  if (slot == Int_t(fResolvedList.size())) {
+    fResolvedList.push_back(qnVectorList);
+    fResolvedVersion.push_back(version);
+    fResolvedVector.resize(fResolvedList.size() * fNoOfVectors, NULL);
+    Resolve(qnVectorList, slot);
+  }
+  else if (fResolvedVersion[slot] != version) {
+    fResolvedVersion[slot] = version;
+    Resolve(qnVectorList, slot);
+  }
+  return slot;
+}
+
+/// Finds the source Qn vector of each layout Qn vector within a Qn vectors list
+///
+/// The layout Qn vectors not found in the list and the Qn vectors in
+/// the list not present in the layout are reported.
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+/// \param slot the slot where the resolution is stored
+void QnCorrectionsQnVectorTreeWriter::Resolve(const TList *qnVectorList, Int_t slot) {
+  const QnCorrectionsQnVector **source = &fResolvedVector[slot * fNoOfVectors];
+  Int_t nMissing = 0;
+  for (Int_t ixVector = 0; ixVector < fNoOfVectors; ixVector++) {
+    const TList *configurationList = (const TList *) qnVectorList->FindObject(fVectorConfiguration[ixVector]);
+    source[ixVector] = (configurationList != NULL)
+        ? QnCorrectionsQnVectorHandle::FindStepQnVector(configurationList, fVectorStep[ixVector]) : NULL;
+    if (source[ixVector] == NULL) nMissing++;
+  }
+
+  Int_t nNotStored = 0;
+  TIter nextConfiguration(qnVectorList);
+  TList *configurationList;
+  while ((configurationList = (TList *) nextConfiguration()) != NULL) {
+    TIter nextVector(configurationList);
+    QnCorrectionsQnVector *qnVector;
+    Bool_t latest = kTRUE;
+    while ((qnVector = (QnCorrectionsQnVector *) nextVector()) != NULL) {
+      const char *step = latest ? "latest" : qnVector->GetName();
+      latest = kFALSE;
+      Bool_t found = kFALSE;
+      for (Int_t ixVector = 0; ixVector < fNoOfVectors && !found; ixVector++) {
+        found = fVectorConfiguration[ixVector].EqualTo(configurationList->GetName()) && fVectorStep[ixVector].EqualTo(step);
+      }
+      if (!found) {
+        QnCorrectionsWarning(Form("Qn vector %s of detector configuration %s is not in the Qn vectors tree layout. Not stored.",
+            step, configurationList->GetName()));
+        nNotStored++;
+      }
+    }
+  }
+  if (nMissing != 0)
+    QnCorrectionsWarning(Form("%d Qn vectors of the Qn vectors tree layout are not available. Stored with quality -1.", nMissing));
+  QnCorrectionsInfo(Form("Qn vectors tree layout resolved: %d Qn vectors missing, %d not stored", nMissing, nNotStored));
+}
+
+/// Queues the current event Qn vectors for being filled into the tree
+///
+/// Only the values are copied; if the queue is full the call waits
+/// for the writer thread to free a slot. The Qn vectors of the branches
+/// layout missing in the list are stored with zero values and a quality
+/// of -1.
+/// \param qnVectorList the list of detector configurations Qn vectors lists
+/// \param version the current structure version of the list
+void QnCorrectionsQnVectorTreeWriter::Fill(const TList *qnVectorList, Int_t version) {
+  if (fTree == NULL || qnVectorList == NULL) return;
+
+  fMutex->Lock();
+  if (fStopWriter) {
+    fMutex->UnLock();
+    return;
+  }
+  if (fVectorFirstHarmonic == NULL)
+    BuildLayout(qnVectorList);
+  Int_t slot = GetResolution(qnVectorList, version);
+  while (!(fNoOfQueued < fQueueDepth)) {
+    fSpaceCondition->Wait();
+  }
+
+  Float_t *record = (fWriterThread != NULL) ? &fQueue[fQueueHead * fRecordSize] : fBranchesBuffer;
+  const QnCorrectionsQnVector **source = &fResolvedVector[slot * fNoOfVectors];
+  Int_t ixValue = 0;
+  for (Int_t ixVector = 0; ixVector < fNoOfVectors; ixVector++) {
+    const QnCorrectionsQnVector *qnVector = source[ixVector];
+    if (qnVector != NULL) {
+      for (Int_t ixHarmonic = fVectorFirstHarmonic[ixVector]; ixHarmonic < fVectorFirstHarmonic[ixVector + 1]; ixHarmonic++) {
+        record[ixValue++] = qnVector->Qx(fHarmonic[ixHarmonic]);
+        record[ixValue++] = qnVector->Qy(fHarmonic[ixHarmonic]);
+      }
+      record[ixValue++] = qnVector->GetN();
+      record[ixValue++] = qnVector->GetSumOfWeights();
+      record[ixValue++] = (qnVector->IsGoodQuality() ? 1.0 : 0.0);
+    }
+    else {
+      /* not available: zero values and an invalid quality */
+      Int_t nValues = 2 * (fVectorFirstHarmonic[ixVector + 1] - fVectorFirstHarmonic[ixVector]) + 2;
+      for (Int_t i = 0; i < nValues; i++) record[ixValue++] = 0.0;
+      record[ixValue++] = -1.0;
+    }
+  }
+
+  if (fWriterThread != NULL) {
+    fQueueHead = (fQueueHead + 1) % fQueueDepth;
+    fNoOfQueued++;
+    fDataCondition->Signal();
+  }
+  else {
+    fTree->Fill();
+  }
+  fMutex->UnLock();
+}
+
+/// The writer thread body
+///
+/// Fills the queued events into the tree until asked to stop and the
+/// queue is empty.
+/// \param writer the tree writer the thread belongs to
+/// \return NULL
+void *QnCorrectionsQnVectorTreeWriter::WriterLoop(void *writer) {
+  QnCorrectionsQnVectorTreeWriter *theWriter = (QnCorrectionsQnVectorTreeWriter *) writer;
+
+  theWriter->fMutex->Lock();
+  while (kTRUE) {
+    while (!theWriter->fStopWriter && (theWriter->fNoOfQueued == 0)) {
+      theWriter->fDataCondition->Wait();
+    }
+    if (theWriter->fNoOfQueued == 0) break;
+    memcpy(theWriter->fBranchesBuffer, &theWriter->fQueue[theWriter->fQueueTail * theWriter->fRecordSize],
+        theWriter->fRecordSize * sizeof(Float_t));
+    theWriter->fQueueTail = (theWriter->fQueueTail + 1) % theWriter->fQueueDepth;
+    theWriter->fNoOfQueued--;
+    theWriter->fSpaceCondition->Broadcast();
+    theWriter->fMutex->UnLock();
+    /* the filling, with its compression and output, out of the lock */
+    theWriter->fTree->Fill();
+    theWriter->fMutex->Lock();
+  }
+  theWriter->fMutex->UnLock();
+  return NULL;
+}
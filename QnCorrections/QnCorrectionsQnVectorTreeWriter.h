@@ -0,0 +1,121 @@
+#ifndef QNCORRECTIONS_QNVECTORTREEWRITER_H
+#define QNCORRECTIONS_QNVECTORTREEWRITER_H
+
+/***************************************************************************
+ * Package:       FlowVectorCorrections                                    *
+ * Authors:       Jaap Onderwaater, GSI, jacobus.onderwaater@cern.ch       *
+ *                Ilya Selyuzhenkov, GSI, ilya.selyuzhenkov@gmail.com      *
+ *                Víctor González, UCM, victor.gonzalez@cern.ch            *
+ *                Contributors are mentioned in the code where appropriate.*
+ * Development:   2012-2016                                                *
+ * See cxx source for GPL licence et. al.                                  *
+ ***************************************************************************/
+
+/// \file QnCorrectionsQnVectorTreeWriter.h
+/// \brief Asynchronous filling of the Qn vectors tree
+
+#include <TObject.h>
+#include <TString.h>
+#include <vector>
+
+class TList;
+class TTree;
+class TThread;
+class TMutex;
+class TCondition;
+class QnCorrectionsQnVector;
+
+/// \class QnCorrectionsQnVectorTreeWriter
+/// \brief Fills a tree with the event Qn vectors on a background thread
+///
+/// The tree has flat float branches. For each detector configuration,
+/// each of its Qn vectors, the latest one and the one of each correction
+/// step, and each of its harmonics there are the Qx and Qy branches plus,
+/// per Qn vector, the N, SumW and quality ones. The branch names are
+/// built as `<configuration>_<step>_Qx<h>`, `<configuration>_<step>_N`,
+/// etc., where `<step>` is `latest` for the latest Qn vector.
+///
+/// The branches layout is taken from the Qn vectors list at the first
+/// event, so that the late attached correction steps are already there.
+/// The source Qn vector of each branch is then found by detector
+/// configuration and step names, once per Qn vectors list and structure
+/// version, so that filling from different managers with the same
+/// configuration, or after the list is rebuilt because the applied
+/// correction steps changed, keeps each value in its branch. Qn vectors
+/// of the layout not present in the list are stored with zero values
+/// and a quality of -1, while the ones in the list not present in the
+/// layout are reported and not stored.
+///
+/// Fill only copies the Qn vectors values into a slot of a bounded
+/// queue. The tree filling, with its compression and output, runs on
+/// the writer thread. Only if the queue gets full, the writer not being
+/// able to keep up, Fill waits for a free slot. Fill is protected so it
+/// can be called from several threads; events are stored in the order
+/// Fill is called.
+///
+/// \author Jaap Onderwaater <jacobus.onderwaater@cern.ch>, GSI
+/// \author Ilya Selyuzhenkov <ilya.selyuzhenkov@gmail.com>, GSI
+/// \author Víctor González <victor.gonzalez@cern.ch>, UCM
+/// \date Jan 4, 2016
+class QnCorrectionsQnVectorTreeWriter : public TObject {
+public:
+  QnCorrectionsQnVectorTreeWriter();
+  QnCorrectionsQnVectorTreeWriter(TTree *tree, Int_t nQueueDepth = nDefaultQueueDepth);
+  virtual ~QnCorrectionsQnVectorTreeWriter();
+
+  /// Gets the tree being filled
+  /// \return the tree, not owned
+  TTree *GetTree() const { return fTree; }
+  /// Gets the number of values stored per event
+  /// \return the number of branches, zero before the first event
+  Int_t GetNoOfBranches() const { return fRecordSize; }
+
+  void Start();
+  void Fill(const TList *qnVectorList, Int_t version);
+  void Stop();
+
+  static const Int_t nDefaultQueueDepth;  ///< the default number of events the queue can hold
+
+private:
+  void BuildLayout(const TList *qnVectorList);
+  Int_t GetResolution(const TList *qnVectorList, Int_t version);
+  void Resolve(const TList *qnVectorList, Int_t slot);
+  static void *WriterLoop(void *writer);
+
+  TTree *fTree;                       //!<! the tree being filled, not owned
+  Int_t fQueueDepth;                  ///< the number of events the queue can hold
+  Int_t fNoOfConfigurations;          //!<! the number of detector configurations
+  Int_t fNoOfVectors;                 //!<! the number of Qn vectors of the layout
+  std::vector<TString> fVectorConfiguration; //!<! per Qn vector, its detector configuration name
+  std::vector<TString> fVectorStep;   //!<! per Qn vector, its step name, `latest` for the latest one
+  Int_t *fVectorFirstHarmonic;        //!<! per Qn vector, the position of its first harmonic, plus the end
+  Int_t *fHarmonic;                   //!<! the harmonics of each Qn vector
+  Int_t fRecordSize;                  //!<! the number of values per event
+  Float_t *fQueue;                    //!<! the queued events values
+  Float_t *fBranchesBuffer;           //!<! the values being filled into the tree
+  std::vector<const TList *> fResolvedList;  //!<! the Qn vectors lists the layout was resolved on
+  std::vector<Int_t> fResolvedVersion;       //!<! the structure version of each list at resolution
+  std::vector<const QnCorrectionsQnVector *> fResolvedVector; //!<! per resolved list, the source Qn vector of each layout Qn vector, not owned
+  Int_t fQueueHead;                   //!<! the next slot to be written
+  Int_t fQueueTail;                   //!<! the next slot to be filled into the tree
+  Int_t fNoOfQueued;                  //!<! the number of queued events
+  Bool_t fStopWriter;                 //!<! kTRUE when the writer thread should finish once the queue is empty
+  TThread *fWriterThread;             //!<! the writer thread
+  TMutex *fMutex;                     //!<! protects the queue
+  TCondition *fDataCondition;         //!<! signals a new queued event or the stop request
+  TCondition *fSpaceCondition;        //!<! signals a free queue slot
+
+private:
+  /// Copy constructor
+  /// Not allowed. Forced private.
+  QnCorrectionsQnVectorTreeWriter(const QnCorrectionsQnVectorTreeWriter &);
+  /// Assignment operator
+  /// Not allowed. Forced private.
+  QnCorrectionsQnVectorTreeWriter& operator= (const QnCorrectionsQnVectorTreeWriter &);
+
+/// \cond CLASSIMP
+  ClassDef(QnCorrectionsQnVectorTreeWriter, 2);
+/// \endcond
+};
+
+#endif /* QNCORRECTIONS_QNVECTORTREEWRITER_H */
@@ -79,6 +79,7 @@ QnCorrectionsQnVectorTwistAndRescale::QnCorrectionsQnVectorTwistAndRescale() :
   fMinNoOfEntriesToValidate = fDefaultMinNoOfEntries;
   fTwistCorrectedQnVector = NULL;
   fRescaleCorrectedQnVector = NULL;
+  fParametersTable = NULL;
 }
 
 /// Default destructor
@@ -102,6 +103,7 @@ QnCorrectionsQnVectorTwistAndRescale::~QnCorrectionsQnVectorTwistAndRescale() {
     delete fTwistCorrectedQnVector;
   if (fRescaleCorrectedQnVector != NULL)
     delete fRescaleCorrectedQnVector;
+  ReleaseParametersTable();
 }
 
 /// Set the detector configurations used as reference for twist and rescaling
@@ -232,11 +234,11 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::CreateSupportHistograms(TList *list
 
   switch (fTwistAndRescaleMethod) {
   case TWRESCALE_doubleHarmonic:
-    fDoubleHarmonicInputHistograms = new QnCorrectionsProfileComponents((const char *) histoDoubleHarmonicNameAndTitle, (const char *) histoDoubleHarmonicNameAndTitle,
-        fDetectorConfiguration->GetEventClassVariablesSet());
-    fDoubleHarmonicInputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+    fDoubleHarmonicInputHistograms = NewDoubleHarmonicInputHistograms();
+    fDoubleHarmonicInputHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
     fDoubleHarmonicCalibrationHistograms = new QnCorrectionsProfileComponents((const char *) histoDoubleHarmonicNameAndTitle, (const char *) histoDoubleHarmonicNameAndTitle,
         fDetectorConfiguration->GetEventClassVariablesSet());
+    fDoubleHarmonicCalibrationHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
     harmonicsMap = new Int_t[fCorrectedQnVector->GetNoOfHarmonics()];
     fCorrectedQnVector->GetHarmonicsMap(harmonicsMap);
     /* we duplicate the harmonics used because that will be the info stored by the profiles */
@@ -245,17 +247,14 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::CreateSupportHistograms(TList *list
     delete [] harmonicsMap;
     break;
   case TWRESCALE_correlations:
-    fCorrelationsInputHistograms = new QnCorrectionsProfile3DCorrelations((const char *) histoCorrelationsNameandTitle, (const char *) histoCorrelationsNameandTitle,
-        fDetectorConfiguration->GetName(),
-        fBDetectorConfiguration->GetName(),
-        fCDetectorConfiguration->GetName(),
-        fDetectorConfiguration->GetEventClassVariablesSet());
-    fCorrelationsInputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+    fCorrelationsInputHistograms = NewCorrelationsInputHistograms();
+    fCorrelationsInputHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
     fCorrelationsCalibrationHistograms = new QnCorrectionsProfile3DCorrelations((const char *) histoCorrelationsNameandTitle, (const char *) histoCorrelationsNameandTitle,
         fDetectorConfiguration->GetName(),
         fBDetectorConfiguration->GetName(),
         fCDetectorConfiguration->GetName(),
         fDetectorConfiguration->GetEventClassVariablesSet());
+    fCorrelationsCalibrationHistograms->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
     harmonicsMap = new Int_t[fCorrectedQnVector->GetNoOfHarmonics()];
     fCorrectedQnVector->GetHarmonicsMap(harmonicsMap);
     fCorrelationsCalibrationHistograms->CreateCorrelationComponentsProfileHistograms(list, fCorrectedQnVector->GetNoOfHarmonics(), 1 /* harmonic multiplier */, harmonicsMap);
@@ -277,6 +276,8 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::AttachInput(TList *list) {
     /* TODO: basically we are re producing half of the information already produce for recentering correction. Re use it! */
     if (fDoubleHarmonicInputHistograms->AttachHistograms(list)) {
       QnCorrectionsInfo(Form("Twist and rescale by the double harmonic method on %s going to be applied", fDetectorConfiguration->GetName()));
+      ReleaseParametersTable();
+      fParametersTable = BuildParametersTable(list, fDoubleHarmonicInputHistograms, NULL);
       fState = QCORRSTEP_applyCollect;
       return kTRUE;
     }
@@ -284,6 +285,8 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::AttachInput(TList *list) {
   case TWRESCALE_correlations:
     if (fCorrelationsInputHistograms->AttachHistograms(list)) {
       QnCorrectionsInfo(Form("Twist and rescale by the correlations method on %s going to be applied", fDetectorConfiguration->GetName()));
+      ReleaseParametersTable();
+      fParametersTable = BuildParametersTable(list, NULL, fCorrelationsInputHistograms);
       fState = QCORRSTEP_applyCollect;
       return kTRUE;
     }
@@ -294,6 +297,197 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::AttachInput(TList *list) {
   return kFALSE;
 }
 
+/// Prepares in advance the input information of a calibration list
+///
+/// The correction parameters table is built out of private input
+/// histograms, according to the chosen method, and published. A
+/// reference to it is held so that AttachInput for the same list
+/// finds it already built.
+/// \param list list where the inputs should be found
+/// \return kTRUE if the correction parameters table is available
+Bool_t QnCorrectionsQnVectorTwistAndRescale::PrepareInput(TList *list) {
+
+  const QnCorrectionsCalibrationSnapshot *table = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (table == NULL) {
+    switch (fTwistAndRescaleMethod) {
+    case TWRESCALE_doubleHarmonic:
+    {
+      QnCorrectionsProfileComponents *inputHistograms = NewDoubleHarmonicInputHistograms();
+      if (inputHistograms->AttachHistograms(list))
+        table = BuildParametersTable(list, inputHistograms, NULL);
+      delete inputHistograms;
+    }
+    break;
+    case TWRESCALE_correlations:
+    {
+      QnCorrectionsProfile3DCorrelations *inputHistograms = NewCorrelationsInputHistograms();
+      if (inputHistograms->AttachHistograms(list))
+        table = BuildParametersTable(list, NULL, inputHistograms);
+      delete inputHistograms;
+    }
+    break;
+    default:
+      QnCorrectionsFatal(Form("Wrong stored twist and rescale method: %d. FIX IT, PLEASE", fTwistAndRescaleMethod));
+    }
+  }
+  if (table == NULL) return kFALSE;
+  HoldPreparedInput(table);
+  return kTRUE;
+}
+
+/// Creates the input histograms for the double harmonic method
+///
+/// Their event class bins are not set, so the caller should
+/// set them if the histograms are going to be used for event processing.
+/// \return the new input histograms
+QnCorrectionsProfileComponents *QnCorrectionsQnVectorTwistAndRescale::NewDoubleHarmonicInputHistograms() const {
+
+  TString histoDoubleHarmonicNameAndTitle = Form("%s %s ",
+      szDoubleHarmonicSupportHistogramName,
+      fDetectorConfiguration->GetName());
+
+  QnCorrectionsProfileComponents *inputHistograms =
+      new QnCorrectionsProfileComponents((const char *) histoDoubleHarmonicNameAndTitle, (const char *) histoDoubleHarmonicNameAndTitle,
+          fDetectorConfiguration->GetEventClassVariablesSet());
+  inputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  return inputHistograms;
+}
+
+/// Creates the input histograms for the correlations method
+///
+/// Their event class bins are not set, so the caller should
+/// set them if the histograms are going to be used for event processing.
+/// \return the new input histograms
+QnCorrectionsProfile3DCorrelations *QnCorrectionsQnVectorTwistAndRescale::NewCorrelationsInputHistograms() const {
+
+  TString histoCorrelationsNameandTitle = Form("%s %s ",
+      szCorrelationsSupportHistogramName,
+      fDetectorConfiguration->GetName());
+
+  QnCorrectionsProfile3DCorrelations *inputHistograms =
+      new QnCorrectionsProfile3DCorrelations((const char *) histoCorrelationsNameandTitle, (const char *) histoCorrelationsNameandTitle,
+          fDetectorConfiguration->GetName(),
+          fBDetectorConfiguration->GetName(),
+          fCDetectorConfiguration->GetName(),
+          fDetectorConfiguration->GetEventClassVariablesSet());
+  inputHistograms->SetNoOfEntriesThreshold(fMinNoOfEntriesToValidate);
+  return inputHistograms;
+}
+
+/// Builds the correction parameters table out of the input histograms
+///
+/// For each event class bin the validation flag is stored together with,
+/// for each configured harmonic, the \f$ \Lambda^{\pm} \f$ and \f$ A^{\pm} \f$
+/// parameters extracted according to the chosen method and the status
+/// of their meaningfulness. The table is addressed by the histograms bin
+/// number and the harmonic number so, the correction apply only needs a
+/// table lookup.
+///
+/// The table is shared with any other instance of the correction step
+/// attached to the same calibration list so, it is only built if none
+/// of them has already published it.
+/// \param list the list the inputs were found in
+/// \param doubleHarmonicHistograms the input histograms attached to the list for the double harmonic method
+/// \param correlationsHistograms the input histograms attached to the list for the correlations method
+/// \return the correction parameters table with a reference taken
+const QnCorrectionsCalibrationSnapshot *QnCorrectionsQnVectorTwistAndRescale::BuildParametersTable(TList *list,
+    QnCorrectionsProfileComponents *doubleHarmonicHistograms, QnCorrectionsProfile3DCorrelations *correlationsHistograms) {
+
+  const QnCorrectionsCalibrationSnapshot *published = QnCorrectionsCalibrationSnapshot::Acquire(list, GetName());
+  if (published != NULL) return published;
+
+  Int_t nNoOfHarmonics = fDetectorConfiguration->GetNoOfHarmonics();
+  Int_t *harmonicsMap = new Int_t[nNoOfHarmonics];
+  fDetectorConfiguration->GetHarmonicMap(harmonicsMap);
+  Int_t nNoOfSlots = 0;
+  for (Int_t h = 0; h < nNoOfHarmonics; h++) {
+    if (nNoOfSlots < harmonicsMap[h] + 1) nNoOfSlots = harmonicsMap[h] + 1;
+  }
+
+  QnCorrectionsHistogramBase *inputHistograms = NULL;
+  switch (fTwistAndRescaleMethod) {
+  case TWRESCALE_doubleHarmonic:
+    inputHistograms = doubleHarmonicHistograms;
+    break;
+  case TWRESCALE_correlations:
+    inputHistograms = correlationsHistograms;
+    break;
+  default:
+    QnCorrectionsFatal(Form("Wrong stored twist and rescale method: %d. FIX IT, PLEASE", fTwistAndRescaleMethod));
+  }
+
+  QnCorrectionsCalibrationSnapshot *table =
+      new QnCorrectionsCalibrationSnapshot(list, GetName(), inputHistograms->GetNoOfBins(), nNoOfSlots, 4, kTRUE);
+
+  for (Long64_t bin = 0; bin < table->GetNoOfBins(); bin++) {
+    table->SetBinValidated(bin, inputHistograms->BinContentValidated(bin));
+    Char_t *status = table->GetStatusToBuild(bin);
+    Float_t *parameters = table->GetParametersToBuild(bin);
+    for (Int_t slot = 0; slot < nNoOfSlots; slot++) {
+      status[slot] = TWRESCALE_skip;
+      parameters[slot * 4 + 0] = 0.0;
+      parameters[slot * 4 + 1] = 0.0;
+      parameters[slot * 4 + 2] = 1.0;
+      parameters[slot * 4 + 3] = 1.0;
+    }
+    if (!table->IsBinValidated(bin)) continue;
+
+    for (Int_t h = 0; h < nNoOfHarmonics; h++) {
+      Int_t harmonic = harmonicsMap[h];
+      Double_t Aplus = 0.0;
+      Double_t Aminus = 0.0;
+      Double_t LambdaPlus = 0.0;
+      Double_t LambdaMinus = 0.0;
+
+      if (fTwistAndRescaleMethod == TWRESCALE_doubleHarmonic) {
+        /* remember we store the profile information on a twice the harmonic number base */
+        Double_t X2n = doubleHarmonicHistograms->GetXBinContent(harmonic*2,bin);
+        Double_t Y2n = doubleHarmonicHistograms->GetYBinContent(harmonic*2,bin);
+
+        Aplus = 1 + X2n;
+        Aminus = 1 - X2n;
+        LambdaPlus = Y2n / Aplus;
+        LambdaMinus = Y2n / Aminus;
+      }
+      else {
+        Double_t XAXC = correlationsHistograms->GetXXBinContent("AC",harmonic,bin);
+        Double_t YAYB = correlationsHistograms->GetYYBinContent("AB",harmonic,bin);
+        Double_t XAXB = correlationsHistograms->GetXXBinContent("AB",harmonic,bin);
+        Double_t XBXC = correlationsHistograms->GetXXBinContent("BC",harmonic,bin);
+        Double_t XAYB = correlationsHistograms->GetXYBinContent("AB",harmonic,bin);
+        Double_t XBYC = correlationsHistograms->GetXYBinContent("BC",harmonic,bin);
+
+        Aplus = TMath::Sqrt(TMath::Abs(2.0*XAXC)) * XAXB / TMath::Sqrt(TMath::Abs(XAXB * XBXC + XAYB * XBYC));
+        Aminus = TMath::Sqrt(TMath::Abs(2.0*XAXC)) * YAYB / TMath::Sqrt(TMath::Abs(XAXB * XBXC + XAYB * XBYC));
+        LambdaPlus = XAYB / XAXB;
+        LambdaMinus = XAYB / YAYB;
+      }
+
+      if (TMath::Abs(Aplus) > fMaxThreshold) continue;
+      if (TMath::Abs(Aminus) > fMaxThreshold) continue;
+      if (TMath::Abs(LambdaPlus) > fMaxThreshold) continue;
+      if (TMath::Abs(LambdaMinus) > fMaxThreshold) continue;
+
+      parameters[harmonic * 4 + 0] = LambdaPlus;
+      parameters[harmonic * 4 + 1] = LambdaMinus;
+      parameters[harmonic * 4 + 2] = Aplus;
+      parameters[harmonic * 4 + 3] = Aminus;
+      if (Aplus == 0.0 || Aminus == 0.0)
+        status[harmonic] = TWRESCALE_twistOnly;
+      else
+        status[harmonic] = TWRESCALE_twistAndRescale;
+    }
+  }
+  delete [] harmonicsMap;
+  return QnCorrectionsCalibrationSnapshot::Publish(table);
+}
+
+/// Releases the reference to the correction parameters table
+void QnCorrectionsQnVectorTwistAndRescale::ReleaseParametersTable() {
+  QnCorrectionsCalibrationSnapshot::Release(fParametersTable);
+  fParametersTable = NULL;
+}
+
 /// Perform after calibration histograms attach actions
 /// It is used to inform the different correction step that
 /// all conditions for running the network are in place so
@@ -334,12 +528,14 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::CreateQAHistograms(TList *list) {
         Form("%s %s", szQATwistQnAverageHistogramName, fDetectorConfiguration->GetName()),
         Form("%s %s", szQATwistQnAverageHistogramName, fDetectorConfiguration->GetName()),
         fDetectorConfiguration->GetEventClassVariablesSet());
+    fQATwistQnAverageHistogram->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   }
   if (fApplyRescale) {
     fQARescaleQnAverageHistogram = new QnCorrectionsProfileComponents(
         Form("%s %s", szQARescaleQnAverageHistogramName, fDetectorConfiguration->GetName()),
         Form("%s %s", szQARescaleQnAverageHistogramName, fDetectorConfiguration->GetName()),
         fDetectorConfiguration->GetEventClassVariablesSet());
+    fQARescaleQnAverageHistogram->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
   }
 
   if (fApplyTwist || fApplyRescale) {
@@ -369,6 +565,7 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::CreateNveQAHistograms(TList *list)
         Form("%s%s %s", szQANotValidatedHistogramName, "DH", fDetectorConfiguration->GetName()),
         Form("%s%s %s", szQANotValidatedHistogramName, "DH", fDetectorConfiguration->GetName()),
         fDetectorConfiguration->GetEventClassVariablesSet());
+    fQANotValidatedBin->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
     fQANotValidatedBin->CreateHistogram(list);
     break;
   case TWRESCALE_correlations:
@@ -376,6 +573,7 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::CreateNveQAHistograms(TList *list)
         Form("%s%s %s", szQANotValidatedHistogramName, "CORR", fDetectorConfiguration->GetName()),
         Form("%s%s %s", szQANotValidatedHistogramName, "CORR", fDetectorConfiguration->GetName()),
         fDetectorConfiguration->GetEventClassVariablesSet());
+    fQANotValidatedBin->SetEventClassBins(fDetectorConfiguration->GetEventClassBins());
     fQANotValidatedBin->CreateHistogram(list);
     break;
   default:
@@ -403,147 +601,78 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::ProcessCorrections(const Float_t *v
     /* and proceed to ... */
   case QCORRSTEP_apply: { /* apply the correction if the current Qn vector is good enough */
     /* logging */
+    Long64_t bin = -1;
     switch (fTwistAndRescaleMethod) {
-    case TWRESCALE_doubleHarmonic: {
-      /* TODO: basically we are re producing half of the information already produce for recentering correction. Re use it! */
-      QnCorrectionsInfo(Form("Twist and rescale in detector %s with double harmonic method.",
+    case TWRESCALE_doubleHarmonic:
+      QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Twist and rescale in detector %s with double harmonic method.",
           fDetectorConfiguration->GetName()));
-      if (fDetectorConfiguration->GetCurrentQnVector()->IsGoodQuality()) {
-        fCorrectedQnVector->Set(fDetectorConfiguration->GetCurrentQnVector(),kFALSE);
-        fTwistCorrectedQnVector->Set(fCorrectedQnVector, kFALSE);
-        fRescaleCorrectedQnVector->Set(fCorrectedQnVector, kFALSE);
-
-        /* let's check the correction histograms */
-        Long64_t bin = fDoubleHarmonicInputHistograms->GetBin(variableContainer);
-        if (fDoubleHarmonicInputHistograms->BinContentValidated(bin)) {
-          /* remember we store the profile information on a twice the harmonic number base */
-          harmonic = fCorrectedQnVector->GetFirstHarmonic();
-          while (harmonic != -1) {
-            Double_t X2n = fDoubleHarmonicInputHistograms->GetXBinContent(harmonic*2,bin);
-            Double_t Y2n = fDoubleHarmonicInputHistograms->GetYBinContent(harmonic*2,bin);
-
-            Double_t Aplus = 1 + X2n;
-            Double_t Aminus = 1 - X2n;
-            Double_t LambdaPlus = Y2n / Aplus;
-            Double_t LambdaMinus = Y2n / Aminus;
-
-            if (TMath::Abs(Aplus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (TMath::Abs(Aminus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (TMath::Abs(LambdaPlus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (TMath::Abs(LambdaMinus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-
-            Double_t Qx = fTwistCorrectedQnVector->Qx(harmonic);
-            Double_t Qy = fTwistCorrectedQnVector->Qy(harmonic);
-            Double_t newQx = (Qx - LambdaMinus * Qy)/(1 - LambdaMinus * LambdaPlus);
-            Double_t newQy = (Qy - LambdaPlus * Qx)/(1 - LambdaMinus * LambdaPlus);
-
-            if (fApplyTwist) {
-              fCorrectedQnVector->SetQx(harmonic, newQx);
-              fCorrectedQnVector->SetQy(harmonic, newQy);
-              fTwistCorrectedQnVector->SetQx(harmonic, newQx);
-              fTwistCorrectedQnVector->SetQy(harmonic, newQy);
-              fRescaleCorrectedQnVector->SetQx(harmonic, newQx);
-              fRescaleCorrectedQnVector->SetQy(harmonic, newQy);
-            }
-            newQx = newQx / Aplus;
-            newQy = newQy / Aminus;
-
-            if (Aplus == 0.0) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (Aminus == 0.0) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-
-            if (fApplyRescale) {
-              fCorrectedQnVector->SetQx(harmonic, newQx);
-              fCorrectedQnVector->SetQy(harmonic, newQy);
-              fRescaleCorrectedQnVector->SetQx(harmonic, newQx);
-              fRescaleCorrectedQnVector->SetQy(harmonic, newQy);
-            }
-            harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
-          }
-        }
-        else {
-          if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, 1.0);
-        }
-      }
-      else {
-        /* not done! input Q vector with bad quality */
-        fCorrectedQnVector->SetGood(kFALSE);
-      }
-    }
-    break;
-
-    case TWRESCALE_correlations: {
-      QnCorrectionsInfo(Form("Twist and rescale in detector %s with correlations with %s and %s method.",
+      bin = fDoubleHarmonicInputHistograms->GetBin(variableContainer);
+      break;
+    case TWRESCALE_correlations:
+      QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Twist and rescale in detector %s with correlations with %s and %s method.",
           fDetectorConfiguration->GetName(),
           fBDetectorConfiguration->GetName(),
           fCDetectorConfiguration->GetName()));
-      if (fDetectorConfiguration->GetCurrentQnVector()->IsGoodQuality()) {
-        fCorrectedQnVector->Set(fDetectorConfiguration->GetCurrentQnVector(),kFALSE);
-        fTwistCorrectedQnVector->Set(fCorrectedQnVector, kFALSE);
-        fRescaleCorrectedQnVector->Set(fCorrectedQnVector, kFALSE);
-
-        /* let's check the correction histograms */
-        Long64_t bin = fCorrelationsInputHistograms->GetBin(variableContainer);
-        if (fCorrelationsInputHistograms->BinContentValidated(bin)) {
-          harmonic = fCorrectedQnVector->GetFirstHarmonic();
-          while (harmonic != -1) {
-            Double_t XAXC = fCorrelationsInputHistograms->GetXXBinContent("AC",harmonic,bin);
-            Double_t YAYB = fCorrelationsInputHistograms->GetYYBinContent("AB",harmonic,bin);
-            Double_t XAXB = fCorrelationsInputHistograms->GetXXBinContent("AB",harmonic,bin);
-            Double_t XBXC = fCorrelationsInputHistograms->GetXXBinContent("BC",harmonic,bin);
-            Double_t XAYB = fCorrelationsInputHistograms->GetXYBinContent("AB",harmonic,bin);
-            Double_t XBYC = fCorrelationsInputHistograms->GetXYBinContent("BC",harmonic,bin);
-
-            Double_t Aplus = TMath::Sqrt(TMath::Abs(2.0*XAXC)) * XAXB / TMath::Sqrt(TMath::Abs(XAXB * XBXC + XAYB * XBYC));
-            Double_t Aminus = TMath::Sqrt(TMath::Abs(2.0*XAXC)) * YAYB / TMath::Sqrt(TMath::Abs(XAXB * XBXC + XAYB * XBYC));
-            Double_t LambdaPlus = XAYB / XAXB;
-            Double_t LambdaMinus = XAYB / YAYB;
-
-            if (TMath::Abs(Aplus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (TMath::Abs(Aminus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (TMath::Abs(LambdaPlus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (TMath::Abs(LambdaMinus) > fMaxThreshold) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-
-            Double_t Qx = fTwistCorrectedQnVector->Qx(harmonic);
-            Double_t Qy = fTwistCorrectedQnVector->Qy(harmonic);
-            Double_t newQx = (Qx - LambdaMinus * Qy)/(1 - LambdaMinus * LambdaPlus);
-            Double_t newQy = (Qy - LambdaPlus * Qx)/(1 - LambdaMinus * LambdaPlus);
-
-            if (fApplyTwist) {
-              fCorrectedQnVector->SetQx(harmonic, newQx);
-              fCorrectedQnVector->SetQy(harmonic, newQy);
-              fTwistCorrectedQnVector->SetQx(harmonic, newQx);
-              fTwistCorrectedQnVector->SetQy(harmonic, newQy);
-              fRescaleCorrectedQnVector->SetQx(harmonic, newQx);
-              fRescaleCorrectedQnVector->SetQy(harmonic, newQy);
-            }
-            newQx = newQx / Aplus;
-            newQy = newQy / Aminus;
-
-            if (Aplus == 0.0) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-            if (Aminus == 0.0) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
-
-            if (fApplyRescale) {
-              fCorrectedQnVector->SetQx(harmonic, newQx);
-              fCorrectedQnVector->SetQy(harmonic, newQy);
-              fRescaleCorrectedQnVector->SetQx(harmonic, newQx);
-              fRescaleCorrectedQnVector->SetQy(harmonic, newQy);
-            }
-            harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
+      bin = fCorrelationsInputHistograms->GetBin(variableContainer);
+      break;
+    default:
+      QnCorrectionsFatal(Form("Wrong stored twist and rescale method: %d. FIX IT, PLEASE", fTwistAndRescaleMethod));
+    }
+    if (fDetectorConfiguration->GetCurrentQnVector()->IsGoodQuality()) {
+      fCorrectedQnVector->Set(fDetectorConfiguration->GetCurrentQnVector(),kFALSE);
+      fTwistCorrectedQnVector->Set(fCorrectedQnVector, kFALSE);
+      fRescaleCorrectedQnVector->Set(fCorrectedQnVector, kFALSE);
+
+      /* let's check the correction parameters table */
+      if (fParametersTable->IsBinValidated(bin)) {
+        QnCorrectionsInstrumentBin(fCorrectionsCounters, kTRUE);
+        const Char_t *status = fParametersTable->GetStatus(bin);
+        const Float_t *parameters = fParametersTable->GetParameters(bin);
+        harmonic = fCorrectedQnVector->GetFirstHarmonic();
+        while (harmonic != -1) {
+          if (status[harmonic] == TWRESCALE_skip) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
+
+          Double_t LambdaPlus = parameters[harmonic * 4 + 0];
+          Double_t LambdaMinus = parameters[harmonic * 4 + 1];
+          Double_t Aplus = parameters[harmonic * 4 + 2];
+          Double_t Aminus = parameters[harmonic * 4 + 3];
+
+          Double_t Qx = fTwistCorrectedQnVector->Qx(harmonic);
+          Double_t Qy = fTwistCorrectedQnVector->Qy(harmonic);
+          Double_t newQx = (Qx - LambdaMinus * Qy)/(1 - LambdaMinus * LambdaPlus);
+          Double_t newQy = (Qy - LambdaPlus * Qx)/(1 - LambdaMinus * LambdaPlus);
+
+          if (fApplyTwist) {
+            fCorrectedQnVector->SetQx(harmonic, newQx);
+            fCorrectedQnVector->SetQy(harmonic, newQy);
+            fTwistCorrectedQnVector->SetQx(harmonic, newQx);
+            fTwistCorrectedQnVector->SetQy(harmonic, newQy);
+            fRescaleCorrectedQnVector->SetQx(harmonic, newQx);
+            fRescaleCorrectedQnVector->SetQy(harmonic, newQy);
           }
-        }
-        else {
-          if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, 1.0);
+
+          if (status[harmonic] == TWRESCALE_twistOnly) { harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic); continue; }
+
+          newQx = newQx / Aplus;
+          newQy = newQy / Aminus;
+
+          if (fApplyRescale) {
+            fCorrectedQnVector->SetQx(harmonic, newQx);
+            fCorrectedQnVector->SetQy(harmonic, newQy);
+            fRescaleCorrectedQnVector->SetQx(harmonic, newQx);
+            fRescaleCorrectedQnVector->SetQy(harmonic, newQy);
+          }
+          harmonic = fCorrectedQnVector->GetNextHarmonic(harmonic);
         }
       }
       else {
-        /* not done! input Q vector with bad quality */
-        fCorrectedQnVector->SetGood(kFALSE);
+        QnCorrectionsInstrumentBin(fCorrectionsCounters, kFALSE);
+        if (fQANotValidatedBin != NULL) fQANotValidatedBin->Fill(variableContainer, 1.0);
       }
     }
-    break;
-
-    default:
-      QnCorrectionsFatal(Form("Wrong stored twist and rescale method: %d. FIX IT, PLEASE", fTwistAndRescaleMethod));
+    else {
+      /* not done! input Q vector with bad quality */
+      fCorrectedQnVector->SetGood(kFALSE);
     }
     /* and update the current Qn vector */
     if (fApplyTwist) {
@@ -573,7 +702,7 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::ProcessDataCollection(const Float_t
     /* logging */
     switch (fTwistAndRescaleMethod) {
     case TWRESCALE_doubleHarmonic: {
-      QnCorrectionsInfo(Form("Twist and rescale in detector %s with double harmonic method. Collecting data",
+      QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Twist and rescale in detector %s with double harmonic method. Collecting data",
           fDetectorConfiguration->GetName()));
       /* remember, we store in the profiles the double harmonic while the Q2n vector stores them single */
       QnCorrectionsQnVector *plainQ2nVector = fDetectorConfiguration->GetPlainQ2nVector();
@@ -589,7 +718,7 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::ProcessDataCollection(const Float_t
     break;
 
     case TWRESCALE_correlations: {
-      QnCorrectionsInfo(Form("Twist and rescale in detector %s with correlations with %s and %s method. Collecting data",
+      QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Twist and rescale in detector %s with correlations with %s and %s method. Collecting data",
           fDetectorConfiguration->GetName(),
           fBDetectorConfiguration->GetName(),
           fCDetectorConfiguration->GetName()));
@@ -617,7 +746,7 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::ProcessDataCollection(const Float_t
     /* logging */
     switch (fTwistAndRescaleMethod) {
     case TWRESCALE_doubleHarmonic: {
-      QnCorrectionsInfo(Form("Twist and rescale in detector %s with double harmonic method. Collecting data",
+      QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Twist and rescale in detector %s with double harmonic method. Collecting data",
           fDetectorConfiguration->GetName()));
       /* remember, we store in the profiles the double harmonic while the Q2n vector stores them single */
       QnCorrectionsQnVector *plainQ2nVector = fDetectorConfiguration->GetPlainQ2nVector();
@@ -633,7 +762,7 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::ProcessDataCollection(const Float_t
     break;
 
     case TWRESCALE_correlations: {
-      QnCorrectionsInfo(Form("Twist and rescale in detector %s with correlations with %s and %s method. Collecting data",
+      QnCorrectionsCategoryInfo(kQnCorrectionsLogEventProcessing, Form("Twist and rescale in detector %s with correlations with %s and %s method. Collecting data",
           fDetectorConfiguration->GetName(),
           fBDetectorConfiguration->GetName(),
           fCDetectorConfiguration->GetName()));
@@ -773,3 +902,25 @@ Bool_t QnCorrectionsQnVectorTwistAndRescale::ReportUsage(TList *calibrationList,
   return kFALSE;
 }
 
+/// Transfers the accumulated content of the filled histograms to them
+void QnCorrectionsQnVectorTwistAndRescale::FlushHistograms() {
+  if (fDoubleHarmonicCalibrationHistograms != NULL)
+    fDoubleHarmonicCalibrationHistograms->FlushAccumulator();
+  if (fCorrelationsCalibrationHistograms != NULL)
+    fCorrelationsCalibrationHistograms->FlushAccumulator();
+  if (fQATwistQnAverageHistogram != NULL)
+    fQATwistQnAverageHistogram->FlushAccumulator();
+  if (fQARescaleQnAverageHistogram != NULL)
+    fQARescaleQnAverageHistogram->FlushAccumulator();
+}
+
+/// Include the B and C detector configurations, if the correlations method is used, into the passed list
+/// \param list list where the referenced detector configurations should be added
+void QnCorrectionsQnVectorTwistAndRescale::FillReferencedConfigurations(TList *list) const {
+  if (fTwistAndRescaleMethod == TWRESCALE_correlations) {
+    if (fBDetectorConfiguration != NULL)
+      list->Add(fBDetectorConfiguration);
+    if (fCDetectorConfiguration != NULL)
+      list->Add(fCDetectorConfiguration);
+  }
+}
@@ -83,6 +83,7 @@
 /* harmonic multiplier */
 
 #include "QnCorrectionsCorrectionOnQvector.h"
+#include "QnCorrectionsCalibrationSnapshot.h"
 
 /// \class QnCorrectionsQnVectorTwistAndRescale
 /// \brief Encapsulates twist and rescale on Q vector
@@ -170,6 +171,7 @@ public:
 
   virtual void AttachedToFrameworkManager();
   virtual Bool_t AttachInput(TList *list);
+  virtual Bool_t PrepareInput(TList *list);
   virtual void AfterInputsAttachActions();
 virtual void CreateSupportDataStructures();
   virtual Bool_t CreateSupportHistograms(TList *list);
@@ -179,11 +181,26 @@ virtual void CreateSupportDataStructures();
   virtual Bool_t ProcessCorrections(const Float_t *variableContainer);
   virtual Bool_t ProcessDataCollection(const Float_t *variableContainer);
   virtual void ClearCorrectionStep();
+  virtual void FlushHistograms();
   virtual void IncludeCorrectedQnVector(TList *list);
   virtual Bool_t IsBeingApplied() const;
   virtual Bool_t ReportUsage(TList *calibrationList, TList *applyList);
+  virtual void FillReferencedConfigurations(TList *list) const;
 
 private:
+  /// \enum QnTwistAndRescaleParameterStatus
+  /// \brief The status of the twist and rescale parameters for a given bin and harmonic
+  enum QnTwistAndRescaleParameterStatus {
+    TWRESCALE_skip,                ///< parameters out of meaningful range, harmonic left untouched
+    TWRESCALE_twistOnly,           ///< twist parameters meaningful, rescale ones not
+    TWRESCALE_twistAndRescale      ///< both twist and rescale parameters meaningful
+  };
+  QnCorrectionsProfileComponents *NewDoubleHarmonicInputHistograms() const;
+  QnCorrectionsProfile3DCorrelations *NewCorrelationsInputHistograms() const;
+  const QnCorrectionsCalibrationSnapshot *BuildParametersTable(TList *list,
+      QnCorrectionsProfileComponents *doubleHarmonicHistograms, QnCorrectionsProfile3DCorrelations *correlationsHistograms);
+  void ReleaseParametersTable();
+
   static const Int_t fDefaultMinNoOfEntries;         ///< the minimum number of entries for bin content validation
   static const Double_t fMaxThreshold;               ///< highest absolute value for meaningful results
   static const char *szTwistCorrectionName;          ///< the name of the twist correction step
@@ -215,8 +232,10 @@ private:
   QnCorrectionsQnVector *fTwistCorrectedQnVector;   ///< twisted Qn vector
   QnCorrectionsQnVector *fRescaleCorrectedQnVector; ///< rescaled Qn vector
 
+  const QnCorrectionsCalibrationSnapshot *fParametersTable; //!<! shared, per bin and harmonic the \f$ \Lambda^{+}, \Lambda^{-}, A^{+}, A^{-} \f$ values and their status
+
 /// \cond CLASSIMP
-  ClassDef(QnCorrectionsQnVectorTwistAndRescale, 2);
+  ClassDef(QnCorrectionsQnVectorTwistAndRescale, 4);
 /// \endcond
 };
 
@@ -13,6 +13,10 @@
 #pragma link off all classes;
 #pragma link off all functions;
 
+#pragma link C++ class QnCorrectionsCalibrationDriver+;
+#pragma link C++ class QnCorrectionsCalibrationMerger+;
+#pragma link C++ class QnCorrectionsCalibrationSnapshot+;
+#pragma link C++ class QnCorrectionsConfigurationsScheduler+;
 #pragma link C++ class QnCorrectionsCorrectionOnInputData+;
 #pragma link C++ class QnCorrectionsCorrectionOnQvector+;
 #pragma link C++ class QnCorrectionsCorrectionsSetOnInputData+;
@@ -27,23 +31,31 @@
 #pragma link C++ class QnCorrectionsCutValue+;
 #pragma link C++ class QnCorrectionsCutWithin+;
 #pragma link C++ class QnCorrectionsDataVector+;
+#pragma link C++ class QnCorrectionsDataVectorBank+;
 #pragma link C++ class QnCorrectionsDataVectorChannelized+;
 #pragma link C++ class QnCorrectionsDetector+;
 #pragma link C++ class QnCorrectionsDetectorConfigurationBase+;
 #pragma link C++ class QnCorrectionsDetectorConfigurationChannels+;
 #pragma link C++ class QnCorrectionsDetectorConfigurationsSet+;
 #pragma link C++ class QnCorrectionsDetectorConfigurationTracks+;
+#pragma link C++ class QnCorrectionsEventClassBins+;
 #pragma link C++ class QnCorrectionsEventClassVariable+;
 #pragma link C++ class QnCorrectionsEventClassVariablesSet+;
+#pragma link C++ class QnCorrectionsEventContext+;
+#pragma link C++ class QnCorrectionsEventGenerator+;
+#pragma link C++ class QnCorrectionsEventReader+;
+#pragma link C++ class QnCorrectionsEventRecorder+;
 #pragma link C++ class QnCorrectionsHistogram+;
 #pragma link C++ class QnCorrectionsHistogramBase+;
 #pragma link C++ class QnCorrectionsHistogramChannelized+;
 #pragma link C++ class QnCorrectionsHistogramChannelizedSparse+;
 #pragma link C++ class QnCorrectionsHistogramSparse+;
 #pragma link C++ class QnCorrectionsInputGainEqualization+;
+#pragma link C++ class QnCorrectionsInstrumentation+;
 #pragma link C++ class QnCorrectionsManager+;
 #pragma link C++ class QnCorrectionsProfile+;
 #pragma link C++ class QnCorrectionsProfile3DCorrelations+;
+#pragma link C++ class QnCorrectionsProfileAccumulator+;
 #pragma link C++ class QnCorrectionsProfileChannelized+;
 #pragma link C++ class QnCorrectionsProfileChannelizedIngress+;
 #pragma link C++ class QnCorrectionsProfileComponents+;
@@ -52,7 +64,9 @@
 #pragma link C++ class QnCorrectionsQnVector+;
 #pragma link C++ class QnCorrectionsQnVectorAlignment+;
 #pragma link C++ class QnCorrectionsQnVectorBuild+;
+#pragma link C++ class QnCorrectionsQnVectorHandle+;
 #pragma link C++ class QnCorrectionsQnVectorRecentering+;
+#pragma link C++ class QnCorrectionsQnVectorTreeWriter+;
 #pragma link C++ class QnCorrectionsQnVectorTwistAndRescale+;
 
 #endif
@@ -20,6 +20,8 @@ replacetracingnames ()
   for j in $tracingnames; do
     sed -i "s/QnCorrections${j}/Ali${j}/g" $file
   done
+  # the categorized messages drop the category
+  sed -i "s/QnCorrectionsCategory\(Info\|Warning\)([^,]*, */Ali\1(/g" $file
 }
 
 
@@ -35,7 +37,11 @@ fi
 
 rsync -av $inputfolder/ $outputfolder
 
-listclasses="CorrectionOnInputData
+listclasses="CalibrationDriver
+CalibrationMerger
+CalibrationSnapshot
+ConfigurationsScheduler
+CorrectionOnInputData
 CorrectionOnQvector
 CorrectionsSetOnInputData
 CorrectionsSetOnQvector
@@ -50,14 +56,24 @@ CutValue
 CutWithin
 DataVector
 Detector
+EventClassBins
 EventClassVariable
+EventContext
+EventGenerator
+EventReader
+EventRecorder
 Histogram
 InputGainEqualization
+Instrumentation
 Manager
 Profile
 QnVector"
 
-listclassesfiles="CorrectionOnInputData
+listclassesfiles="CalibrationDriver
+CalibrationMerger
+CalibrationSnapshot
+ConfigurationsScheduler
+CorrectionOnInputData
 CorrectionOnQvector
 CorrectionsSetOnInputData
 CorrectionsSetOnQvector
@@ -71,23 +87,31 @@ CutsSet
 CutValue
 CutWithin
 DataVector
+DataVectorBank
 DataVectorChannelized
 Detector
 DetectorConfigurationBase
 DetectorConfigurationChannels
 DetectorConfigurationsSet
 DetectorConfigurationTracks
+EventClassBins
 EventClassVariable
 EventClassVariablesSet
+EventContext
+EventGenerator
+EventReader
+EventRecorder
 Histogram
 HistogramBase
 HistogramChannelized
 HistogramChannelizedSparse
 HistogramSparse
 InputGainEqualization
+Instrumentation
 Manager
 Profile
 Profile3DCorrelations
+ProfileAccumulator
 ProfileChannelized
 ProfileChannelizedIngress
 ProfileComponents
@@ -95,9 +119,11 @@ ProfileCorrelationComponents
 ProfileCorrelationComponentsHarmonics
 QnVector
 QnVectorBuild
+QnVectorHandle
 QnVectorRecentering
 QnVectorAlignment
-QnVectorTwistAndRescale"
+QnVectorTwistAndRescale
+QnVectorTreeWriter"
 
 for j in $listclassesfiles; do
   mv $outputfolder/QnCorrections${j}.cxx $outputfolder/AliQnCorrections${j}.cxx